@@ -0,0 +1,149 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+// Latency of the active-set QP plug-ins on small model-predictive-control
+// like problems: a sequence of random strictly convex QPs whose bounds
+// move slightly between two solves. Each sequence is solved from scratch
+// (reset and solve), and with resolve (), with and without warm starting
+// from the previous working set.
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/numeric-linear-function.hh>
+#include <roboptim/core/numeric-quadratic-function.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+
+#include "harness.hh"
+
+using namespace roboptim;
+
+namespace
+{
+  enum solveMode_t
+    {
+      COLD,
+      RESOLVE,
+      WARM
+    };
+
+  template <typename T>
+  void run (const char* plugin, int n, solveMode_t mode, int repeat)
+  {
+    typedef Solver<T> solver_t;
+    typedef typename solver_t::problem_t problem_t;
+    typedef typename problem_t::function_t function_t;
+    typedef typename problem_t::intervals_t intervals_t;
+    typedef typename problem_t::scaling_t scaling_t;
+    typedef typename function_t::vector_t vector_t;
+    typedef typename function_t::matrix_t matrix_t;
+
+    // Banded Hessian and constraints, as in discretized dynamics.
+    const int m = n / 2;
+    std::srand (0);
+    Eigen::MatrixXd H = Eigen::MatrixXd::Identity (n, n);
+    for (int i = 0; i + 1 < n; ++i)
+      {
+        H (i, i + 1) = H (i + 1, i) = -.4;
+        H (i, i) += .8;
+      }
+    Eigen::MatrixXd G = Eigen::MatrixXd::Zero (m, n);
+    for (int i = 0; i < m; ++i)
+      for (int j = 2 * i; j < std::min (2 * i + 4, n); ++j)
+        G (i, j) = static_cast<double> (std::rand () % 7) - 3.;
+
+    matrix_t A;
+    A = H.sparseView ();
+    matrix_t C;
+    C = G.sparseView ();
+    vector_t q = 4. * vector_t::Random (n);
+
+    problem_t pb (boost::make_shared<GenericNumericQuadraticFunction<T> >
+                  (A, q));
+    intervals_t bounds (static_cast<std::size_t> (n),
+                        function_t::makeInterval (-1., 1.));
+    pb.setArgumentBounds (bounds);
+    pb.addConstraint (boost::make_shared<GenericNumericLinearFunction<T> >
+                      (C, vector_t::Zero (m)),
+                      intervals_t (static_cast<std::size_t> (m),
+                                   function_t::makeInterval (-1., 1.)),
+                      scaling_t (static_cast<std::size_t> (m), 1.));
+
+    SolverFactory<solver_t> factory (plugin, pb);
+    solver_t& solver = factory ();
+    solver.parameters ()["qp.warm-start"].value = mode == WARM;
+
+    double cost = 0.;
+    const benchmark::Stopwatch watch;
+    for (int k = 0; k < repeat; ++k)
+      {
+        const double shift = .1 * std::sin (.1 * k);
+        for (std::size_t i = 0; i < bounds.size (); ++i)
+          bounds[i] = function_t::makeInterval (-1. + shift, .5 + shift);
+        solver.updateArgumentBounds (bounds);
+
+        if (mode == COLD)
+          {
+            solver.reset ();
+            solver.solve ();
+          }
+        else
+          solver.resolve ();
+
+        if (solver.minimumType () == GenericSolver::SOLVER_VALUE)
+          cost += solver.template getMinimum<Result> ().value[0];
+      }
+    double time = watch.elapsed () / repeat;
+
+    static const char* modes[] = {"cold", "resolve", "warm"};
+    std::cout << plugin << ", " << n << ", " << modes[mode] << ", "
+              << cost / repeat << ", " << time * 1e6 << std::endl;
+  }
+} // end of anonymous namespace
+
+int main ()
+{
+  lt_dlinit ();
+  lt_dlsetsearchpath (PLUGIN_PATH);
+
+  std::cout << "plug-in, n, mode, average cost, time (us)" << std::endl;
+
+  const int sizes[] = {10, 30, 100};
+  for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+    {
+      const int n = sizes[s];
+      const int repeat = n < 100 ? 2000 : 200;
+      for (int mode = COLD; mode <= WARM; ++mode)
+        {
+          run<EigenMatrixDense> ("active-set-qp", n,
+                                 static_cast<solveMode_t> (mode), repeat);
+          run<EigenMatrixSparse> ("active-set-qp-sparse", n,
+                                  static_cast<solveMode_t> (mode), repeat);
+        }
+    }
+
+  PluginRegistry::instance ().unloadUnused ();
+  lt_dlexit ();
+  return 0;
+}
@@ -0,0 +1,176 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+// Scalability of the augmented Lagrangian plug-in on a sparse problem:
+//   min sum_i (x_i - 2)^2  s.t.  x_i^2 + x_{i+1}^2 <= 1
+// The n - 1 constraints are split into 8 constraint functions, evaluated
+// by one or several threads.
+
+#include <iostream>
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+
+#include "harness.hh"
+
+using namespace roboptim;
+
+namespace
+{
+  /// \brief Cost: sum_i (x_i - 2)^2.
+  struct Cost : public DifferentiableSparseFunction
+  {
+    explicit Cost (size_type n)
+      : DifferentiableSparseFunction (n, 1, "sum (x_i - 2)^2")
+    {}
+
+    void impl_compute (result_ref res, const_argument_ref x) const
+    {
+      res[0] = (x.array () - 2.).square ().sum ();
+    }
+
+    void impl_gradient (gradient_ref grad, const_argument_ref x,
+                        size_type) const
+    {
+      for (size_type i = 0; i < x.size (); ++i)
+        grad.coeffRef (i) = 2. * (x[i] - 2.);
+    }
+  };
+
+  /// \brief Constraints x_i^2 + x_{i+1}^2 for i in [first, first + m).
+  struct Circles : public DifferentiableSparseFunction
+  {
+    Circles (size_type n, size_type first, size_type m)
+      : DifferentiableSparseFunction (n, m, "x_i^2 + x_{i+1}^2"),
+        first_ (first)
+    {}
+
+    void impl_compute (result_ref res, const_argument_ref x) const
+    {
+      for (size_type k = 0; k < outputSize (); ++k)
+        {
+          const size_type i = first_ + k;
+          res[k] = x[i] * x[i] + x[i + 1] * x[i + 1];
+        }
+    }
+
+    void impl_gradient (gradient_ref grad, const_argument_ref x,
+                        size_type k) const
+    {
+      const size_type i = first_ + k;
+      grad.coeffRef (i) = 2. * x[i];
+      grad.coeffRef (i + 1) = 2. * x[i + 1];
+    }
+
+    void impl_jacobian (jacobian_ref jac, const_argument_ref x) const
+    {
+      jac.reserve (Eigen::VectorXi::Constant (inputSize (), 2));
+      for (size_type k = 0; k < outputSize (); ++k)
+        {
+          const size_type i = first_ + k;
+          jac.coeffRef (k, i) = 2. * x[i];
+          jac.coeffRef (k, i + 1) = 2. * x[i + 1];
+        }
+    }
+
+    size_type first_;
+  };
+
+  /// \brief Count the outer iterations.
+  struct IterationCounter
+  {
+    explicit IterationCounter (int& count)
+      : count_ (count)
+    {}
+
+    void operator() (const Solver<EigenMatrixSparse>::problem_t&,
+                     Solver<EigenMatrixSparse>::solverState_t&)
+    {
+      ++count_;
+    }
+
+    int& count_;
+  };
+
+  void run (Function::size_type n, int threads)
+  {
+    typedef Solver<EigenMatrixSparse> solver_t;
+
+    solver_t::problem_t pb (boost::make_shared<Cost> (n));
+    const Function::size_type blocks = 8;
+    const Function::size_type m = n - 1;
+    for (Function::size_type b = 0; b < blocks; ++b)
+      {
+        const Function::size_type first = b * m / blocks;
+        const Function::size_type last = (b + 1) * m / blocks;
+        pb.addConstraint
+          (boost::make_shared<Circles> (n, first, last - first),
+           solver_t::problem_t::intervals_t
+           (static_cast<std::size_t> (last - first),
+            Function::makeUpperInterval (1.)),
+           solver_t::problem_t::scaling_t
+           (static_cast<std::size_t> (last - first), 1.));
+      }
+    pb.setStartingPoint (Function::vector_t::Zero (n));
+
+    SolverFactory<solver_t> factory ("augmented-lagrangian", pb);
+    solver_t& solver = factory ();
+    solver.parameters ()["al.threads"].value = threads;
+
+    int iterations = 0;
+    solver.setIterationCallback (IterationCounter (iterations));
+
+    const benchmark::Stopwatch watch;
+    solver.solve ();
+    double time = watch.elapsed ();
+
+    std::cout << n << ", " << threads << ", ";
+    if (solver.minimumType () == GenericSolver::SOLVER_VALUE)
+      {
+        const Result& res = solver.getMinimum<Result> ();
+        std::cout << res.value[0] << ", " << res.constraint_violation;
+      }
+    else
+      std::cout << "failed, -";
+    std::cout << ", " << iterations << ", " << time * 1e3 << std::endl;
+  }
+} // end of anonymous namespace
+
+int main ()
+{
+  lt_dlinit ();
+  lt_dlsetsearchpath (PLUGIN_PATH);
+
+  std::cout << "n, threads, cost, violation, outer iterations, time (ms)"
+            << std::endl;
+
+  const Function::size_type sizes[] = {100, 1000, 10000};
+  for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+    {
+      run (sizes[s], 1);
+      run (sizes[s], 4);
+    }
+
+  PluginRegistry::instance ().unloadUnused ();
+  lt_dlexit ();
+  return 0;
+}
@@ -0,0 +1,102 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+// Measure the throughput of solving many small independent problems:
+// - loop: a solver is created for each problem,
+// - batch: the problems are solved by a BatchSolver.
+
+#include <iostream>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/batch-solver.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+#include <roboptim/core/function/constant.hh>
+
+#include "harness.hh"
+
+using namespace roboptim;
+
+typedef BatchSolver<EigenMatrixDense> batchSolver_t;
+typedef batchSolver_t::solver_t solver_t;
+typedef batchSolver_t::problem_t problem_t;
+
+int main ()
+{
+  lt_dlinit ();
+  lt_dlsetsearchpath (PLUGIN_PATH);
+
+  // Tiny problems, e.g. inverse kinematics of a 7-DoF arm.
+  const Function::size_type n = 7;
+  const std::size_t problems = 20000;
+  const char* plugin = "dummy-laststate";
+
+  Function::vector_t v (1);
+  v[0] = 1.;
+  boost::shared_ptr<GenericConstantFunction<EigenMatrixDense> >
+    f = boost::make_shared<GenericConstantFunction<EigenMatrixDense> > (n, v);
+  problem_t pb (f);
+  pb.addConstraint (f, Function::makeInterval (0., 2.));
+
+  std::vector<boost::shared_ptr<problem_t> > storage (problems);
+  batchSolver_t::problems_t batch (problems);
+  for (std::size_t i = 0; i < problems; ++i)
+    {
+      storage[i] = boost::make_shared<problem_t> (pb);
+      storage[i]->setStartingPoint
+        (Function::vector_t::Constant (n, static_cast<double> (i)));
+      batch[i] = storage[i].get ();
+    }
+
+  std::cout << "method, threads, problems per second" << std::endl;
+
+  // One solver per problem.
+  {
+    const benchmark::Stopwatch watch;
+    batchSolver_t::results_t results (problems);
+    for (std::size_t i = 0; i < problems; ++i)
+      {
+        SolverFactory<solver_t> factory (plugin, *batch[i]);
+        results[i] = factory ().minimum ();
+      }
+    std::cout << "loop, 1, " << problems / watch.elapsed () << std::endl;
+  }
+
+  // Batch solving.
+  std::size_t threads[] = {1, boost::thread::hardware_concurrency ()};
+  for (std::size_t t = 0; t < sizeof (threads) / sizeof (threads[0]); ++t)
+    {
+      batchSolver_t solver (plugin, threads[t]);
+      batchSolver_t::results_t results;
+
+      // Warm up (solver creation, result allocation).
+      solver.solve (batch, results);
+
+      const benchmark::Stopwatch watch;
+      solver.solve (batch, results);
+      std::cout << "batch, " << solver.threads () << ", "
+                << problems / watch.elapsed () << std::endl;
+    }
+
+  PluginRegistry::instance ().unloadUnused ();
+  lt_dlexit ();
+  return 0;
+}
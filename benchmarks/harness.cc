@@ -0,0 +1,286 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "harness.hh"
+
+namespace roboptim
+{
+  namespace benchmark
+  {
+    namespace
+    {
+      /// \brief Split a comma-separated list.
+      std::vector<std::string> split (const std::string& s)
+      {
+        std::vector<std::string> tokens;
+        std::istringstream ss (s);
+        std::string token;
+        while (std::getline (ss, token, ','))
+          if (!token.empty ())
+            tokens.push_back (token);
+        return tokens;
+      }
+
+      /// \brief Parse a positive integer.
+      int toInt (const std::string& option, const std::string& s)
+      {
+        char* end = 0;
+        long v = std::strtol (s.c_str (), &end, 10);
+        if (s.empty () || *end != '\0' || v <= 0)
+          throw std::runtime_error
+            ("invalid value for " + option + ": " + s);
+        return static_cast<int> (v);
+      }
+    } // end of anonymous namespace
+
+    const char* usage =
+      "usage: benchmark-suite [options]\n"
+      "  --output FILE         write the JSON report to FILE\n"
+      "  --sizes N,...         sizes of the scalable problems (10,100)\n"
+      "  --repeat N            function evaluations per timing (1000)\n"
+      "  --solve-repeat N      solves per plug-in and problem (3)\n"
+      "  --plugins NAME,...    plug-ins to run (all)\n"
+      "  --filter STRING       only run the problems containing STRING\n";
+
+    JsonWriter::JsonWriter (std::ostream& o)
+      : o_ (o),
+        counts_ (),
+        afterKey_ (false)
+    {
+      o_.precision (17);
+    }
+
+    void JsonWriter::prefix ()
+    {
+      if (afterKey_)
+        {
+          afterKey_ = false;
+          return;
+        }
+      if (counts_.empty ())
+        return;
+      if (counts_.back ()++ > 0)
+        o_ << ',';
+      o_ << '\n' << std::string (2 * counts_.size (), ' ');
+    }
+
+    void JsonWriter::string (const std::string& s)
+    {
+      o_ << '"';
+      for (std::string::const_iterator it = s.begin (); it != s.end (); ++it)
+        switch (*it)
+          {
+          case '"':  o_ << "\\\""; break;
+          case '\\': o_ << "\\\\"; break;
+          case '\n': o_ << "\\n"; break;
+          case '\r': o_ << "\\r"; break;
+          case '\t': o_ << "\\t"; break;
+          default:
+            if (static_cast<unsigned char> (*it) < 0x20)
+              {
+                char buffer[8];
+                std::sprintf (buffer, "\\u%04x",
+                              static_cast<unsigned> (*it));
+                o_ << buffer;
+              }
+            else
+              o_ << *it;
+          }
+      o_ << '"';
+    }
+
+    JsonWriter& JsonWriter::beginObject ()
+    {
+      prefix ();
+      o_ << '{';
+      counts_.push_back (0);
+      return *this;
+    }
+
+    JsonWriter& JsonWriter::endObject ()
+    {
+      bool empty = counts_.back () == 0;
+      counts_.pop_back ();
+      if (!empty)
+        o_ << '\n' << std::string (2 * counts_.size (), ' ');
+      o_ << '}';
+      if (counts_.empty ())
+        o_ << std::endl;
+      return *this;
+    }
+
+    JsonWriter& JsonWriter::beginArray ()
+    {
+      prefix ();
+      o_ << '[';
+      counts_.push_back (0);
+      return *this;
+    }
+
+    JsonWriter& JsonWriter::endArray ()
+    {
+      bool empty = counts_.back () == 0;
+      counts_.pop_back ();
+      if (!empty)
+        o_ << '\n' << std::string (2 * counts_.size (), ' ');
+      o_ << ']';
+      if (counts_.empty ())
+        o_ << std::endl;
+      return *this;
+    }
+
+    JsonWriter& JsonWriter::key (const std::string& k)
+    {
+      prefix ();
+      string (k);
+      o_ << ": ";
+      afterKey_ = true;
+      return *this;
+    }
+
+    JsonWriter& JsonWriter::value (const std::string& v)
+    {
+      prefix ();
+      string (v);
+      return *this;
+    }
+
+    JsonWriter& JsonWriter::value (const char* v)
+    {
+      return value (std::string (v));
+    }
+
+    JsonWriter& JsonWriter::value (double v)
+    {
+      if (!(std::fabs (v) <= 1e308))
+        return null ();
+      prefix ();
+      o_ << v;
+      return *this;
+    }
+
+    JsonWriter& JsonWriter::value (long v)
+    {
+      prefix ();
+      o_ << v;
+      return *this;
+    }
+
+    JsonWriter& JsonWriter::value (int v)
+    {
+      return value (static_cast<long> (v));
+    }
+
+    JsonWriter& JsonWriter::value (bool v)
+    {
+      prefix ();
+      o_ << (v ? "true" : "false");
+      return *this;
+    }
+
+    JsonWriter& JsonWriter::null ()
+    {
+      prefix ();
+      o_ << "null";
+      return *this;
+    }
+
+    Stopwatch::Stopwatch ()
+      : start_ (boost::posix_time::microsec_clock::universal_time ())
+    {}
+
+    void Stopwatch::restart ()
+    {
+      start_ = boost::posix_time::microsec_clock::universal_time ();
+    }
+
+    double Stopwatch::elapsed () const
+    {
+      return static_cast<double>
+        ((boost::posix_time::microsec_clock::universal_time () - start_)
+         .total_microseconds ()) * 1e-6;
+    }
+
+    Options::Options ()
+      : output (),
+        sizes (),
+        repeat (1000),
+        solveRepeat (3),
+        plugins (),
+        filter ()
+    {
+      sizes.push_back (10);
+      sizes.push_back (100);
+    }
+
+    void Options::parse (int argc, char** argv)
+    {
+      for (int i = 1; i < argc; ++i)
+        {
+          const std::string option (argv[i]);
+          if (i + 1 >= argc)
+            throw std::runtime_error ("missing value for " + option);
+          const std::string v (argv[++i]);
+
+          if (option == "--output")
+            output = v;
+          else if (option == "--sizes")
+            {
+              std::vector<std::string> tokens = split (v);
+              sizes.clear ();
+              for (std::size_t j = 0; j < tokens.size (); ++j)
+                sizes.push_back (toInt (option, tokens[j]));
+            }
+          else if (option == "--repeat")
+            repeat = toInt (option, v);
+          else if (option == "--solve-repeat")
+            solveRepeat = toInt (option, v);
+          else if (option == "--plugins")
+            plugins = split (v);
+          else if (option == "--filter")
+            filter = v;
+          else
+            throw std::runtime_error ("unknown option " + option);
+        }
+    }
+
+    bool Options::hasPlugin (const std::string& plugin) const
+    {
+      if (plugins.empty ())
+        return true;
+      for (std::size_t i = 0; i < plugins.size (); ++i)
+        if (plugins[i] == plugin)
+          return true;
+      return false;
+    }
+
+    bool Options::matches (const std::string& problem) const
+    {
+      return problem.find (filter) != std::string::npos;
+    }
+  } // end of namespace benchmark
+} // end of namespace roboptim
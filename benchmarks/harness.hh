@@ -0,0 +1,134 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_BENCHMARKS_HARNESS_HH
+# define ROBOPTIM_CORE_BENCHMARKS_HARNESS_HH
+
+# include <iosfwd>
+# include <string>
+# include <vector>
+
+# include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace roboptim
+{
+  namespace benchmark
+  {
+    /// \brief Minimal streaming JSON writer.
+    ///
+    /// Values are written as soon as they are given, and commas are
+    /// inserted automatically. Non-finite numbers are written as null.
+    class JsonWriter
+    {
+    public:
+      /// \param o output stream.
+      explicit JsonWriter (std::ostream& o);
+
+      JsonWriter& beginObject ();
+      JsonWriter& endObject ();
+      JsonWriter& beginArray ();
+      JsonWriter& endArray ();
+
+      /// \brief Write the key of the next member of the current object.
+      JsonWriter& key (const std::string& k);
+
+      JsonWriter& value (const std::string& v);
+      JsonWriter& value (const char* v);
+      JsonWriter& value (double v);
+      JsonWriter& value (long v);
+      JsonWriter& value (int v);
+      JsonWriter& value (bool v);
+      JsonWriter& null ();
+
+    private:
+      /// \brief Write a separator and indentation before a value.
+      void prefix ();
+
+      /// \brief Write a quoted and escaped string.
+      void string (const std::string& s);
+
+      /// \brief Output stream.
+      std::ostream& o_;
+
+      /// \brief Number of elements written at each nesting level.
+      std::vector<int> counts_;
+
+      /// \brief Whether a key was just written.
+      bool afterKey_;
+    };
+
+    /// \brief Wall-clock stopwatch.
+    class Stopwatch
+    {
+    public:
+      /// \brief Create and start the stopwatch.
+      Stopwatch ();
+
+      /// \brief Restart the stopwatch.
+      void restart ();
+
+      /// \brief Elapsed time since the last restart, in seconds.
+      double elapsed () const;
+
+    private:
+      boost::posix_time::ptime start_;
+    };
+
+    /// \brief Command-line options of the benchmark suite.
+    struct Options
+    {
+      Options ();
+
+      /// \brief Parse the command line.
+      ///
+      /// \param argc number of arguments.
+      /// \param argv arguments.
+      /// \throw std::runtime_error
+      void parse (int argc, char** argv);
+
+      /// \brief Whether a plug-in was selected.
+      bool hasPlugin (const std::string& plugin) const;
+
+      /// \brief Whether a problem matches the filter.
+      bool matches (const std::string& problem) const;
+
+      /// \brief Output file (empty for the standard output).
+      std::string output;
+
+      /// \brief Sizes of the scalable problems.
+      std::vector<int> sizes;
+
+      /// \brief Number of function evaluations per timing.
+      int repeat;
+
+      /// \brief Number of solves per plug-in and problem.
+      int solveRepeat;
+
+      /// \brief Selected plug-ins (empty for all).
+      std::vector<std::string> plugins;
+
+      /// \brief Substring the problem names have to contain.
+      std::string filter;
+    };
+
+    /// \brief Usage of the benchmark suite.
+    extern const char* usage;
+  } // end of namespace benchmark
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_BENCHMARKS_HARNESS_HH
@@ -0,0 +1,187 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// Measure the throughput of the L-BFGS-B plug-in on standard test
+// functions (extended Rosenbrock and a tridiagonal quadratic), with and
+// without active bounds.
+
+#include <iostream>
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+
+#include "harness.hh"
+
+using namespace roboptim;
+
+typedef Solver<EigenMatrixDense> solver_t;
+
+namespace
+{
+  /// \brief Function counting its evaluations.
+  struct CountingFunction : public DifferentiableFunction
+  {
+    CountingFunction (size_type n, const std::string& name)
+      : DifferentiableFunction (n, 1, name),
+        evaluations (0)
+    {}
+
+    mutable long evaluations;
+  };
+
+  /// \brief Iteration callback counting the iterations.
+  struct CountIterations
+  {
+    explicit CountIterations (long& iterations)
+      : iterations_ (iterations)
+    {}
+
+    void operator() (const solver_t::problem_t&, solver_t::solverState_t&)
+    {
+      ++iterations_;
+    }
+
+    long& iterations_;
+  };
+
+  /// \brief Extended Rosenbrock function.
+  struct Rosenbrock : public CountingFunction
+  {
+    explicit Rosenbrock (size_type n)
+      : CountingFunction (n, "extended Rosenbrock")
+    {}
+
+    void impl_compute (result_ref result, const_argument_ref x) const
+    {
+      ++evaluations;
+      result[0] = 0.;
+      for (size_type i = 0; i + 1 < inputSize (); i += 2)
+        result[0] += 100. * (x[i + 1] - x[i] * x[i]) * (x[i + 1] - x[i] * x[i])
+          + (1. - x[i]) * (1. - x[i]);
+    }
+
+    void impl_gradient (gradient_ref grad, const_argument_ref x,
+                        size_type) const
+    {
+      for (size_type i = 0; i + 1 < inputSize (); i += 2)
+        {
+          grad[i] = -400. * x[i] * (x[i + 1] - x[i] * x[i])
+            - 2. * (1. - x[i]);
+          grad[i + 1] = 200. * (x[i + 1] - x[i] * x[i]);
+        }
+    }
+  };
+
+  /// \brief Tridiagonal quadratic: (2 x_0 - 1)^2 + sum i (2 x_i - x_{i-1})^2.
+  struct Tridiagonal : public CountingFunction
+  {
+    explicit Tridiagonal (size_type n)
+      : CountingFunction (n, "tridiagonal quadratic")
+    {}
+
+    void impl_compute (result_ref result, const_argument_ref x) const
+    {
+      ++evaluations;
+      result[0] = (2. * x[0] - 1.) * (2. * x[0] - 1.);
+      for (size_type i = 1; i < inputSize (); ++i)
+        result[0] += static_cast<value_type> (i + 1)
+          * (2. * x[i] - x[i - 1]) * (2. * x[i] - x[i - 1]);
+    }
+
+    void impl_gradient (gradient_ref grad, const_argument_ref x,
+                        size_type) const
+    {
+      grad[0] = 4. * (2. * x[0] - 1.);
+      for (size_type i = 1; i < inputSize (); ++i)
+        {
+          value_type r = 2. * static_cast<value_type> (i + 1)
+            * (2. * x[i] - x[i - 1]);
+          grad[i] += 2. * r;
+          grad[i - 1] -= r;
+        }
+    }
+  };
+
+  void run (const char* name, boost::shared_ptr<CountingFunction> f,
+            bool bounded, int repeat)
+  {
+    const Function::size_type n = f->inputSize ();
+    solver_t::problem_t pb (f);
+    Function::vector_t x0 (n);
+    for (Function::size_type i = 0; i < n; ++i)
+      x0[i] = i % 2 ? 1. : -1.2;
+    pb.setStartingPoint (x0);
+    if (bounded)
+      for (Function::size_type i = 0; i < n; ++i)
+        pb.setArgumentBounds (static_cast<std::size_t> (i),
+                              Function::makeInterval (-2., i % 3 ? 2. : .5));
+
+    SolverFactory<solver_t> factory ("lbfgsb", pb);
+    solver_t& solver = factory ();
+
+    long iterations = 0;
+    solver.setIterationCallback (CountIterations (iterations));
+    f->evaluations = 0;
+    const benchmark::Stopwatch watch;
+    for (int i = 0; i < repeat; ++i)
+      {
+        solver.reset ();
+        solver.solve ();
+      }
+    double time = watch.elapsed () / repeat;
+
+    const Result& res = solver.getMinimum<Result> ();
+    std::cout << name << ", " << n << ", " << (bounded ? "yes" : "no")
+              << ", " << res.value[0]
+              << ", " << iterations / repeat
+              << ", " << f->evaluations / repeat
+              << ", " << time * 1e3
+              << ", " << static_cast<double> (iterations) / repeat / time
+              << std::endl;
+  }
+} // end of anonymous namespace
+
+int main ()
+{
+  lt_dlinit ();
+  lt_dlsetsearchpath (PLUGIN_PATH);
+
+  std::cout << "function, n, bounds, cost, iterations, evaluations,"
+            << " time (ms), iterations/s" << std::endl;
+
+  const Function::size_type sizes[] = {2, 100, 1000};
+  for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+    {
+      const Function::size_type n = sizes[s];
+      const int repeat = n < 1000 ? 100 : 10;
+      for (int bounded = 0; bounded < 2; ++bounded)
+        {
+          run ("rosenbrock", boost::make_shared<Rosenbrock> (n),
+               bounded != 0, repeat);
+          run ("tridiagonal", boost::make_shared<Tridiagonal> (n),
+               bounded != 0, repeat);
+        }
+    }
+
+  PluginRegistry::instance ().unloadUnused ();
+  lt_dlexit ();
+  return 0;
+}
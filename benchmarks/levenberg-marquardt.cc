@@ -0,0 +1,142 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// Compare the Levenberg-Marquardt plug-ins (dense and sparse), which use
+// the residuals and the Jacobian of a sum of squares, with a generic
+// quasi-Newton solver (L-BFGS-B) minimizing the same cost through its
+// gradient only.
+
+#include <iostream>
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+#include <roboptim/core/sum-of-c1-squares.hh>
+
+#include "harness.hh"
+
+using namespace roboptim;
+
+namespace
+{
+  /// \brief Residuals of the extended Rosenbrock function.
+  template <typename T>
+  struct Rosenbrock : public GenericDifferentiableFunction<T>
+  {
+    ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+    (GenericDifferentiableFunction<T>);
+
+    explicit Rosenbrock (size_type n)
+      : GenericDifferentiableFunction<T> (n, n, "Rosenbrock residuals"),
+        evaluations (0)
+    {}
+
+    void impl_compute (result_ref res, const_argument_ref x) const
+    {
+      ++evaluations;
+      for (size_type i = 0; i < this->inputSize (); i += 2)
+        {
+          res[i] = 10. * (x[i + 1] - x[i] * x[i]);
+          res[i + 1] = 1. - x[i];
+        }
+    }
+
+    void impl_gradient (gradient_ref grad, const_argument_ref x,
+                        size_type i) const
+    {
+      size_type j = i - i % 2;
+      if (i % 2 == 0)
+        {
+          grad.coeffRef (j) = -20. * x[j];
+          grad.coeffRef (j + 1) = 10.;
+        }
+      else
+        grad.coeffRef (j) = -1.;
+    }
+
+    mutable long evaluations;
+  };
+
+  template <typename T>
+  void run (const char* plugin, typename Solver<T>::problem_t::size_type n,
+            int repeat)
+  {
+    typedef Solver<T> solver_t;
+    typedef typename solver_t::problem_t problem_t;
+    typedef typename problem_t::vector_t vector_t;
+
+    boost::shared_ptr<Rosenbrock<T> > residuals =
+      boost::make_shared<Rosenbrock<T> > (n);
+    problem_t pb (boost::make_shared<GenericSumOfC1Squares<T> >
+                  (residuals, "Rosenbrock"));
+    vector_t x0 (n);
+    for (typename problem_t::size_type i = 0; i < n; ++i)
+      x0[i] = i % 2 ? 1. : -1.2;
+    pb.setStartingPoint (x0);
+
+    SolverFactory<solver_t> factory (plugin, pb);
+    solver_t& solver = factory ();
+    if (solver.parameters ().count ("lbfgsb.pgtol"))
+      {
+        solver.parameters ()["lbfgsb.pgtol"].value = 1e-8;
+        solver.parameters ()["lbfgsb.max-iterations"].value = 100000;
+      }
+
+    residuals->evaluations = 0;
+    const benchmark::Stopwatch watch;
+    for (int i = 0; i < repeat; ++i)
+      {
+        solver.reset ();
+        solver.solve ();
+      }
+    double time = watch.elapsed () / repeat;
+
+    std::cout << plugin << ", " << n << ", ";
+    if (solver.minimumType () == GenericSolver::SOLVER_VALUE)
+      std::cout << solver.template getMinimum<Result> ().value[0];
+    else
+      std::cout << "failed";
+    std::cout << ", " << residuals->evaluations / repeat
+              << ", " << time * 1e3 << std::endl;
+  }
+} // end of anonymous namespace
+
+int main ()
+{
+  lt_dlinit ();
+  lt_dlsetsearchpath (PLUGIN_PATH);
+
+  std::cout << "plug-in, n, cost, residual evaluations, time (ms)"
+            << std::endl;
+
+  const Function::size_type sizes[] = {10, 100, 1000};
+  for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+    {
+      const Function::size_type n = sizes[s];
+      const int repeat = n < 1000 ? 20 : 2;
+      run<EigenMatrixDense> ("lbfgsb", n, repeat);
+      run<EigenMatrixDense> ("levenberg-marquardt", n, repeat);
+      run<EigenMatrixSparse> ("levenberg-marquardt-sparse", n, repeat);
+    }
+
+  PluginRegistry::instance ().unloadUnused ();
+  lt_dlexit ();
+  return 0;
+}
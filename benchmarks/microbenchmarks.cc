@@ -0,0 +1,459 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+// Measure the cost of the building blocks of RobOptim functions in
+// isolation: virtual dispatch of GenericFunction::operator (), each
+// operator, the cached function and function pool decorators, the finite
+// difference policies and Problem::jacobian.
+//
+// Every entry reports the time per call and the number of heap allocations
+// per call (see ROBOPTIM_DEFINE_ALLOCATION_HOOKS: without glibc, only the
+// allocations made with operator new are counted). The storage order
+// of the dense matrices is fixed when configuring the project
+// (STORAGE_ORDER), so the benchmark has to be built once per storage order
+// to compare them.
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <boost/make_shared.hpp>
+#include <boost/mpl/list.hpp>
+#include <boost/optional.hpp>
+
+#include <roboptim/core/alloc.hh>
+#include <roboptim/core/differentiable-function.hh>
+#include <roboptim/core/function-pool.hh>
+#include <roboptim/core/problem.hh>
+#include <roboptim/core/decorator/cached-function.hh>
+#include <roboptim/core/decorator/finite-difference-gradient.hh>
+#include <roboptim/core/operator/bind.hh>
+#include <roboptim/core/operator/chain.hh>
+#include <roboptim/core/operator/concatenate.hh>
+#include <roboptim/core/operator/map.hh>
+#include <roboptim/core/operator/minus.hh>
+#include <roboptim/core/operator/plus.hh>
+#include <roboptim/core/operator/product.hh>
+#include <roboptim/core/operator/scalar.hh>
+#include <roboptim/core/operator/selection.hh>
+#include <roboptim/core/operator/split.hh>
+
+#include "harness.hh"
+
+using namespace roboptim;
+
+ROBOPTIM_DEFINE_ALLOCATION_HOOKS
+
+namespace
+{
+  /// \brief Minimum duration of a measurement, in seconds.
+  const double minimumDuration = .01;
+
+  /// \brief Banded function: \f$f_i (x) = x_i^2 + x_{i+1}\f$ (with
+  /// \f$x_n = x_0\f$).
+  template <typename T>
+  struct Banded : public GenericDifferentiableFunction<T>
+  {
+    ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+    (GenericDifferentiableFunction<T>);
+
+    explicit Banded (size_type n)
+      : GenericDifferentiableFunction<T> (n, n, "banded")
+    {}
+
+    void impl_compute (result_ref res, const_argument_ref x) const
+    {
+      const size_type n = this->inputSize ();
+      for (size_type i = 0; i < n; ++i)
+        res[i] = x[i] * x[i] + x[(i + 1) % n];
+    }
+
+    void impl_gradient (gradient_ref grad, const_argument_ref x,
+                        size_type i) const
+    {
+      const size_type n = this->inputSize ();
+      grad.coeffRef (i) = 2. * x[i];
+      grad.coeffRef ((i + 1) % n) += 1.;
+    }
+
+    void impl_jacobian (jacobian_ref jac, const_argument_ref x) const
+    {
+      const size_type n = this->inputSize ();
+      for (size_type i = 0; i < n; ++i)
+        {
+          jac.coeffRef (i, i) = 2. * x[i];
+          jac.coeffRef (i, (i + 1) % n) += 1.;
+        }
+    }
+  };
+
+  /// \brief Name of the matrix type.
+  template <typename T>
+  const char* matrixName ();
+
+  template <>
+  const char* matrixName<EigenMatrixDense> ()
+  {
+    return "dense";
+  }
+
+  template <>
+  const char* matrixName<EigenMatrixSparse> ()
+  {
+    return "sparse";
+  }
+
+  /// \brief Print one measurement.
+  void report (const std::string& name, const char* matrix,
+               Function::size_type n, const char* evaluation,
+               double time, long calls, unsigned long allocs)
+  {
+    std::cout << name << ", " << matrix << ", " << n << ", " << evaluation
+              << ", " << std::fixed << std::setprecision (1)
+              << time / static_cast<double> (calls) * 1e9 << ", ";
+    if (is_allocation_accounting_enabled ())
+      std::cout << std::setprecision (2)
+                << static_cast<double> (allocs) / static_cast<double> (calls);
+    else
+      std::cout << "n/a";
+    std::cout.unsetf (std::ios_base::floatfield);
+    std::cout << std::endl;
+  }
+
+  /// \brief Call an evaluation until minimumDuration is reached and report
+  /// the time and the allocations per call.
+  template <typename F>
+  void measure (const std::string& name, const char* matrix,
+                Function::size_type n, const char* evaluation, F f)
+  {
+    // Warm-up: let the functions set their caches up.
+    f ();
+
+    long calls = 1;
+    for (;;)
+      {
+        AllocationScope scope;
+        const benchmark::Stopwatch watch;
+        for (long i = 0; i < calls; ++i)
+          f ();
+        double time = watch.elapsed ();
+        unsigned long allocs = scope.stats ().allocations;
+
+        if (time >= minimumDuration)
+          {
+            report (name, matrix, n, evaluation, time, calls, allocs);
+            return;
+          }
+        calls *= 2;
+      }
+  }
+
+  /// \brief Evaluation of a function through its public interface.
+  template <typename T>
+  struct Compute
+  {
+    typedef GenericDifferentiableFunction<T> function_t;
+
+    Compute (const function_t& f, typename function_t::result_t& res,
+             const typename function_t::argument_t& x)
+      : f_ (f), res_ (res), x_ (x)
+    {}
+
+    void operator() () const
+    {
+      f_ (res_, x_);
+    }
+
+    const function_t& f_;
+    typename function_t::result_t& res_;
+    const typename function_t::argument_t& x_;
+  };
+
+  /// \brief Evaluation of the first gradient of a function.
+  template <typename T>
+  struct Gradient
+  {
+    typedef GenericDifferentiableFunction<T> function_t;
+
+    Gradient (const function_t& f, typename function_t::gradient_t& grad,
+              const typename function_t::argument_t& x)
+      : f_ (f), grad_ (grad), x_ (x)
+    {}
+
+    void operator() () const
+    {
+      f_.gradient (grad_, x_, 0);
+    }
+
+    const function_t& f_;
+    typename function_t::gradient_t& grad_;
+    const typename function_t::argument_t& x_;
+  };
+
+  /// \brief Evaluation of the Jacobian of a function.
+  template <typename T>
+  struct Jacobian
+  {
+    typedef GenericDifferentiableFunction<T> function_t;
+
+    Jacobian (const function_t& f, typename function_t::jacobian_t& jac,
+              const typename function_t::argument_t& x)
+      : f_ (f), jac_ (jac), x_ (x)
+    {}
+
+    void operator() () const
+    {
+      f_.jacobian (jac_, x_);
+    }
+
+    const function_t& f_;
+    typename function_t::jacobian_t& jac_;
+    const typename function_t::argument_t& x_;
+  };
+
+  /// \brief Direct call of Banded::impl_compute, without the checks of
+  /// the public interface.
+  template <typename T>
+  struct DirectCompute
+  {
+    DirectCompute (const Banded<T>& f,
+                   typename Banded<T>::result_t& res,
+                   const typename Banded<T>::argument_t& x)
+      : f_ (f), res_ (res), x_ (x)
+    {}
+
+    void operator() () const
+    {
+      f_.Banded<T>::impl_compute (res_, x_);
+    }
+
+    const Banded<T>& f_;
+    typename Banded<T>::result_t& res_;
+    const typename Banded<T>::argument_t& x_;
+  };
+
+  /// \brief Evaluation at a point that changes at each call.
+  template <typename T>
+  struct MovingCompute
+  {
+    typedef GenericDifferentiableFunction<T> function_t;
+
+    MovingCompute (const function_t& f, typename function_t::result_t& res,
+                   typename function_t::argument_t& x)
+      : f_ (f), res_ (res), x_ (x)
+    {}
+
+    void operator() () const
+    {
+      x_[0] += 1e-6;
+      f_ (res_, x_);
+    }
+
+    const function_t& f_;
+    typename function_t::result_t& res_;
+    typename function_t::argument_t& x_;
+  };
+
+  /// \brief Evaluation of the Jacobian of a problem.
+  template <typename T>
+  struct ProblemJacobian
+  {
+    ProblemJacobian (const Problem<T>& pb,
+                     typename Problem<T>::jacobian_t& jac,
+                     const typename Problem<T>::vector_t& x)
+      : pb_ (pb), jac_ (jac), x_ (x)
+    {}
+
+    void operator() () const
+    {
+      pb_.jacobian (jac_, x_);
+    }
+
+    const Problem<T>& pb_;
+    typename Problem<T>::jacobian_t& jac_;
+    const typename Problem<T>::vector_t& x_;
+  };
+
+  /// \brief Evaluations to measure.
+  enum evaluation_t
+  {
+    VALUE = 1,
+    GRADIENT = 2,
+    JACOBIAN = 4,
+    ALL = VALUE | GRADIENT | JACOBIAN
+  };
+
+  /// \brief Measure the value, gradient and Jacobian of a function.
+  template <typename T>
+  void run (const std::string& name,
+            const boost::shared_ptr<GenericDifferentiableFunction<T> >& f,
+            typename GenericDifferentiableFunction<T>::size_type n,
+            int evaluations = ALL)
+  {
+    typedef GenericDifferentiableFunction<T> function_t;
+
+    typename function_t::argument_t x (f->inputSize ());
+    for (typename function_t::size_type i = 0; i < x.size (); ++i)
+      x[i] = .1 * static_cast<double> (i % 7) - .3;
+    typename function_t::result_t res (f->outputSize ());
+    typename function_t::gradient_t grad (f->inputSize ());
+    typename function_t::jacobian_t jac = f->jacobian (x);
+
+    if (evaluations & VALUE)
+      measure (name, matrixName<T> (), n, "value", Compute<T> (*f, res, x));
+    if (evaluations & GRADIENT)
+      measure (name, matrixName<T> (), n, "gradient",
+               Gradient<T> (*f, grad, x));
+    if (evaluations & JACOBIAN)
+      measure (name, matrixName<T> (), n, "jacobian",
+               Jacobian<T> (*f, jac, x));
+  }
+
+  /// \brief Operators that only support dense matrices (Chain, Split).
+  void runDenseOperators
+  (const boost::shared_ptr<DifferentiableFunction>& f,
+   DifferentiableFunction::size_type n)
+  {
+    run<EigenMatrixDense> ("chain", chain (f, f), n);
+    run<EigenMatrixDense>
+      ("split", boost::make_shared<Split<DifferentiableFunction> > (f, 0), n);
+  }
+
+  void runDenseOperators
+  (const boost::shared_ptr<DifferentiableSparseFunction>&,
+   DifferentiableSparseFunction::size_type)
+  {}
+
+  template <typename T>
+  void runAll (typename GenericDifferentiableFunction<T>::size_type n)
+  {
+    typedef GenericDifferentiableFunction<T> function_t;
+    typedef boost::shared_ptr<function_t> functionPtr_t;
+    typedef typename function_t::size_type size_type;
+
+    boost::shared_ptr<Banded<T> > banded = boost::make_shared<Banded<T> > (n);
+    functionPtr_t f = banded;
+
+    // Dispatch: direct call versus public interface.
+    {
+      typename function_t::argument_t x =
+        function_t::vector_t::Constant (n, .5);
+      typename function_t::result_t res (n);
+      measure ("impl_compute", matrixName<T> (), n, "value",
+               DirectCompute<T> (*banded, res, x));
+    }
+    run<T> ("function", f, n);
+
+    // Operators.
+    runDenseOperators (f, n);
+    run<T> ("map", roboptim::map<function_t>
+            (boost::make_shared<Banded<T> > (1), n), n);
+
+    typename Bind<function_t>::boundValues_t bound
+      (static_cast<std::size_t> (n));
+    for (size_type i = 0; i < n; i += 2)
+      bound[static_cast<std::size_t> (i)] = 1.;
+    run<T> ("bind", roboptim::bind (f, bound), n);
+
+    run<T> ("concatenate", concatenate (f, f), n);
+    run<T> ("product", boost::make_shared<Product<function_t, function_t> >
+            (f, f), n);
+    run<T> ("selection", selection (f, 0, n / 2 + 1), n);
+    run<T> ("scalar", 2. * f, n);
+    run<T> ("plus", f + f, n);
+    run<T> ("minus", f - f, n);
+
+    // Cached function: hits (same point) and misses (moving point).
+    {
+      boost::shared_ptr<CachedFunction<function_t> > cached =
+        boost::make_shared<CachedFunction<function_t> > (f);
+      run<T> ("cached-function (hit)", cached, n);
+
+      typename function_t::argument_t x =
+        function_t::vector_t::Constant (n, .5);
+      typename function_t::result_t res (n);
+      measure ("cached-function (miss)", matrixName<T> (), n, "value",
+               MovingCompute<T> (*cached, res, x));
+    }
+
+    // Function pool: the banded function is the engine, the pool returns
+    // two halves of its output. Pools do not compute gradients.
+    {
+      typedef boost::mpl::list<function_t> poolTypes_t;
+      typedef FunctionPool<function_t, poolTypes_t> pool_t;
+      typename pool_t::functionList_t functions;
+      functions.push_back (selection (f, 0, n / 2));
+      functions.push_back (selection (f, n / 2, n - n / 2));
+      run<T> ("function-pool", boost::make_shared<pool_t> (f, functions), n,
+              VALUE | JACOBIAN);
+    }
+
+    // Finite differences (the Jacobian costs O(n) evaluations, so large
+    // sizes are skipped).
+    if (n <= 100)
+      {
+        run<T> ("finite-difference (simple)",
+                boost::make_shared<GenericFiniteDifferenceGradient
+                <T, finiteDifferenceGradientPolicies::Simple<T> > > (f), n);
+        run<T> ("finite-difference (five points)",
+                boost::make_shared<GenericFiniteDifferenceGradient
+                <T, finiteDifferenceGradientPolicies::FivePointsRule<T> > >
+                (f), n);
+      }
+
+    // Problem::jacobian with two constraints.
+    {
+      typedef Problem<T> problem_t;
+      problem_t pb (selection (f, 0, 1));
+      pb.addConstraint (f, typename problem_t::intervals_t
+                        (static_cast<std::size_t> (n),
+                         function_t::makeInfiniteInterval ()),
+                        typename problem_t::scaling_t
+                        (static_cast<std::size_t> (n), 1.));
+      pb.addConstraint (2. * f, typename problem_t::intervals_t
+                        (static_cast<std::size_t> (n),
+                         function_t::makeInfiniteInterval ()),
+                        typename problem_t::scaling_t
+                        (static_cast<std::size_t> (n), 1.));
+      typename problem_t::vector_t x =
+        problem_t::vector_t::Constant (n, .5);
+      typename problem_t::jacobian_t jac = pb.jacobian (x);
+      measure ("problem-jacobian", matrixName<T> (), n, "jacobian",
+               ProblemJacobian<T> (pb, jac, x));
+    }
+  }
+} // end of anonymous namespace
+
+int main ()
+{
+  std::cout << "storage order: "
+            << (Eigen::ROBOPTIM_STORAGE_ORDER == Eigen::RowMajor
+                ? "RowMajor" : "ColMajor") << std::endl;
+  std::cout << "case, matrix, n, evaluation, ns/call, allocations/call"
+            << std::endl;
+
+  const Function::size_type sizes[] = {10, 100, 1000};
+  for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+    {
+      runAll<EigenMatrixDense> (sizes[s]);
+      runAll<EigenMatrixSparse> (sizes[s]);
+    }
+  return 0;
+}
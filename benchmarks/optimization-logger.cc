@@ -0,0 +1,171 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// Measure the cost per iteration of the optimization logger:
+// - csv: one directory per iteration, with CSV files,
+// - binary: single append-only binary file,
+// - csv-async, binary-async: same formats, logged by a background thread
+//   (us/callback is then the time spent in the solver callback),
+// - convert: conversion of the binary log to the CSV layout.
+//
+// allocs/iteration is the number of heap allocations per callback for the
+// synchronous formats (see ROBOPTIM_DEFINE_ALLOCATION_HOOKS).
+
+#include <iostream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/alloc.hh>
+#include <roboptim/core/solver.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+#include <roboptim/core/binary-log.hh>
+#include <roboptim/core/optimization-logger.hh>
+#include <roboptim/core/numeric-linear-function.hh>
+
+#include "harness.hh"
+
+using namespace roboptim;
+
+ROBOPTIM_DEFINE_ALLOCATION_HOOKS
+
+typedef Solver<EigenMatrixDense> solver_t;
+typedef solver_t::problem_t problem_t;
+typedef NumericLinearFunction::matrix_t matrix_t;
+typedef NumericLinearFunction::vector_t vector_t;
+
+namespace
+{
+  /// \brief Number of files and total size of a directory.
+  void usage (const boost::filesystem::path& path,
+              std::size_t& files, boost::uintmax_t& bytes)
+  {
+    files = 0;
+    bytes = 0;
+    for (boost::filesystem::recursive_directory_iterator it (path), end;
+         it != end; ++it)
+      if (boost::filesystem::is_regular_file (it->status ()))
+        {
+          ++files;
+          bytes += boost::filesystem::file_size (it->path ());
+        }
+  }
+} // end of anonymous namespace
+
+int main ()
+{
+  lt_dlinit ();
+  lt_dlsetsearchpath (PLUGIN_PATH);
+
+  const boost::filesystem::path root =
+    "/tmp/roboptim-core-benchmarks/optimization-logger";
+  const int iterations = 200;
+  const std::size_t constraints = 10;
+  const NumericLinearFunction::size_type sizes[] = {10, 100};
+
+  std::cout << "format, n, constraints, iterations, us/iteration, "
+            << "us/callback, allocs/iteration, bytes/iteration, files" << std::endl;
+
+  for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+    {
+      const NumericLinearFunction::size_type n = sizes[s];
+
+      // Cost and constraints: random linear functions.
+      boost::shared_ptr<NumericLinearFunction> f =
+        boost::make_shared<NumericLinearFunction>
+        (matrix_t::Random (1, n), vector_t::Zero (1));
+      problem_t pb (f);
+      for (std::size_t i = 0; i < constraints; ++i)
+        pb.addConstraint
+          (boost::static_pointer_cast<LinearFunction>
+           (boost::make_shared<NumericLinearFunction>
+            (matrix_t::Random (2, n), vector_t::Random (2))),
+           problem_t::intervals_t (2, Function::makeInterval (-1., 1.)),
+           problem_t::scaling_t (2, 1.));
+      pb.setStartingPoint (vector_t::Zero (n));
+
+      SolverFactory<solver_t> factory ("dummy", pb);
+      solver_t& solver = factory ();
+      solver_t::solverState_t state (pb);
+
+      const logFormat_t formats[] =
+        {CSV_LOG, BINARY_LOG, CSV_LOG, BINARY_LOG};
+      const bool asynchronous[] = {false, false, true, true};
+      const char* names[] = {"csv", "binary", "csv-async", "binary-async"};
+      for (std::size_t k = 0; k < 4; ++k)
+        {
+          const boost::filesystem::path path = root / names[k];
+
+          double callbackTime;
+          unsigned long allocs;
+          const benchmark::Stopwatch watch;
+          {
+            OptimizationLogger<solver_t>
+              logger (solver, path, false, formats[k]);
+            if (asynchronous[k])
+              logger.setAsynchronous (static_cast<std::size_t> (iterations));
+
+            AllocationScope scope;
+            const benchmark::Stopwatch callbackWatch;
+            for (int i = 0; i < iterations; ++i)
+              {
+                state.x ().setConstant (i);
+                logger (pb, state);
+              }
+            callbackTime = callbackWatch.elapsed () * 1e6 / iterations;
+            allocs = scope.stats ().allocations;
+          }
+          const double time = watch.elapsed () * 1e6 / iterations;
+
+          std::size_t files;
+          boost::uintmax_t bytes;
+          usage (path, files, bytes);
+          std::cout << names[k] << ", " << n << ", " << constraints << ", "
+                    << iterations << ", " << time << ", " << callbackTime
+                    << ", ";
+          if (asynchronous[k])
+            std::cout << "n/a";
+          else
+            std::cout << allocs / iterations;
+          std::cout << ", " << bytes / iterations << ", " << files
+                    << std::endl;
+        }
+
+      // Conversion of the binary log to the CSV layout.
+      const boost::filesystem::path converted = root / "converted";
+      boost::filesystem::remove_all (converted);
+      const benchmark::Stopwatch watch;
+      convertBinaryLog (root / "binary" / "log.bin", converted);
+      const double time = watch.elapsed () * 1e6 / iterations;
+
+      std::size_t files;
+      boost::uintmax_t bytes;
+      usage (converted, files, bytes);
+      std::cout << "convert, " << n << ", " << constraints << ", "
+                << iterations << ", " << time << ", " << time << ", n/a, "
+                << bytes / iterations << ", " << files << std::endl;
+    }
+
+  boost::filesystem::remove_all (root);
+  PluginRegistry::instance ().unloadUnused ();
+  lt_dlexit ();
+  return 0;
+}
@@ -0,0 +1,106 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// Measure the cost of copying a large problem, and of creating a solver
+// (which keeps a copy of the problem):
+// - shared: the problem is set up with setArgumentBounds and
+//   setStartingPoint, so that its copies share its data,
+// - unshareable: a mutable reference on the data of the problem has been
+//   handed out (argumentNames ()), so that copying the problem copies
+//   its data.
+
+#include <iostream>
+
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/solver.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+#include <roboptim/core/function/constant.hh>
+
+#include "harness.hh"
+
+using namespace roboptim;
+
+typedef Solver<EigenMatrixDense> solver_t;
+typedef solver_t::problem_t problem_t;
+typedef GenericConstantFunction<EigenMatrixDense> constantFunction_t;
+
+int main ()
+{
+  lt_dlinit ();
+  lt_dlsetsearchpath (PLUGIN_PATH);
+
+  const Function::size_type n = 100000;
+  const std::size_t constraints = 100;
+  const int iterations = 100;
+
+  Function::vector_t v (1);
+  v[0] = 1.;
+  boost::shared_ptr<constantFunction_t> f =
+    boost::make_shared<constantFunction_t> (n, v);
+
+  problem_t shared (f);
+  shared.setArgumentBounds
+    (problem_t::intervals_t (static_cast<std::size_t> (n),
+                             Function::makeInterval (-1., 1.)));
+  shared.setStartingPoint (Function::vector_t::Zero (n));
+  for (std::size_t i = 0; i < constraints; ++i)
+    shared.addConstraint (f, Function::makeInterval (0., 2.));
+
+  problem_t unshareable (shared);
+  for (Function::size_type i = 0; i < n; ++i)
+    unshareable.argumentNames ().push_back
+      ((boost::format ("x%d") % i).str ());
+
+  const char* names[] = {"shared", "unshareable"};
+  const problem_t* problems[] = {&shared, &unshareable};
+
+  // Load the plug-in once.
+  {
+    SolverFactory<solver_t> factory ("dummy", shared);
+  }
+
+  std::cout << "problem, n, constraints, copy (us), solver creation (us)"
+            << std::endl;
+  for (std::size_t k = 0; k < 2; ++k)
+    {
+      benchmark::Stopwatch watch;
+      for (int i = 0; i < iterations; ++i)
+        {
+          const problem_t copy (*problems[k]);
+        }
+      const double copy = watch.elapsed () * 1e6 / iterations;
+
+      watch.restart ();
+      for (int i = 0; i < iterations; ++i)
+        {
+          SolverFactory<solver_t> factory ("dummy", *problems[k]);
+        }
+      const double creation = watch.elapsed () * 1e6 / iterations;
+
+      std::cout << names[k] << ", " << n << ", " << constraints << ", "
+                << copy << ", " << creation << std::endl;
+    }
+
+  PluginRegistry::instance ().unloadUnused ();
+  lt_dlexit ();
+  return 0;
+}
@@ -0,0 +1,467 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_BENCHMARKS_PROBLEMS_HH
+# define ROBOPTIM_CORE_BENCHMARKS_PROBLEMS_HH
+
+# include <cmath>
+# include <limits>
+# include <sstream>
+# include <string>
+# include <vector>
+
+# include <boost/make_shared.hpp>
+# include <boost/shared_ptr.hpp>
+
+# include <roboptim/core/differentiable-function.hh>
+# include <roboptim/core/numeric-linear-function.hh>
+# include <roboptim/core/numeric-quadratic-function.hh>
+# include <roboptim/core/problem.hh>
+# include <roboptim/core/sum-of-c1-squares.hh>
+
+namespace roboptim
+{
+  namespace benchmark
+  {
+    /// \brief Problem of the benchmark suite.
+    ///
+    /// \tparam T matrix type
+    template <typename T>
+    struct BenchmarkProblem
+    {
+      typedef Problem<T> problem_t;
+
+      /// \brief Name of the problem (e.g. hs071, rosenbrock-100).
+      std::string name;
+
+      /// \brief Problem, with its starting point.
+      boost::shared_ptr<problem_t> problem;
+
+      /// \brief Known optimal cost (NaN if unknown).
+      double optimum;
+    };
+
+    /// \brief Residuals of the extended Rosenbrock function (Moré,
+    /// Garbow and Hillstrom, problem 21):
+    /// \f$r_{2i} = 10 (x_{2i+1} - x_{2i}^2)\f$, \f$r_{2i+1} = 1 - x_{2i}\f$.
+    template <typename T>
+    struct RosenbrockResiduals : public GenericDifferentiableFunction<T>
+    {
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      explicit RosenbrockResiduals (size_type n)
+        : GenericDifferentiableFunction<T> (n, n, "Rosenbrock residuals")
+      {}
+
+      void impl_compute (result_ref res, const_argument_ref x) const
+      {
+        for (size_type i = 0; i < this->inputSize (); i += 2)
+          {
+            res[i] = 10. * (x[i + 1] - x[i] * x[i]);
+            res[i + 1] = 1. - x[i];
+          }
+      }
+
+      void impl_gradient (gradient_ref grad, const_argument_ref x,
+                          size_type i) const
+      {
+        const size_type j = i - i % 2;
+        if (i % 2 == 0)
+          {
+            grad.coeffRef (j) = -20. * x[j];
+            grad.coeffRef (j + 1) = 10.;
+          }
+        else
+          grad.coeffRef (j) = -1.;
+      }
+    };
+
+    /// \brief HS006 cost: \f$(1 - x_0)^2\f$.
+    template <typename T>
+    struct HS006Cost : public GenericDifferentiableFunction<T>
+    {
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      HS006Cost ()
+        : GenericDifferentiableFunction<T> (2, 1, "(1 - x0)^2")
+      {}
+
+      void impl_compute (result_ref res, const_argument_ref x) const
+      {
+        res[0] = (1. - x[0]) * (1. - x[0]);
+      }
+
+      void impl_gradient (gradient_ref grad, const_argument_ref x,
+                          size_type) const
+      {
+        grad.coeffRef (0) = -2. * (1. - x[0]);
+      }
+    };
+
+    /// \brief HS006 constraint: \f$10 (x_1 - x_0^2) = 0\f$.
+    template <typename T>
+    struct HS006Constraint : public GenericDifferentiableFunction<T>
+    {
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      HS006Constraint ()
+        : GenericDifferentiableFunction<T> (2, 1, "10 (x1 - x0^2)")
+      {}
+
+      void impl_compute (result_ref res, const_argument_ref x) const
+      {
+        res[0] = 10. * (x[1] - x[0] * x[0]);
+      }
+
+      void impl_gradient (gradient_ref grad, const_argument_ref x,
+                          size_type) const
+      {
+        grad.coeffRef (0) = -20. * x[0];
+        grad.coeffRef (1) = 10.;
+      }
+    };
+
+    /// \brief HS021 cost: \f$0.01 x_0^2 + x_1^2 - 100\f$.
+    template <typename T>
+    struct HS021Cost : public GenericDifferentiableFunction<T>
+    {
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      HS021Cost ()
+        : GenericDifferentiableFunction<T> (2, 1, "0.01 x0^2 + x1^2 - 100")
+      {}
+
+      void impl_compute (result_ref res, const_argument_ref x) const
+      {
+        res[0] = .01 * x[0] * x[0] + x[1] * x[1] - 100.;
+      }
+
+      void impl_gradient (gradient_ref grad, const_argument_ref x,
+                          size_type) const
+      {
+        grad.coeffRef (0) = .02 * x[0];
+        grad.coeffRef (1) = 2. * x[1];
+      }
+    };
+
+    /// \brief HS071 cost: \f$x_0 x_3 (x_0 + x_1 + x_2) + x_2\f$.
+    template <typename T>
+    struct HS071Cost : public GenericDifferentiableFunction<T>
+    {
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      HS071Cost ()
+        : GenericDifferentiableFunction<T>
+          (4, 1, "x0 x3 (x0 + x1 + x2) + x2")
+      {}
+
+      void impl_compute (result_ref res, const_argument_ref x) const
+      {
+        res[0] = x[0] * x[3] * (x[0] + x[1] + x[2]) + x[2];
+      }
+
+      void impl_gradient (gradient_ref grad, const_argument_ref x,
+                          size_type) const
+      {
+        grad.coeffRef (0) = x[3] * (2. * x[0] + x[1] + x[2]);
+        grad.coeffRef (1) = x[0] * x[3];
+        grad.coeffRef (2) = x[0] * x[3] + 1.;
+        grad.coeffRef (3) = x[0] * (x[0] + x[1] + x[2]);
+      }
+    };
+
+    /// \brief HS071 constraints: \f$x_0 x_1 x_2 x_3 \geq 25\f$ and
+    /// \f$\|x\|^2 = 40\f$.
+    template <typename T>
+    struct HS071Constraints : public GenericDifferentiableFunction<T>
+    {
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      HS071Constraints ()
+        : GenericDifferentiableFunction<T>
+          (4, 2, "x0 x1 x2 x3, x0^2 + x1^2 + x2^2 + x3^2")
+      {}
+
+      void impl_compute (result_ref res, const_argument_ref x) const
+      {
+        res[0] = x[0] * x[1] * x[2] * x[3];
+        res[1] = x.squaredNorm ();
+      }
+
+      void impl_gradient (gradient_ref grad, const_argument_ref x,
+                          size_type i) const
+      {
+        if (i == 0)
+          {
+            grad.coeffRef (0) = x[1] * x[2] * x[3];
+            grad.coeffRef (1) = x[0] * x[2] * x[3];
+            grad.coeffRef (2) = x[0] * x[1] * x[3];
+            grad.coeffRef (3) = x[0] * x[1] * x[2];
+          }
+        else
+          for (size_type j = 0; j < 4; ++j)
+            grad.coeffRef (j) = 2. * x[j];
+      }
+    };
+
+    /// \brief Banded trajectory-like NLP: a pendulum driven from rest
+    /// to the angle 1 in N steps of length dt.
+    ///
+    /// The variables are interleaved by time step:
+    /// \f$(p_0, v_0, u_0, \dots, p_{N-1}, v_{N-1}, u_{N-1}, p_N, v_N)\f$.
+    /// The cost is \f$dt \sum_k u_k^2\f$.
+    template <typename T>
+    struct TrajectoryCost : public GenericDifferentiableFunction<T>
+    {
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      TrajectoryCost (size_type steps, value_type dt)
+        : GenericDifferentiableFunction<T>
+          (3 * steps + 2, 1, "trajectory cost"),
+          steps_ (steps),
+          dt_ (dt)
+      {}
+
+      void impl_compute (result_ref res, const_argument_ref x) const
+      {
+        res[0] = 0.;
+        for (size_type k = 0; k < steps_; ++k)
+          res[0] += dt_ * x[3 * k + 2] * x[3 * k + 2];
+      }
+
+      void impl_gradient (gradient_ref grad, const_argument_ref x,
+                          size_type) const
+      {
+        for (size_type k = 0; k < steps_; ++k)
+          grad.coeffRef (3 * k + 2) = 2. * dt_ * x[3 * k + 2];
+      }
+
+      size_type steps_;
+      value_type dt_;
+    };
+
+    /// \brief Dynamics of the trajectory NLP (2 N equality constraints):
+    /// \f$p_{k+1} - p_k - dt\, v_k = 0\f$ and
+    /// \f$v_{k+1} - v_k - dt (u_k - \sin p_k) = 0\f$.
+    template <typename T>
+    struct TrajectoryDynamics : public GenericDifferentiableFunction<T>
+    {
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      TrajectoryDynamics (size_type steps, value_type dt)
+        : GenericDifferentiableFunction<T>
+          (3 * steps + 2, 2 * steps, "pendulum dynamics"),
+          steps_ (steps),
+          dt_ (dt)
+      {}
+
+      void impl_compute (result_ref res, const_argument_ref x) const
+      {
+        for (size_type k = 0; k < steps_; ++k)
+          {
+            const size_type i = 3 * k;
+            res[2 * k] = x[i + 3] - x[i] - dt_ * x[i + 1];
+            res[2 * k + 1] =
+              x[i + 4] - x[i + 1] - dt_ * (x[i + 2] - std::sin (x[i]));
+          }
+      }
+
+      void impl_gradient (gradient_ref grad, const_argument_ref x,
+                          size_type row) const
+      {
+        const size_type i = 3 * (row / 2);
+        if (row % 2 == 0)
+          {
+            grad.coeffRef (i) = -1.;
+            grad.coeffRef (i + 1) = -dt_;
+            grad.coeffRef (i + 3) = 1.;
+          }
+        else
+          {
+            grad.coeffRef (i) = dt_ * std::cos (x[i]);
+            grad.coeffRef (i + 1) = -1.;
+            grad.coeffRef (i + 2) = -dt_;
+            grad.coeffRef (i + 4) = 1.;
+          }
+      }
+
+      size_type steps_;
+      value_type dt_;
+    };
+
+    /// \brief Build the benchmark suite.
+    ///
+    /// Scalable problems are instantiated for each size. The
+    /// Hock-Schittkowski problems (hs006, hs021, hs035, hs071) have a fixed
+    /// size.
+    ///
+    /// \param sizes sizes of the scalable problems.
+    /// \tparam T matrix type
+    template <typename T>
+    std::vector<BenchmarkProblem<T> >
+    makeProblems (const std::vector<int>& sizes)
+    {
+      typedef BenchmarkProblem<T> benchmarkProblem_t;
+      typedef typename benchmarkProblem_t::problem_t problem_t;
+      typedef typename problem_t::function_t function_t;
+      typedef typename problem_t::size_type size_type;
+      typedef typename function_t::vector_t vector_t;
+      typedef typename function_t::matrix_t matrix_t;
+
+      const double nan = std::numeric_limits<double>::quiet_NaN ();
+      std::vector<benchmarkProblem_t> problems;
+      benchmarkProblem_t p;
+
+      // HS006: equality constrained.
+      p.name = "hs006";
+      p.problem = boost::make_shared<problem_t>
+        (boost::make_shared<HS006Cost<T> > ());
+      p.problem->addConstraint (boost::make_shared<HS006Constraint<T> > (),
+                                function_t::makeInterval (0., 0.));
+      vector_t x (2);
+      x << -1.2, 1.;
+      p.problem->setStartingPoint (x);
+      p.optimum = 0.;
+      problems.push_back (p);
+
+      // HS021: bounds and a linear inequality.
+      Eigen::MatrixXd A21 (1, 2);
+      A21 << 10., -1.;
+      matrix_t A21_;
+      A21_ = A21.sparseView ();
+      p.name = "hs021";
+      p.problem = boost::make_shared<problem_t>
+        (boost::make_shared<HS021Cost<T> > ());
+      p.problem->setArgumentBounds (0, function_t::makeInterval (2., 50.));
+      p.problem->setArgumentBounds (1, function_t::makeInterval (-50., 50.));
+      p.problem->addConstraint
+        (boost::make_shared<GenericNumericLinearFunction<T> >
+         (A21_, vector_t::Zero (1)),
+         function_t::makeLowerInterval (10.));
+      x << -1., -1.;
+      p.problem->setStartingPoint (x);
+      p.optimum = -99.96;
+      problems.push_back (p);
+
+      // HS035: convex quadratic program.
+      Eigen::MatrixXd H35 (3, 3);
+      H35 << 2., 1., 1.,
+             1., 2., 0.,
+             1., 0., 1.;
+      matrix_t H35_;
+      H35_ = H35.sparseView ();
+      vector_t b35 (3);
+      b35 << -8., -6., -4.;
+      vector_t c35 (1);
+      c35 << 9.;
+      Eigen::MatrixXd A35 (1, 3);
+      A35 << 1., 1., 2.;
+      matrix_t A35_;
+      A35_ = A35.sparseView ();
+      p.name = "hs035";
+      p.problem = boost::make_shared<problem_t>
+        (boost::make_shared<GenericNumericQuadraticFunction<T> >
+         (H35_, b35, c35));
+      for (size_type i = 0; i < 3; ++i)
+        p.problem->setArgumentBounds (i, function_t::makeLowerInterval (0.));
+      p.problem->addConstraint
+        (boost::make_shared<GenericNumericLinearFunction<T> >
+         (A35_, vector_t::Zero (1)),
+         function_t::makeUpperInterval (3.));
+      p.problem->setStartingPoint (vector_t::Constant (3, .5));
+      p.optimum = 1. / 9.;
+      problems.push_back (p);
+
+      // HS071: nonlinear inequality and equality.
+      p.name = "hs071";
+      p.problem = boost::make_shared<problem_t>
+        (boost::make_shared<HS071Cost<T> > ());
+      for (size_type i = 0; i < 4; ++i)
+        p.problem->setArgumentBounds (i, function_t::makeInterval (1., 5.));
+      typename problem_t::intervals_t bounds71 (2);
+      bounds71[0] = function_t::makeLowerInterval (25.);
+      bounds71[1] = function_t::makeInterval (40., 40.);
+      p.problem->addConstraint
+        (boost::make_shared<HS071Constraints<T> > (), bounds71,
+         typename problem_t::scaling_t (2, 1.));
+      vector_t x71 (4);
+      x71 << 1., 5., 5., 1.;
+      p.problem->setStartingPoint (x71);
+      p.optimum = 17.0140173;
+      problems.push_back (p);
+
+      for (std::size_t s = 0; s < sizes.size (); ++s)
+        {
+          const size_type n = sizes[s] + sizes[s] % 2;
+          std::ostringstream suffix;
+          suffix << "-" << sizes[s];
+
+          // Extended Rosenbrock, as a sum of squares.
+          p.name = "rosenbrock" + suffix.str ();
+          p.problem = boost::make_shared<problem_t>
+            (boost::make_shared<GenericSumOfC1Squares<T> >
+             (boost::make_shared<RosenbrockResiduals<T> > (n),
+              "Rosenbrock"));
+          vector_t x0 (n);
+          for (size_type i = 0; i < n; ++i)
+            x0[i] = i % 2 ? 1. : -1.2;
+          p.problem->setStartingPoint (x0);
+          p.optimum = 0.;
+          problems.push_back (p);
+
+          // Banded trajectory NLP.
+          const size_type steps = sizes[s];
+          const double dt = 2. / static_cast<double> (steps);
+          p.name = "trajectory" + suffix.str ();
+          p.problem = boost::make_shared<problem_t>
+            (boost::make_shared<TrajectoryCost<T> > (steps, dt));
+          p.problem->addConstraint
+            (boost::make_shared<TrajectoryDynamics<T> > (steps, dt),
+             typename problem_t::intervals_t
+             (static_cast<std::size_t> (2 * steps),
+              function_t::makeInterval (0., 0.)),
+             typename problem_t::scaling_t
+             (static_cast<std::size_t> (2 * steps), 1.));
+          p.problem->setArgumentBounds (0, function_t::makeInterval (0., 0.));
+          p.problem->setArgumentBounds (1, function_t::makeInterval (0., 0.));
+          p.problem->setArgumentBounds
+            (3 * steps, function_t::makeInterval (1., 1.));
+          p.problem->setArgumentBounds
+            (3 * steps + 1, function_t::makeInterval (0., 0.));
+          for (size_type k = 0; k < steps; ++k)
+            p.problem->setArgumentBounds
+              (3 * k + 2, function_t::makeInterval (-10., 10.));
+          p.problem->setStartingPoint (vector_t::Zero (3 * steps + 2));
+          p.optimum = nan;
+          problems.push_back (p);
+        }
+
+      return problems;
+    }
+  } // end of namespace benchmark
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_BENCHMARKS_PROBLEMS_HH
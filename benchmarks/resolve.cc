@@ -0,0 +1,106 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+// Measure the latency of solving a sequence of related problems, where
+// only the starting point and the bounds change (e.g. model predictive
+// control):
+// - recreate: a new solver is created for each problem,
+// - resolve: the problem is updated in place and solved again.
+
+#include <algorithm>
+#include <iostream>
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/solver.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+#include <roboptim/core/function/constant.hh>
+
+#include "harness.hh"
+
+using namespace roboptim;
+
+typedef Solver<EigenMatrixDense> solver_t;
+
+int main ()
+{
+  lt_dlinit ();
+  lt_dlsetsearchpath (PLUGIN_PATH);
+
+  const Function::size_type n = 1000;
+  const int iterations = 1000;
+
+  Function::vector_t v (1);
+  v[0] = 1.;
+  boost::shared_ptr<GenericConstantFunction<EigenMatrixDense> >
+    f = boost::make_shared<GenericConstantFunction<EigenMatrixDense> > (n, v);
+
+  solver_t::problem_t pb (f);
+  pb.addConstraint (f, Function::makeInterval (0., 2.));
+  pb.setStartingPoint (Function::vector_t::Zero (n));
+
+  const char* plugins[] = {"dummy", "dummy-laststate"};
+
+  std::cout << "plug-in, recreate (us), resolve (us)" << std::endl;
+  for (std::size_t p = 0; p < sizeof (plugins) / sizeof (plugins[0]); ++p)
+    {
+      Function::vector_t x0 (n);
+      solver_t::intervals_t bounds (static_cast<std::size_t> (n));
+
+      // Recreate the problem and the solver for each problem.
+      benchmark::Stopwatch watch;
+      for (int i = 0; i < iterations; ++i)
+        {
+          solver_t::problem_t pb_i (pb);
+          x0.setConstant (i);
+          pb_i.setStartingPoint (x0);
+          std::fill (bounds.begin (), bounds.end (),
+                     Function::makeInterval (-i, i));
+          pb_i.setArgumentBounds (bounds);
+
+          SolverFactory<solver_t> factory (plugins[p], pb_i);
+          factory ().solve ();
+        }
+      double recreate = watch.elapsed () / iterations;
+
+      // Update the problem in place and solve it again.
+      SolverFactory<solver_t> factory (plugins[p], pb);
+      solver_t& solver = factory ();
+      solver.solve ();
+
+      watch.restart ();
+      for (int i = 0; i < iterations; ++i)
+        {
+          x0.setConstant (i);
+          solver.updateStartingPoint (x0);
+          std::fill (bounds.begin (), bounds.end (),
+                     Function::makeInterval (-i, i));
+          solver.updateArgumentBounds (bounds);
+          solver.resolve ();
+        }
+      double resolve = watch.elapsed () / iterations;
+
+      std::cout << plugins[p] << ", " << recreate << ", " << resolve
+                << std::endl;
+    }
+
+  PluginRegistry::instance ().unloadUnused ();
+  lt_dlexit ();
+  return 0;
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+// Measure the latency of solver creation through SolverFactory:
+// - cold: the plug-in is loaded (unless it is linked statically) and
+//   validated,
+// - warm: the plug-in is retrieved from the registry.
+
+#include <iostream>
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/solver.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+#include <roboptim/core/function/constant.hh>
+
+#include "harness.hh"
+
+#ifdef ROBOPTIM_BENCHMARK_STATIC_PLUGINS
+ROBOPTIM_IMPORT_STATIC_PLUGIN (dummy)
+ROBOPTIM_IMPORT_STATIC_PLUGIN (dummy_laststate)
+ROBOPTIM_IMPORT_STATIC_PLUGIN (dummy_td)
+#endif //! ROBOPTIM_BENCHMARK_STATIC_PLUGINS
+
+using namespace roboptim;
+
+typedef Solver<EigenMatrixDense> solver_t;
+
+int main ()
+{
+  lt_dlinit ();
+  lt_dlsetsearchpath (PLUGIN_PATH);
+
+  const Function::size_type n = 1000;
+  const int iterations = 1000;
+
+  Function::vector_t v (1);
+  v[0] = 1.;
+  solver_t::problem_t pb
+    (boost::make_shared<GenericConstantFunction<EigenMatrixDense> > (n, v));
+
+  const char* plugins[] = {"dummy", "dummy-laststate", "dummy-td"};
+
+  std::cout << "plug-in, cold creation (us), warm creation (us)" << std::endl;
+  for (std::size_t p = 0; p < sizeof (plugins) / sizeof (plugins[0]); ++p)
+    {
+      // Make sure the plug-in is not loaded.
+      PluginRegistry::instance ().unloadUnused ();
+
+      benchmark::Stopwatch watch;
+      {
+        SolverFactory<solver_t> factory (plugins[p], pb);
+      }
+      double cold = 1e6 * watch.elapsed ();
+
+      watch.restart ();
+      for (int i = 0; i < iterations; ++i)
+        {
+          SolverFactory<solver_t> factory (plugins[p], pb);
+        }
+      double warm = 1e6 * watch.elapsed () / iterations;
+
+      std::cout << plugins[p] << ", " << cold << ", " << warm << std::endl;
+    }
+
+  PluginRegistry::instance ().unloadUnused ();
+  lt_dlexit ();
+  return 0;
+}
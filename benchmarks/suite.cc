@@ -0,0 +1,346 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+// Run the standard problem suite (Hock-Schittkowski problems, extended
+// Rosenbrock and a banded trajectory NLP) on the built-in plug-ins, and
+// write a JSON report: evaluation times of the cost, its gradient and the
+// constraint Jacobian, and solve time, cost, constraint violation and
+// iteration count for each plug-in.
+//
+// Plug-ins that cannot be loaded are reported as "unavailable", problems a
+// plug-in does not support as "error". Iteration counts are null when the
+// plug-in does not call the iteration callback.
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <roboptim/core/compiled-problem.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+
+#include "harness.hh"
+#include "problems.hh"
+
+using namespace roboptim;
+using namespace roboptim::benchmark;
+
+namespace
+{
+  /// \brief Iteration callback counting the iterations.
+  template <typename S>
+  struct CountIterations
+  {
+    explicit CountIterations (long& iterations)
+      : iterations_ (iterations)
+    {}
+
+    void operator() (const typename S::problem_t&,
+                     typename S::solverState_t&)
+    {
+      ++iterations_;
+    }
+
+    long& iterations_;
+  };
+
+  /// \brief Name of the matrix type.
+  template <typename T>
+  const char* matrixName ();
+
+  template <>
+  const char* matrixName<EigenMatrixDense> ()
+  {
+    return "dense";
+  }
+
+  template <>
+  const char* matrixName<EigenMatrixSparse> ()
+  {
+    return "sparse";
+  }
+
+  /// \brief Maximum violation of the argument and constraint bounds.
+  template <typename T>
+  double violation (const CompiledProblem<T>& cpb,
+                    const typename CompiledProblem<T>::vector_t& x)
+  {
+    typedef typename CompiledProblem<T>::vector_t vector_t;
+
+    double v = 0.;
+    v = std::max (v, (cpb.argumentLowerBounds () - x).maxCoeff ());
+    v = std::max (v, (x - cpb.argumentUpperBounds ()).maxCoeff ());
+    if (cpb.constraintsOutputSize () > 0)
+      {
+        vector_t g (cpb.constraintsOutputSize ());
+        cpb.constraints (g, x);
+        v = std::max (v, (cpb.constraintsLowerBounds () - g).maxCoeff ());
+        v = std::max (v, (g - cpb.constraintsUpperBounds ()).maxCoeff ());
+      }
+    return v;
+  }
+
+  /// \brief Time the evaluations of the problem functions at the starting
+  /// point, in microseconds per call.
+  template <typename T>
+  void timeEvaluations (JsonWriter& json, const Problem<T>& pb,
+                        const Options& options)
+  {
+    typedef CompiledProblem<T> compiledProblem_t;
+    typedef typename compiledProblem_t::vector_t vector_t;
+    typedef typename compiledProblem_t::jacobian_t jacobian_t;
+    typedef typename compiledProblem_t::differentiableFunction_t
+      differentiableFunction_t;
+    typedef typename differentiableFunction_t::gradient_t gradient_t;
+
+    compiledProblem_t cpb (pb);
+    const vector_t x = *pb.startingPoint ();
+    const double scale = 1e6 / options.repeat;
+
+    vector_t value (1);
+    Stopwatch watch;
+    for (int i = 0; i < options.repeat; ++i)
+      pb.function () (value, x);
+    json.key ("value_us").value (watch.elapsed () * scale);
+
+    json.key ("gradient_us");
+    const differentiableFunction_t* df = cpb.differentiableFunction ();
+    if (df)
+      {
+        gradient_t grad (cpb.inputSize ());
+        watch.restart ();
+        for (int i = 0; i < options.repeat; ++i)
+          {
+            grad.setZero ();
+            df->gradient (grad, x, 0);
+          }
+        json.value (watch.elapsed () * scale);
+      }
+    else
+      json.null ();
+
+    json.key ("jacobian_us");
+    if (cpb.jacobianRows () > 0)
+      {
+        cpb.updateJacobianPattern (x);
+        jacobian_t jac = cpb.jacobianPattern ();
+        watch.restart ();
+        for (int i = 0; i < options.repeat; ++i)
+          cpb.jacobian (jac, x);
+        json.value (watch.elapsed () * scale);
+      }
+    else
+      json.null ();
+  }
+
+  /// \brief Solve a problem with a plug-in and report the results.
+  template <typename T>
+  void solve (JsonWriter& json, const BenchmarkProblem<T>& bp,
+              const std::string& plugin, const Options& options)
+  {
+    typedef Solver<T> solver_t;
+    typedef typename solver_t::problem_t problem_t;
+
+    json.beginObject ();
+    json.key ("plugin").value (plugin);
+
+    const problem_t& pb = *bp.problem;
+    boost::shared_ptr<SolverFactory<solver_t> > factory;
+    try
+      {
+        factory = boost::make_shared<SolverFactory<solver_t> > (plugin, pb);
+      }
+    catch (const std::exception& e)
+      {
+        json.key ("status").value ("unavailable");
+        json.key ("message").value (e.what ());
+        json.endObject ();
+        return;
+      }
+
+    try
+      {
+        solver_t& solver = (*factory) ();
+        long iterations = 0;
+        try
+          {
+            solver.setIterationCallback
+              (CountIterations<solver_t> (iterations));
+          }
+        catch (const std::runtime_error&)
+          {
+            // Iteration callback not supported.
+          }
+
+        double min = 0.;
+        double total = 0.;
+        Stopwatch watch;
+        for (int i = 0; i < options.solveRepeat; ++i)
+          {
+            solver.reset ();
+            watch.restart ();
+            solver.solve ();
+            double t = watch.elapsed ();
+            min = i == 0 ? t : std::min (min, t);
+            total += t;
+          }
+
+        switch (solver.minimumType ())
+          {
+          case solver_t::SOLVER_ERROR:
+            json.key ("status").value ("error");
+            json.key ("message").value
+              (solver.template getMinimum<SolverError> ().what ());
+            json.endObject ();
+            return;
+          case solver_t::SOLVER_NO_SOLUTION:
+            json.key ("status").value ("error");
+            json.key ("message").value ("no solution");
+            json.endObject ();
+            return;
+          default:
+            break;
+          }
+
+        const Result& res = solver.template getMinimum<Result> ();
+        json.key ("status").value ("ok");
+        json.key ("time_min_ms").value (min * 1e3);
+        json.key ("time_mean_ms").value (total * 1e3 / options.solveRepeat);
+        json.key ("cost").value (res.value[0]);
+        json.key ("cost_error");
+        if (bp.optimum == bp.optimum)
+          json.value (std::fabs (res.value[0] - bp.optimum));
+        else
+          json.null ();
+        json.key ("violation").value
+          (violation (CompiledProblem<T> (pb), res.x));
+        json.key ("iterations");
+        if (iterations > 0)
+          json.value (iterations / options.solveRepeat);
+        else
+          json.null ();
+        json.key ("warnings").value (static_cast<long> (res.warnings.size ()));
+      }
+    catch (const std::exception& e)
+      {
+        json.key ("status").value ("error");
+        json.key ("message").value (e.what ());
+      }
+    json.endObject ();
+  }
+
+  /// \brief Run the suite for a matrix type.
+  template <typename T>
+  void run (JsonWriter& json, const char* const plugins[], std::size_t n,
+            const Options& options)
+  {
+    std::vector<BenchmarkProblem<T> > problems =
+      makeProblems<T> (options.sizes);
+
+    for (std::size_t i = 0; i < problems.size (); ++i)
+      {
+        const BenchmarkProblem<T>& bp = problems[i];
+        if (!options.matches (bp.name))
+          continue;
+
+        json.beginObject ();
+        json.key ("name").value (bp.name);
+        json.key ("matrix").value (matrixName<T> ());
+        json.key ("n").value (static_cast<long>
+                              (bp.problem->function ().inputSize ()));
+        json.key ("m").value (static_cast<long>
+                              (bp.problem->constraintsOutputSize ()));
+        json.key ("optimum").value (bp.optimum);
+        json.key ("evaluation").beginObject ();
+        timeEvaluations (json, *bp.problem, options);
+        json.endObject ();
+
+        json.key ("solvers").beginArray ();
+        for (std::size_t j = 0; j < n; ++j)
+          if (options.hasPlugin (plugins[j]))
+            solve (json, bp, plugins[j], options);
+        json.endArray ();
+        json.endObject ();
+      }
+  }
+} // end of anonymous namespace
+
+int main (int argc, char** argv)
+{
+  Options options;
+  for (int i = 1; i < argc; ++i)
+    if (!std::strcmp (argv[i], "-h") || !std::strcmp (argv[i], "--help"))
+      {
+        std::cout << usage;
+        return 0;
+      }
+  try
+    {
+      options.parse (argc, argv);
+    }
+  catch (const std::exception& e)
+    {
+      std::cerr << e.what () << '\n' << usage;
+      return 1;
+    }
+
+  std::ofstream file;
+  if (!options.output.empty ())
+    {
+      file.open (options.output.c_str ());
+      if (!file)
+        {
+          std::cerr << "cannot open " << options.output << std::endl;
+          return 1;
+        }
+    }
+  JsonWriter json (options.output.empty () ? std::cout : file);
+
+  lt_dlinit ();
+  lt_dlsetsearchpath (PLUGIN_PATH);
+
+  const char* const densePlugins[] =
+    {"lbfgsb", "levenberg-marquardt", "active-set-qp"};
+  const char* const sparsePlugins[] =
+    {"levenberg-marquardt-sparse", "active-set-qp-sparse",
+     "augmented-lagrangian"};
+
+  json.beginObject ();
+  json.key ("sizes").beginArray ();
+  for (std::size_t i = 0; i < options.sizes.size (); ++i)
+    json.value (options.sizes[i]);
+  json.endArray ();
+  json.key ("repeat").value (options.repeat);
+  json.key ("solve_repeat").value (options.solveRepeat);
+  json.key ("problems").beginArray ();
+  run<EigenMatrixDense> (json, densePlugins,
+                         sizeof (densePlugins) / sizeof (densePlugins[0]),
+                         options);
+  run<EigenMatrixSparse> (json, sparsePlugins,
+                          sizeof (sparsePlugins) / sizeof (sparsePlugins[0]),
+                          options);
+  json.endArray ();
+  json.endObject ();
+
+  PluginRegistry::instance ().unloadUnused ();
+  lt_dlexit ();
+  return 0;
+}
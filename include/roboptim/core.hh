@@ -45,6 +45,7 @@
 # include <roboptim/core/twice-differentiable-function.hh>
 
 # include <roboptim/core/problem.hh>
+# include <roboptim/core/compiled-problem.hh>
 # include <roboptim/core/generic-solver.hh>
 # include <roboptim/core/solver.hh>
 # include <roboptim/core/solver-callback.hh>
@@ -52,6 +53,10 @@
 # include <roboptim/core/solver-factory.hh>
 # include <roboptim/core/solver-state.hh>
 # include <roboptim/core/solver-warning.hh>
+# include <roboptim/core/batch-solver.hh>
+# include <roboptim/core/multi-start-solver.hh>
+# include <roboptim/core/portfolio-solver.hh>
+# include <roboptim/core/solve-async.hh>
 
 # include <roboptim/core/result-with-warnings.hh>
 # include <roboptim/core/result.hh>
@@ -27,6 +27,12 @@
 #  include <Eigen/Core>
 # endif //! ROBOPTIM_CHECK_ALLOCATION
 
+# include <cstddef>
+# include <cstdlib>
+# include <iosfwd>
+# include <new>
+# include <string>
+
 # include <roboptim/core/sys.hh>
 
 namespace roboptim
@@ -53,8 +59,197 @@ namespace roboptim
   {
     return is_malloc_allowed_update (false);
   }
+
+  /// \brief Allocation statistics.
+  struct ROBOPTIM_DLLAPI AllocationStats
+  {
+    AllocationStats ();
+
+    /// \brief Number of allocations.
+    unsigned long allocations;
+
+    /// \brief Number of allocated bytes.
+    unsigned long bytes;
+
+    /// \brief Number of accounted calls (see AllocationScope).
+    unsigned long calls;
+  };
+
+  /// \brief Record a heap allocation.
+  ///
+  /// This is called by the allocation hooks (see
+  /// ROBOPTIM_DEFINE_ALLOCATION_HOOKS) and must not allocate.
+  ///
+  /// \param bytes size of the allocation.
+  ROBOPTIM_DLLAPI void record_allocation (std::size_t bytes);
+
+  /// \brief Allocations recorded since the start of the program.
+  ROBOPTIM_DLLAPI AllocationStats allocation_stats ();
+
+  /// \brief Whether allocations are recorded, i.e. whether the allocation
+  /// hooks were installed in the program.
+  ROBOPTIM_DLLAPI bool is_allocation_accounting_enabled ();
+
+  /// \brief Update the variable returned by
+  /// is_allocation_accounting_enabled.
+  ROBOPTIM_DLLAPI
+  bool allocation_accounting_update (bool update = false,
+                                     bool new_value = false);
+
+  /// \brief Count the allocations made during the lifetime of the scope.
+  ///
+  /// If a name is given, the allocations are also added to the
+  /// per-function statistics of that name on destruction (see
+  /// function_allocation_stats). This is how function evaluations are
+  /// accounted when roboptim-core is configured with the
+  /// ROBOPTIM_ACCOUNT_ALLOCATION option (see config.hh). Nested scopes are
+  /// inclusive: the allocations of an operator include the ones of the
+  /// functions it evaluates.
+  ///
+  /// Allocations are only recorded if the program installed the
+  /// allocation hooks. Counters are process-wide atomics, and the
+  /// per-function statistics are guarded by a mutex, so scopes can be used
+  /// from several threads. The allocations of a scope then include the
+  /// ones made concurrently by the other threads, and the ones made while
+  /// another thread adds a function to the statistics are not recorded.
+  class ROBOPTIM_DLLAPI AllocationScope
+  {
+  public:
+    /// \brief Start counting.
+    AllocationScope ();
+
+    /// \brief Start counting on behalf of a function.
+    ///
+    /// \param name function name (must outlive the scope).
+    explicit AllocationScope (const std::string& name);
+
+    /// \brief Stop counting, and update the per-function statistics.
+    ~AllocationScope ();
+
+    /// \brief Allocations made since the creation of the scope.
+    AllocationStats stats () const;
+
+  private:
+    AllocationScope (const AllocationScope&);
+    AllocationScope& operator= (const AllocationScope&);
+
+    /// \brief Counters at the creation of the scope.
+    AllocationStats start_;
+
+    /// \brief Function name (may be null).
+    const std::string* name_;
+  };
+
+  /// \brief Allocations accounted to the functions with a given name.
+  ///
+  /// \param name function name (see GenericFunction::getName).
+  ROBOPTIM_DLLAPI
+  AllocationStats function_allocation_stats (const std::string& name);
+
+  /// \brief Clear the per-function allocation statistics.
+  ROBOPTIM_DLLAPI void reset_function_allocation_stats ();
+
+  /// \brief Print the per-function allocation statistics as a table.
+  ///
+  /// \param o output stream
+  /// \return output stream
+  ROBOPTIM_DLLAPI
+  std::ostream& print_function_allocation_stats (std::ostream& o);
+
+  /// \brief Count the allocations made by a call.
+  ///
+  /// \param f nullary functor.
+  /// \return allocations made by f ().
+  template <typename F>
+  AllocationStats count_allocations (F f)
+  {
+    AllocationScope scope;
+    f ();
+    return scope.stats ();
+  }
+
+  namespace detail
+  {
+    /// \brief Enable allocation accounting at static initialization time.
+    struct AllocationHooksRegistration
+    {
+      AllocationHooksRegistration ()
+      {
+        allocation_accounting_update (true, true);
+      }
+    };
+  } // end of namespace detail
 }
 
+/// \brief Install the allocation hooks used by allocation accounting.
+///
+/// This has to be used once, at global scope, in the program (not in a
+/// library): it replaces the global allocation functions. With glibc,
+/// malloc, calloc and realloc are interposed, which catches both Eigen and
+/// operator new. Elsewhere, only the global operator new is replaced.
+# ifdef __GLIBC__
+#  define ROBOPTIM_DEFINE_ALLOCATION_HOOKS				\
+  extern "C"								\
+  {									\
+    void* __libc_malloc (std::size_t);					\
+    void* __libc_calloc (std::size_t, std::size_t);			\
+    void* __libc_realloc (void*, std::size_t);				\
+									\
+    void* malloc (std::size_t size) throw ()				\
+    {									\
+      ::roboptim::record_allocation (size);				\
+      return __libc_malloc (size);					\
+    }									\
+									\
+    void* calloc (std::size_t n, std::size_t size) throw ()		\
+    {									\
+      ::roboptim::record_allocation (n * size);				\
+      return __libc_calloc (n, size);					\
+    }									\
+									\
+    void* realloc (void* ptr, std::size_t size) throw ()		\
+    {									\
+      ::roboptim::record_allocation (size);				\
+      return __libc_realloc (ptr, size);				\
+    }									\
+  }									\
+  namespace								\
+  {									\
+    ::roboptim::detail::AllocationHooksRegistration			\
+    roboptimAllocationHooksRegistration;				\
+  }
+# else
+#  define ROBOPTIM_DEFINE_ALLOCATION_HOOKS				\
+  void* operator new (std::size_t size)					\
+  {									\
+    ::roboptim::record_allocation (size);				\
+    void* p = std::malloc (size ? size : 1);				\
+    if (!p)								\
+      throw std::bad_alloc ();						\
+    return p;								\
+  }									\
+									\
+  void* operator new[] (std::size_t size)				\
+  {									\
+    return operator new (size);						\
+  }									\
+									\
+  void operator delete (void* p) throw ()				\
+  {									\
+    std::free (p);							\
+  }									\
+									\
+  void operator delete[] (void* p) throw ()				\
+  {									\
+    std::free (p);							\
+  }									\
+  namespace								\
+  {									\
+    ::roboptim::detail::AllocationHooksRegistration			\
+    roboptimAllocationHooksRegistration;				\
+  }
+# endif //! __GLIBC__
+
 # ifdef ROBOPTIM_CHECK_ALLOCATION
 #  undef ROBOPTIM_CHECK_ALLOCATION
 # endif //! ROBOPTIM_CHECK_ALLOCATION
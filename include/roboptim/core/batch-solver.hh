@@ -0,0 +1,236 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_BATCH_SOLVER_HH
+# define ROBOPTIM_CORE_BATCH_SOLVER_HH
+
+# include <cstddef>
+# include <string>
+# include <vector>
+
+# include <boost/noncopyable.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/mutex.hpp>
+
+# include <roboptim/core/fwd.hh>
+# include <roboptim/core/portability.hh>
+# include <roboptim/core/detail/thread-pool.hh>
+# include <roboptim/core/solver.hh>
+# include <roboptim/core/solver-factory.hh>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \brief Range of task indices owned by a worker, from which other
+    /// workers can steal.
+    ///
+    /// The owner takes tasks from the front of the range, thieves take the
+    /// back half of the range.
+    class WorkStealingRange : public boost::noncopyable
+    {
+    public:
+      WorkStealingRange ()
+        : mutex_ (),
+          begin_ (0),
+          end_ (0)
+      {
+      }
+
+      /// \brief Set the range of tasks [begin, end).
+      void reset (std::size_t begin, std::size_t end)
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        begin_ = begin;
+        end_ = end;
+      }
+
+      /// \brief Take the first task (owner).
+      /// \return false if the range is empty.
+      bool pop (std::size_t& i)
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        if (begin_ >= end_)
+          return false;
+        i = begin_++;
+        return true;
+      }
+
+      /// \brief Take the back half of the tasks (thief).
+      /// \return false if the range is empty.
+      bool steal (std::size_t& begin, std::size_t& end)
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        if (begin_ >= end_)
+          return false;
+        end = end_;
+        begin = end_ - (end_ - begin_ + 1) / 2;
+        end_ = begin;
+        return true;
+      }
+
+    private:
+      boost::mutex mutex_;
+      std::size_t begin_;
+      std::size_t end_;
+    };
+  } // end of namespace detail
+
+  /// \addtogroup roboptim_solver
+  /// @{
+
+  /// \brief Solve many small independent problems with the same plug-in.
+  ///
+  /// Solving many tiny problems one after the other is dominated by
+  /// per-solve overhead: plug-in lookup, solver and thread creation, and
+  /// workspace allocation. The batch solver keeps the plug-in loaded, and
+  /// its threads and one solver per thread alive across batches. The problems of a batch are
+  /// distributed among the threads with a work-stealing scheduler, and the
+  /// results are written in a result array that is only allocated if its
+  /// size does not match the batch.
+  ///
+  /// A thread reuses its solver (see Solver::resolve) when a problem has the
+  /// same cost function and constraint objects as the previous one, and
+  /// only the starting point, the argument bounds or the constraint bounds
+  /// change. Otherwise, a new solver is created. For best throughput,
+  /// problems should thus be copies of the same problem (copies are cheap,
+  /// see Problem), with problem-specific data expressed as bounds (e.g. the
+  /// target of an inverse kinematics problem as the bounds of an equality
+  /// constraint).
+  ///
+  /// Functions are shared between the threads, so they have to be
+  /// reentrant.
+  ///
+  /// \tparam T matrix type
+  template <typename T>
+  class BatchSolver : public boost::noncopyable
+  {
+  public:
+    /// \brief Solver type.
+    typedef Solver<T> solver_t;
+
+    /// \brief Problem type.
+    typedef typename solver_t::problem_t problem_t;
+
+    /// \brief Result type.
+    typedef typename solver_t::result_t result_t;
+
+    /// \brief Solver parameters type.
+    typedef typename solver_t::parameters_t parameters_t;
+
+    /// \brief Batch of problems.
+    ///
+    /// Problems are given by pointers, so that they are not copied.
+    typedef std::vector<const problem_t*> problems_t;
+
+    /// \brief Results of a batch.
+    typedef std::vector<result_t> results_t;
+
+    /// \brief Factory of the solvers of the plug-in.
+    typedef SolverFactory<solver_t> factory_t;
+
+    /// \brief Build a batch solver.
+    ///
+    /// \param plugin name of the plug-in used to solve the problems
+    /// \param threads number of threads (0: number of hardware threads)
+    /// \throw std::runtime_error if the plug-in can not be loaded.
+    explicit BatchSolver (const std::string& plugin, std::size_t threads = 0);
+
+    virtual ~BatchSolver ();
+
+    /// \brief Solve a batch of problems.
+    ///
+    /// \param problems problems to solve
+    /// \param results results of the problems, resized if needed
+    void solve (const problems_t& problems, results_t& results);
+
+    /// \brief Name of the plug-in.
+    const std::string& plugin () const;
+
+    /// \brief Number of threads.
+    std::size_t threads () const;
+
+    /// \brief Parameters given to the solvers of the plug-in.
+    ///
+    /// Parameters are applied when solvers are created.
+    /// \{
+    const parameters_t& parameters () const;
+    parameters_t& parameters ();
+    /// \}
+
+    /// \brief Number of solvers created during the last batch.
+    std::size_t solversCreated () const;
+
+  private:
+    /// \brief State of a thread.
+    struct Worker
+    {
+      Worker ();
+
+      /// \brief Factory of the current solver of the thread.
+      boost::shared_ptr<factory_t> factory;
+
+      /// \brief Tasks of the thread.
+      detail::WorkStealingRange tasks;
+
+      /// \brief Number of solvers created during the current batch.
+      std::size_t solversCreated;
+    };
+
+    /// \brief Process tasks of the current batch until there is nothing
+    /// left to steal.
+    void run (std::size_t w);
+
+    /// \brief Solve a problem with the solver of a thread.
+    void solve (Worker& worker, const problem_t& problem,
+                result_t& result);
+
+    /// \brief Update the solver of a thread to solve a problem.
+    ///
+    /// \return false if the problem has different functions, i.e. a new
+    /// solver has to be created.
+    bool update (solver_t& solver, const problem_t& problem) const;
+
+    /// \brief Name of the plug-in.
+    std::string plugin_;
+
+    /// \brief Number of threads.
+    std::size_t threads_;
+
+    /// \brief Parameters of the solvers.
+    parameters_t parameters_;
+
+    /// \brief Threads states.
+    std::vector<boost::shared_ptr<Worker> > workers_;
+
+    /// \brief Threads, the calling thread being the first one.
+    boost::shared_ptr<detail::ThreadPool> pool_;
+
+    /// \brief Task run by the threads.
+    detail::ThreadPool::task_t task_;
+
+    /// \brief Current batch.
+    const problems_t* problems_;
+    results_t* results_;
+  };
+
+  /// @}
+
+} // end of namespace roboptim
+
+# include <roboptim/core/batch-solver.hxx>
+#endif //! ROBOPTIM_CORE_BATCH_SOLVER_HH
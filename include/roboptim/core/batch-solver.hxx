@@ -0,0 +1,255 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_BATCH_SOLVER_HXX
+# define ROBOPTIM_CORE_BATCH_SOLVER_HXX
+
+# include <algorithm>
+# include <stdexcept>
+
+# include <boost/bind.hpp>
+# include <boost/make_shared.hpp>
+# include <boost/thread/thread.hpp>
+
+# include <roboptim/core/plugin-registry.hh>
+
+namespace roboptim
+{
+  template <typename T>
+  BatchSolver<T>::Worker::Worker ()
+    : factory (),
+      tasks (),
+      solversCreated (0)
+  {
+  }
+
+  template <typename T>
+  BatchSolver<T>::BatchSolver (const std::string& plugin, std::size_t threads)
+    : plugin_ (plugin),
+      threads_ (threads > 0
+                ? threads
+                : static_cast<std::size_t>
+                (boost::thread::hardware_concurrency ())),
+      parameters_ (),
+      workers_ (),
+      pool_ (),
+      task_ (),
+      problems_ (0),
+      results_ (0)
+  {
+    threads_ = std::max<std::size_t> (threads_, 1);
+
+    // Keep the plug-in loaded while the batch solver exists.
+    PluginRegistry::instance ().acquire (plugin_);
+
+    workers_.resize (threads_);
+    for (std::size_t w = 0; w < threads_; ++w)
+      workers_[w] = boost::make_shared<Worker> ();
+
+    pool_ = boost::make_shared<detail::ThreadPool> (threads_);
+    task_ = boost::bind (&BatchSolver<T>::run, this, _1);
+  }
+
+  template <typename T>
+  BatchSolver<T>::~BatchSolver ()
+  {
+    // Stop the threads and destroy the solvers before releasing the
+    // plug-in.
+    pool_.reset ();
+    workers_.clear ();
+    PluginRegistry::instance ().release (plugin_);
+  }
+
+  template <typename T>
+  void
+  BatchSolver<T>::solve (const problems_t& problems, results_t& results)
+  {
+    if (results.size () != problems.size ())
+      results.resize (problems.size ());
+
+    std::size_t n = std::min (threads_, problems.size ());
+    if (n == 0)
+      return;
+
+    // Split the batch evenly, the scheduler balances the load afterwards.
+    for (std::size_t w = 0; w < n; ++w)
+      {
+        workers_[w]->solversCreated = 0;
+        workers_[w]->tasks.reset (w * problems.size () / n,
+                                  (w + 1) * problems.size () / n);
+      }
+    for (std::size_t w = n; w < threads_; ++w)
+      workers_[w]->solversCreated = 0;
+
+    // The calling thread is the first worker, and runs single-task batches
+    // alone.
+    problems_ = &problems;
+    results_ = &results;
+    if (n == 1)
+      run (0);
+    else
+      pool_->run (task_);
+    problems_ = 0;
+    results_ = 0;
+  }
+
+  template <typename T>
+  void
+  BatchSolver<T>::run (std::size_t w)
+  {
+    const problems_t& problems = *problems_;
+    results_t& results = *results_;
+    std::size_t n = std::min (threads_, problems.size ());
+    if (w >= n)
+      return;
+    Worker& worker = *workers_[w];
+
+    while (true)
+      {
+        std::size_t i;
+        while (worker.tasks.pop (i))
+          solve (worker, *problems[i], results[i]);
+
+        // Steal half of the remaining tasks of another worker.
+        bool stolen = false;
+        for (std::size_t k = 1; k < n && !stolen; ++k)
+          {
+            std::size_t begin, end;
+            if (workers_[(w + k) % n]->tasks.steal (begin, end))
+              {
+                worker.tasks.reset (begin, end);
+                stolen = true;
+              }
+          }
+
+        if (!stolen)
+          return;
+      }
+  }
+
+  template <typename T>
+  void
+  BatchSolver<T>::solve (Worker& worker, const problem_t& problem,
+                         result_t& result)
+  {
+    try
+      {
+        if (worker.factory && update ((*worker.factory) (), problem))
+          (*worker.factory) ().resolve ();
+        else
+          {
+            worker.factory.reset ();
+            worker.factory = boost::make_shared<factory_t> (plugin_, problem);
+            ++worker.solversCreated;
+
+            solver_t& solver = (*worker.factory) ();
+            typedef typename parameters_t::const_iterator citer_t;
+            for (citer_t it = parameters_.begin ();
+                 it != parameters_.end (); ++it)
+              solver.parameters ()[it->first] = it->second;
+
+            solver.solve ();
+          }
+
+        result = (*worker.factory) ().minimum ();
+      }
+    catch (const std::exception& e)
+      {
+        worker.factory.reset ();
+        result = SolverError (e.what ());
+      }
+  }
+
+  template <typename T>
+  bool
+  BatchSolver<T>::update (solver_t& solver, const problem_t& problem) const
+  {
+    const problem_t& current = solver.problem ();
+
+    // The functions have to be the same.
+    if (&current.function () != &problem.function ()
+        || current.constraints ().size () != problem.constraints ().size ())
+      return false;
+
+    for (std::size_t i = 0; i < problem.constraints ().size (); ++i)
+      if (current.constraints ()[i] != problem.constraints ()[i])
+        return false;
+
+    if (current.argumentScaling () != problem.argumentScaling ()
+        || current.scalingVector () != problem.scalingVector ())
+      return false;
+
+    // The starting point can be changed, but not removed.
+    if (current.startingPoint () && !problem.startingPoint ())
+      return false;
+
+    if (problem.startingPoint ()
+        && (!current.startingPoint ()
+            || *current.startingPoint () != *problem.startingPoint ()))
+      solver.updateStartingPoint (*problem.startingPoint ());
+
+    if (current.argumentBounds () != problem.argumentBounds ())
+      solver.updateArgumentBounds (problem.argumentBounds ());
+
+    for (std::size_t i = 0; i < problem.boundsVector ().size (); ++i)
+      if (current.boundsVector ()[i] != problem.boundsVector ()[i])
+        solver.updateConstraintBounds (i, problem.boundsVector ()[i]);
+
+    return true;
+  }
+
+  template <typename T>
+  const std::string&
+  BatchSolver<T>::plugin () const
+  {
+    return plugin_;
+  }
+
+  template <typename T>
+  std::size_t
+  BatchSolver<T>::threads () const
+  {
+    return threads_;
+  }
+
+  template <typename T>
+  const typename BatchSolver<T>::parameters_t&
+  BatchSolver<T>::parameters () const
+  {
+    return parameters_;
+  }
+
+  template <typename T>
+  typename BatchSolver<T>::parameters_t&
+  BatchSolver<T>::parameters ()
+  {
+    return parameters_;
+  }
+
+  template <typename T>
+  std::size_t
+  BatchSolver<T>::solversCreated () const
+  {
+    std::size_t n = 0;
+    for (std::size_t w = 0; w < workers_.size (); ++w)
+      n += workers_[w]->solversCreated;
+    return n;
+  }
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_BATCH_SOLVER_HXX
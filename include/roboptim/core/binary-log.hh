@@ -0,0 +1,321 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_BINARY_LOG_HH
+# define ROBOPTIM_CORE_BINARY_LOG_HH
+
+# include <cstddef>
+# include <string>
+# include <vector>
+
+# include <boost/cstdint.hpp>
+# include <boost/filesystem/fstream.hpp>
+# include <boost/filesystem/path.hpp>
+# include <boost/noncopyable.hpp>
+# include <boost/scoped_ptr.hpp>
+
+# include <roboptim/core/portability.hh>
+# include <roboptim/core/function.hh>
+
+namespace roboptim
+{
+  /// \brief Layout of a binary optimization log, i.e. the sizes and names
+  /// stored in its header.
+  struct ROBOPTIM_DLLAPI BinaryLogLayout
+  {
+    /// \brief Description of a constraint.
+    struct Constraint
+    {
+      Constraint ();
+
+      /// \param name name of the constraint.
+      /// \param outputSize output size of the constraint.
+      /// \param differentiable whether the Jacobian may be logged.
+      Constraint (const std::string& name, boost::uint64_t outputSize,
+                  bool differentiable);
+
+      /// \brief Name of the constraint.
+      std::string name;
+
+      /// \brief Output size of the constraint.
+      boost::uint64_t outputSize;
+
+      /// \brief Whether the Jacobian of the constraint may be logged.
+      bool differentiable;
+    };
+
+    BinaryLogLayout ();
+
+    /// \brief Size of the argument.
+    boost::uint64_t inputSize;
+
+    /// \brief Names of the arguments (may be empty).
+    std::vector<std::string> argumentNames;
+
+    /// \brief Constraints, in the order of the problem.
+    std::vector<Constraint> constraints;
+
+    /// \brief Sum of the output sizes of the constraints.
+    boost::uint64_t constraintsOutputSize () const;
+  };
+
+  /// \brief Append-only writer of binary optimization logs.
+  ///
+  /// A binary log is a single file made of a header (see BinaryLogLayout)
+  /// followed by one record per iteration. All the fields are stored in
+  /// the native byte order, and aligned on 8 bytes so that the file can be
+  /// read in place once mapped in memory (see BinaryLogReader).
+  ///
+  /// A record starts with a fixed-size part (iteration, time, cost,
+  /// constraint violation), followed by the argument, the values of all
+  /// the constraints (NaN if they were not logged), and optional Jacobian
+  /// blocks. Dense Jacobians are stored row-major, sparse Jacobians as
+  /// (row, column, value) triplets.
+  ///
+  /// Each record is built in a buffer that is reused, and written at once
+  /// by endRecord: a crash can only lose the record being written.
+  class ROBOPTIM_DLLAPI BinaryLogWriter : public boost::noncopyable
+  {
+  public:
+    /// \brief Constant reference to a vector.
+    typedef GenericFunctionTraits<EigenMatrixDense>::const_vector_ref
+    const_vector_ref;
+
+    /// \brief Constant reference to a dense matrix.
+    typedef GenericFunctionTraits<EigenMatrixDense>::const_matrix_ref
+    const_dense_matrix_ref;
+
+    /// \brief Constant reference to a sparse matrix.
+    typedef GenericFunctionTraits<EigenMatrixSparse>::const_matrix_ref
+    const_sparse_matrix_ref;
+
+    /// \brief Create the log file and write its header.
+    ///
+    /// \param file log file (truncated if it exists).
+    /// \param layout layout of the log.
+    /// \throw std::runtime_error
+    BinaryLogWriter (const boost::filesystem::path& file,
+                     const BinaryLogLayout& layout);
+
+    /// \brief Flush and close the log file.
+    ~BinaryLogWriter ();
+
+    /// \brief Layout of the log.
+    const BinaryLogLayout& layout () const;
+
+    /// \brief Start a new record.
+    ///
+    /// \param iteration iteration number.
+    /// \param time time since the beginning of the optimization (s).
+    /// \param cost cost.
+    /// \param violation constraint violation (NaN if unknown).
+    /// \param x argument.
+    void beginRecord (boost::uint64_t iteration, double time, double cost,
+                      double violation, const_vector_ref x);
+
+    /// \brief Set the value of a constraint in the current record.
+    ///
+    /// \param constraint index of the constraint.
+    /// \param value value of the constraint.
+    void constraint (std::size_t constraint, const_vector_ref value);
+
+    /// \brief Append a dense Jacobian block to the current record.
+    ///
+    /// \param constraint index of the constraint.
+    /// \param jacobian Jacobian of the constraint.
+    void jacobian (std::size_t constraint, const_dense_matrix_ref jacobian);
+
+    /// \brief Append a sparse Jacobian block to the current record.
+    ///
+    /// \param constraint index of the constraint.
+    /// \param jacobian Jacobian of the constraint.
+    void jacobian (std::size_t constraint, const_sparse_matrix_ref jacobian);
+
+    /// \brief Append the current record to the log file.
+    void endRecord ();
+
+    /// \brief Flush the log file.
+    void flush ();
+
+    /// \brief Number of records written.
+    boost::uint64_t records () const;
+
+    /// \brief Size of the log file (bytes).
+    boost::uint64_t size () const;
+
+  private:
+    /// \brief Reserve space for a Jacobian block in the current record.
+    ///
+    /// \return offset of the block data in the record buffer.
+    std::size_t beginJacobian (std::size_t constraint, boost::uint32_t format,
+                               std::size_t count, std::size_t entrySize);
+
+    /// \brief Layout of the log.
+    BinaryLogLayout layout_;
+
+    /// \brief Offset of the value of each constraint in a record.
+    std::vector<std::size_t> constraintOffsets_;
+
+    /// \brief Size of a record without Jacobian blocks.
+    std::size_t recordSize_;
+
+    /// \brief Log file.
+    boost::filesystem::ofstream file_;
+
+    /// \brief Current record.
+    std::vector<char> record_;
+
+    /// \brief Number of records written.
+    boost::uint64_t records_;
+
+    /// \brief Size of the log file.
+    boost::uint64_t size_;
+  };
+
+  /// \brief Reader of binary optimization logs.
+  ///
+  /// The log file is mapped in memory: records are not copied, and the
+  /// vectors they contain are read in place. A truncated last record (e.g.
+  /// after a crash) is ignored.
+  class ROBOPTIM_DLLAPI BinaryLogReader : public boost::noncopyable
+  {
+  public:
+    /// \brief Vector type.
+    typedef GenericFunctionTraits<EigenMatrixDense>::vector_t vector_t;
+
+    /// \brief Dense matrix type.
+    typedef GenericFunctionTraits<EigenMatrixDense>::matrix_t matrix_t;
+
+    /// \brief Vector read in place.
+    typedef Eigen::Map<const vector_t> const_vector_map;
+
+    /// \brief Record of an iteration.
+    class ROBOPTIM_DLLAPI Record
+    {
+    public:
+      /// \brief Iteration number.
+      boost::uint64_t iteration () const;
+
+      /// \brief Time since the beginning of the optimization (s).
+      double time () const;
+
+      /// \brief Cost.
+      double cost () const;
+
+      /// \brief Constraint violation (NaN if unknown).
+      double violation () const;
+
+      /// \brief Argument.
+      const_vector_map x () const;
+
+      /// \brief Value of a constraint.
+      ///
+      /// \param constraint index of the constraint.
+      const_vector_map constraint (std::size_t constraint) const;
+
+      /// \brief Whether the record contains the Jacobian of a constraint.
+      ///
+      /// \param constraint index of the constraint.
+      /// \throw std::runtime_error if a Jacobian block of the record is
+      /// corrupt.
+      bool hasJacobian (std::size_t constraint) const;
+
+      /// \brief Copy the Jacobian of a constraint into a dense matrix.
+      ///
+      /// \param constraint index of the constraint.
+      /// \param jacobian output matrix (resized).
+      /// \throw std::runtime_error if the record does not contain the
+      /// Jacobian, or if it is corrupt.
+      void jacobian (std::size_t constraint, matrix_t& jacobian) const;
+
+    private:
+      friend class BinaryLogReader;
+
+      Record (const char* data, const BinaryLogReader& reader);
+
+      /// \brief Find a Jacobian block.
+      ///
+      /// The extents of the blocks are checked against the record.
+      ///
+      /// \return beginning of the block, or null.
+      /// \throw std::runtime_error if a block is corrupt.
+      const char* findJacobian (std::size_t constraint) const;
+
+      /// \brief Beginning of the record.
+      const char* data_;
+
+      /// \brief Reader of the log.
+      const BinaryLogReader* reader_;
+    };
+
+    /// \brief Map a log file in memory and index its records.
+    ///
+    /// \param file log file.
+    /// \throw std::runtime_error
+    explicit BinaryLogReader (const boost::filesystem::path& file);
+
+    ~BinaryLogReader ();
+
+    /// \brief Layout of the log.
+    const BinaryLogLayout& layout () const;
+
+    /// \brief Number of complete records.
+    std::size_t size () const;
+
+    /// \brief Retrieve a record.
+    ///
+    /// \param i index of the record.
+    Record operator[] (std::size_t i) const;
+
+  private:
+    /// \brief Memory mapping of the log file.
+    struct Mapping;
+
+    /// \brief Memory mapping of the log file.
+    boost::scoped_ptr<Mapping> mapping_;
+
+    /// \brief Layout of the log.
+    BinaryLogLayout layout_;
+
+    /// \brief Offset of the value of each constraint in a record.
+    std::vector<std::size_t> constraintOffsets_;
+
+    /// \brief Offset of the first Jacobian block in a record.
+    std::size_t jacobiansOffset_;
+
+    /// \brief Offset of each record in the file.
+    std::vector<std::size_t> offsets_;
+  };
+
+  /// \brief Convert a binary optimization log to the CSV layout of
+  /// OptimizationLogger.
+  ///
+  /// This writes one directory per iteration (x.csv, cost, and the value
+  /// and Jacobian of each constraint), as well as the evolution files
+  /// (cost-evolution.csv, x-evolution.csv, etc.).
+  ///
+  /// \param file binary log file.
+  /// \param directory output directory (created if needed).
+  /// \throw std::runtime_error
+  ROBOPTIM_DLLAPI void
+  convertBinaryLog (const boost::filesystem::path& file,
+                    const boost::filesystem::path& directory);
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_BINARY_LOG_HH
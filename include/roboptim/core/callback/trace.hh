@@ -0,0 +1,91 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_CALLBACK_TRACE_HH
+# define ROBOPTIM_CORE_CALLBACK_TRACE_HH
+
+# include <boost/cstdint.hpp>
+
+# include <roboptim/core/solver-state.hh>
+# include <roboptim/core/solver-callback.hh>
+# include <roboptim/core/trace.hh>
+
+namespace roboptim
+{
+  namespace callback
+  {
+    /// \brief Record the solver iterations in the Tracer.
+    ///
+    /// Each call records a span of category "iteration", from the previous
+    /// call (or from the construction of the callback, or the last call to
+    /// reset) to the current one, indexed by the iteration number. The
+    /// function evaluations traced during the iteration are thus nested in
+    /// its span.
+    ///
+    /// \tparam S solver type.
+    template <typename S>
+    class Trace : public SolverCallback<S>
+    {
+    public:
+      /// \brief Parent type.
+      typedef SolverCallback<S> parent_t;
+
+      /// \brief Type of the solver.
+      typedef S solver_t;
+
+      /// \brief Problem type.
+      typedef typename solver_t::problem_t problem_t;
+
+      /// \brief Type of the state of the solver.
+      typedef SolverState<problem_t> solverState_t;
+
+      /// \brief Default constructor.
+      /// \param name name of the iteration spans.
+      explicit Trace (const std::string& name = "solver iteration");
+
+      /// \brief Virtual destructor.
+      virtual ~Trace ();
+
+      /// \brief Restart the iteration count and the timing of the next
+      /// iteration, e.g. right before solving.
+      void reset ();
+
+      /// \brief Number of iterations seen since the last reset.
+      boost::int64_t iterations () const;
+
+    protected:
+      /// \brief Record the iteration span.
+      ///
+      /// \param pb problem.
+      /// \param state solver state.
+      virtual void perIterationCallbackUnsafe
+      (const problem_t& pb, solverState_t& state);
+
+    private:
+      /// \brief End of the previous iteration (ns).
+      boost::uint64_t last_;
+
+      /// \brief Number of iterations.
+      boost::int64_t iteration_;
+    };
+  } // end of namespace callback
+} // end of namespace roboptim
+
+# include <roboptim/core/callback/trace.hxx>
+
+#endif //! ROBOPTIM_CORE_CALLBACK_TRACE_HH
@@ -0,0 +1,74 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_CALLBACK_TRACE_HXX
+# define ROBOPTIM_CORE_CALLBACK_TRACE_HXX
+
+# include <roboptim/core/solver.hh>
+# include <roboptim/core/solver-state.hh>
+# include <roboptim/core/solver-callback.hh>
+# include <roboptim/core/trace.hh>
+
+namespace roboptim
+{
+  namespace callback
+  {
+    template <typename S>
+    Trace<S>::Trace (const std::string& name)
+    : parent_t (name),
+      last_ (monotonicTime ()),
+      iteration_ (0)
+    {
+    }
+
+    template <typename S>
+    Trace<S>::~Trace ()
+    {}
+
+    template <typename S>
+    void Trace<S>::reset ()
+    {
+      last_ = monotonicTime ();
+      iteration_ = 0;
+    }
+
+    template <typename S>
+    boost::int64_t Trace<S>::iterations () const
+    {
+      return iteration_;
+    }
+
+    template <typename S>
+    void Trace<S>::perIterationCallbackUnsafe
+    (const problem_t&, solverState_t&)
+    {
+      const boost::uint64_t now = monotonicTime ();
+      Tracer& tracer = Tracer::instance ();
+
+      if (tracer.isEnabled ())
+        tracer.record ("iteration", this->name ().c_str (),
+                       last_, now, iteration_);
+
+      last_ = now;
+      ++iteration_;
+    }
+
+  } // end of namespace callback
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_CALLBACK_TRACE_HXX
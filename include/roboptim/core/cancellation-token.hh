@@ -0,0 +1,56 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_CANCELLATION_TOKEN_HH
+# define ROBOPTIM_CORE_CANCELLATION_TOKEN_HH
+
+# include <boost/atomic.hpp>
+# include <boost/shared_ptr.hpp>
+
+# include <roboptim/core/portability.hh>
+
+namespace roboptim
+{
+  /// \addtogroup roboptim_solver
+  /// @{
+
+  /// \brief Token used to cancel an asynchronous solve.
+  ///
+  /// Copies of a token share the same state, so that a token given to
+  /// solveAsync can be cancelled from another thread.
+  class ROBOPTIM_DLLAPI CancellationToken
+  {
+  public:
+    /// \brief Create a new token (not cancelled).
+    CancellationToken ();
+
+    /// \brief Request the cancellation.
+    void cancel ();
+
+    /// \brief Whether the cancellation was requested.
+    bool cancelled () const;
+
+  private:
+    /// \brief Shared cancellation flag.
+    boost::shared_ptr<boost::atomic<bool> > cancelled_;
+  };
+
+  /// @}
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_CANCELLATION_TOKEN_HH
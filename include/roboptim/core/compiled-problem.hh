@@ -0,0 +1,329 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_COMPILED_PROBLEM_HH
+# define ROBOPTIM_CORE_COMPILED_PROBLEM_HH
+
+# include <iostream>
+# include <vector>
+
+# include <roboptim/core/fwd.hh>
+# include <roboptim/core/portability.hh>
+# include <roboptim/core/function.hh>
+# include <roboptim/core/differentiable-function.hh>
+# include <roboptim/core/numeric-linear-function.hh>
+# include <roboptim/core/problem.hh>
+
+namespace roboptim
+{
+  /// \addtogroup roboptim_problem
+  /// @{
+
+  /// \brief Flattened representation of an optimization problem.
+  ///
+  /// Solver plugins usually need the same information about a problem:
+  /// contiguous bounds, the offset of each constraint in the stacked
+  /// constraint vector, which constraints are differentiable or linear,
+  /// etc. A compiled problem computes all of this once, so that solvers
+  /// can initialize quickly and avoid type checks (asType, castInto)
+  /// during the iterations.
+  ///
+  /// The compiled problem keeps references to the problem and its
+  /// functions: the problem must outlive it, and it must be compiled
+  /// again if constraints are added to the problem. Bounds and scaling
+  /// are copied during the compilation.
+  ///
+  /// \tparam T matrix type
+  template <typename T>
+  class CompiledProblem
+  {
+  public:
+    /// \brief Problem type.
+    typedef Problem<T> problem_t;
+
+    /// \brief Function type.
+    typedef typename problem_t::function_t function_t;
+
+    /// \brief Differentiable function type.
+    typedef GenericDifferentiableFunction<T> differentiableFunction_t;
+
+    /// \brief Numeric linear function type.
+    typedef GenericNumericLinearFunction<T> numericLinearFunction_t;
+
+    /// \brief Value type.
+    typedef typename problem_t::value_type value_type;
+
+    /// \brief Size type.
+    typedef typename problem_t::size_type size_type;
+
+    /// \brief Vector type.
+    typedef typename problem_t::vector_t vector_t;
+
+    /// \brief Matrix type.
+    typedef typename function_t::matrix_t matrix_t;
+
+    /// \brief Jacobian type.
+    typedef typename problem_t::jacobian_t jacobian_t;
+
+    /// \brief Reference to a Jacobian matrix.
+    typedef typename problem_t::jacobian_ref jacobian_ref;
+
+    /// \brief Reference to a result vector.
+    typedef typename problem_t::result_ref result_ref;
+
+    /// \brief Constant reference to an argument vector.
+    typedef typename problem_t::const_argument_ref const_argument_ref;
+
+    /// \brief Function flag type.
+    typedef typename function_t::flag_t flag_t;
+
+    /// \brief Information about a constraint of the compiled problem.
+    struct ConstraintInfo
+    {
+      /// \brief Constraint function.
+      const function_t* function;
+
+      /// \brief Constraint as a differentiable function (NULL if the
+      /// constraint is not differentiable).
+      const differentiableFunction_t* differentiable;
+
+      /// \brief Constraint as a numeric linear function (NULL if the
+      /// constraint is not a numeric linear function).
+      const numericLinearFunction_t* numericLinear;
+
+      /// \brief Flags of the constraint (see GenericFunction::getFlags).
+      flag_t flags;
+
+      /// \brief Output size of the constraint.
+      size_type outputSize;
+
+      /// \brief First row of the constraint in the stacked constraint
+      /// vector.
+      size_type rowOffset;
+
+      /// \brief First row of the constraint in the stacked Jacobian matrix
+      /// (-1 if the constraint is not differentiable).
+      size_type jacobianRowOffset;
+
+      /// \brief First row of the constraint in the stacked linear system
+      /// (-1 if the constraint is not a numeric linear function).
+      size_type linearRowOffset;
+
+      /// \brief Whether the constraint is linear.
+      bool isLinear () const
+      {
+        return (flags & ROBOPTIM_IS_LINEAR) != 0;
+      }
+    };
+
+    /// \brief Vector of constraint information.
+    typedef std::vector<ConstraintInfo> constraintsInfo_t;
+
+    /// \brief Vector of constraint indices.
+    typedef std::vector<size_type> indices_t;
+
+    /// \brief Compile a problem.
+    ///
+    /// \param pb problem to compile.
+    explicit CompiledProblem (const problem_t& pb);
+
+    /// \brief Virtual destructor.
+    virtual ~CompiledProblem ();
+
+    /// \brief Retrieve the compiled problem.
+    const problem_t& problem () const;
+
+    /// \brief Retrieve the cost function.
+    const function_t& function () const;
+
+    /// \brief Retrieve the cost function as a differentiable function.
+    /// \return differentiable cost function, or NULL if the cost function is
+    /// not differentiable.
+    const differentiableFunction_t* differentiableFunction () const;
+
+    /// \brief Size of the argument.
+    size_type inputSize () const;
+
+    /// \brief Size of the stacked constraint vector.
+    size_type constraintsOutputSize () const;
+
+    /// \brief Number of rows of the stacked Jacobian matrix, i.e. the sum of
+    /// the output sizes of the differentiable constraints.
+    size_type jacobianRows () const;
+
+    /// \brief Number of rows of the stacked linear system.
+    size_type linearRows () const;
+
+    /// \brief Information about each constraint, in the order of the
+    /// problem.
+    const constraintsInfo_t& constraints () const;
+
+    /// \brief Indices of the linear constraints.
+    const indices_t& linearConstraints () const;
+
+    /// \brief Indices of the nonlinear constraints.
+    const indices_t& nonlinearConstraints () const;
+
+    /// \brief Whether all the constraints are linear.
+    bool hasOnlyLinearConstraints () const;
+
+    /// \brief Lower bounds of the arguments.
+    const vector_t& argumentLowerBounds () const;
+
+    /// \brief Upper bounds of the arguments.
+    const vector_t& argumentUpperBounds () const;
+
+    /// \brief Lower bounds of the stacked constraints.
+    const vector_t& constraintsLowerBounds () const;
+
+    /// \brief Upper bounds of the stacked constraints.
+    const vector_t& constraintsUpperBounds () const;
+
+    /// \brief Scaling of the arguments.
+    const vector_t& argumentScaling () const;
+
+    /// \brief Scaling of the stacked constraints.
+    const vector_t& constraintsScaling () const;
+
+    /// \brief Stacked matrix of the numeric linear constraints.
+    ///
+    /// The numeric linear constraints are stacked in the order of the
+    /// problem, so that \f$A x + b\f$ gives their values (see
+    /// ConstraintInfo::linearRowOffset).
+    const matrix_t& linearA () const;
+
+    /// \brief Stacked vector of the numeric linear constraints.
+    const vector_t& linearB () const;
+
+    /// \brief Evaluate the stacked constraints.
+    ///
+    /// \param g stacked constraint values, of size constraintsOutputSize ().
+    /// \param x point where the constraints are evaluated.
+    void constraints (result_ref g, const_argument_ref x) const;
+
+    /// \brief Compute the stacked Jacobian of the differentiable
+    /// constraints.
+    ///
+    /// This is equivalent to Problem::jacobian, but does not check the types
+    /// of the constraints.
+    ///
+    /// \param jac output Jacobian matrix, of size jacobianRows () x
+    /// inputSize ().
+    /// \param x point where the Jacobian is evaluated.
+    void jacobian (jacobian_ref jac, const_argument_ref x) const;
+
+    /// \brief Sparsity pattern of the stacked Jacobian.
+    ///
+    /// For sparse problems, the pattern is computed when the problem is
+    /// compiled, from the Jacobian at the starting point (or, if there is
+    /// none, at the projection of zero on the argument bounds), and the
+    /// nonzeros are set to one. Patterns at other points can be merged with
+    /// updateJacobianPattern (). For dense problems, the pattern is full.
+    const jacobian_t& jacobianPattern () const;
+
+    /// \brief Merge the sparsity pattern of the Jacobian at x into the
+    /// Jacobian pattern.
+    ///
+    /// This is only needed if the structure of the Jacobian depends on the
+    /// point. It allocates memory and should be called before the
+    /// iterations. This is a no-op for dense problems.
+    ///
+    /// \param x point where the Jacobian is evaluated.
+    void updateJacobianPattern (const_argument_ref x);
+
+    /// \brief Display the compiled problem on the specified output stream.
+    ///
+    /// \param o output stream used for display
+    /// \return output stream
+    virtual std::ostream& print (std::ostream& o) const;
+
+  private:
+    /// \brief Stack the numeric linear constraints.
+    void compileLinearConstraints ();
+
+    /// \brief Initialize the Jacobian pattern.
+    void initializeJacobianPattern ();
+
+    /// \brief Compiled problem.
+    const problem_t& problem_;
+
+    /// \brief Differentiable cost function.
+    const differentiableFunction_t* differentiableFunction_;
+
+    /// \brief Constraint information.
+    constraintsInfo_t constraints_;
+
+    /// \brief Indices of the linear constraints.
+    indices_t linearConstraints_;
+
+    /// \brief Indices of the nonlinear constraints.
+    indices_t nonlinearConstraints_;
+
+    /// \brief Size of the stacked constraints.
+    size_type constraintsOutputSize_;
+
+    /// \brief Number of rows of the stacked Jacobian.
+    size_type jacobianRows_;
+
+    /// \brief Number of rows of the stacked linear system.
+    size_type linearRows_;
+
+    /// \brief Lower bounds of the arguments.
+    vector_t argumentLowerBounds_;
+
+    /// \brief Upper bounds of the arguments.
+    vector_t argumentUpperBounds_;
+
+    /// \brief Lower bounds of the constraints.
+    vector_t constraintsLowerBounds_;
+
+    /// \brief Upper bounds of the constraints.
+    vector_t constraintsUpperBounds_;
+
+    /// \brief Scaling of the arguments.
+    vector_t argumentScaling_;
+
+    /// \brief Scaling of the constraints.
+    vector_t constraintsScaling_;
+
+    /// \brief Stacked matrix of the numeric linear constraints.
+    matrix_t linearA_;
+
+    /// \brief Stacked vector of the numeric linear constraints.
+    vector_t linearB_;
+
+    /// \brief Sparsity pattern of the stacked Jacobian.
+    jacobian_t jacobianPattern_;
+
+    /// \brief Cache used to fill sparse Jacobian matrices.
+    mutable detail::ProblemJacobianCache<T> jacobianCache_;
+  };
+
+  /// \brief Override operator<< to display compiled problems.
+  ///
+  /// \param o output stream used for display
+  /// \param pb compiled problem to be displayed
+  /// \return output stream
+  template <typename T>
+  std::ostream& operator<< (std::ostream& o, const CompiledProblem<T>& pb);
+
+  /// @}
+
+} // end of namespace roboptim
+
+# include <roboptim/core/compiled-problem.hxx>
+#endif //! ROBOPTIM_CORE_COMPILED_PROBLEM_HH
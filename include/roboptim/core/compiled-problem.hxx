@@ -0,0 +1,441 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_COMPILED_PROBLEM_HXX
+# define ROBOPTIM_CORE_COMPILED_PROBLEM_HXX
+
+# include <algorithm>
+# include <cassert>
+
+# define EIGEN_YES_I_KNOW_SPARE_MODULE_IS_NOT_STABLE_YET
+# include <Eigen/Core>
+# include <Eigen/Sparse>
+
+# include <roboptim/core/indent.hh>
+# include <roboptim/core/util.hh>
+
+namespace roboptim
+{
+  template <typename T>
+  CompiledProblem<T>::CompiledProblem (const problem_t& pb)
+    : problem_ (pb),
+      differentiableFunction_ (0),
+      constraints_ (),
+      linearConstraints_ (),
+      nonlinearConstraints_ (),
+      constraintsOutputSize_ (pb.constraintsOutputSize ()),
+      jacobianRows_ (0),
+      linearRows_ (0),
+      argumentLowerBounds_ (pb.argumentLowerBounds ()),
+      argumentUpperBounds_ (pb.argumentUpperBounds ()),
+      constraintsLowerBounds_ (pb.constraintsLowerBounds ()),
+      constraintsUpperBounds_ (pb.constraintsUpperBounds ()),
+      argumentScaling_ (pb.function ().inputSize ()),
+      constraintsScaling_ (pb.constraintsOutputSize ()),
+      linearA_ (),
+      linearB_ (),
+      jacobianPattern_ (),
+      jacobianCache_ ()
+  {
+    if (pb.function ().template asType<differentiableFunction_t> ())
+      differentiableFunction_ =
+        pb.function ().template castInto<differentiableFunction_t> ();
+
+    // Arguments scaling.
+    for (size_type i = 0; i < argumentScaling_.size (); ++i)
+      argumentScaling_[i] = pb.argumentScaling ()[static_cast<std::size_t> (i)];
+
+    // Classify the constraints and compute their offsets.
+    constraints_.reserve (pb.constraints ().size ());
+    size_type row = 0;
+    for (std::size_t i = 0; i < pb.constraints ().size (); ++i)
+      {
+        const function_t* f = pb.constraints ()[i].get ();
+
+        ConstraintInfo info;
+        info.function = f;
+        info.differentiable = 0;
+        info.numericLinear = 0;
+        info.flags = f->getFlags ();
+        info.outputSize = f->outputSize ();
+        info.rowOffset = row;
+        info.jacobianRowOffset = -1;
+        info.linearRowOffset = -1;
+
+        if (f->template asType<differentiableFunction_t> ())
+          {
+            info.differentiable = f->template castInto<differentiableFunction_t> ();
+            info.jacobianRowOffset = jacobianRows_;
+            jacobianRows_ += info.outputSize;
+          }
+
+        if (f->template asType<numericLinearFunction_t> ())
+          {
+            info.numericLinear = f->template castInto<numericLinearFunction_t> ();
+            info.linearRowOffset = linearRows_;
+            linearRows_ += info.outputSize;
+          }
+
+        if (info.isLinear ())
+          linearConstraints_.push_back (static_cast<size_type> (i));
+        else
+          nonlinearConstraints_.push_back (static_cast<size_type> (i));
+
+        // Constraints scaling.
+        const typename problem_t::scaling_t& scaling = pb.scalingVector ()[i];
+        for (size_type j = 0; j < info.outputSize; ++j)
+          constraintsScaling_[row + j] = scaling[static_cast<std::size_t> (j)];
+
+        row += info.outputSize;
+        constraints_.push_back (info);
+      }
+
+    compileLinearConstraints ();
+    initializeJacobianPattern ();
+  }
+
+  template <typename T>
+  CompiledProblem<T>::~CompiledProblem ()
+  {}
+
+  template <typename T>
+  const typename CompiledProblem<T>::problem_t&
+  CompiledProblem<T>::problem () const
+  {
+    return problem_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::function_t&
+  CompiledProblem<T>::function () const
+  {
+    return problem_.function ();
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::differentiableFunction_t*
+  CompiledProblem<T>::differentiableFunction () const
+  {
+    return differentiableFunction_;
+  }
+
+  template <typename T>
+  typename CompiledProblem<T>::size_type
+  CompiledProblem<T>::inputSize () const
+  {
+    return problem_.function ().inputSize ();
+  }
+
+  template <typename T>
+  typename CompiledProblem<T>::size_type
+  CompiledProblem<T>::constraintsOutputSize () const
+  {
+    return constraintsOutputSize_;
+  }
+
+  template <typename T>
+  typename CompiledProblem<T>::size_type
+  CompiledProblem<T>::jacobianRows () const
+  {
+    return jacobianRows_;
+  }
+
+  template <typename T>
+  typename CompiledProblem<T>::size_type
+  CompiledProblem<T>::linearRows () const
+  {
+    return linearRows_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::constraintsInfo_t&
+  CompiledProblem<T>::constraints () const
+  {
+    return constraints_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::indices_t&
+  CompiledProblem<T>::linearConstraints () const
+  {
+    return linearConstraints_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::indices_t&
+  CompiledProblem<T>::nonlinearConstraints () const
+  {
+    return nonlinearConstraints_;
+  }
+
+  template <typename T>
+  bool
+  CompiledProblem<T>::hasOnlyLinearConstraints () const
+  {
+    return nonlinearConstraints_.empty ();
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::vector_t&
+  CompiledProblem<T>::argumentLowerBounds () const
+  {
+    return argumentLowerBounds_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::vector_t&
+  CompiledProblem<T>::argumentUpperBounds () const
+  {
+    return argumentUpperBounds_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::vector_t&
+  CompiledProblem<T>::constraintsLowerBounds () const
+  {
+    return constraintsLowerBounds_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::vector_t&
+  CompiledProblem<T>::constraintsUpperBounds () const
+  {
+    return constraintsUpperBounds_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::vector_t&
+  CompiledProblem<T>::argumentScaling () const
+  {
+    return argumentScaling_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::vector_t&
+  CompiledProblem<T>::constraintsScaling () const
+  {
+    return constraintsScaling_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::matrix_t&
+  CompiledProblem<T>::linearA () const
+  {
+    return linearA_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::vector_t&
+  CompiledProblem<T>::linearB () const
+  {
+    return linearB_;
+  }
+
+  template <typename T>
+  const typename CompiledProblem<T>::jacobian_t&
+  CompiledProblem<T>::jacobianPattern () const
+  {
+    return jacobianPattern_;
+  }
+
+  template <typename T>
+  void
+  CompiledProblem<T>::constraints (result_ref g, const_argument_ref x) const
+  {
+    assert (g.size () == constraintsOutputSize_);
+
+    for (typename constraintsInfo_t::const_iterator
+           c = constraints_.begin (); c != constraints_.end (); ++c)
+      (*c->function) (g.segment (c->rowOffset, c->outputSize), x);
+  }
+
+  // Dense version.
+  template <typename T>
+  void
+  CompiledProblem<T>::compileLinearConstraints ()
+  {
+    size_type n = inputSize ();
+    linearA_.resize (linearRows_, n);
+    linearB_.resize (linearRows_);
+
+    for (typename constraintsInfo_t::const_iterator
+           c = constraints_.begin (); c != constraints_.end (); ++c)
+      {
+        if (!c->numericLinear)
+          continue;
+
+        linearA_.middleRows (c->linearRowOffset, c->outputSize)
+          = c->numericLinear->A ();
+        linearB_.segment (c->linearRowOffset, c->outputSize)
+          = c->numericLinear->b ();
+      }
+  }
+
+  template <>
+  inline void
+  CompiledProblem<EigenMatrixSparse>::compileLinearConstraints ()
+  {
+    typedef Eigen::Triplet<double> triplet_t;
+
+    size_type n = inputSize ();
+    linearB_.resize (linearRows_);
+
+    size_type nnz = 0;
+    for (constraintsInfo_t::const_iterator
+           c = constraints_.begin (); c != constraints_.end (); ++c)
+      if (c->numericLinear)
+        nnz += c->numericLinear->A ().nonZeros ();
+
+    std::vector<triplet_t> coeffs;
+    coeffs.reserve (static_cast<std::size_t> (nnz));
+
+    for (constraintsInfo_t::const_iterator
+           c = constraints_.begin (); c != constraints_.end (); ++c)
+      {
+        if (!c->numericLinear)
+          continue;
+
+        const matrix_t& A = c->numericLinear->A ();
+        for (int o = 0; o < A.outerSize (); ++o)
+          for (matrix_t::InnerIterator it (A, o); it; ++it)
+            coeffs.push_back
+              (triplet_t (static_cast<int> (c->linearRowOffset + it.row ()),
+                          static_cast<int> (it.col ()), it.value ()));
+
+        linearB_.segment (c->linearRowOffset, c->outputSize)
+          = c->numericLinear->b ();
+      }
+
+    linearA_.resize (linearRows_, n);
+    linearA_.setFromTriplets (coeffs.begin (), coeffs.end ());
+    linearA_.makeCompressed ();
+  }
+
+  // Dense version.
+  template <typename T>
+  void
+  CompiledProblem<T>::jacobian (jacobian_ref jac, const_argument_ref x) const
+  {
+    assert (jac.rows () == jacobianRows_);
+    assert (jac.cols () == inputSize ());
+
+    jac.setZero ();
+
+    size_type n = inputSize ();
+    for (typename constraintsInfo_t::const_iterator
+           c = constraints_.begin (); c != constraints_.end (); ++c)
+      {
+        if (!c->differentiable)
+          continue;
+
+        c->differentiable->jacobian
+          (jac.block (c->jacobianRowOffset, 0, c->outputSize, n), x);
+      }
+  }
+
+  template <>
+  inline void
+  CompiledProblem<EigenMatrixSparse>::jacobian (jacobian_ref jac,
+                                                const_argument_ref x) const
+  {
+    detail::fillStackedJacobian (jacobianCache_, inputSize (), jac, x);
+  }
+
+  // Dense version.
+  template <typename T>
+  void
+  CompiledProblem<T>::updateJacobianPattern (const_argument_ref)
+  {
+  }
+
+  template <>
+  inline void
+  CompiledProblem<EigenMatrixSparse>::updateJacobianPattern
+  (const_argument_ref x)
+  {
+    jacobian_t jac (jacobianRows_, inputSize ());
+    jacobian (jac, x);
+
+    // Merge the structures, and mark the nonzeros with ones.
+    jacobian_t merged = jacobianPattern_.cwiseAbs () + jac.cwiseAbs ();
+    jacobianPattern_ = merged;
+    jacobianPattern_.makeCompressed ();
+    std::fill (jacobianPattern_.valuePtr (),
+               jacobianPattern_.valuePtr () + jacobianPattern_.nonZeros (),
+               1.);
+  }
+
+  // Dense version.
+  template <typename T>
+  void
+  CompiledProblem<T>::initializeJacobianPattern ()
+  {
+    jacobianPattern_.setOnes (jacobianRows_, inputSize ());
+  }
+
+  template <>
+  inline void
+  CompiledProblem<EigenMatrixSparse>::initializeJacobianPattern ()
+  {
+    jacobianPattern_.resize (jacobianRows_, inputSize ());
+
+    jacobianCache_.functions.clear ();
+    for (constraintsInfo_t::const_iterator
+           c = constraints_.begin (); c != constraints_.end (); ++c)
+      if (c->differentiable)
+        jacobianCache_.functions.push_back (c->differentiable);
+    jacobianCache_.functionsValid = true;
+
+    if (jacobianRows_ == 0)
+      return;
+
+    // Pattern at the starting point or, if there is none, at the projection
+    // of zero on the argument bounds, where solvers usually start.
+    if (problem_.startingPoint ())
+      updateJacobianPattern (*problem_.startingPoint ());
+    else
+      updateJacobianPattern
+        (vector_t::Zero (inputSize ())
+         .cwiseMax (argumentLowerBounds_).cwiseMin (argumentUpperBounds_));
+  }
+
+  template <typename T>
+  std::ostream&
+  CompiledProblem<T>::print (std::ostream& o) const
+  {
+    o << "Compiled problem:" << incindent
+      << iendl << "Number of arguments: " << inputSize ()
+      << iendl << "Number of constraints: " << constraints_.size ()
+      << iendl << "Linear constraints: " << linearConstraints_.size ()
+      << iendl << "Nonlinear constraints: " << nonlinearConstraints_.size ()
+      << iendl << "Constraints output size: " << constraintsOutputSize_
+      << iendl << "Jacobian rows: " << jacobianRows_
+      << iendl << "Linear system rows: " << linearRows_
+      << decindent;
+    return o;
+  }
+
+  template <typename T>
+  std::ostream&
+  operator<< (std::ostream& o, const CompiledProblem<T>& pb)
+  {
+    return pb.print (o);
+  }
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_COMPILED_PROBLEM_HXX
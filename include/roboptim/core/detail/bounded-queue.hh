@@ -0,0 +1,119 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_DETAIL_BOUNDED_QUEUE_HH
+# define ROBOPTIM_CORE_DETAIL_BOUNDED_QUEUE_HH
+
+# include <cstddef>
+# include <vector>
+
+# include <boost/atomic.hpp>
+# include <boost/noncopyable.hpp>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \brief Bounded lock-free single-producer single-consumer queue.
+    ///
+    /// The elements are preallocated, and filled or read in place: the
+    /// producer fills the slot returned by prepare () and publishes it
+    /// with commit (), the consumer reads the slot returned by front ()
+    /// and releases it with pop (). Hence, elements owning memory (e.g.
+    /// vectors) are reused without allocation.
+    ///
+    /// \tparam T element type.
+    template <typename T>
+    class BoundedQueue : public boost::noncopyable
+    {
+    public:
+      /// \param capacity maximum number of elements, must be positive.
+      /// \param prototype initial value of the slots.
+      explicit BoundedQueue (std::size_t capacity, const T& prototype = T ())
+        : slots_ (capacity + 1, prototype),
+          head_ (0),
+          tail_ (0)
+      {}
+
+      /// \brief Maximum number of elements.
+      std::size_t capacity () const
+      {
+        return slots_.size () - 1;
+      }
+
+      /// \brief Number of elements (approximate if called concurrently).
+      std::size_t size () const
+      {
+        const std::size_t head = head_.load (boost::memory_order_acquire);
+        const std::size_t tail = tail_.load (boost::memory_order_acquire);
+        return (tail + slots_.size () - head) % slots_.size ();
+      }
+
+      /// \brief Slot to fill (producer).
+      /// \return free slot, or null if the queue is full.
+      T* prepare ()
+      {
+        const std::size_t tail = tail_.load (boost::memory_order_relaxed);
+        if (next (tail) == head_.load (boost::memory_order_acquire))
+          return 0;
+        return &slots_[tail];
+      }
+
+      /// \brief Publish the slot returned by prepare () (producer).
+      void commit ()
+      {
+        const std::size_t tail = tail_.load (boost::memory_order_relaxed);
+        tail_.store (next (tail), boost::memory_order_release);
+      }
+
+      /// \brief Oldest element (consumer).
+      /// \return oldest element, or null if the queue is empty.
+      T* front ()
+      {
+        const std::size_t head = head_.load (boost::memory_order_relaxed);
+        if (head == tail_.load (boost::memory_order_acquire))
+          return 0;
+        return &slots_[head];
+      }
+
+      /// \brief Release the element returned by front () (consumer).
+      void pop ()
+      {
+        const std::size_t head = head_.load (boost::memory_order_relaxed);
+        head_.store (next (head), boost::memory_order_release);
+      }
+
+    private:
+      std::size_t next (std::size_t i) const
+      {
+        return (i + 1) % slots_.size ();
+      }
+
+      /// \brief Slots (one is always free).
+      std::vector<T> slots_;
+
+      /// \brief Index of the oldest element (written by the consumer).
+      boost::atomic<std::size_t> head_;
+
+      /// \brief Index of the next free slot (written by the producer).
+      boost::atomic<std::size_t> tail_;
+    };
+  } // end of namespace detail
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_DETAIL_BOUNDED_QUEUE_HH
@@ -0,0 +1,196 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_DETAIL_THREAD_POOL_HH
+# define ROBOPTIM_CORE_DETAIL_THREAD_POOL_HH
+
+# include <algorithm>
+# include <cstddef>
+
+# include <boost/bind.hpp>
+# include <boost/exception_ptr.hpp>
+# include <boost/function.hpp>
+# include <boost/noncopyable.hpp>
+# include <boost/thread/condition_variable.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/thread.hpp>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \brief Fixed set of persistent threads running the same task.
+    ///
+    /// The threads are created once, and wait for tasks between two calls
+    /// to run (). A task is called once per thread with the index of the
+    /// thread, the calling thread being thread 0, so that run () does not
+    /// create threads nor allocate memory.
+    ///
+    /// run () must not be called concurrently, nor from a task.
+    class ThreadPool : public boost::noncopyable
+    {
+    public:
+      /// \brief Task, called with the index of the thread.
+      typedef boost::function<void (std::size_t)> task_t;
+
+      /// \param threads number of threads, including the calling thread.
+      explicit ThreadPool (std::size_t threads)
+        : mutex_ (),
+          start_ (),
+          done_ (),
+          task_ (0),
+          generation_ (0),
+          pending_ (0),
+          stop_ (false),
+          error_ (),
+          threads_ (),
+          size_ (std::max<std::size_t> (threads, 1))
+      {
+        for (std::size_t w = 1; w < size_; ++w)
+          threads_.create_thread
+            (boost::bind (&ThreadPool::work, this, w));
+      }
+
+      ~ThreadPool ()
+      {
+        {
+          boost::mutex::scoped_lock lock (mutex_);
+          stop_ = true;
+        }
+        start_.notify_all ();
+        threads_.join_all ();
+      }
+
+      /// \brief Number of threads, including the calling thread.
+      std::size_t size () const
+      {
+        return size_;
+      }
+
+      /// \brief Run a task on all the threads and wait for its completion.
+      ///
+      /// If the task throws, the first exception is rethrown once all the
+      /// threads are done.
+      ///
+      /// \param task task to run, called with the indices 0 to size () - 1.
+      void run (const task_t& task)
+      {
+        if (size_ == 1)
+          {
+            task (0);
+            return;
+          }
+
+        {
+          boost::mutex::scoped_lock lock (mutex_);
+          task_ = &task;
+          pending_ = size_ - 1;
+          error_ = boost::exception_ptr ();
+          ++generation_;
+        }
+        start_.notify_all ();
+
+        boost::exception_ptr error;
+        try
+          {
+            task (0);
+          }
+        catch (...)
+          {
+            error = boost::current_exception ();
+          }
+
+        boost::mutex::scoped_lock lock (mutex_);
+        while (pending_ > 0)
+          done_.wait (lock);
+        task_ = 0;
+
+        if (!error)
+          error = error_;
+        if (error)
+          boost::rethrow_exception (error);
+      }
+
+    private:
+      /// \brief Loop of the threads 1 to size () - 1.
+      void work (std::size_t w)
+      {
+        std::size_t generation = 0;
+        while (true)
+          {
+            const task_t* task;
+            {
+              boost::mutex::scoped_lock lock (mutex_);
+              while (!stop_ && generation_ == generation)
+                start_.wait (lock);
+              if (stop_)
+                return;
+              generation = generation_;
+              task = task_;
+            }
+
+            boost::exception_ptr error;
+            try
+              {
+                (*task) (w);
+              }
+            catch (...)
+              {
+                error = boost::current_exception ();
+              }
+
+            boost::mutex::scoped_lock lock (mutex_);
+            if (error && !error_)
+              error_ = error;
+            if (--pending_ == 0)
+              done_.notify_one ();
+          }
+      }
+
+      boost::mutex mutex_;
+
+      /// \brief Signaled when a task is available, or on destruction.
+      boost::condition_variable start_;
+
+      /// \brief Signaled when the last thread is done.
+      boost::condition_variable done_;
+
+      /// \brief Current task.
+      const task_t* task_;
+
+      /// \brief Number of tasks run so far.
+      std::size_t generation_;
+
+      /// \brief Number of threads still running the current task.
+      std::size_t pending_;
+
+      /// \brief Whether the threads have to exit.
+      bool stop_;
+
+      /// \brief First exception thrown by the threads.
+      boost::exception_ptr error_;
+
+      boost::thread_group threads_;
+
+      /// \brief Number of threads, including the calling thread.
+      std::size_t size_;
+    };
+  } // end of namespace detail
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_DETAIL_THREAD_POOL_HH
@@ -155,6 +155,19 @@ namespace roboptim
       set_is_malloc_allowed (false);
 #endif //! ROBOPTIM_DO_NOT_CHECK_ALLOCATION
 
+#ifdef ROBOPTIM_INSTRUMENT_EVALUATION
+      EvaluationScope evaluationScope (this->getName (), JACOBIAN_EVALUATION);
+#endif //! ROBOPTIM_INSTRUMENT_EVALUATION
+
+#ifdef ROBOPTIM_TRACE_EVALUATION
+      TraceScope traceScope (evaluationName (JACOBIAN_EVALUATION),
+                             this->getName ());
+#endif //! ROBOPTIM_TRACE_EVALUATION
+
+#ifdef ROBOPTIM_ACCOUNT_ALLOCATION
+      AllocationScope allocationScope (this->getName ());
+#endif //! ROBOPTIM_ACCOUNT_ALLOCATION
+
       this->impl_jacobian (jacobian, argument);
 
 #ifndef ROBOPTIM_DO_NOT_CHECK_ALLOCATION
@@ -204,6 +217,19 @@ namespace roboptim
       set_is_malloc_allowed (false);
 #endif //! ROBOPTIM_DO_NOT_CHECK_ALLOCATION
 
+#ifdef ROBOPTIM_INSTRUMENT_EVALUATION
+      EvaluationScope evaluationScope (this->getName (), GRADIENT_EVALUATION);
+#endif //! ROBOPTIM_INSTRUMENT_EVALUATION
+
+#ifdef ROBOPTIM_TRACE_EVALUATION
+      TraceScope traceScope (evaluationName (GRADIENT_EVALUATION),
+                             this->getName ());
+#endif //! ROBOPTIM_TRACE_EVALUATION
+
+#ifdef ROBOPTIM_ACCOUNT_ALLOCATION
+      AllocationScope allocationScope (this->getName ());
+#endif //! ROBOPTIM_ACCOUNT_ALLOCATION
+
       this->impl_gradient (gradient, argument, functionId);
 
 #ifndef ROBOPTIM_DO_NOT_CHECK_ALLOCATION
@@ -28,7 +28,14 @@
 
 # define EIGEN_YES_I_KNOW_SPARSE_MODULE_IS_NOT_STABLE_YET
 
+# include <roboptim/core/config.hh>
 # include <roboptim/core/alloc.hh>
+# ifdef ROBOPTIM_INSTRUMENT_EVALUATION
+#  include <roboptim/core/instrumentation.hh>
+# endif //! ROBOPTIM_INSTRUMENT_EVALUATION
+# ifdef ROBOPTIM_TRACE_EVALUATION
+#  include <roboptim/core/trace.hh>
+# endif //! ROBOPTIM_TRACE_EVALUATION
 # include <Eigen/Core>
 # include <Eigen/Dense>
 # include <Eigen/Sparse>
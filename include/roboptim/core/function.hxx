@@ -181,6 +181,19 @@ namespace roboptim
     set_is_malloc_allowed (false);
 #endif //! ROBOPTIM_DO_NOT_CHECK_ALLOCATION
 
+#ifdef ROBOPTIM_INSTRUMENT_EVALUATION
+    EvaluationScope evaluationScope (this->getName (), COMPUTE_EVALUATION);
+#endif //! ROBOPTIM_INSTRUMENT_EVALUATION
+
+#ifdef ROBOPTIM_TRACE_EVALUATION
+    TraceScope traceScope (evaluationName (COMPUTE_EVALUATION),
+                           this->getName ());
+#endif //! ROBOPTIM_TRACE_EVALUATION
+
+#ifdef ROBOPTIM_ACCOUNT_ALLOCATION
+    AllocationScope allocationScope (this->getName ());
+#endif //! ROBOPTIM_ACCOUNT_ALLOCATION
+
     this->impl_compute (result, argument);
 
 #ifndef ROBOPTIM_DO_NOT_CHECK_ALLOCATION
@@ -0,0 +1,216 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_INSTRUMENTATION_HH
+# define ROBOPTIM_CORE_INSTRUMENTATION_HH
+
+# include <cstddef>
+# include <iosfwd>
+# include <string>
+# include <vector>
+
+# include <boost/atomic.hpp>
+# include <boost/cstdint.hpp>
+# include <boost/noncopyable.hpp>
+
+# include <roboptim/core/portability.hh>
+
+namespace roboptim
+{
+  /// \addtogroup roboptim_function
+  /// @{
+
+  /// \brief Kinds of function evaluations.
+  enum evaluation_t
+  {
+    /// \brief Function value (impl_compute).
+    COMPUTE_EVALUATION = 0,
+    /// \brief Gradient (impl_gradient).
+    GRADIENT_EVALUATION,
+    /// \brief Jacobian (impl_jacobian).
+    JACOBIAN_EVALUATION,
+    /// \brief Hessian (impl_hessian).
+    HESSIAN_EVALUATION,
+    /// \brief Number of evaluation kinds.
+    EVALUATION_KINDS
+  };
+
+  /// \brief Name of an evaluation kind (e.g. "gradient").
+  ROBOPTIM_DLLAPI const char* evaluationName (evaluation_t kind);
+
+  /// \brief Monotonic clock, in nanoseconds.
+  ROBOPTIM_DLLAPI boost::uint64_t monotonicTime ();
+
+  /// \brief Lock-free evaluation counters of a function.
+  ///
+  /// For each kind of evaluation, the counters store the number of calls,
+  /// the total and maximum durations, and a latency histogram whose bin
+  /// \f$b\f$ counts the calls lasting \f$[2^b, 2^{b+1})\f$ ns.
+  class ROBOPTIM_DLLAPI EvaluationCounters : public boost::noncopyable
+  {
+  public:
+    /// \brief Number of bins of the latency histograms.
+    static const std::size_t bins = 40;
+
+    EvaluationCounters ();
+
+    /// \brief Record an evaluation.
+    ///
+    /// \param kind kind of evaluation.
+    /// \param duration duration of the evaluation (ns).
+    void record (evaluation_t kind, boost::uint64_t duration);
+
+    /// \brief Number of evaluations.
+    boost::uint64_t count (evaluation_t kind) const;
+
+    /// \brief Total duration of the evaluations (ns).
+    boost::uint64_t totalTime (evaluation_t kind) const;
+
+    /// \brief Maximum duration of an evaluation (ns).
+    boost::uint64_t maxTime (evaluation_t kind) const;
+
+    /// \brief Number of evaluations in a bin of the latency histogram.
+    boost::uint64_t histogram (evaluation_t kind, std::size_t bin) const;
+
+    /// \brief Approximate quantile of the durations (ns).
+    ///
+    /// This is the upper bound of the histogram bin containing the
+    /// quantile, i.e. it overestimates the quantile by at most a factor 2.
+    ///
+    /// \param kind kind of evaluation.
+    /// \param q quantile, in [0, 1].
+    boost::uint64_t quantile (evaluation_t kind, double q) const;
+
+    /// \brief Reset the counters.
+    void reset ();
+
+    /// \brief Histogram bin of a duration.
+    static std::size_t bin (boost::uint64_t duration);
+
+  private:
+    /// \brief Counters of one kind of evaluation.
+    struct Stats
+    {
+      boost::atomic<boost::uint64_t> count;
+      boost::atomic<boost::uint64_t> total;
+      boost::atomic<boost::uint64_t> max;
+      boost::atomic<boost::uint64_t> histogram[bins];
+    };
+
+    Stats stats_[EVALUATION_KINDS];
+  };
+
+  /// \brief Process-wide evaluation counters, indexed by function name.
+  ///
+  /// Functions sharing a name share their counters. Looking up and
+  /// creating counters is lock-free: the registry is a fixed-size hash
+  /// table whose entries are never removed. When the table is full, the
+  /// evaluations are accounted to an overflow entry named "<other>".
+  class ROBOPTIM_DLLAPI EvaluationRegistry : public boost::noncopyable
+  {
+  public:
+    /// \brief Maximum number of function names.
+    static const std::size_t capacity = 1024;
+
+    /// \brief Retrieve the registry.
+    static EvaluationRegistry& instance ();
+
+    /// \brief Counters of a function (created if needed).
+    ///
+    /// \param name function name.
+    EvaluationCounters& counters (const std::string& name);
+
+    /// \brief Counters of a function.
+    ///
+    /// \param name function name.
+    /// \return counters, or null if the function was never evaluated.
+    const EvaluationCounters* find (const std::string& name) const;
+
+    /// \brief Names of the evaluated functions, sorted.
+    std::vector<std::string> names () const;
+
+    /// \brief Reset all the counters.
+    void reset ();
+
+    /// \brief Print the counters as a table.
+    ///
+    /// \param o output stream
+    /// \return output stream
+    std::ostream& print (std::ostream& o) const;
+
+  private:
+    /// \brief Named counters.
+    struct Entry
+    {
+      explicit Entry (const std::string& n, std::size_t h);
+
+      std::string name;
+      std::size_t hash;
+      EvaluationCounters counters;
+    };
+
+    EvaluationRegistry ();
+    ~EvaluationRegistry ();
+
+    /// \brief Entries, by open addressing.
+    boost::atomic<Entry*> entries_[capacity];
+
+    /// \brief Entry used when the table is full.
+    Entry overflow_;
+  };
+
+  /// \brief Time an evaluation and record it in the evaluation registry.
+  ///
+  /// This is used by the evaluation front-ends (e.g.
+  /// GenericFunction::operator ()) when roboptim-core is configured with
+  /// the ROBOPTIM_INSTRUMENT_EVALUATION option (see config.hh).
+  class ROBOPTIM_DLLAPI EvaluationScope : public boost::noncopyable
+  {
+  public:
+    /// \param name function name.
+    /// \param kind kind of evaluation.
+    EvaluationScope (const std::string& name, evaluation_t kind)
+      : counters_ (EvaluationRegistry::instance ().counters (name)),
+        kind_ (kind),
+        start_ (monotonicTime ())
+    {}
+
+    ~EvaluationScope ()
+    {
+      counters_.record (kind_, monotonicTime () - start_);
+    }
+
+  private:
+    EvaluationCounters& counters_;
+    evaluation_t kind_;
+    boost::uint64_t start_;
+  };
+
+  /// \brief Override operator<< to display the evaluation counters.
+  ///
+  /// \param o output stream used for display
+  /// \param registry evaluation registry
+  /// \return output stream
+  ROBOPTIM_DLLAPI std::ostream&
+  operator<< (std::ostream& o, const EvaluationRegistry& registry);
+
+  /// @}
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_INSTRUMENTATION_HH
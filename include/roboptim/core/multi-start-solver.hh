@@ -0,0 +1,260 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_MULTI_START_SOLVER_HH
+# define ROBOPTIM_CORE_MULTI_START_SOLVER_HH
+
+# include <cstddef>
+# include <string>
+# include <vector>
+
+# include <boost/exception_ptr.hpp>
+# include <boost/function.hpp>
+# include <boost/optional.hpp>
+# include <boost/thread/mutex.hpp>
+
+# include <roboptim/core/fwd.hh>
+# include <roboptim/core/portability.hh>
+# include <roboptim/core/solver.hh>
+# include <roboptim/core/solver-factory.hh>
+
+namespace roboptim
+{
+  /// \addtogroup roboptim_solver
+  /// @{
+
+  /// \brief Multi-start solver.
+  ///
+  /// Nonconvex problems are usually solved from several starting points,
+  /// keeping the best solution. This solver runs the plug-in given to the
+  /// constructor from the starting points returned by a generator, on a
+  /// pool of threads, and returns the best result (i.e. the result with the
+  /// lowest cost).
+  ///
+  /// Each thread creates its own solver, from its own copy of the problem,
+  /// and solves the problem again for each of its starting points (see
+  /// Solver::resolve). The functions of the problem are shared between the
+  /// threads, so they have to be reentrant.
+  ///
+  /// The best cost found so far (the incumbent) is shared between the
+  /// threads. If pruning is enabled, a start is stopped when its cost is
+  /// worse than the incumbent after a given number of iterations. This
+  /// requires the plug-in to support the iteration callback and cooperative
+  /// interruption (see SolverState::requestStop).
+  ///
+  /// The multi-start solver is configured with the following parameters:
+  ///   - ``multistart.starts'' (int): number of starting points,
+  ///   - ``multistart.threads'' (int): number of threads (0: number of
+  ///     hardware threads),
+  ///   - ``multistart.prune'' (bool): whether to prune the starts,
+  ///   - ``multistart.prune-after'' (int): number of iterations before a
+  ///     start can be pruned,
+  ///   - ``multistart.prune-margin'' (double): a start is pruned when its
+  ///     cost is greater than the incumbent plus this margin.
+  ///
+  /// Other parameters are forwarded to the solvers of the plug-in.
+  ///
+  /// \tparam T matrix type
+  template <typename T>
+  class MultiStartSolver : public Solver<T>
+  {
+  public:
+    /// \brief Parent type.
+    typedef Solver<T> parent_t;
+
+    /// \brief Problem type.
+    typedef typename parent_t::problem_t problem_t;
+
+    /// \brief Vector type.
+    typedef typename parent_t::vector_t vector_t;
+
+    /// \brief Value type.
+    typedef typename problem_t::value_type value_type;
+
+    /// \brief Callback type.
+    typedef typename parent_t::callback_t callback_t;
+
+    /// \brief Solver state type.
+    typedef typename parent_t::solverState_t solverState_t;
+
+    /// \brief Result type.
+    typedef typename parent_t::result_t result_t;
+
+    /// \brief Factory of the solvers of the plug-in.
+    typedef SolverFactory<parent_t> factory_t;
+
+    /// \brief Starting point generator.
+    ///
+    /// The generator fills x (which has the input size of the problem) with
+    /// the i-th starting point. Calls to the generator are serialized, so it
+    /// can use a random number generator that is not thread-safe. If it
+    /// throws, the i-th start fails (see StartStatistics::error).
+    typedef boost::function<void (vector_t& x, std::size_t i)> generator_t;
+
+    /// \brief Statistics of a start.
+    struct StartStatistics
+    {
+      StartStatistics ();
+
+      /// \brief Index of the start.
+      std::size_t start;
+
+      /// \brief Index of the thread that ran the start.
+      std::size_t thread;
+
+      /// \brief Kind of result of the start.
+      GenericSolver::solutions status;
+
+      /// \brief Final cost (NaN if the start failed).
+      value_type cost;
+
+      /// \brief Number of iterations (i.e. calls to the iteration callback).
+      std::size_t iterations;
+
+      /// \brief Whether the start was pruned.
+      bool pruned;
+
+      /// \brief Wall-clock time of the start (in seconds).
+      double time;
+
+      /// \brief Error message (if the start failed).
+      std::string error;
+    };
+
+    /// \brief Vector of start statistics.
+    typedef std::vector<StartStatistics> statistics_t;
+
+    /// \brief Build a multi-start solver.
+    ///
+    /// \param problem problem that will be solved
+    /// \param plugin name of the plug-in used for each start
+    /// \param generator starting point generator
+    MultiStartSolver (const problem_t& problem,
+                      const std::string& plugin,
+                      generator_t generator);
+
+    virtual ~MultiStartSolver ();
+
+    /// \brief Solve the problem from all the starting points.
+    ///
+    /// The result is the best result of the starts, or a SolverError if no
+    /// start succeeded.
+    ///
+    /// \throw std::runtime_error if the plug-in can not be loaded.
+    /// Other exceptions of the workers are rethrown once all the threads
+    /// are joined.
+    virtual void solve ();
+
+    /// \brief Set the per-iteration callback.
+    ///
+    /// The callback is called for the iterations of all the starts. Calls
+    /// are serialized.
+    virtual void setIterationCallback (callback_t callback);
+
+    /// \brief Name of the plug-in used for each start.
+    const std::string& plugin () const;
+
+    /// \brief Statistics of each start of the last solve.
+    const statistics_t& statistics () const;
+
+    /// \brief Index of the best start of the last solve (if any).
+    const boost::optional<std::size_t>& bestStart () const;
+
+    /// \brief Display the solver on the specified output stream.
+    ///
+    /// \param o output stream used for display
+    /// \return output stream
+    virtual std::ostream& print (std::ostream& o) const;
+
+  private:
+    /// \brief State of the start currently solved by a thread.
+    struct Worker
+    {
+      /// \brief Index of the thread.
+      std::size_t thread;
+
+      /// \brief Solver factory of the thread.
+      factory_t* factory;
+
+      /// \brief Index of the current start.
+      std::size_t start;
+
+      /// \brief Number of iterations of the current start.
+      std::size_t iterations;
+
+      /// \brief Whether the current start was pruned.
+      bool pruned;
+    };
+
+    /// \brief Solve starts until all of them are done.
+    void run (Worker& worker);
+
+    /// \brief Run a worker, and record the exception it throws (if any).
+    void work (Worker& worker);
+
+    /// \brief Iteration callback of the solvers of the plug-in.
+    void iterate (Worker& worker, const problem_t& problem,
+                  solverState_t& state);
+
+    /// \brief Forward the solver parameters to a solver of the plug-in.
+    void forwardParameters (parent_t& solver) const;
+
+    /// \brief Name of the plug-in.
+    std::string plugin_;
+
+    /// \brief Starting point generator.
+    generator_t generator_;
+
+    /// \brief User iteration callback.
+    callback_t callback_;
+
+    /// \brief Statistics of the starts.
+    statistics_t statistics_;
+
+    /// \brief Best start.
+    boost::optional<std::size_t> bestStart_;
+
+    /// \brief Cost of the best start (incumbent).
+    boost::optional<value_type> incumbent_;
+
+    /// \brief Next start to solve.
+    std::size_t nextStart_;
+
+    /// \brief Number of starts of the current solve.
+    std::size_t starts_;
+
+    /// \brief Pruning settings of the current solve.
+    bool prune_;
+    std::size_t pruneAfter_;
+    value_type pruneMargin_;
+
+    /// \brief First exception thrown by a worker.
+    boost::exception_ptr error_;
+
+    /// \brief Protects the starts, the incumbent and the result.
+    boost::mutex mutex_;
+
+    /// \brief Serializes the calls to the user iteration callback.
+    boost::mutex callbackMutex_;
+  };
+
+  /// @}
+
+} // end of namespace roboptim
+
+# include <roboptim/core/multi-start-solver.hxx>
+#endif //! ROBOPTIM_CORE_MULTI_START_SOLVER_HH
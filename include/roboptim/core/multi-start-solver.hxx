@@ -0,0 +1,401 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_MULTI_START_SOLVER_HXX
+# define ROBOPTIM_CORE_MULTI_START_SOLVER_HXX
+
+# include <algorithm>
+# include <limits>
+# include <stdexcept>
+
+# include <boost/bind.hpp>
+# include <boost/date_time/posix_time/posix_time_types.hpp>
+# include <boost/exception_ptr.hpp>
+# include <boost/make_shared.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/thread.hpp>
+
+# include <roboptim/core/io.hh>
+
+namespace roboptim
+{
+  template <typename T>
+  MultiStartSolver<T>::StartStatistics::StartStatistics ()
+    : start (0),
+      thread (0),
+      status (GenericSolver::SOLVER_NO_SOLUTION),
+      cost (std::numeric_limits<value_type>::quiet_NaN ()),
+      iterations (0),
+      pruned (false),
+      time (0.),
+      error ()
+  {
+  }
+
+  namespace detail
+  {
+    /// \brief Join a group of threads when leaving the scope, so that
+    /// the threads never outlive the data they use.
+    class ThreadGroupJoiner
+    {
+    public:
+      explicit ThreadGroupJoiner (boost::thread_group& group)
+        : group_ (group)
+      {}
+
+      ~ThreadGroupJoiner ()
+      {
+        group_.join_all ();
+      }
+
+    private:
+      boost::thread_group& group_;
+    };
+  } // end of namespace detail
+
+  template <typename T>
+  MultiStartSolver<T>::MultiStartSolver (const problem_t& pb,
+                                         const std::string& plugin,
+                                         generator_t generator)
+    : parent_t (pb),
+      plugin_ (plugin),
+      generator_ (generator),
+      callback_ (),
+      statistics_ (),
+      bestStart_ (),
+      incumbent_ (),
+      nextStart_ (0),
+      starts_ (0),
+      prune_ (false),
+      pruneAfter_ (0),
+      pruneMargin_ (0.),
+      error_ (),
+      mutex_ (),
+      callbackMutex_ ()
+  {
+    if (!generator_)
+      throw std::runtime_error ("multi-start: invalid starting point generator");
+
+    parent_t::parameters_["multistart.starts"].description =
+      "number of starting points";
+    parent_t::parameters_["multistart.starts"].value = 10;
+
+    parent_t::parameters_["multistart.threads"].description =
+      "number of threads (0: number of hardware threads)";
+    parent_t::parameters_["multistart.threads"].value = 0;
+
+    parent_t::parameters_["multistart.prune"].description =
+      "stop the starts that are worse than the incumbent";
+    parent_t::parameters_["multistart.prune"].value = false;
+
+    parent_t::parameters_["multistart.prune-after"].description =
+      "number of iterations before a start can be pruned";
+    parent_t::parameters_["multistart.prune-after"].value = 10;
+
+    parent_t::parameters_["multistart.prune-margin"].description =
+      "cost margin above the incumbent before pruning";
+    parent_t::parameters_["multistart.prune-margin"].value = 0.;
+  }
+
+  template <typename T>
+  MultiStartSolver<T>::~MultiStartSolver ()
+  {
+  }
+
+  template <typename T>
+  void
+  MultiStartSolver<T>::solve ()
+  {
+    starts_ = static_cast<std::size_t>
+      (std::max (0, this->template getParameter<int> ("multistart.starts")));
+    int threads = this->template getParameter<int> ("multistart.threads");
+    prune_ = this->template getParameter<bool> ("multistart.prune");
+    pruneAfter_ = static_cast<std::size_t>
+      (std::max (0, this->template getParameter<int>
+                 ("multistart.prune-after")));
+    pruneMargin_ =
+      this->template getParameter<value_type> ("multistart.prune-margin");
+
+    statistics_.assign (starts_, StartStatistics ());
+    bestStart_.reset ();
+    incumbent_.reset ();
+    nextStart_ = 0;
+    error_ = boost::exception_ptr ();
+
+    if (starts_ == 0)
+      {
+        this->result_ = SolverError ("multi-start: no starting point");
+        return;
+      }
+
+    std::size_t n = (threads > 0)
+      ? static_cast<std::size_t> (threads)
+      : static_cast<std::size_t> (boost::thread::hardware_concurrency ());
+    n = std::max<std::size_t> (1, std::min (n, starts_));
+
+    // Create the solvers in the calling thread, so that plug-in errors are
+    // reported to the caller.
+    std::vector<boost::shared_ptr<factory_t> > factories (n);
+    std::vector<Worker> workers (n);
+    for (std::size_t i = 0; i < n; ++i)
+      {
+        factories[i] = boost::make_shared<factory_t> (plugin_, this->problem_);
+        parent_t& solver = (*factories[i]) ();
+        forwardParameters (solver);
+
+        Worker& worker = workers[i];
+        worker.thread = i;
+        worker.factory = factories[i].get ();
+        worker.start = 0;
+        worker.iterations = 0;
+        worker.pruned = false;
+
+        try
+          {
+            solver.setIterationCallback
+              (boost::bind (&MultiStartSolver<T>::iterate, this,
+                            boost::ref (worker), _1, _2));
+          }
+        catch (const std::runtime_error&)
+          {
+            // Iteration callbacks are not supported: no statistics on the
+            // iterations and no pruning.
+          }
+      }
+
+    // The calling thread is the first worker. The threads are joined even
+    // if an exception is thrown, since they use the workers and factories.
+    {
+      boost::thread_group group;
+      detail::ThreadGroupJoiner joiner (group);
+      for (std::size_t i = 1; i < n; ++i)
+        group.create_thread
+          (boost::bind (&MultiStartSolver<T>::work, this,
+                        boost::ref (workers[i])));
+      work (workers[0]);
+    }
+
+    if (error_)
+      boost::rethrow_exception (error_);
+
+    if (!bestStart_)
+      this->result_ = SolverError ("multi-start: no start succeeded");
+  }
+
+  template <typename T>
+  void
+  MultiStartSolver<T>::work (Worker& worker)
+  {
+    try
+      {
+        run (worker);
+      }
+    catch (...)
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        if (!error_)
+          error_ = boost::current_exception ();
+        // Stop the other workers.
+        nextStart_ = starts_;
+      }
+  }
+
+  template <typename T>
+  void
+  MultiStartSolver<T>::run (Worker& worker)
+  {
+    parent_t& solver = (*worker.factory) ();
+    vector_t x (this->problem_.function ().inputSize ());
+
+    while (true)
+      {
+        {
+          boost::mutex::scoped_lock lock (mutex_);
+          if (nextStart_ >= starts_)
+            return;
+          worker.start = nextStart_++;
+
+          // A failing generator only fails its start.
+          std::string error;
+          try
+            {
+              generator_ (x, worker.start);
+            }
+          catch (const std::exception& e)
+            {
+              error = e.what ();
+            }
+          catch (...)
+            {
+              error = "unknown exception";
+            }
+
+          if (!error.empty ())
+            {
+              StartStatistics& stats = statistics_[worker.start];
+              stats.start = worker.start;
+              stats.thread = worker.thread;
+              stats.status = GenericSolver::SOLVER_ERROR;
+              stats.error = "multi-start: starting point generator failed: "
+                + error;
+              continue;
+            }
+        }
+
+        worker.iterations = 0;
+        worker.pruned = false;
+
+        StartStatistics stats;
+        stats.start = worker.start;
+        stats.thread = worker.thread;
+
+        result_t result;
+        boost::posix_time::ptime start =
+          boost::posix_time::microsec_clock::universal_time ();
+        try
+          {
+            solver.updateStartingPoint (x);
+            solver.resolve ();
+            result = solver.minimum ();
+
+            switch (result.which ())
+              {
+              case GenericSolver::SOLVER_VALUE:
+                stats.status = GenericSolver::SOLVER_VALUE;
+                stats.cost = boost::get<Result> (result).value[0];
+                break;
+              case GenericSolver::SOLVER_ERROR:
+                stats.status = GenericSolver::SOLVER_ERROR;
+                stats.error = boost::get<SolverError> (result).what ();
+                break;
+              default:
+                break;
+              }
+          }
+        catch (const std::exception& e)
+          {
+            stats.status = GenericSolver::SOLVER_ERROR;
+            stats.error = e.what ();
+          }
+        catch (...)
+          {
+            stats.status = GenericSolver::SOLVER_ERROR;
+            stats.error = "unknown exception";
+          }
+        stats.time = static_cast<double>
+          ((boost::posix_time::microsec_clock::universal_time () - start)
+           .total_microseconds ()) * 1e-6;
+        stats.iterations = worker.iterations;
+        stats.pruned = worker.pruned;
+
+        boost::mutex::scoped_lock lock (mutex_);
+        statistics_[worker.start] = stats;
+        if (stats.status == GenericSolver::SOLVER_VALUE
+            && (!incumbent_ || stats.cost < *incumbent_))
+          {
+            incumbent_ = stats.cost;
+            bestStart_ = worker.start;
+            this->result_ = result;
+          }
+      }
+  }
+
+  template <typename T>
+  void
+  MultiStartSolver<T>::iterate (Worker& worker, const problem_t& problem,
+                                solverState_t& state)
+  {
+    ++worker.iterations;
+
+    if (callback_)
+      {
+        boost::mutex::scoped_lock lock (callbackMutex_);
+        callback_ (problem, state);
+      }
+
+    if (!prune_ || worker.pruned || worker.iterations < pruneAfter_
+        || !state.cost ())
+      return;
+
+    boost::optional<value_type> incumbent;
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      incumbent = incumbent_;
+    }
+
+    if (incumbent && *state.cost () > *incumbent + pruneMargin_)
+      worker.pruned = state.requestStop ();
+  }
+
+  template <typename T>
+  void
+  MultiStartSolver<T>::forwardParameters (parent_t& solver) const
+  {
+    static const std::string prefix ("multistart.");
+
+    typedef typename parent_t::parameters_t::const_iterator citer_t;
+    for (citer_t it = this->parameters_.begin ();
+         it != this->parameters_.end (); ++it)
+      if (it->first.compare (0, prefix.size (), prefix) != 0)
+        solver.parameters ()[it->first] = it->second;
+  }
+
+  template <typename T>
+  void
+  MultiStartSolver<T>::setIterationCallback (callback_t callback)
+  {
+    callback_ = callback;
+  }
+
+  template <typename T>
+  const std::string&
+  MultiStartSolver<T>::plugin () const
+  {
+    return plugin_;
+  }
+
+  template <typename T>
+  const typename MultiStartSolver<T>::statistics_t&
+  MultiStartSolver<T>::statistics () const
+  {
+    return statistics_;
+  }
+
+  template <typename T>
+  const boost::optional<std::size_t>&
+  MultiStartSolver<T>::bestStart () const
+  {
+    return bestStart_;
+  }
+
+  template <typename T>
+  std::ostream&
+  MultiStartSolver<T>::print (std::ostream& o) const
+  {
+    parent_t::print (o);
+
+    o << incindent << iendl << "Multi-start plug-in: " << plugin_;
+    if (bestStart_)
+      o << iendl << "Best start: " << *bestStart_
+        << " (cost: " << statistics_[*bestStart_].cost << ")";
+    o << decindent;
+    return o;
+  }
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_MULTI_START_SOLVER_HXX
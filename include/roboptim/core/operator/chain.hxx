@@ -75,7 +75,7 @@ namespace roboptim
     (*right_) (rightResult_, x);
     left_->gradient (gradientLeft_, rightResult_, functionId);
     right_->jacobian (jacobianRight_, x);
-    gradient.noalias () = gradientLeft_.adjoint () * jacobianRight_;
+    gradient.noalias () = gradientLeft_ * jacobianRight_;
   }
 
   template <typename U, typename V>
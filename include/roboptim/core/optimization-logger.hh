@@ -18,6 +18,7 @@
 #ifndef ROBOPTIM_CORE_OPTIMIZATION_LOGGER_HH
 # define ROBOPTIM_CORE_OPTIMIZATION_LOGGER_HH
 # include <string>
+# include <vector>
 
 # include <boost/bind.hpp>
 # include <boost/date_time/posix_time/posix_time.hpp>
@@ -25,14 +26,47 @@
 # include <boost/filesystem/fstream.hpp>
 # include <boost/format.hpp>
 # include <boost/mpl/vector.hpp>
+# include <boost/optional.hpp>
+# include <boost/scoped_ptr.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/condition_variable.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/thread.hpp>
 # include <boost/type_traits/is_same.hpp>
 
 # include <roboptim/core/config.hh>
 # include <roboptim/core/portability.hh>
+# include <roboptim/core/binary-log.hh>
+# include <roboptim/core/compiled-problem.hh>
+# include <roboptim/core/detail/bounded-queue.hh>
 # include <roboptim/core/solver-callback.hh>
 
 namespace roboptim
 {
+  /// \brief Output formats of the optimization logger.
+  enum logFormat_t
+    {
+      /// \brief One directory per iteration, containing CSV files.
+      CSV_LOG,
+      /// \brief Single append-only binary file (log.bin), see
+      /// BinaryLogWriter. It can be converted to the CSV layout with
+      /// convertBinaryLog.
+      BINARY_LOG
+    };
+
+  /// \brief Behavior of the asynchronous optimization logger when its queue
+  /// is full.
+  enum logOverflowPolicy_t
+    {
+      /// \brief Wait for the background writer: no iteration is lost.
+      BLOCK_ON_OVERFLOW,
+      /// \brief Drop the iteration.
+      DROP_ON_OVERFLOW,
+      /// \brief Drop the iteration, and only log every k-th iteration until
+      /// the queue is half empty again (k doubles at each overflow).
+      SAMPLE_ON_OVERFLOW
+    };
+
   /// \brief Log the optimization process (values, Jacobians, time taken
   /// etc.).
   /// \tparam S solver type.
@@ -56,6 +90,7 @@ namespace roboptim
     typedef typename function_t::const_argument_ref            const_argument_ref;
 
     typedef GenericDifferentiableFunction<traits_t> differentiableFunction_t;
+    typedef CompiledProblem<traits_t> compiledProblem_t;
 
     /// \brief Constructor.
     /// \param solver solver that will be logged.
@@ -63,12 +98,14 @@ namespace roboptim
     /// \param selfRegister whether the logger will register itself as a
     /// callback with the solver. Set this to false if you use it with a
     /// multiplexer.
+    /// \param format output format of the iterations.
     explicit OptimizationLogger (solver_t& solver,
 				 const boost::filesystem::path& path,
-				 bool selfRegister = true);
+				 bool selfRegister = true,
+				 logFormat_t format = CSV_LOG);
 
     /// \brief Destructor.
-    /// CSV files are written in this destructor.
+    /// The pending iterations are logged, and the log files are closed.
     virtual ~OptimizationLogger ();
 
     /// \brief Append extra information to the log file.
@@ -84,14 +121,121 @@ namespace roboptim
     template <typename U>
     OptimizationLogger<S>& operator<< (const U& u);
 
+    /// \brief Log the iterations in a background thread.
+    ///
+    /// The iteration callback then only copies a snapshot of the solver
+    /// state (x, cost, constraint violation) into a bounded lock-free
+    /// queue. A background thread evaluates the constraints and their
+    /// Jacobians, and writes the logs. Note that the functions of the
+    /// problem are thus evaluated concurrently with the solver.
+    ///
+    /// \param capacity capacity of the queue (number of iterations).
+    /// \param policy behavior when the queue is full.
+    void setAsynchronous (std::size_t capacity,
+                          logOverflowPolicy_t policy = BLOCK_ON_OVERFLOW);
+
+    /// \brief Log the iterations in the iteration callback (default).
+    /// The pending iterations are logged first.
+    void setSynchronous ();
+
+    /// \brief Whether the iterations are logged in a background thread.
+    bool isAsynchronous () const;
+
+    /// \brief Wait until the pending iterations are logged, and flush the
+    /// log files.
+    void flush ();
+
+    /// \brief Number of iterations dropped by the asynchronous logger.
+    std::size_t droppedIterations () const;
+
+    /// \brief Only log some of the iterations, to reduce the I/O volume.
+    ///
+    /// An iteration is logged if its index is a multiple of the period, or
+    /// if the argument (or the cost, when given by the solver) changed
+    /// significantly since the last logged iteration, i.e. by more than
+    /// threshold * max (1, |last value|) in uniform norm. The first
+    /// iteration is always logged.
+    ///
+    /// \param period logging period (0: only log significant changes).
+    /// \param threshold relative change threshold (0: disabled).
+    void setDecimation (unsigned period, value_type threshold = 0.);
+
+    /// \brief Number of iterations skipped by the decimation.
+    std::size_t skippedIterations () const;
+
   private:
+    /// \brief Snapshot of the solver state at an iteration.
+    struct Snapshot
+    {
+      /// \brief Callback iteration index.
+      unsigned iteration;
+
+      /// \brief Time of the iteration.
+      boost::posix_time::ptime time;
+
+      /// \brief Time elapsed since the previous iteration.
+      boost::posix_time::time_duration elapsed;
+
+      /// \brief Argument.
+      vector_t x;
+
+      /// \brief Cost (if given by the solver).
+      boost::optional<value_type> cost;
+
+      /// \brief Constraint violation (if given by the solver).
+      boost::optional<value_type> constraintViolation;
+    };
+
+    /// \brief Queue of snapshots.
+    typedef detail::BoundedQueue<Snapshot> queue_t;
+
+    /// \brief Copy the solver state into a snapshot.
+    void capture (Snapshot& snapshot, const solverState_t& state);
+
+    /// \brief Whether the iteration should be logged (see setDecimation).
+    bool shouldLog (const solverState_t& state);
+
+    /// \brief Open the evolution streams and write their headers
+    /// (CSV_LOG format).
+    void openEvolutionStreams ();
+
+    /// \brief Queue a snapshot of the solver state (asynchronous logger).
+    void enqueue (const solverState_t& state);
+
+    /// \brief Log an iteration.
+    void process (const problem_t& pb, const Snapshot& snapshot);
+
+    /// \brief Loop of the background thread.
+    void run ();
+
+    /// \brief Stop the background thread, once the pending iterations
+    /// are logged.
+    void stop ();
+
+    /// \brief Evaluate the constraints and their Jacobians in the
+    /// preallocated buffers, and the constraint violation (if it was not
+    /// given by the solver).
+    ///
+    /// The violation is computed with the current bounds of pb, which
+    /// may have been updated since the logger was created.
+    void evaluate_constraints (const typename solver_t::problem_t& pb,
+                               const Snapshot& snapshot,
+                               const_argument_ref x,
+                               value_type& cstrViol);
+
     /// \brief Process constraints in the callback.
     void process_constraints (const typename solver_t::problem_t& pb,
-                              const typename solver_t::solverState_t& state,
+                              const Snapshot& snapshot,
                               const boost::filesystem::path& iterationPath,
                               const_argument_ref x,
                               value_type& cstrViol);
 
+    /// \brief Append the iteration to the binary log.
+    void write_binary_record (const typename solver_t::problem_t& pb,
+                              const Snapshot& snapshot,
+                              const_argument_ref x,
+                              value_type cost);
+
     /// \brief Attach the logger to the solver.
     void attach ();
 
@@ -145,6 +289,10 @@ namespace roboptim
     /// \return callback iteration index.
     unsigned callbackCallId () const;
 
+  public:
+    /// \brief Return the output format of the iterations.
+    logFormat_t format () const;
+
   private:
     /// \brief Solver associated with the logger.
     solver_t& solver_;
@@ -168,10 +316,89 @@ namespace roboptim
     /// Note: this provides a way to use the logger in a callback multiplexer.
     bool selfRegister_;
 
-    std::vector<vector_t> x_;
-    std::vector<value_type> costs_;
-    std::vector<value_type> constraintViolations_;
-    std::vector<std::vector<vector_t> > constraints_;
+    /// \brief Output format of the iterations.
+    logFormat_t format_;
+
+    /// \brief Binary log (BINARY_LOG format).
+    boost::scoped_ptr<BinaryLogWriter> binaryLog_;
+
+    /// \brief Snapshot of the synchronous logger.
+    Snapshot snapshot_;
+
+    /// \brief Queue of the asynchronous logger.
+    boost::scoped_ptr<queue_t> queue_;
+
+    /// \brief Behavior of the asynchronous logger when the queue is full.
+    logOverflowPolicy_t policy_;
+
+    /// \brief Only every stride_-th iteration is queued
+    /// (SAMPLE_ON_OVERFLOW).
+    unsigned stride_;
+
+    /// \brief Background thread of the asynchronous logger.
+    boost::thread worker_;
+
+    /// \brief Whether the background thread should stop.
+    boost::atomic<bool> stopping_;
+
+    /// \brief Number of queued iterations.
+    boost::atomic<std::size_t> enqueued_;
+
+    /// \brief Number of logged iterations of the queue.
+    boost::atomic<std::size_t> processed_;
+
+    /// \brief Number of dropped iterations.
+    boost::atomic<std::size_t> dropped_;
+
+    /// \brief Logging period (see setDecimation).
+    unsigned decimationPeriod_;
+
+    /// \brief Relative change threshold (see setDecimation).
+    value_type decimationThreshold_;
+
+    /// \brief Argument of the last logged iteration.
+    vector_t lastLoggedX_;
+
+    /// \brief Cost of the last logged iteration (if given by the solver).
+    boost::optional<value_type> lastLoggedCost_;
+
+    /// \brief Number of iterations skipped by the decimation.
+    std::size_t skipped_;
+
+    /// \brief Mutex guarding the journal and the evolution streams.
+    boost::mutex journalMutex_;
+
+    /// \brief Mutex of the queue condition.
+    boost::mutex queueMutex_;
+
+    /// \brief Notified when the queue changes.
+    boost::condition_variable queueChanged_;
+
+    /// \brief Cost evolution stream (CSV_LOG format).
+    boost::filesystem::ofstream costStream_;
+
+    /// \brief Constraint violation evolution stream (CSV_LOG format).
+    boost::filesystem::ofstream constraintViolationStream_;
+
+    /// \brief X evolution stream (CSV_LOG format).
+    boost::filesystem::ofstream xStream_;
+
+    /// \brief Constraint evolution streams (CSV_LOG format).
+    std::vector<boost::shared_ptr<boost::filesystem::ofstream> >
+    constraintStreams_;
+
+    /// \brief Compiled problem (stacked constraints and bounds).
+    compiledProblem_t compiled_;
+
+    /// \brief Buffer of the cost value.
+    vector_t costValue_;
+
+    /// \brief Buffer of the stacked constraint values.
+    vector_t constraintValues_;
+
+    /// \brief Buffers of the constraint Jacobians (empty for the
+    /// non-differentiable constraints).
+    std::vector<jacobian_t> jacobians_;
   };
 } // end of namespace roboptim
 
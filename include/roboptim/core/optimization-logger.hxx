@@ -17,6 +17,11 @@
 
 #ifndef ROBOPTIM_CORE_OPTIMIZATION_LOGGER_HXX
 # define ROBOPTIM_CORE_OPTIMIZATION_LOGGER_HXX
+# include <algorithm>
+# include <cmath>
+# include <iostream>
+# include <limits>
+# include <stdexcept>
 # include <string>
 # include <sstream>
 
@@ -24,160 +29,135 @@
 # include <boost/filesystem.hpp>
 # include <boost/filesystem/fstream.hpp>
 # include <boost/format.hpp>
+# include <boost/make_shared.hpp>
 # include <boost/mpl/vector.hpp>
 # include <boost/type_traits/is_same.hpp>
 
 # include <roboptim/core/config.hh>
 # include <roboptim/core/solver.hh>
 # include <roboptim/core/indent.hh>
+# include <roboptim/core/trace.hh>
 
 namespace roboptim
 {
   namespace detail
   {
-    template <typename P>
-    struct EvaluateConstraintViolation
+    /// \brief Uniform norm of the violation of stacked constraints.
+    ///
+    /// \param g stacked constraint values.
+    /// \param lower stacked lower bounds.
+    /// \param upper stacked upper bounds.
+    /// \return \f$\max_i \max (l_i - g_i, g_i - u_i, 0)\f$.
+    template <typename V, typename L, typename U>
+    typename V::Scalar
+    uniformNormViolation (const Eigen::MatrixBase<V>& g,
+                          const Eigen::MatrixBase<L>& lower,
+                          const Eigen::MatrixBase<U>& upper)
     {
-      typedef typename P::vector_t        vector_t;
-      typedef typename P::value_type      value_type;
-      typedef typename P::size_type       size_type;
-      typedef typename P::intervalsVect_t intervalsVect_t;
-      typedef typename P::interval_t      interval_t;
-
-      EvaluateConstraintViolation
-      (const std::vector<vector_t>& constraints,
-       const intervalsVect_t& bounds)
-        : constraints_ (constraints),
-          bounds_ (bounds)
-      {}
-
-      value_type computeViolation (const value_type& x,
-                                   const interval_t& x_ul) const
-      {
-        if (x < x_ul.first)
-          return x_ul.first - x;
-        else if (x > x_ul.second)
-          return x - x_ul.second;
-        else return 0.;
-      }
-
-      value_type uniformNorm () const
-      {
-        value_type norm = 0.;
-        value_type cstr_viol = 0.;
-
-        // For each multidimensional constraint
-        for (std::size_t i = 0; i < constraints_.size (); ++i)
-          {
-            // For each dimension of the constraint
-            for (size_type j = 0; j < constraints_[i].size (); ++j)
-              {
-                cstr_viol = computeViolation
-                  (constraints_[i][j],
-                   bounds_[i][static_cast<std::size_t> (j)]);
-
-                norm = std::max (norm, fabs (cstr_viol));
-              }
-
-          }
-        return norm;
-      }
+      typedef typename V::Scalar value_type;
 
-    private:
-      const std::vector<vector_t>& constraints_;
-      const intervalsVect_t& bounds_;
-    };
+      if (g.size () == 0)
+        return 0.;
 
+      // Infinite bounds give -inf terms, i.e. no violation.
+      return std::max<value_type>
+        (0., std::max ((lower - g).maxCoeff (), (g - upper).maxCoeff ()));
+    }
 
-    template <typename P>
-    struct LogJacobianConstraint
+    /// \brief Write a Jacobian matrix as CSV.
+    ///
+    /// \param o output stream.
+    /// \param jacobian Jacobian matrix (dense or sparse).
+    template <typename M>
+    void writeJacobian (std::ostream& o, const M& jacobian)
     {
-      /// \brief Type of the problem.
-      typedef P problem_t;
-
-      /// \brief Function traits.
-      typedef typename problem_t::function_t::traits_t traits_t;
-
-      /// \brief Type of differentiable functions.
-      typedef GenericDifferentiableFunction<traits_t> differentiableFunction_t;
-
-      /// \brief Argument type.
-      typedef typename differentiableFunction_t::const_argument_ref const_argument_ref;
-
-      /// \brief Size type.
-      typedef typename problem_t::size_type size_type;
-
-      /// \brief Jacobian type.
-      typedef typename differentiableFunction_t::jacobian_t jacobian_t;
-
-      LogJacobianConstraint
-      (const_argument_ref x,
-       const boost::filesystem::path& constraintPath)
-        : x_ (x),
-          constraintPath_ (constraintPath)
-      {}
-
-      template <typename U>
-      void operator () (const boost::shared_ptr<U>& constraint) const
-      {
-        // If the constraint is differentiable
-        if (constraint->template asType<differentiableFunction_t> ())
-	  {
-	    // Differentiable function: log Jacobian
-	    boost::filesystem::ofstream
-	      jacobianStream (constraintPath_ / "jacobian.csv");
-
-	    // Get the Jacobian
-	    jacobian_t jacobian
-	      = constraint->template castInto<differentiableFunction_t> ()
-	      ->jacobian (x_);
-
-	    for (size_type i = 0;
-		 i < static_cast<size_type> (jacobian.rows ()); ++i)
-	      {
-		for (size_type j = 0; j < jacobian.cols (); ++j)
-		  {
-		    jacobianStream << jacobian.coeffRef (i, j);
-		    if (j < jacobian.cols () - 1)
-		      jacobianStream << ", ";
-		  }
-		jacobianStream << "\n";
-	      }
-	  }
-      }
-
-    private:
-      /// \brief Argument.
-      const_argument_ref x_;
-
-      /// \brief Path to the constraint log directory.
-      const boost::filesystem::path& constraintPath_;
-    };
+      typedef typename M::Index index_t;
+
+      for (index_t i = 0; i < jacobian.rows (); ++i)
+        {
+          for (index_t j = 0; j < jacobian.cols (); ++j)
+            {
+              o << jacobian.coeff (i, j);
+              if (j < jacobian.cols () - 1)
+                o << ", ";
+            }
+          o << "\n";
+        }
+    }
   } // end of namespace detail.
 
   template <typename T>
   OptimizationLogger<T>::OptimizationLogger (solver_t& solver,
 					     const boost::filesystem::path& path,
-					     bool selfRegister)
+					     bool selfRegister,
+					     logFormat_t format)
     : parent_t ("Optimization logger"),
       solver_ (solver),
       path_ (path),
       output_ (),
       callbackCallId_ (0),
       firstTime_ (boost::posix_time::microsec_clock::universal_time ()),
-      selfRegister_ (selfRegister)
+      selfRegister_ (selfRegister),
+      format_ (format),
+      binaryLog_ (),
+      snapshot_ (),
+      queue_ (),
+      policy_ (BLOCK_ON_OVERFLOW),
+      stride_ (1),
+      worker_ (),
+      stopping_ (false),
+      enqueued_ (0),
+      processed_ (0),
+      dropped_ (0),
+      decimationPeriod_ (1),
+      decimationThreshold_ (0.),
+      lastLoggedX_ (),
+      lastLoggedCost_ (),
+      skipped_ (0),
+      compiled_ (solver.problem ()),
+      costValue_ (1),
+      constraintValues_ (compiled_.constraintsOutputSize ()),
+      jacobians_ (compiled_.constraints ().size ())
   {
     lastTime_ = firstTime_;
 
+    // Buffers of the constraint Jacobians.
+    for (std::size_t i = 0; i < compiled_.constraints ().size (); ++i)
+      if (compiled_.constraints ()[i].differentiable)
+	jacobians_[i].resize (compiled_.constraints ()[i].outputSize,
+			      compiled_.inputSize ());
+
     // Register the callback with the solver.
     if (selfRegister_) attach ();
 
+    TraceScope traceScope ("io", "optimization logger: open");
+
     // Remove old logs.
     boost::filesystem::remove_all (path);
     boost::filesystem::create_directories (path);
 
     output_.open (path / "journal.log");
 
+    // Single binary file for all the iterations.
+    if (format_ == BINARY_LOG)
+      {
+	const typename solver_t::problem_t& pb = solver_.problem ();
+	BinaryLogLayout layout;
+	layout.inputSize =
+	  static_cast<boost::uint64_t> (pb.function ().inputSize ());
+	layout.argumentNames = pb.argumentNames ();
+	for (std::size_t i = 0; i < pb.constraints ().size (); ++i)
+	  layout.constraints.push_back
+	    (BinaryLogLayout::Constraint
+	     (pb.constraints ()[i]->getName (),
+	      static_cast<boost::uint64_t>
+	      (pb.constraints ()[i]->outputSize ()),
+	      pb.constraints ()[i]->template asType<differentiableFunction_t> ()));
+	binaryLog_.reset (new BinaryLogWriter (path / "log.bin", layout));
+      }
+    else
+      openEvolutionStreams ();
+
     // Display banner.
     output_
       << std::string (80, '*') << iendl
@@ -195,6 +175,11 @@ namespace roboptim
     // Unregister the callback, do not fail if this is impossible.
     if (selfRegister_) unregister ();
 
+    // Log the pending iterations.
+    stop ();
+
+    TraceScope traceScope ("io", "optimization logger: close");
+
     // Get current time
     boost::posix_time::ptime t =
       boost::posix_time::microsec_clock::universal_time();
@@ -209,90 +194,75 @@ namespace roboptim
       << std::string (80, '*') << iendl
       ;
 
+    // The evolution streams were written at each iteration. The evolution
+    // of the binary log is extracted by convertBinaryLog.
+    if (binaryLog_)
+      binaryLog_->flush ();
+  }
+
+  template <typename T>
+  void OptimizationLogger<T>::openEvolutionStreams ()
+  {
+    const problem_t& pb = solver_.problem ();
+
     // Cost evolution over time.
-    {
-      boost::filesystem::ofstream streamCost (path_ / "cost-evolution.csv");
-      streamCost << "Cost\n";
-      for (std::size_t i = 0; i < costs_.size (); ++i)
-	streamCost << costs_[i] << "\n";
-    }
+    costStream_.open (path_ / "cost-evolution.csv");
+    costStream_ << "Cost\n";
 
     // Constraint violation evolution over time.
-    if (!constraintViolations_.empty ())
+    if (!pb.constraints ().empty ())
       {
-	boost::filesystem::ofstream streamCstrViol
+	constraintViolationStream_.open
 	  (path_ / "constraint-violation-evolution.csv");
-	streamCstrViol << "Constraint violation\n";
-	for (std::size_t i = 0; i < constraintViolations_.size (); ++i)
-	  streamCstrViol << constraintViolations_[i] << "\n";
+	constraintViolationStream_ << "Constraint violation\n";
       }
 
     // X evolution over time.
-    {
-      boost::filesystem::ofstream streamX (path_ / "x-evolution.csv");
-      const typename solver_t::problem_t::names_t
-	argumentNames = solver_.problem ().argumentNames ();
+    xStream_.open (path_ / "x-evolution.csv");
+    const typename problem_t::names_t& argumentNames = pb.argumentNames ();
 
-      // Whether to print X 0, X 1 etc... or user-provided names.
-      bool printDefaultX = (static_cast<size_type> (argumentNames.size ())
-			    != solver_.problem ().function ().inputSize ());
-
-      if (!x_.empty ())
-	{
-	  for (std::size_t i = 0;
-	       i < static_cast<std::size_t> (x_[0].size ()); ++i)
-	    {
-	      if (i > 0)
-		streamX << ", ";
-	      if (printDefaultX)
-		streamX << "X_" << i;
-	      else streamX << argumentNames[i];
-	    }
-	  streamX << "\n";
-	  for (std::size_t nIter = 0; nIter < x_.size (); ++nIter)
-	    {
-	      for (size_type i = 0; i < x_[nIter].size (); ++i)
-		{
-		  if (i > 0)
-		    streamX << ", ";
-		  streamX << x_[nIter][i];
-		}
-	      streamX << "\n";
-	    }
-	}
-    }
+    // Whether to print X 0, X 1 etc... or user-provided names.
+    bool printDefaultX = (static_cast<size_type> (argumentNames.size ())
+			  != pb.function ().inputSize ());
 
+    for (size_type i = 0; i < pb.function ().inputSize (); ++i)
+      {
+	if (i > 0)
+	  xStream_ << ", ";
+	if (printDefaultX)
+	  xStream_ << "X_" << i;
+	else xStream_ << argumentNames[static_cast<std::size_t> (i)];
+      }
+    xStream_ << "\n";
 
     // Constraints evolution over time.
-    if (!constraints_.empty ())
-      for (std::size_t constraintId = 0; constraintId < constraints_[0].size ();
-	   ++constraintId)
-	{
-	  boost::filesystem::ofstream streamConstraint
-	    (path_ / (boost::format ("constraint-%d-evolution.csv") % constraintId).str ());
-	  for (size_type i = 0; i < constraints_[0][constraintId].size (); ++i)
-	    {
-	      if (i > 0)
-		streamConstraint << ", ";
-	      streamConstraint << "output " << i;
-	    }
-	  streamConstraint << "\n";
-	  for (std::size_t nIter = 0; nIter < constraints_.size (); ++nIter)
-	    {
-	      for (size_type i = 0; i < constraints_[nIter][constraintId].size (); ++i)
-		{
-		  if (i > 0)
-		    streamConstraint << ", ";
-		  streamConstraint << constraints_[nIter][constraintId][i];
-		}
-	      streamConstraint << "\n";
-	    }
-	}
+    constraintStreams_.resize (pb.constraints ().size ());
+    for (std::size_t constraintId = 0; constraintId < pb.constraints ().size ();
+	 ++constraintId)
+      {
+	constraintStreams_[constraintId] =
+	  boost::make_shared<boost::filesystem::ofstream>
+	  (path_ / (boost::format ("constraint-%d-evolution.csv")
+		    % constraintId).str ());
+	boost::filesystem::ofstream& streamConstraint =
+	  *constraintStreams_[constraintId];
+	for (size_type i = 0; i < pb.constraints ()[constraintId]->outputSize ();
+	     ++i)
+	  {
+	    if (i > 0)
+	      streamConstraint << ", ";
+	    streamConstraint << "output " << i;
+	  }
+	streamConstraint << "\n";
+      }
   }
 
   template <typename T>
   void OptimizationLogger<T>::append (const std::string& text)
   {
+    TraceScope traceScope ("io", "optimization logger: append");
+
+    boost::mutex::scoped_lock lock (journalMutex_);
     output_
       << std::string (80, '+') << iendl
       << text << iendl
@@ -316,19 +286,52 @@ namespace roboptim
     return *this;
   }
 
+  template <typename T>
+  void OptimizationLogger<T>::evaluate_constraints
+  (const typename solver_t::problem_t& pb,
+   const Snapshot& snapshot,
+   const_argument_ref x,
+   value_type& cstrViol)
+  {
+    // Constraint values and Jacobians, in the preallocated buffers.
+    compiled_.constraints (constraintValues_, x);
+    for (std::size_t i = 0; i < compiled_.constraints ().size (); ++i)
+      if (compiled_.constraints ()[i].differentiable)
+	{
+	  jacobians_[i].setZero ();
+	  compiled_.constraints ()[i].differentiable->jacobian
+	    (jacobians_[i], x);
+	}
+
+    // if the constraint violation was not given by the solver
+    if (!snapshot.constraintViolation)
+      {
+	// FIXME: handle argument bounds
+	cstrViol = ::roboptim::detail::uniformNormViolation
+	  (constraintValues_, pb.constraintsLowerBounds (),
+	   pb.constraintsUpperBounds ());
+      }
+  }
+
   template <typename T>
   void OptimizationLogger<T>::process_constraints
   (const typename solver_t::problem_t& pb,
-   const typename solver_t::solverState_t& state,
+   const Snapshot& snapshot,
    const boost::filesystem::path& iterationPath,
    const_argument_ref x,
    value_type& cstrViol)
   {
+    evaluate_constraints (pb, snapshot, x, cstrViol);
+
     // constraints
-    std::vector<vector_t> constraintsOneIteration (pb.constraints ().size ());
     for (std::size_t constraintId = 0; constraintId < pb.constraints ().size ();
 	 ++constraintId)
       {
+	const typename compiledProblem_t::ConstraintInfo& info =
+	  compiled_.constraints ()[constraintId];
+	typename function_t::const_result_ref constraintValue =
+	  constraintValues_.segment (info.rowOffset, info.outputSize);
+
 	// Create local path.
 	boost::filesystem::path constraintPath =
 	  iterationPath / (boost::format ("constraint-%d") % constraintId).str ();
@@ -342,7 +345,6 @@ namespace roboptim
 	boost::filesystem::ofstream
 	  constraintValueStream (constraintPath / "value.csv");
 
-	vector_t constraintValue = pb.constraints ()[constraintId]->operator() (x);
 	for (size_type i = 0; i < constraintValue.size (); ++i)
 	  {
 	    constraintValueStream << constraintValue[i];
@@ -350,26 +352,32 @@ namespace roboptim
 	      constraintValueStream << ", ";
 	  }
 	constraintValueStream << "\n";
-	constraintsOneIteration[constraintId] = constraintValue;
+
+	// Constraint evolution
+	boost::filesystem::ofstream& streamConstraint =
+	  *constraintStreams_[constraintId];
+	for (size_type i = 0; i < constraintValue.size (); ++i)
+	  {
+	    if (i > 0)
+	      streamConstraint << ", ";
+	    streamConstraint << constraintValue[i];
+	  }
+	streamConstraint << "\n";
 
 	// Log the Jacobian (if the function is differentiable)
-	::roboptim::detail::LogJacobianConstraint<problem_t> jac(x, constraintPath);
-	jac(pb.constraints ()[constraintId]);
+	if (info.differentiable)
+	  {
+	    boost::filesystem::ofstream
+	      jacobianStream (constraintPath / "jacobian.csv");
+	    ::roboptim::detail::writeJacobian
+	      (jacobianStream, jacobians_[constraintId]);
+	  }
       }
-    constraints_.push_back (constraintsOneIteration);
 
     // constraint violation: if the vector of constraints is not empty
     if (!pb.constraints (). empty ())
       {
-	// if the constraint violation was not given by the solver
-	if (!state.constraintViolation ())
-	  {
-	    // FIXME: handle argument bounds
-	    ::roboptim::detail::EvaluateConstraintViolation<problem_t>
-	      evalCstrViol (constraintsOneIteration, pb.boundsVector ());
-	    cstrViol = evalCstrViol.uniformNorm ();
-	  }
-	constraintViolations_.push_back (cstrViol);
+	constraintViolationStream_ << cstrViol << "\n";
 
 	boost::filesystem::ofstream streamCstrViol (iterationPath / "constraint-violation");
 	streamCstrViol << cstrViol << "\n";
@@ -380,6 +388,40 @@ namespace roboptim
   }
 
 
+  template <typename T>
+  void OptimizationLogger<T>::write_binary_record
+  (const typename solver_t::problem_t& pb,
+   const Snapshot& snapshot,
+   const_argument_ref x,
+   value_type cost)
+  {
+    // Constraint violation (NaN for unconstrained problems).
+    value_type cstrViol = std::numeric_limits<value_type>::quiet_NaN ();
+    if (snapshot.constraintViolation)
+      cstrViol = *snapshot.constraintViolation;
+    evaluate_constraints (pb, snapshot, x, cstrViol);
+
+    if (!pb.constraints ().empty ())
+      output_ << "- viol_g(x):" << incindent << iendl
+	      << cstrViol << decindent << iendl;
+
+    const double time = static_cast<double>
+      ((snapshot.time - firstTime_).total_microseconds ()) * 1e-6;
+    binaryLog_->beginRecord (snapshot.iteration, time, cost, cstrViol, x);
+    for (std::size_t i = 0; i < pb.constraints ().size (); ++i)
+      {
+	const typename compiledProblem_t::ConstraintInfo& info =
+	  compiled_.constraints ()[i];
+	binaryLog_->constraint
+	  (i, constraintValues_.segment (info.rowOffset, info.outputSize));
+
+	// Log the Jacobian (if the function is differentiable)
+	if (info.differentiable)
+	  binaryLog_->jacobian (i, jacobians_[i]);
+      }
+    binaryLog_->endRecord ();
+  }
+
   template <typename T>
   void OptimizationLogger<T>::attach ()
   {
@@ -435,44 +477,222 @@ namespace roboptim
   (const typename solver_t::problem_t& pb,
    typename solver_t::solverState_t& state)
   {
+    // Update journal
+    if (callbackCallId_ == 0)
+      {
+	boost::mutex::scoped_lock lock (journalMutex_);
+	output_ << solver_ << iendl;
+      }
+
+    if (!shouldLog (state))
+      return;
+
+    if (queue_)
+      {
+	enqueue (state);
+	return;
+      }
+
+    capture (snapshot_, state);
+    process (pb, snapshot_);
+  }
+
+  template <typename T>
+  void OptimizationLogger<T>::capture (Snapshot& snapshot,
+				       const solverState_t& state)
+  {
+    snapshot.iteration = callbackCallId_;
+    snapshot.time = boost::posix_time::microsec_clock::universal_time ();
+    snapshot.elapsed = snapshot.time - lastTime_;
+    snapshot.x = state.x ();
+    snapshot.cost = state.cost ();
+    snapshot.constraintViolation = state.constraintViolation ();
+  }
+
+  template <typename T>
+  bool OptimizationLogger<T>::shouldLog (const solverState_t& state)
+  {
+    const vector_t& x = state.x ();
+
+    bool log = lastLoggedX_.size () != x.size ()
+      || (decimationPeriod_ > 0 && callbackCallId_ % decimationPeriod_ == 0);
+
+    // Significant change since the last logged iteration.
+    if (!log && decimationThreshold_ > 0.)
+      {
+	const value_type scaleX = std::max<value_type>
+	  (1., lastLoggedX_.template lpNorm<Eigen::Infinity> ());
+	log = (x - lastLoggedX_).template lpNorm<Eigen::Infinity> ()
+	  > decimationThreshold_ * scaleX;
+
+	if (!log && state.cost () && lastLoggedCost_)
+	  log = std::abs (*state.cost () - *lastLoggedCost_)
+	    > decimationThreshold_ * std::max<value_type>
+	    (1., std::abs (*lastLoggedCost_));
+      }
+
+    if (!log)
+      {
+	++skipped_;
+	return false;
+      }
+
+    lastLoggedX_ = x;
+    lastLoggedCost_ = state.cost ();
+    return true;
+  }
+
+  template <typename T>
+  void OptimizationLogger<T>::setDecimation (unsigned period,
+					     value_type threshold)
+  {
+    if (threshold < 0.)
+      throw std::runtime_error ("the decimation threshold must be positive");
+
+    decimationPeriod_ = period;
+    decimationThreshold_ = threshold;
+  }
+
+  template <typename T>
+  std::size_t OptimizationLogger<T>::skippedIterations () const
+  {
+    return skipped_;
+  }
+
+  template <typename T>
+  void OptimizationLogger<T>::enqueue (const solverState_t& state)
+  {
+    TraceScope traceScope ("io", "optimization logger: enqueue",
+			   static_cast<boost::int64_t> (callbackCallId_));
+
+    if (policy_ == SAMPLE_ON_OVERFLOW)
+      {
+	// Log more iterations again once the background thread caught up.
+	if (stride_ > 1 && queue_->size () < queue_->capacity () / 2)
+	  stride_ /= 2;
+	if (callbackCallId_ % stride_ != 0)
+	  {
+	    ++dropped_;
+	    return;
+	  }
+      }
+
+    Snapshot* snapshot = queue_->prepare ();
+    while (!snapshot && policy_ == BLOCK_ON_OVERFLOW)
+      {
+	boost::mutex::scoped_lock lock (queueMutex_);
+	snapshot = queue_->prepare ();
+	if (!snapshot)
+	  queueChanged_.timed_wait (lock, boost::posix_time::milliseconds (1));
+      }
+
+    if (!snapshot)
+      {
+	++dropped_;
+	if (policy_ == SAMPLE_ON_OVERFLOW)
+	  stride_ *= 2;
+	return;
+      }
+
+    capture (*snapshot, state);
+    queue_->commit ();
+    ++enqueued_;
+    queueChanged_.notify_all ();
+  }
+
+  template <typename T>
+  void OptimizationLogger<T>::run ()
+  {
+    const problem_t& pb = solver_.problem ();
+    while (true)
+      {
+	Snapshot* snapshot = queue_->front ();
+	if (!snapshot)
+	  {
+	    if (stopping_)
+	      {
+		// The producer may have committed an element in the meantime.
+		if (!queue_->front ())
+		  break;
+		continue;
+	      }
+	    boost::mutex::scoped_lock lock (queueMutex_);
+	    if (!queue_->front () && !stopping_)
+	      queueChanged_.timed_wait (lock, boost::posix_time::milliseconds (1));
+	    continue;
+	  }
+
+	try
+	  {
+	    process (pb, *snapshot);
+	  }
+	catch (std::exception& e)
+	  {
+	    std::cerr << e.what () << std::endl;
+	  }
+	catch (...)
+	  {
+	    std::cerr << "unknown exception" << std::endl;
+	  }
+
+	queue_->pop ();
+	++processed_;
+	queueChanged_.notify_all ();
+      }
+  }
+
+  template <typename T>
+  void OptimizationLogger<T>::process (const problem_t& pb,
+				       const Snapshot& snapshot)
+  {
+    TraceScope traceScope ("io", "optimization logger: iteration",
+			   static_cast<boost::int64_t> (snapshot.iteration));
+
+    boost::mutex::scoped_lock lock (journalMutex_);
+
     // Create the iteration-specific directory.
     boost::filesystem::path iterationPath =
-      path_ / (boost::format ("iteration-%d") % callbackCallId_).str ();
-    boost::filesystem::remove_all (iterationPath);
-    boost::filesystem::create_directories (iterationPath);
+      path_ / (boost::format ("iteration-%d") % snapshot.iteration).str ();
+    if (!binaryLog_)
+      {
+	boost::filesystem::remove_all (iterationPath);
+	boost::filesystem::create_directories (iterationPath);
+      }
 
     // Compute intermediary values.
     // - Store X
-    const_argument_ref x = state.x ();
-    x_.push_back (x);
-    // - Get current time
-    boost::posix_time::ptime t =
-      boost::posix_time::microsec_clock::universal_time ();
+    const_argument_ref x = snapshot.x;
     // - Current cost
     value_type cost;
-    if (!state.cost ())
-      cost = pb.function ()(x)[0];
-    else cost = *state.cost ();
-    costs_.push_back (cost);
+    if (!snapshot.cost)
+      {
+	pb.function () (costValue_, x);
+	cost = costValue_[0];
+      }
+    else cost = *snapshot.cost;
     // - Current constraint violation
     value_type cstrViol;
-    if (!state.constraintViolation ())
+    if (!snapshot.constraintViolation)
       cstrViol = 0;
-    else cstrViol = *state.constraintViolation ();
+    else cstrViol = *snapshot.constraintViolation;
 
     // Update journal
-    if (callbackCallId_ == 0)
-      output_ << solver_ << iendl;
-
     output_
       << std::string (80, '+') << iendl
-      << boost::format ("Callback call number: %d") % callbackCallId_ << iendl
-      << "Elapsed time since last call: " << (t - lastTime_) << iendl
+      << boost::format ("Callback call number: %d") % snapshot.iteration << iendl
+      << "Elapsed time since last call: " << snapshot.elapsed << iendl
       << "- x:" << incindent << iendl
       << x << decindent << iendl
       << "- f(x):" << incindent << iendl
       << cost << decindent << iendl;
 
+    if (binaryLog_)
+      {
+	write_binary_record (pb, snapshot, x, cost);
+	output_ << std::string (80, '-') << iendl;
+	return;
+      }
+
     // Log all data
     // x
     boost::filesystem::ofstream streamX (iterationPath / "x.csv");
@@ -488,11 +708,104 @@ namespace roboptim
     boost::filesystem::ofstream streamCost (iterationPath / "cost");
     streamCost << cost << "\n";
 
+    // evolution
+    for (size_type i = 0; i < x.size (); ++i)
+      {
+	if (i > 0)
+	  xStream_ << ", ";
+	xStream_ << x[i];
+      }
+    xStream_ << "\n";
+    costStream_ << cost << "\n";
+
     // constraints: only process if the problem is constrained
     if (!pb.constraints ().empty ())
-      process_constraints (pb, state, iterationPath, x, cstrViol);
+      process_constraints (pb, snapshot, iterationPath, x, cstrViol);
 
     output_ << std::string (80, '-') << iendl;
+
+    // Keep the evolution streams up to date in case of a crash.
+    xStream_.flush ();
+    costStream_.flush ();
+    if (!pb.constraints ().empty ())
+      {
+	constraintViolationStream_.flush ();
+	for (std::size_t i = 0; i < constraintStreams_.size (); ++i)
+	  constraintStreams_[i]->flush ();
+      }
+  }
+
+  template <typename T>
+  void OptimizationLogger<T>::setAsynchronous (std::size_t capacity,
+					       logOverflowPolicy_t policy)
+  {
+    if (capacity == 0)
+      throw std::runtime_error ("the logger queue capacity must be positive");
+
+    stop ();
+
+    Snapshot prototype;
+    prototype.x.resize (solver_.problem ().function ().inputSize ());
+    queue_.reset (new queue_t (capacity, prototype));
+    policy_ = policy;
+    stride_ = 1;
+    stopping_ = false;
+    worker_ = boost::thread (&OptimizationLogger<T>::run, this);
+  }
+
+  template <typename T>
+  void OptimizationLogger<T>::setSynchronous ()
+  {
+    stop ();
+  }
+
+  template <typename T>
+  bool OptimizationLogger<T>::isAsynchronous () const
+  {
+    return queue_.get () != 0;
+  }
+
+  template <typename T>
+  void OptimizationLogger<T>::stop ()
+  {
+    if (!queue_)
+      return;
+
+    stopping_ = true;
+    queueChanged_.notify_all ();
+    worker_.join ();
+    queue_.reset ();
+  }
+
+  template <typename T>
+  void OptimizationLogger<T>::flush ()
+  {
+    while (queue_ && processed_ != enqueued_)
+      {
+	boost::mutex::scoped_lock lock (queueMutex_);
+	if (processed_ != enqueued_)
+	  queueChanged_.timed_wait (lock, boost::posix_time::milliseconds (1));
+      }
+
+    boost::mutex::scoped_lock lock (journalMutex_);
+    output_.flush ();
+    if (binaryLog_)
+      binaryLog_->flush ();
+    else
+      {
+	costStream_.flush ();
+	xStream_.flush ();
+	if (constraintViolationStream_.is_open ())
+	  constraintViolationStream_.flush ();
+	for (std::size_t i = 0; i < constraintStreams_.size (); ++i)
+	  constraintStreams_[i]->flush ();
+      }
+  }
+
+  template <typename T>
+  std::size_t OptimizationLogger<T>::droppedIterations () const
+  {
+    return dropped_;
   }
 
   template <typename T>
@@ -508,6 +821,13 @@ namespace roboptim
   {
     o << this->name () << ":" << incindent;
     o << iendl << "Log directory: " << path_.string ();
+    if (format_ == BINARY_LOG)
+      o << iendl << "Format: binary";
+    if (queue_)
+      o << iendl << "Asynchronous: queue capacity " << queue_->capacity ();
+    if (decimationPeriod_ != 1 || decimationThreshold_ > 0.)
+      o << iendl << "Decimation: period " << decimationPeriod_
+	<< ", threshold " << decimationThreshold_;
     o << decindent;
 
     return o;
@@ -547,6 +867,12 @@ namespace roboptim
     return callbackCallId_;
   }
 
+  template <typename T>
+  logFormat_t OptimizationLogger<T>::format () const
+  {
+    return format_;
+  }
+
 // Explicit template instantiations for dense and sparse matrices.
 # ifdef ROBOPTIM_PRECOMPILED_DENSE_SPARSE
   extern template class ROBOPTIM_DLLAPI OptimizationLogger<Solver<EigenMatrixDense> >;
@@ -0,0 +1,343 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_PLUGIN_REGISTRY_HH
+# define ROBOPTIM_CORE_PLUGIN_REGISTRY_HH
+
+# include <cstddef>
+# include <map>
+# include <set>
+# include <string>
+# include <typeinfo>
+
+# include <ltdl.h>
+
+# include <boost/noncopyable.hpp>
+
+# include <roboptim/core/portability.hh>
+
+namespace roboptim
+{
+  /// \addtogroup roboptim_problem
+  /// @{
+
+  /// \brief Process-wide registry of the loaded solver plug-ins.
+  ///
+  /// Loading a plug-in requires initializing libltdl, searching for the
+  /// shared object, opening it and resolving its entry points. The registry
+  /// does this once per plug-in and keeps the plug-in loaded, so that
+  /// creating solvers in a loop only costs the call to the plug-in's
+  /// create function.
+  ///
+  /// Plug-ins can also be linked statically, and registered at static
+  /// initialization time (see ROBOPTIM_DEFINE_PLUGIN). Statically
+  /// registered plug-ins are used before looking for a shared object, so
+  /// libltdl is not needed for them.
+  ///
+  /// The registry is thread-safe. It is used by SolverFactory, and should
+  /// rarely be used directly.
+  class ROBOPTIM_DLLAPI PluginRegistry : public boost::noncopyable
+  {
+  public:
+    /// \brief Entry points of a loaded plug-in.
+    ///
+    /// Entry points are stored as object pointers, as returned by
+    /// lt_dlsym. They have to be cast to the proper function type.
+    struct Plugin
+    {
+      Plugin ();
+
+      /// \brief Name of the shared object (e.g. roboptim-core-plugin-dummy).
+      std::string name;
+
+      /// \brief ltdl plug-in handle (null for static plug-ins).
+      lt_dlhandle handle;
+
+      /// \brief Whether the plug-in was registered statically.
+      bool isStatic;
+
+      /// \brief getSizeOfProblem entry point.
+      void* getSizeOfProblem;
+
+      /// \brief getTypeIdOfConstraintsList entry point.
+      void* getTypeIdOfConstraintsList;
+
+      /// \brief create entry point.
+      void* create;
+
+      /// \brief destroy entry point (may be null).
+      void* destroy;
+
+      /// \brief Solver types for which the plug-in was validated.
+      std::set<std::string> validated;
+
+      /// \brief Number of users (e.g. solver factories) of the plug-in.
+      std::size_t users;
+    };
+
+    /// \brief Retrieve the registry.
+    static PluginRegistry& instance ();
+
+    /// \brief Load a plug-in (if needed) and register a new user.
+    ///
+    /// Each successful call has to be matched by a call to release.
+    ///
+    /// \param plugin plug-in name (for instance ``cfsqp'').
+    /// \return entry points of the plug-in.
+    /// \throw std::runtime_error
+    const Plugin& acquire (const std::string& plugin);
+
+    /// \brief Unregister a user of a plug-in.
+    ///
+    /// The plug-in stays loaded, see unloadUnused.
+    ///
+    /// \param plugin plug-in name.
+    void release (const std::string& plugin);
+
+    /// \brief Whether a plug-in is currently loaded.
+    /// \param plugin plug-in name.
+    bool isLoaded (const std::string& plugin) const;
+
+    /// \brief Whether a plug-in was registered statically.
+    /// \param plugin plug-in name.
+    bool isStatic (const std::string& plugin) const;
+
+    /// \brief Whether a plug-in was validated for a solver type.
+    ///
+    /// \param plugin plug-in name.
+    /// \param solver solver type identifier.
+    bool isValidated (const std::string& plugin,
+                      const std::string& solver) const;
+
+    /// \brief Mark a plug-in as validated for a solver type, i.e. the
+    /// problem type of the plug-in matches the one of the application.
+    ///
+    /// \param plugin plug-in name.
+    /// \param solver solver type identifier.
+    void setValidated (const std::string& plugin, const std::string& solver);
+
+    /// \brief Unload the plug-ins that are not used anymore.
+    ///
+    /// Static plug-ins are never unloaded.
+    ///
+    /// \return number of unloaded plug-ins.
+    std::size_t unloadUnused ();
+
+    /// \brief Register a statically linked plug-in.
+    ///
+    /// This is usually done by ROBOPTIM_DEFINE_PLUGIN. Registering a
+    /// plug-in that is already known (e.g. already loaded) has no effect.
+    ///
+    /// \param plugin plug-in name (for instance ``cfsqp'').
+    /// \param getSizeOfProblem getSizeOfProblem entry point.
+    /// \param getTypeIdOfConstraintsList getTypeIdOfConstraintsList entry
+    /// point.
+    /// \param create create entry point.
+    /// \param destroy destroy entry point.
+    void registerStatic (const std::string& plugin,
+                         void* getSizeOfProblem,
+                         void* getTypeIdOfConstraintsList,
+                         void* create,
+                         void* destroy);
+
+  private:
+    /// \brief Plug-ins, indexed by plug-in name.
+    typedef std::map<std::string, Plugin> plugins_t;
+
+    PluginRegistry ();
+    ~PluginRegistry ();
+
+    /// \brief Create the registry (called once).
+    static void createInstance ();
+
+    /// \brief Load a plug-in and resolve its entry points.
+    ///
+    /// \param plugin plug-in name.
+    /// \param entry entry to fill.
+    /// \throw std::runtime_error
+    void load (const std::string& plugin, Plugin& entry);
+
+    /// \brief Whether libltdl was initialized by the registry.
+    bool ltdlInitialized_;
+
+    /// \brief Loaded plug-ins.
+    plugins_t plugins_;
+  };
+
+  /// @}
+
+  namespace detail
+  {
+    /// \brief Convert a pointer to function into a pointer to object.
+    ///
+    /// This is the counterpart of unionCast (see solver-factory.hxx).
+    template <typename S>
+    void* functionCast (S* ptr)
+    {
+      union
+      {
+        S* real_ptr;
+        void* ptr;
+      } u;
+      u.real_ptr = ptr;
+      return u.ptr;
+    }
+
+    /// \brief Entry points of a plug-in providing the solver S.
+    ///
+    /// \tparam S solver type, S::parent_t being the Solver type exposed by
+    /// the plug-in.
+    template <typename S>
+    struct PluginEntryPoints
+    {
+      /// \brief Solver type exposed by the plug-in.
+      typedef typename S::parent_t solver_t;
+
+      /// \brief Problem type.
+      typedef typename solver_t::problem_t problem_t;
+
+      static std::size_t getSizeOfProblem ()
+      {
+        return sizeof (problem_t);
+      }
+
+      static const char* getTypeIdOfConstraintsList ()
+      {
+        return typeid (typename problem_t::constraintsList_t).name ();
+      }
+
+      static solver_t* create (const problem_t& pb)
+      {
+        return new S (pb);
+      }
+
+      static void destroy (solver_t* p)
+      {
+        delete p;
+      }
+
+      /// \brief Register the entry points in the plug-in registry.
+      ///
+      /// \param plugin plug-in name.
+      static void registerStatic (const char* plugin)
+      {
+        PluginRegistry::instance ().registerStatic
+          (plugin,
+           functionCast (&getSizeOfProblem),
+           functionCast (&getTypeIdOfConstraintsList),
+           functionCast (&create),
+           functionCast (&destroy));
+      }
+    };
+
+    /// \brief Call a registration function at static initialization time.
+    struct StaticPluginRegistration
+    {
+      explicit StaticPluginRegistration (void (*registration) ())
+      {
+        registration ();
+      }
+    };
+  } // end of namespace detail
+
+} // end of namespace roboptim
+
+/// \brief Define the entry points of a solver plug-in.
+///
+/// By default, this exports the C functions looked up by SolverFactory in
+/// the plug-in's shared object (getSizeOfProblem,
+/// getTypeIdOfConstraintsList, create and destroy).
+///
+/// If ROBOPTIM_STATIC_PLUGIN is defined, the plug-in is meant to be linked
+/// statically: nothing is exported, and the plug-in is registered in the
+/// PluginRegistry at static initialization time instead. Since linkers drop
+/// unreferenced objects of static libraries, applications should use
+/// ROBOPTIM_IMPORT_STATIC_PLUGIN (ID) (or link the whole archive).
+///
+/// Example:
+/// \code
+/// ROBOPTIM_DEFINE_PLUGIN (dummy_td, "dummy-td", DummySolverTd)
+/// \endcode
+///
+/// \param ID plug-in identifier (valid C identifier).
+/// \param NAME plug-in name, as given to SolverFactory.
+/// \param SOLVER solver type, SOLVER::parent_t being the Solver type.
+# ifdef ROBOPTIM_STATIC_PLUGIN
+#  define ROBOPTIM_DEFINE_PLUGIN(ID, NAME, SOLVER)			\
+  extern "C" void roboptim_register_plugin_##ID ();			\
+  extern "C" void roboptim_register_plugin_##ID ()			\
+  {									\
+    ::roboptim::detail::PluginEntryPoints<SOLVER>::registerStatic (NAME); \
+  }									\
+  namespace								\
+  {									\
+    ::roboptim::detail::StaticPluginRegistration			\
+    roboptimStaticPluginRegistration_##ID (&roboptim_register_plugin_##ID); \
+  }
+# else
+#  define ROBOPTIM_DEFINE_PLUGIN(ID, NAME, SOLVER)			\
+  extern "C"								\
+  {									\
+    typedef ::roboptim::detail::PluginEntryPoints<SOLVER>		\
+    roboptim_plugin_entry_points_t;					\
+									\
+    ROBOPTIM_DLLEXPORT std::size_t getSizeOfProblem ();		\
+    ROBOPTIM_DLLEXPORT const char* getTypeIdOfConstraintsList ();	\
+    ROBOPTIM_DLLEXPORT roboptim_plugin_entry_points_t::solver_t*	\
+    create (const roboptim_plugin_entry_points_t::problem_t& pb);	\
+    ROBOPTIM_DLLEXPORT void						\
+    destroy (roboptim_plugin_entry_points_t::solver_t* p);		\
+									\
+    ROBOPTIM_DLLEXPORT std::size_t getSizeOfProblem ()			\
+    {									\
+      return roboptim_plugin_entry_points_t::getSizeOfProblem ();	\
+    }									\
+									\
+    ROBOPTIM_DLLEXPORT const char* getTypeIdOfConstraintsList ()	\
+    {									\
+      return roboptim_plugin_entry_points_t::getTypeIdOfConstraintsList (); \
+    }									\
+									\
+    ROBOPTIM_DLLEXPORT roboptim_plugin_entry_points_t::solver_t*	\
+    create (const roboptim_plugin_entry_points_t::problem_t& pb)	\
+    {									\
+      return roboptim_plugin_entry_points_t::create (pb);		\
+    }									\
+									\
+    ROBOPTIM_DLLEXPORT void						\
+    destroy (roboptim_plugin_entry_points_t::solver_t* p)		\
+    {									\
+      roboptim_plugin_entry_points_t::destroy (p);			\
+    }									\
+  }
+# endif //! ROBOPTIM_STATIC_PLUGIN
+
+/// \brief Make sure a statically linked plug-in is registered.
+///
+/// This references the registration function of the plug-in, so that the
+/// linker keeps it. Use it at namespace scope in the application.
+///
+/// \param ID plug-in identifier, as given to ROBOPTIM_DEFINE_PLUGIN.
+# define ROBOPTIM_IMPORT_STATIC_PLUGIN(ID)				\
+  extern "C" void roboptim_register_plugin_##ID ();			\
+  namespace								\
+  {									\
+    ::roboptim::detail::StaticPluginRegistration			\
+    roboptimStaticPluginImport_##ID (&roboptim_register_plugin_##ID);	\
+  }
+
+#endif //! ROBOPTIM_CORE_PLUGIN_REGISTRY_HH
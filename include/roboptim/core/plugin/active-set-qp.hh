@@ -0,0 +1,284 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_PLUGIN_ACTIVE_SET_QP_HH
+# define ROBOPTIM_CORE_PLUGIN_ACTIVE_SET_QP_HH
+
+# include <vector>
+
+# include <Eigen/Core>
+# include <Eigen/Sparse>
+
+# include <roboptim/core/numeric-linear-function.hh>
+# include <roboptim/core/numeric-quadratic-function.hh>
+# include <roboptim/core/solver.hh>
+# include <roboptim/core/solver-state.hh>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \brief Rows of the linear constraints of a quadratic program.
+    ///
+    /// The active-set method only accesses the constraint matrix row by
+    /// row, either to evaluate a constraint or to project its normal on the
+    /// null space of the active constraints.
+    ///
+    /// \tparam T matrix type
+    template <typename T>
+    class QPConstraintRows;
+
+    /// \brief Dense constraint rows.
+    template <>
+    class QPConstraintRows<EigenMatrixDense>
+    {
+    public:
+      typedef GenericNumericLinearFunction<EigenMatrixDense> function_t;
+      typedef function_t::value_type value_type;
+      typedef function_t::size_type size_type;
+      typedef function_t::vector_t vector_t;
+      typedef function_t::matrix_t matrix_t;
+
+      /// \brief Copy the stacked constraint matrix.
+      void set (const matrix_t& C);
+
+      /// \brief Dot product of the i-th row with v.
+      value_type dot (size_type i, const vector_t& v) const;
+
+      /// \brief Compute \f$M^T c_i\f$, c_i being the i-th row.
+      void transposeProduct (size_type i, const Eigen::MatrixXd& M,
+                             vector_t& result) const;
+
+    private:
+      /// \brief Constraint matrix, stored by rows.
+      Eigen::Matrix<value_type, Eigen::Dynamic, Eigen::Dynamic,
+                    Eigen::RowMajor> C_;
+    };
+
+    /// \brief Sparse constraint rows.
+    ///
+    /// Products only involve the nonzero coefficients of the rows.
+    template <>
+    class QPConstraintRows<EigenMatrixSparse>
+    {
+    public:
+      typedef GenericNumericLinearFunction<EigenMatrixSparse> function_t;
+      typedef function_t::value_type value_type;
+      typedef function_t::size_type size_type;
+      typedef function_t::vector_t vector_t;
+      typedef function_t::matrix_t matrix_t;
+
+      void set (const matrix_t& C);
+      value_type dot (size_type i, const vector_t& v) const;
+      void transposeProduct (size_type i, const Eigen::MatrixXd& M,
+                             vector_t& result) const;
+
+    private:
+      /// \brief Constraint matrix, stored by rows.
+      Eigen::SparseMatrix<value_type, Eigen::RowMajor> C_;
+    };
+  } // end of namespace detail
+
+  /// \brief Active-set solver for strictly convex quadratic programs.
+  ///
+  /// The cost function has to be a GenericNumericQuadraticFunction
+  /// \f$f(x) = x^T A x + b^T x + c\f$ with a positive definite A, and all
+  /// the constraints have to be GenericNumericLinearFunction. Both are
+  /// recognized through their flags (ROBOPTIM_IS_NUMERIC_QUADRATIC,
+  /// ROBOPTIM_IS_NUMERIC_LINEAR), and their matrices are used directly:
+  /// the functions are never evaluated.
+  ///
+  /// The solver implements the dual active-set method of Goldfarb and
+  /// Idnani: starting from the unconstrained minimum, the most violated
+  /// constraint is added to the working set until the iterate is feasible,
+  /// while dropping the constraints whose multiplier would become negative.
+  /// Equality constraints (equal lower and upper bounds) are added first.
+  /// No feasible starting point is needed, and the starting point of the
+  /// problem is ignored.
+  ///
+  /// The Cholesky factor of the Hessian and the constraint rows are
+  /// extracted once. When the problem is solved again with resolve (),
+  /// they are kept, and the working set of the previous solution is used
+  /// to warm start the method: its violated constraints are added first.
+  /// This is the usual situation of model predictive control, where only
+  /// the bounds change between two solves. Changing the problem parameters
+  /// extracts the matrices again, in case they were updated in place.
+  ///
+  /// The dense and sparse variants only differ in how the constraint
+  /// matrix is stored and used. The factorization and the working set
+  /// matrices are dense (n x n), so the solver targets small and medium
+  /// problems.
+  ///
+  /// The iteration callback is called each time a constraint is added to
+  /// the working set. The solver supports cooperative interruption through
+  /// the ``qp.stop'' state parameter (see SolverState::requestStop).
+  ///
+  /// \tparam T matrix type
+  template <typename T>
+  class GenericActiveSetQPSolver : public Solver<T>
+  {
+  public:
+    /// \brief Define parent's type.
+    typedef Solver<T> parent_t;
+
+    /// \brief Problem type.
+    typedef typename parent_t::problem_t problem_t;
+
+    /// \brief Callback function type.
+    typedef typename parent_t::callback_t callback_t;
+
+    /// \brief Type of the state of the solver.
+    typedef typename parent_t::solverState_t solverState_t;
+
+    /// \brief Quadratic cost function type.
+    typedef GenericNumericQuadraticFunction<T> quadraticFunction_t;
+
+    /// \brief Import types from the cost function.
+    typedef typename quadraticFunction_t::value_type value_type;
+    typedef typename quadraticFunction_t::size_type size_type;
+    typedef typename quadraticFunction_t::vector_t vector_t;
+
+    /// \brief Dense matrix type used by the working set.
+    typedef Eigen::MatrixXd denseMatrix_t;
+
+    /// \brief Build a solver from a problem.
+    /// \param problem problem that will be solved
+    explicit GenericActiveSetQPSolver (const problem_t& problem);
+
+    virtual ~GenericActiveSetQPSolver ();
+
+    /// \brief Solve the problem.
+    virtual void solve ();
+
+    virtual void setIterationCallback (callback_t callback);
+
+    /// \brief Current state of the solver.
+    const solverState_t& solverState () const;
+
+    /// \brief Working set of the last solution.
+    ///
+    /// Each constraint is identified by 2 i (lower bound) or 2 i + 1 (upper
+    /// bound), i being the index of the argument for i < n, or n plus the
+    /// row in the stacked constraints.
+    const std::vector<size_type>& workingSet () const;
+
+  protected:
+    virtual void updateProblem (unsigned int updates);
+
+  private:
+    /// \brief Extract the matrices of the problem and factorize the
+    /// Hessian.
+    /// \return whether the problem is a strictly convex QP.
+    bool compile (const problem_t& pb);
+
+    /// \brief Value of the argument or stacked constraint i at x.
+    value_type value (size_type i, const vector_t& x) const;
+
+    /// \brief Slack of constraint k at the current point (negative if
+    /// violated).
+    value_type slack (size_type k) const;
+
+    /// \brief Dot product of the normal of constraint k with v.
+    value_type normalDot (size_type k, const vector_t& v) const;
+
+    /// \brief Compute the primal and dual directions for constraint k
+    /// (d_, z_ and r_).
+    void computeDirections (size_type k);
+
+    /// \brief Add the constraint whose transformed normal is d_ to the
+    /// working set.
+    /// \return false if it is linearly dependent on the working set.
+    bool addConstraint (size_type k);
+
+    /// \brief Remove the l-th constraint of the working set.
+    void dropConstraint (size_type l);
+
+    /// \brief Iteration callback.
+    callback_t callback_;
+
+    /// \brief Current state of the solver.
+    solverState_t state_;
+
+    /// \brief State parameters.
+    StateParameterHandle<bool> stop_;
+    StateParameterHandle<int> iteration_;
+    StateParameterHandle<int> activeConstraints_;
+
+    /// \brief Constraint rows.
+    detail::QPConstraintRows<T> rows_;
+
+    /// \brief Constant part of the constraints.
+    vector_t b_;
+
+    /// \brief Hessian (2 A), linear and constant terms of the cost.
+    denseMatrix_t H_;
+    vector_t q_;
+    value_type c_;
+
+    /// \brief Inverse of the transposed Cholesky factor of the Hessian.
+    denseMatrix_t J0_;
+
+    /// \brief Whether the matrices were extracted.
+    bool compiled_;
+
+    /// \brief Whether the next solve is a resolve.
+    bool resolving_;
+
+    /// \brief Argument and constraint bounds, stacked.
+    vector_t lower_;
+    vector_t upper_;
+
+    /// \brief Current point.
+    vector_t x_;
+
+    /// \brief Working set factorization: J = L^-T Q and R.
+    denseMatrix_t J_;
+    denseMatrix_t R_;
+    value_type Rnorm_;
+
+    /// \brief J^T n, primal direction and dual direction.
+    vector_t d_;
+    vector_t z_;
+    vector_t r_;
+
+    /// \brief Multipliers of the working set.
+    vector_t u_;
+
+    /// \brief Working set and its size.
+    std::vector<size_type> active_;
+    size_type activeSize_;
+
+    /// \brief Whether each constraint is in the working set.
+    std::vector<bool> isActive_;
+
+    /// \brief Working set of the last solution.
+    std::vector<size_type> workingSet_;
+  };
+
+  /// \brief Dense active-set QP solver.
+  typedef GenericActiveSetQPSolver<EigenMatrixDense> ActiveSetQPSolver;
+
+  /// \brief Sparse active-set QP solver.
+  typedef GenericActiveSetQPSolver<EigenMatrixSparse>
+  ActiveSetQPSparseSolver;
+
+} // end of namespace roboptim
+
+# include <roboptim/core/plugin/active-set-qp.hxx>
+
+#endif //! ROBOPTIM_CORE_PLUGIN_ACTIVE_SET_QP_HH
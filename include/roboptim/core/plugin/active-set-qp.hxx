@@ -0,0 +1,638 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_PLUGIN_ACTIVE_SET_QP_HXX
+# define ROBOPTIM_CORE_PLUGIN_ACTIVE_SET_QP_HXX
+
+# include <algorithm>
+# include <cmath>
+# include <limits>
+
+# include <Eigen/Cholesky>
+
+# include <roboptim/core/alloc.hh>
+# include <roboptim/core/compiled-problem.hh>
+# include <roboptim/core/result.hh>
+# include <roboptim/core/solver-error.hh>
+# include <roboptim/core/solver-warning.hh>
+# include <roboptim/core/util.hh>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    inline void
+    QPConstraintRows<EigenMatrixDense>::set (const matrix_t& C)
+    {
+      C_ = C;
+    }
+
+    inline QPConstraintRows<EigenMatrixDense>::value_type
+    QPConstraintRows<EigenMatrixDense>::dot (size_type i,
+                                             const vector_t& v) const
+    {
+      return C_.row (i).dot (v);
+    }
+
+    inline void
+    QPConstraintRows<EigenMatrixDense>::transposeProduct
+    (size_type i, const Eigen::MatrixXd& M, vector_t& result) const
+    {
+      result.noalias () = M.transpose () * C_.row (i).transpose ();
+    }
+
+    inline void
+    QPConstraintRows<EigenMatrixSparse>::set (const matrix_t& C)
+    {
+      C_ = C;
+      C_.makeCompressed ();
+    }
+
+    inline QPConstraintRows<EigenMatrixSparse>::value_type
+    QPConstraintRows<EigenMatrixSparse>::dot (size_type i,
+                                              const vector_t& v) const
+    {
+      value_type result = 0.;
+      for (Eigen::SparseMatrix<value_type, Eigen::RowMajor>::InnerIterator
+             it (C_, i); it; ++it)
+        result += it.value () * v[it.col ()];
+      return result;
+    }
+
+    inline void
+    QPConstraintRows<EigenMatrixSparse>::transposeProduct
+    (size_type i, const Eigen::MatrixXd& M, vector_t& result) const
+    {
+      result.setZero ();
+      for (Eigen::SparseMatrix<value_type, Eigen::RowMajor>::InnerIterator
+             it (C_, i); it; ++it)
+        result.noalias () += it.value () * M.row (it.col ()).transpose ();
+    }
+  } // end of namespace detail
+
+  template <typename T>
+  GenericActiveSetQPSolver<T>::GenericActiveSetQPSolver (const problem_t& pb)
+    : parent_t (pb),
+      callback_ (),
+      state_ (pb),
+      stop_ (),
+      iteration_ (),
+      activeConstraints_ (),
+      rows_ (),
+      b_ (),
+      H_ (),
+      q_ (),
+      c_ (0.),
+      J0_ (),
+      compiled_ (false),
+      resolving_ (false),
+      lower_ (),
+      upper_ (),
+      x_ (),
+      J_ (),
+      R_ (),
+      Rnorm_ (1.),
+      d_ (),
+      z_ (),
+      r_ (),
+      u_ (),
+      active_ (),
+      activeSize_ (0),
+      isActive_ (),
+      workingSet_ ()
+  {
+    parent_t::parameters_["qp.max-iterations"].description =
+      "maximum number of constraints added to the working set";
+    parent_t::parameters_["qp.max-iterations"].value = 1000;
+
+    parent_t::parameters_["qp.feasibility-tolerance"].description =
+      "tolerance on the violation of the constraints";
+    parent_t::parameters_["qp.feasibility-tolerance"].value = 1e-9;
+
+    parent_t::parameters_["qp.warm-start"].description =
+      "whether resolve () starts from the previous working set";
+    parent_t::parameters_["qp.warm-start"].value = true;
+
+    stop_ = state_.registerParameter
+      ("qp.stop", "whether to stop the optimization", false);
+    iteration_ = state_.registerParameter
+      ("qp.iteration", "current iteration", 0);
+    activeConstraints_ = state_.registerParameter
+      ("qp.active-constraints", "size of the working set", 0);
+  }
+
+  template <typename T>
+  GenericActiveSetQPSolver<T>::~GenericActiveSetQPSolver ()
+  {
+  }
+
+  template <typename T>
+  void
+  GenericActiveSetQPSolver<T>::setIterationCallback (callback_t callback)
+  {
+    callback_ = callback;
+  }
+
+  template <typename T>
+  const typename GenericActiveSetQPSolver<T>::solverState_t&
+  GenericActiveSetQPSolver<T>::solverState () const
+  {
+    return state_;
+  }
+
+  template <typename T>
+  const std::vector<typename GenericActiveSetQPSolver<T>::size_type>&
+  GenericActiveSetQPSolver<T>::workingSet () const
+  {
+    return workingSet_;
+  }
+
+  template <typename T>
+  void
+  GenericActiveSetQPSolver<T>::updateProblem (unsigned int updates)
+  {
+    // The structure of the problem is fixed, so the factorization stays
+    // valid, unless the data of the functions depends on the parameters.
+    resolving_ = true;
+    if (updates & parent_t::PARAMETERS_UPDATE)
+      compiled_ = false;
+  }
+
+  template <typename T>
+  bool
+  GenericActiveSetQPSolver<T>::compile (const problem_t& pb)
+  {
+    if (!pb.function ().template asType<quadraticFunction_t> ())
+      {
+        this->result_ = SolverError
+          ("active-set-qp: the cost function must be a numeric quadratic"
+           " function");
+        return false;
+      }
+    const quadraticFunction_t& cost =
+      *pb.function ().template castInto<quadraticFunction_t> ();
+
+    CompiledProblem<T> cpb (pb);
+    if (cpb.linearRows () != cpb.constraintsOutputSize ())
+      {
+        this->result_ = SolverError
+          ("active-set-qp: the constraints must be numeric linear functions");
+        return false;
+      }
+
+    const size_type n = cpb.inputSize ();
+    const size_type m = cpb.constraintsOutputSize ();
+
+    H_ = 2. * toDense (cost.A ());
+    q_ = cost.b ();
+    c_ = cost.c ()[0];
+    rows_.set (cpb.linearA ());
+    b_ = cpb.linearB ();
+
+    Eigen::LLT<denseMatrix_t> llt (H_);
+    if (llt.info () != Eigen::Success)
+      {
+        this->result_ = SolverError
+          ("active-set-qp: the Hessian of the cost function must be positive"
+           " definite");
+        return false;
+      }
+
+    // J0 = L^-T, so that H^-1 = J0 J0^T.
+    J0_.setIdentity (n, n);
+    llt.matrixU ().solveInPlace (J0_);
+
+    lower_.resize (n + m);
+    upper_.resize (n + m);
+    x_.resize (n);
+    J_.resize (n, n);
+    R_.resize (n, n);
+    d_.resize (n);
+    z_.resize (n);
+    r_.resize (n);
+    u_.resize (n);
+    active_.resize (static_cast<std::size_t> (n));
+    isActive_.resize (static_cast<std::size_t> (2 * (n + m)));
+    workingSet_.reserve (static_cast<std::size_t> (n));
+
+    compiled_ = true;
+    return true;
+  }
+
+  template <typename T>
+  typename GenericActiveSetQPSolver<T>::value_type
+  GenericActiveSetQPSolver<T>::value (size_type i, const vector_t& x) const
+  {
+    const size_type n = x_.size ();
+    return i < n ? x[i] : rows_.dot (i - n, x) + b_[i - n];
+  }
+
+  template <typename T>
+  typename GenericActiveSetQPSolver<T>::value_type
+  GenericActiveSetQPSolver<T>::slack (size_type k) const
+  {
+    const size_type i = k / 2;
+    return k % 2 ? upper_[i] - value (i, x_) : value (i, x_) - lower_[i];
+  }
+
+  template <typename T>
+  typename GenericActiveSetQPSolver<T>::value_type
+  GenericActiveSetQPSolver<T>::normalDot (size_type k,
+                                          const vector_t& v) const
+  {
+    const size_type n = x_.size ();
+    const size_type i = k / 2;
+    const value_type dot = i < n ? v[i] : rows_.dot (i - n, v);
+    return k % 2 ? -dot : dot;
+  }
+
+  template <typename T>
+  void
+  GenericActiveSetQPSolver<T>::computeDirections (size_type k)
+  {
+    const size_type n = x_.size ();
+    const size_type i = k / 2;
+
+    // d = J^T n.
+    if (i < n)
+      d_ = J_.row (i).transpose ();
+    else
+      rows_.transposeProduct (i - n, J_, d_);
+    if (k % 2)
+      d_ = -d_;
+
+    // Primal direction: z = J2 d2, J2 spanning the null space of the
+    // working set. Dual direction: r = R^-1 d1.
+    const size_type q = activeSize_;
+    z_.noalias () = J_.rightCols (n - q) * d_.tail (n - q);
+    r_.head (q) = d_.head (q);
+    R_.topLeftCorner (q, q).template triangularView<Eigen::Upper> ()
+      .solveInPlace (r_.head (q));
+  }
+
+  template <typename T>
+  bool
+  GenericActiveSetQPSolver<T>::addConstraint (size_type k)
+  {
+    const size_type n = x_.size ();
+
+    // Givens rotations zeroing the tail of d, applied to J.
+    for (size_type j = n - 1; j > activeSize_; --j)
+      {
+        value_type cc = d_[j - 1];
+        value_type ss = d_[j];
+        const value_type h = std::sqrt (cc * cc + ss * ss);
+        if (h == 0.)
+          continue;
+        d_[j] = 0.;
+        cc /= h;
+        ss /= h;
+        if (cc < 0.)
+          {
+            cc = -cc;
+            ss = -ss;
+            d_[j - 1] = -h;
+          }
+        else
+          d_[j - 1] = h;
+        const value_type xny = ss / (1. + cc);
+        for (size_type l = 0; l < n; ++l)
+          {
+            const value_type t1 = J_ (l, j - 1);
+            const value_type t2 = J_ (l, j);
+            J_ (l, j - 1) = t1 * cc + t2 * ss;
+            J_ (l, j) = xny * (t1 + J_ (l, j - 1)) - t2;
+          }
+      }
+
+    const size_type q = activeSize_;
+    R_.col (q).head (q + 1) = d_.head (q + 1);
+    if (std::abs (d_[q]) <= std::numeric_limits<value_type>::epsilon ()
+        * Rnorm_)
+      return false;
+    Rnorm_ = std::max (Rnorm_, std::abs (d_[q]));
+
+    active_[static_cast<std::size_t> (q)] = k;
+    isActive_[static_cast<std::size_t> (k)] = true;
+    ++activeSize_;
+    return true;
+  }
+
+  template <typename T>
+  void
+  GenericActiveSetQPSolver<T>::dropConstraint (size_type l)
+  {
+    const size_type n = x_.size ();
+    isActive_[static_cast<std::size_t> (active_[static_cast<std::size_t>
+                                                (l)])] = false;
+
+    for (size_type i = l; i < activeSize_ - 1; ++i)
+      {
+        active_[static_cast<std::size_t> (i)] =
+          active_[static_cast<std::size_t> (i + 1)];
+        u_[i] = u_[i + 1];
+        R_.col (i).head (activeSize_) = R_.col (i + 1).head (activeSize_);
+      }
+    --activeSize_;
+
+    // Restore the triangular form of R with Givens rotations, applied to J.
+    for (size_type j = l; j < activeSize_; ++j)
+      {
+        value_type cc = R_ (j, j);
+        value_type ss = R_ (j + 1, j);
+        const value_type h = std::sqrt (cc * cc + ss * ss);
+        if (h == 0.)
+          continue;
+        cc /= h;
+        ss /= h;
+        R_ (j + 1, j) = 0.;
+        if (cc < 0.)
+          {
+            R_ (j, j) = -h;
+            cc = -cc;
+            ss = -ss;
+          }
+        else
+          R_ (j, j) = h;
+        const value_type xny = ss / (1. + cc);
+        for (size_type k = j + 1; k < activeSize_; ++k)
+          {
+            const value_type t1 = R_ (j, k);
+            const value_type t2 = R_ (j + 1, k);
+            R_ (j, k) = t1 * cc + t2 * ss;
+            R_ (j + 1, k) = xny * (t1 + R_ (j, k)) - t2;
+          }
+        for (size_type k = 0; k < n; ++k)
+          {
+            const value_type t1 = J_ (k, j);
+            const value_type t2 = J_ (k, j + 1);
+            J_ (k, j) = t1 * cc + t2 * ss;
+            J_ (k, j + 1) = xny * (J_ (k, j) + t1) - t2;
+          }
+      }
+  }
+
+  template <typename T>
+  void
+  GenericActiveSetQPSolver<T>::solve ()
+  {
+    const problem_t& pb = this->problem ();
+
+    // A plain solve () starts from scratch.
+    if (!resolving_)
+      {
+        compiled_ = false;
+        workingSet_.clear ();
+      }
+    resolving_ = false;
+    if (!compiled_ && !compile (pb))
+      return;
+
+    const int maxIterations = this->template getParameter<int>
+      ("qp.max-iterations");
+    const value_type tol = this->template getParameter<value_type>
+      ("qp.feasibility-tolerance");
+    const bool warmStart = this->template getParameter<bool>
+      ("qp.warm-start");
+
+    const size_type n = x_.size ();
+    const size_type m = b_.size ();
+    const size_type nConstraints = 2 * (n + m);
+
+    lower_.head (n) = pb.argumentLowerBounds ();
+    upper_.head (n) = pb.argumentUpperBounds ();
+    lower_.tail (m) = pb.constraintsLowerBounds ();
+    upper_.tail (m) = pb.constraintsUpperBounds ();
+    for (size_type i = 0; i < n + m; ++i)
+      if (lower_[i] > upper_[i])
+        {
+          this->result_ = SolverError ("active-set-qp: inconsistent bounds");
+          return;
+        }
+
+    state_.setParameter (stop_, false);
+    state_.setParameter (iteration_, 0);
+    state_.setParameter (activeConstraints_, 0);
+
+    const value_type inf = std::numeric_limits<value_type>::infinity ();
+    const char* error = 0;
+    const char* warning = 0;
+
+    set_is_malloc_allowed (false);
+
+    // Unconstrained minimum: x = -H^-1 q.
+    J_ = J0_;
+    d_.noalias () = J0_.transpose () * q_;
+    x_.noalias () = -J0_ * d_;
+    activeSize_ = 0;
+    Rnorm_ = 1.;
+    std::fill (isActive_.begin (), isActive_.end (), false);
+
+    // Equality constraints.
+    for (size_type i = 0; i < n + m && !error; ++i)
+      {
+        if (lower_[i] != upper_[i])
+          continue;
+
+        const size_type k = 2 * i;
+        computeDirections (k);
+        const value_type zn = normalDot (k, z_);
+        if (!(std::abs (zn) > std::numeric_limits<value_type>::epsilon ()))
+          {
+            // Linearly dependent on the previous equalities.
+            if (std::abs (slack (k)) > tol)
+              error = "active-set-qp: inconsistent equality constraints";
+            isActive_[static_cast<std::size_t> (k + 1)] = true;
+            continue;
+          }
+
+        const value_type t = -slack (k) / zn;
+        x_ += t * z_;
+        u_.head (activeSize_) -= t * r_.head (activeSize_);
+        if (!addConstraint (k))
+          error = "active-set-qp: inconsistent equality constraints";
+        else
+          u_[activeSize_ - 1] = t;
+        isActive_[static_cast<std::size_t> (k + 1)] = true;
+      }
+    const size_type nEqualities = activeSize_;
+
+    int iter = 0;
+    while (!error)
+      {
+        // Select the most violated constraint, starting with the previous
+        // working set.
+        size_type p = -1;
+        value_type sp = -tol;
+        if (warmStart)
+          for (std::size_t j = 0; j < workingSet_.size (); ++j)
+            {
+              const size_type k = workingSet_[j];
+              if (isActive_[static_cast<std::size_t> (k)])
+                continue;
+              const value_type s = slack (k);
+              if (s < sp)
+                {
+                  sp = s;
+                  p = k;
+                }
+            }
+        if (p < 0)
+          for (size_type k = 0; k < nConstraints; ++k)
+            {
+              if (isActive_[static_cast<std::size_t> (k)])
+                continue;
+              const value_type s = slack (k);
+              if (s < sp)
+                {
+                  sp = s;
+                  p = k;
+                }
+            }
+
+        if (p < 0)
+          break;
+
+        if (iter >= maxIterations)
+          {
+            warning = "active-set-qp: maximum number of iterations reached";
+            break;
+          }
+        ++iter;
+
+        // Move towards the feasible region of p, dropping the constraints
+        // whose multiplier vanishes on the way.
+        value_type uPlus = 0.;
+        while (true)
+          {
+            computeDirections (p);
+
+            value_type t1 = inf;
+            size_type l = -1;
+            for (size_type j = nEqualities; j < activeSize_; ++j)
+              if (r_[j] > 0. && u_[j] / r_[j] < t1)
+                {
+                  t1 = u_[j] / r_[j];
+                  l = j;
+                }
+
+            const value_type t2 =
+              z_.squaredNorm () > std::numeric_limits<value_type>::epsilon ()
+              ? -sp / normalDot (p, z_) : inf;
+            const value_type t = std::min (t1, t2);
+
+            if (t == inf)
+              {
+                error = "active-set-qp: the constraints are infeasible";
+                break;
+              }
+
+            u_.head (activeSize_) -= t * r_.head (activeSize_);
+            uPlus += t;
+
+            if (t2 == inf)
+              {
+                // Dual step only.
+                dropConstraint (l);
+                continue;
+              }
+
+            x_ += t * z_;
+            if (t2 <= t1)
+              {
+                // Full step: p becomes active.
+                if (!addConstraint (p))
+                  error = "active-set-qp: the constraints are infeasible";
+                else
+                  u_[activeSize_ - 1] = uPlus;
+                break;
+              }
+
+            // Partial step.
+            dropConstraint (l);
+            sp = slack (p);
+          }
+        if (error)
+          break;
+
+        state_.setParameter (iteration_, iter);
+        state_.setParameter (activeConstraints_,
+                             static_cast<int> (activeSize_));
+
+        if (callback_)
+          {
+            set_is_malloc_allowed (true);
+            state_.x () = x_;
+            z_.noalias () = H_ * x_;
+            state_.cost () = .5 * x_.dot (z_) + q_.dot (x_) + c_;
+            state_.constraintViolation () = std::max (-sp, 0.);
+            callback_ (pb, state_);
+            set_is_malloc_allowed (false);
+          }
+
+        if (state_.parameter (stop_))
+          {
+            warning = "active-set-qp: stopped by the iteration callback";
+            break;
+          }
+      }
+
+    set_is_malloc_allowed (true);
+
+    if (error)
+      {
+        workingSet_.clear ();
+        this->result_ = SolverError (error);
+        return;
+      }
+
+    workingSet_.assign (active_.begin (), active_.begin () + activeSize_);
+
+    Result res (n, 1);
+    res.x = x_;
+    z_.noalias () = H_ * x_;
+    res.value[0] = .5 * x_.dot (z_) + q_.dot (x_) + c_;
+
+    res.constraints.resize (m);
+    value_type violation = 0.;
+    for (size_type i = 0; i < n + m; ++i)
+      {
+        const value_type v = value (i, x_);
+        if (i >= n)
+          res.constraints[i - n] = v;
+        violation = std::max (violation, std::max (lower_[i] - v,
+                                                   v - upper_[i]));
+      }
+    res.constraint_violation = violation;
+
+    // Multipliers: positive for lower bounds, negative for upper bounds.
+    res.lambda = vector_t::Zero (n + m);
+    for (size_type j = 0; j < activeSize_; ++j)
+      {
+        const size_type k = active_[static_cast<std::size_t> (j)];
+        res.lambda[k / 2] += k % 2 ? -u_[j] : u_[j];
+      }
+
+    if (warning)
+      res.warnings.push_back (SolverWarning (warning));
+    this->result_ = res;
+  }
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_PLUGIN_ACTIVE_SET_QP_HXX
@@ -0,0 +1,213 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_PLUGIN_AUGMENTED_LAGRANGIAN_HH
+# define ROBOPTIM_CORE_PLUGIN_AUGMENTED_LAGRANGIAN_HH
+
+# include <cstddef>
+# include <string>
+# include <vector>
+
+# include <boost/shared_ptr.hpp>
+
+# include <roboptim/core/compiled-problem.hh>
+# include <roboptim/core/detail/thread-pool.hh>
+# include <roboptim/core/differentiable-function.hh>
+# include <roboptim/core/solver.hh>
+# include <roboptim/core/solver-factory.hh>
+# include <roboptim/core/solver-state.hh>
+
+namespace roboptim
+{
+  /// \brief Augmented Lagrangian solver for sparse nonlinear problems.
+  ///
+  /// The general constraints \f$l \leq g(x) \leq u\f$ are moved into the
+  /// cost with the Powell-Hestenes-Rockafellar augmented Lagrangian
+  /// \f[L_\rho(x, \mu) = f(x) + \frac{\rho}{2} \sum_i
+  /// d\left(g_i(x) + \frac{\mu_i}{\rho}, [l_i, u_i]\right)^2\f]
+  /// d being the distance to the interval. Each outer iteration minimizes
+  /// \f$L_\rho\f$ subject to the argument bounds only, then updates the
+  /// multipliers:
+  /// \f[\mu_i \leftarrow \rho \left(g_i(x) + \frac{\mu_i}{\rho}
+  /// - P_{[l_i, u_i]}\left(g_i(x) + \frac{\mu_i}{\rho}\right)\right)\f]
+  /// The penalty \f$\rho\f$ is increased when the infeasibility and
+  /// complementarity measure does not decrease fast enough, and the
+  /// multiplier estimates are safeguarded (as in ALGENCAN).
+  ///
+  /// The bound-constrained subproblems are solved by another plug-in
+  /// (``lbfgsb'' by default, see the ``al.inner-solver'' parameter) on a
+  /// dense problem whose cost is the augmented Lagrangian. Its tolerance
+  /// is tightened along the outer iterations.
+  ///
+  /// Constraints are evaluated through the sparse Jacobian API, one
+  /// constraint at a time, in preallocated buffers. They are independent,
+  /// so they can be evaluated by several threads (see ``al.threads''),
+  /// created once per solve. Constraints sharing the same function object
+  /// are always evaluated by the same thread, but distinct function
+  /// objects must not share mutable data (e.g. a function used by two
+  /// Chain operators). Apart from the code of the functions, evaluating
+  /// the augmented Lagrangian and its gradient does not allocate memory.
+  ///
+  /// The multipliers of the constraints are stored in Result::lambda after
+  /// the bound multipliers given by the inner solver, with the usual sign
+  /// convention (positive for lower bounds).
+  ///
+  /// The iteration callback is called after each outer iteration. The
+  /// solver supports cooperative interruption through the ``al.stop''
+  /// state parameter (see SolverState::requestStop).
+  class AugmentedLagrangianSolver : public Solver<EigenMatrixSparse>
+  {
+  public:
+    /// \brief Define parent's type.
+    typedef Solver<EigenMatrixSparse> parent_t;
+
+    /// \brief Differentiable function type.
+    typedef GenericDifferentiableFunction<EigenMatrixSparse> function_t;
+
+    /// \brief Import types from the function.
+    typedef function_t::value_type value_type;
+    typedef function_t::size_type size_type;
+    typedef function_t::gradient_t gradient_t;
+    typedef function_t::jacobian_t jacobian_t;
+
+    /// \brief Solver of the bound-constrained subproblems.
+    typedef Solver<EigenMatrixDense> innerSolver_t;
+
+    /// \brief Build a solver from a problem.
+    /// \param problem problem that will be solved
+    explicit AugmentedLagrangianSolver (const problem_t& problem);
+
+    virtual ~AugmentedLagrangianSolver ();
+
+    /// \brief Solve the problem.
+    virtual void solve ();
+
+    virtual void setIterationCallback (callback_t callback);
+
+    /// \brief Current state of the solver.
+    const solverState_t& solverState () const;
+
+  private:
+    /// \brief Augmented Lagrangian, minimized by the inner solver.
+    class Lagrangian;
+
+    /// \brief Factory of the inner solver.
+    typedef SolverFactory<innerSolver_t> innerFactory_t;
+
+    /// \brief Create or update the inner solver.
+    /// \return whether the inner solver is available.
+    bool prepareInnerSolver (const std::string& plugin);
+
+    /// \brief Evaluate the constraints (and their Jacobians) at x.
+    ///
+    /// The last point is cached, since the inner solver usually evaluates
+    /// the cost and its gradient at the same point.
+    void evaluateConstraints (DifferentiableFunction::const_argument_ref x,
+                              bool jacobian);
+
+    /// \brief Assign the constraints to the threads.
+    void partitionConstraints (std::size_t threads);
+
+    /// \brief Evaluate the constraints assigned to a thread.
+    void evaluateConstraintPartition (std::size_t thread);
+
+    /// \brief Update the shifted multipliers at the current constraint
+    /// values: \f$\rho (g + \mu / \rho - P(g + \mu / \rho))\f$.
+    void computeShiftedMultipliers ();
+
+    /// \brief Value of the augmented Lagrangian.
+    value_type lagrangian (DifferentiableFunction::const_argument_ref x);
+
+    /// \brief Gradient of the augmented Lagrangian.
+    void lagrangianGradient (DifferentiableFunction::const_argument_ref x,
+                             DifferentiableFunction::gradient_ref gradient);
+
+    /// \brief Iteration callback.
+    callback_t callback_;
+
+    /// \brief Current state of the solver.
+    solverState_t state_;
+
+    /// \brief State parameters.
+    StateParameterHandle<bool> stop_;
+    StateParameterHandle<int> iteration_;
+    StateParameterHandle<value_type> penalty_;
+
+    /// \brief Compiled problem.
+    boost::shared_ptr<CompiledProblem<EigenMatrixSparse> > compiled_;
+
+    /// \brief Differentiable cost function.
+    const function_t* cost_;
+
+    /// \brief Augmented Lagrangian.
+    boost::shared_ptr<Lagrangian> lagrangian_;
+
+    /// \brief Inner solver factory, and its plug-in.
+    boost::shared_ptr<innerFactory_t> innerFactory_;
+    std::string innerPlugin_;
+
+    /// \brief Threads evaluating the constraints (null if there is only
+    /// one thread).
+    boost::shared_ptr<detail::ThreadPool> pool_;
+
+    /// \brief Task of the threads, evaluating their constraints.
+    detail::ThreadPool::task_t evaluationTask_;
+
+    /// \brief Indices of the constraints evaluated by each thread.
+    std::vector<std::vector<std::size_t> > partition_;
+
+    /// \brief Whether the current evaluation computes the Jacobians.
+    bool evaluateJacobians_;
+
+    /// \brief Penalty.
+    value_type rho_;
+
+    /// \brief Bounds of the stacked constraints.
+    vector_t lower_;
+    vector_t upper_;
+
+    /// \brief Safeguarded multiplier estimates.
+    vector_t mu_;
+
+    /// \brief Shifted multipliers at the current constraint values.
+    vector_t shifted_;
+
+    /// \brief Current point.
+    vector_t x_;
+
+    /// \brief Point of the cached constraint values.
+    vector_t xEval_;
+
+    /// \brief Whether the cache holds values and Jacobians.
+    bool valuesValid_;
+    bool jacobiansValid_;
+
+    /// \brief Stacked constraint values.
+    vector_t g_;
+
+    /// \brief Cost value buffer and gradient.
+    vector_t costValue_;
+    gradient_t costGradient_;
+
+    /// \brief Jacobian of each constraint.
+    std::vector<jacobian_t> jacobians_;
+  };
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_PLUGIN_AUGMENTED_LAGRANGIAN_HH
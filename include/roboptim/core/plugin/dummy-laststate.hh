@@ -32,6 +32,12 @@ namespace roboptim
   /// constraints etc.). These values can be obtained thanks to
   /// SolverError::lastState.
   ///
+  /// The solver also demonstrates warm starts (see Solver::resolve): the
+  /// last state is allocated once, and when the problem is solved again
+  /// after an update of the starting point, the last state starts from the
+  /// new starting point. The updates processed by the last call to resolve
+  /// are given by lastUpdates ().
+  ///
   /// This solver always fails but is always available
   /// as it does not rely on the plug-in mechanism.
   ///
@@ -76,11 +82,31 @@ namespace roboptim
       return callback_;
     }
 
+    /// \brief Updates processed by the last call to resolve ().
+    /// \return combination of problemUpdate_t flags
+    unsigned int lastUpdates () const
+    {
+      return lastUpdates_;
+    }
+
     /// \brief Intermediate callback (called at each end of iteration).
     callback_t callback_;
 
     /// \brief Current state of the solver (used by the callback function).
     solverState_t solverState_;
+
+  protected:
+    /// \brief Process the updates of the problem (warm start).
+    virtual void updateProblem (unsigned int updates);
+
+    /// \brief Workspace storing the last state of the solver.
+    Result lastState_;
+
+    /// \brief Whether the solver is warm started from the starting point.
+    bool warmStart_;
+
+    /// \brief Updates processed by the last call to resolve ().
+    unsigned int lastUpdates_;
   };
 
   typedef GenericDummySolverLastState<EigenMatrixDense> DummySolverLastState;
@@ -24,7 +24,10 @@ namespace roboptim
   (const problem_t& pb)
     : parent_t (pb),
       callback_ (),
-      solverState_ (pb)
+      solverState_ (pb),
+      lastState_ (pb.function ().inputSize (), pb.function ().outputSize ()),
+      warmStart_ (false),
+      lastUpdates_ (0)
   {
     parent_t::parameters_["dummy-parameter"].description = "dummy parameter";
     parent_t::parameters_["dummy-parameter"].value = 42.;
@@ -52,9 +55,11 @@ namespace roboptim
   void GenericDummySolverLastState<T>::solve ()
   {
     // Set some dummy values for the last state of the solver
-    Result res (parent_t::problem ().function ().inputSize (),
-                parent_t::problem ().function ().outputSize ());
-    res.x.fill (1337);
+    Result& res = lastState_;
+    if (warmStart_)
+      res.x = *parent_t::problem ().startingPoint ();
+    else
+      res.x.fill (1337);
     res.constraints.fill (0);
     res.lambda.fill (0);
     res.value.fill (42);
@@ -72,4 +77,15 @@ namespace roboptim
     parent_t::result_ = SolverError ("The dummy solver always fail.", res);
   }
 
+  template <typename T>
+  void GenericDummySolverLastState<T>::updateProblem (unsigned int updates)
+  {
+    // A real solver would update its workspaces here, instead of
+    // rebuilding them from scratch.
+    if (updates & parent_t::STARTING_POINT_UPDATE)
+      warmStart_ = true;
+
+    lastUpdates_ = updates;
+  }
+
 } // end of namespace roboptim
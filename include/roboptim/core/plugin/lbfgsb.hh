@@ -0,0 +1,222 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_PLUGIN_LBFGSB_HH
+# define ROBOPTIM_CORE_PLUGIN_LBFGSB_HH
+
+# include <utility>
+# include <vector>
+
+# include <Eigen/LU>
+
+# include <roboptim/core/differentiable-function.hh>
+# include <roboptim/core/solver.hh>
+# include <roboptim/core/solver-state.hh>
+
+namespace roboptim
+{
+  /// \brief Limited-memory BFGS solver for bound-constrained problems
+  /// (L-BFGS-B).
+  ///
+  /// This solver minimizes a differentiable cost function subject to
+  /// argument bounds only (general constraints are not supported). It
+  /// follows Byrd, Lu, Nocedal and Zhu, "A Limited Memory Algorithm for
+  /// Bound Constrained Optimization" (1995):
+  ///
+  /// - the Hessian approximation uses the compact representation
+  ///   \f$B = \theta I - W M W^T\f$, built from the last ``lbfgsb.memory''
+  ///   correction pairs,
+  /// - the generalized Cauchy point is computed along the projected
+  ///   gradient path, which identifies the active bounds,
+  /// - the quadratic model is then minimized over the free variables
+  ///   (direct primal method), and a backtracking line search is done
+  ///   between the current point and the resulting point.
+  ///
+  /// All the workspaces are allocated when solving starts: the iterations
+  /// do not allocate memory (this is checked when RobOptim is built with
+  /// EIGEN_RUNTIME_NO_MALLOC).
+  ///
+  /// The iteration callback is called after each iteration. The solver
+  /// supports cooperative interruption through the ``lbfgsb.stop'' state
+  /// parameter (see SolverState::requestStop).
+  class LbfgsbSolver : public Solver<EigenMatrixDense>
+  {
+  public:
+    /// \brief Define parent's type.
+    typedef Solver<EigenMatrixDense> parent_t;
+
+    /// \brief Value type.
+    typedef problem_t::value_type value_type;
+
+    /// \brief Size type.
+    typedef problem_t::size_type size_type;
+
+    /// \brief Matrix type.
+    typedef Eigen::Matrix<value_type, Eigen::Dynamic, Eigen::Dynamic>
+    matrix_t;
+
+    /// \brief Build a solver from a problem.
+    /// \param problem problem that will be solved
+    explicit LbfgsbSolver (const problem_t& problem);
+
+    virtual ~LbfgsbSolver ();
+
+    /// \brief Solve the problem.
+    virtual void solve ();
+
+    virtual void setIterationCallback (callback_t callback);
+
+    /// \brief Current state of the solver.
+    const solverState_t& solverState () const;
+
+  private:
+    /// \brief Breakpoint of the projected gradient path: (time, index).
+    typedef std::pair<value_type, size_type> breakpoint_t;
+
+    /// \brief Allocate the workspaces.
+    ///
+    /// \param n number of variables.
+    /// \param m number of correction pairs.
+    void allocate (size_type n, size_type m);
+
+    /// \brief Forget the correction pairs (B = I).
+    void resetMemory ();
+
+    /// \brief Add a correction pair and update the compact representation.
+    ///
+    /// \return whether the pair was accepted (curvature condition).
+    bool updateMemory ();
+
+    /// \brief Compute the generalized Cauchy point xCauchy_, and c_ =
+    /// W^T (xCauchy_ - x_).
+    void computeCauchyPoint ();
+
+    /// \brief Minimize the quadratic model over the free variables, starting
+    /// from the Cauchy point. The result is stored in xBar_.
+    void minimizeSubspace ();
+
+    /// \brief Infinity norm of the projected gradient.
+    value_type projectedGradientNorm () const;
+
+    /// \brief Evaluate the cost and the gradient at x.
+    value_type evaluate (const vector_t& x, vector_t& g);
+
+    /// \brief Iteration callback.
+    callback_t callback_;
+
+    /// \brief Current state of the solver.
+    solverState_t state_;
+
+    /// \brief State parameters.
+    StateParameterHandle<bool> stop_;
+    StateParameterHandle<int> iteration_;
+    StateParameterHandle<value_type> projectedGradient_;
+
+    /// \brief Differentiable cost function.
+    const DifferentiableFunction* function_;
+
+    /// \brief Argument bounds.
+    vector_t lb_;
+    vector_t ub_;
+
+    /// \brief Current point, gradient and cost.
+    vector_t x_;
+    vector_t g_;
+    value_type f_;
+
+    /// \brief Previous point and gradient.
+    vector_t xPrevious_;
+    vector_t gPrevious_;
+
+    /// \brief Cost value buffer.
+    vector_t value_;
+
+    /// \brief Generalized Cauchy point.
+    vector_t xCauchy_;
+
+    /// \brief Result of the subspace minimization.
+    vector_t xBar_;
+
+    /// \brief Search direction.
+    vector_t direction_;
+
+    /// \brief Projected gradient path direction.
+    vector_t d_;
+
+    /// \brief Reduced gradient and subspace step (free variables only).
+    vector_t r_;
+    vector_t du_;
+
+    /// \brief Correction pairs s = x_{k+1} - x_k, y = g_{k+1} - g_k.
+    vector_t s_;
+    vector_t y_;
+
+    /// \brief Correction pairs, oldest first (n x m).
+    matrix_t S_;
+    matrix_t Y_;
+
+    /// \brief S^T S and S^T Y (m x m).
+    matrix_t SS_;
+    matrix_t SY_;
+
+    /// \brief W = [Y, theta S] (n x 2m).
+    matrix_t W_;
+
+    /// \brief Inverse of the middle matrix M, and M (2m x 2m).
+    matrix_t Minv_;
+    matrix_t M_;
+
+    /// \brief Identity matrix (2m x 2m).
+    matrix_t identity_;
+
+    /// \brief Subspace minimization matrices (2m x 2m).
+    matrix_t WtW_;
+    matrix_t N_;
+
+    /// \brief LU decompositions of Minv_ and N_.
+    Eigen::PartialPivLU<matrix_t> luM_;
+    Eigen::PartialPivLU<matrix_t> luN_;
+
+    /// \brief 2m-vectors of the Cauchy point computation.
+    vector_t p_;
+    vector_t c_;
+    vector_t wb_;
+    vector_t Mp_;
+    vector_t Mc_;
+    vector_t Mw_;
+    vector_t v_;
+    vector_t Nv_;
+
+    /// \brief Breakpoints of the projected gradient path.
+    std::vector<breakpoint_t> breakpoints_;
+
+    /// \brief Free variables at the Cauchy point.
+    std::vector<size_type> free_;
+
+    /// \brief Scaling of the Hessian approximation.
+    value_type theta_;
+
+    /// \brief Maximum number of correction pairs.
+    size_type memory_;
+
+    /// \brief Number of stored correction pairs.
+    size_type pairs_;
+  };
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_PLUGIN_LBFGSB_HH
@@ -0,0 +1,284 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_PLUGIN_LEVENBERG_MARQUARDT_HH
+# define ROBOPTIM_CORE_PLUGIN_LEVENBERG_MARQUARDT_HH
+
+# include <vector>
+
+# include <Eigen/Cholesky>
+# include <Eigen/Sparse>
+
+# include <roboptim/core/differentiable-function.hh>
+# include <roboptim/core/solver.hh>
+# include <roboptim/core/solver-state.hh>
+# include <roboptim/core/sum-of-c1-squares.hh>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    /// \brief Damped normal equations of a least-squares problem:
+    /// \f$(J^T J + \mu I) \delta = -J^T r\f$.
+    ///
+    /// \tparam T matrix type
+    template <typename T>
+    class NormalEquations;
+
+    /// \brief Dense normal equations, solved by a Cholesky decomposition.
+    template <>
+    class NormalEquations<EigenMatrixDense>
+    {
+    public:
+      typedef GenericDifferentiableFunction<EigenMatrixDense> function_t;
+      typedef function_t::value_type value_type;
+      typedef function_t::size_type size_type;
+      typedef function_t::vector_t vector_t;
+      typedef function_t::matrix_t matrix_t;
+      typedef function_t::jacobian_t jacobian_t;
+
+      /// \brief Allocate the workspaces.
+      /// \param n number of variables.
+      void resize (size_type n);
+
+      /// \brief Compute J^T J.
+      void update (const jacobian_t& jacobian);
+
+      /// \brief Largest diagonal coefficient of J^T J.
+      value_type maxDiagonal () const;
+
+      /// \brief Solve the damped normal equations.
+      ///
+      /// \param mu damping.
+      /// \param gradient J^T r, zero for the fixed variables.
+      /// \param fixed variables that are not moved (active bounds).
+      /// \param delta step.
+      /// \return whether the decomposition succeeded.
+      bool solve (value_type mu, const vector_t& gradient,
+                  const std::vector<bool>& fixed, vector_t& delta);
+
+    private:
+      /// \brief J^T J.
+      matrix_t JtJ_;
+
+      /// \brief Damped matrix.
+      matrix_t damped_;
+
+      /// \brief Cholesky decomposition of the damped matrix.
+      Eigen::LLT<matrix_t> llt_;
+    };
+
+    /// \brief Sparse normal equations, solved by a sparse Cholesky
+    /// decomposition.
+    ///
+    /// The sparsity pattern of the damped matrix and its symbolic analysis
+    /// are only computed again when the sparsity pattern of J changes.
+    /// Otherwise, J^T J is refilled in place from the values of J.
+    template <>
+    class NormalEquations<EigenMatrixSparse>
+    {
+    public:
+      typedef GenericDifferentiableFunction<EigenMatrixSparse> function_t;
+      typedef function_t::value_type value_type;
+      typedef function_t::size_type size_type;
+      typedef function_t::vector_t vector_t;
+      typedef function_t::jacobian_t jacobian_t;
+      typedef Eigen::SparseMatrix<value_type, Eigen::ColMajor> matrix_t;
+
+      NormalEquations ();
+
+      void resize (size_type n);
+      void update (const jacobian_t& jacobian);
+      value_type maxDiagonal () const;
+      bool solve (value_type mu, const vector_t& gradient,
+                  const std::vector<bool>& fixed, vector_t& delta);
+
+    private:
+      /// \brief Index type.
+      typedef matrix_t::StorageIndex index_t;
+
+      /// \brief Contribution of a pair of Jacobian coefficients of the same
+      /// row to a coefficient of J^T J.
+      struct Product
+      {
+        /// \brief Indices of the Jacobian coefficients.
+        index_t lhs;
+        index_t rhs;
+
+        /// \brief Index of the coefficient of J^T J (in damped_).
+        index_t target;
+      };
+
+      /// \brief Whether the sparsity pattern of J is the analyzed one.
+      bool samePattern (const jacobian_t& jacobian) const;
+
+      /// \brief Compute the sparsity pattern of the damped matrix, and
+      /// its symbolic analysis.
+      void analyzePattern (const jacobian_t& jacobian);
+
+      /// \brief Damped matrix: pattern of J^T J, and of the diagonal.
+      matrix_t damped_;
+
+      /// \brief Values of J^T J, in the order of the values of damped_.
+      vector_t normal_;
+
+      /// \brief Values of J, in the order of the analyzed pattern.
+      vector_t jacobianValues_;
+
+      /// \brief Products of Jacobian coefficients making up J^T J.
+      std::vector<Product> products_;
+
+      /// \brief Indices of the diagonal coefficients (in damped_).
+      std::vector<index_t> diagonal_;
+
+      /// \brief Sparse Cholesky decomposition of the damped matrix.
+      Eigen::SimplicialLDLT<matrix_t> ldlt_;
+
+      /// \brief Analyzed sparsity pattern of J.
+      std::vector<index_t> outerIndices_;
+      std::vector<index_t> innerIndices_;
+
+      /// \brief Whether the symbolic analysis was done.
+      bool analyzed_;
+    };
+  } // end of namespace detail
+
+  /// \brief Levenberg-Marquardt solver for nonlinear least squares.
+  ///
+  /// The cost function has to be a GenericSumOfC1Squares: the solver works
+  /// on the residuals r and on the Jacobian J of the base function, instead
+  /// of the gradient of the sum of squares. Each iteration solves the
+  /// damped normal equations
+  /// \f[(J^T J + \mu I) \delta = -J^T r\f]
+  /// with a dense or sparse Cholesky decomposition (depending on T), and
+  /// the damping \f$\mu\f$ is updated from the ratio between the actual
+  /// and the predicted cost reductions (Nielsen's strategy). With
+  /// \f$\mu \to 0\f$, the step is the Gauss-Newton step.
+  ///
+  /// Argument bounds are handled as in projected Newton methods: the
+  /// variables on an active bound (i.e. the gradient pushes them outside)
+  /// are fixed, and the trial points are projected on the bounds. General
+  /// constraints are not supported.
+  ///
+  /// The iteration callback is called after each iteration. The solver
+  /// supports cooperative interruption through the ``lm.stop'' state
+  /// parameter (see SolverState::requestStop).
+  ///
+  /// \tparam T matrix type
+  template <typename T>
+  class GenericLevenbergMarquardtSolver : public Solver<T>
+  {
+  public:
+    /// \brief Define parent's type.
+    typedef Solver<T> parent_t;
+
+    /// \brief Problem type.
+    typedef typename parent_t::problem_t problem_t;
+
+    /// \brief Callback function type.
+    typedef typename parent_t::callback_t callback_t;
+
+    /// \brief Type of the state of the solver.
+    typedef typename parent_t::solverState_t solverState_t;
+
+    /// \brief Differentiable function type.
+    typedef GenericDifferentiableFunction<T> function_t;
+
+    /// \brief Sum of squares type.
+    typedef GenericSumOfC1Squares<T> sumOfSquares_t;
+
+    /// \brief Import types from the function.
+    typedef typename function_t::value_type value_type;
+    typedef typename function_t::size_type size_type;
+    typedef typename function_t::vector_t vector_t;
+    typedef typename function_t::jacobian_t jacobian_t;
+
+    /// \brief Build a solver from a problem.
+    /// \param problem problem that will be solved
+    explicit GenericLevenbergMarquardtSolver (const problem_t& problem);
+
+    virtual ~GenericLevenbergMarquardtSolver ();
+
+    /// \brief Solve the problem.
+    virtual void solve ();
+
+    virtual void setIterationCallback (callback_t callback);
+
+    /// \brief Current state of the solver.
+    const solverState_t& solverState () const;
+
+  private:
+    /// \brief Evaluate the residuals at x.
+    /// \return half of the sum of squares.
+    value_type evaluate (const vector_t& x, vector_t& residuals);
+
+    /// \brief Project x on the argument bounds.
+    void project (vector_t& x) const;
+
+    /// \brief Iteration callback.
+    callback_t callback_;
+
+    /// \brief Current state of the solver.
+    solverState_t state_;
+
+    /// \brief State parameters.
+    StateParameterHandle<bool> stop_;
+    StateParameterHandle<int> iteration_;
+    StateParameterHandle<value_type> damping_;
+
+    /// \brief Residuals (base function of the sum of squares).
+    const function_t* residuals_;
+
+    /// \brief Normal equations.
+    detail::NormalEquations<T> normalEquations_;
+
+    /// \brief Current point, residuals and Jacobian.
+    vector_t x_;
+    vector_t r_;
+    jacobian_t J_;
+
+    /// \brief Gradient of the half sum of squares: J^T r.
+    vector_t g_;
+
+    /// \brief Gradient with respect to the free variables.
+    vector_t gFree_;
+
+    /// \brief Variables fixed on an active bound.
+    std::vector<bool> fixed_;
+
+    /// \brief Step, trial point and trial residuals.
+    vector_t delta_;
+    vector_t xTrial_;
+    vector_t rTrial_;
+
+    /// \brief J delta.
+    vector_t Jdelta_;
+  };
+
+  /// \brief Dense Levenberg-Marquardt solver.
+  typedef GenericLevenbergMarquardtSolver<EigenMatrixDense>
+  LevenbergMarquardtSolver;
+
+  /// \brief Sparse Levenberg-Marquardt solver.
+  typedef GenericLevenbergMarquardtSolver<EigenMatrixSparse>
+  LevenbergMarquardtSparseSolver;
+
+} // end of namespace roboptim
+
+# include <roboptim/core/plugin/levenberg-marquardt.hxx>
+
+#endif //! ROBOPTIM_CORE_PLUGIN_LEVENBERG_MARQUARDT_HH
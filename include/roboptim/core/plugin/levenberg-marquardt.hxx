@@ -0,0 +1,517 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_PLUGIN_LEVENBERG_MARQUARDT_HXX
+# define ROBOPTIM_CORE_PLUGIN_LEVENBERG_MARQUARDT_HXX
+
+# include <algorithm>
+# include <cmath>
+# include <utility>
+
+# include <roboptim/core/result.hh>
+# include <roboptim/core/solver-error.hh>
+# include <roboptim/core/solver-warning.hh>
+
+namespace roboptim
+{
+  namespace detail
+  {
+    inline void
+    NormalEquations<EigenMatrixDense>::resize (size_type n)
+    {
+      JtJ_.resize (n, n);
+      damped_.resize (n, n);
+    }
+
+    inline void
+    NormalEquations<EigenMatrixDense>::update (const jacobian_t& jacobian)
+    {
+      JtJ_.noalias () = jacobian.transpose () * jacobian;
+    }
+
+    inline NormalEquations<EigenMatrixDense>::value_type
+    NormalEquations<EigenMatrixDense>::maxDiagonal () const
+    {
+      return JtJ_.diagonal ().maxCoeff ();
+    }
+
+    inline bool
+    NormalEquations<EigenMatrixDense>::solve (value_type mu,
+                                              const vector_t& gradient,
+                                              const std::vector<bool>& fixed,
+                                              vector_t& delta)
+    {
+      damped_ = JtJ_;
+      damped_.diagonal ().array () += mu;
+      for (size_type i = 0; i < damped_.rows (); ++i)
+        if (fixed[static_cast<std::size_t> (i)])
+          {
+            damped_.row (i).setZero ();
+            damped_.col (i).setZero ();
+            damped_ (i, i) = 1.;
+          }
+      llt_.compute (damped_);
+      if (llt_.info () != Eigen::Success)
+        return false;
+
+      delta = llt_.solve (gradient);
+      delta = -delta;
+      return true;
+    }
+
+    inline
+    NormalEquations<EigenMatrixSparse>::NormalEquations ()
+      : damped_ (),
+        normal_ (),
+        jacobianValues_ (),
+        products_ (),
+        diagonal_ (),
+        ldlt_ (),
+        outerIndices_ (),
+        innerIndices_ (),
+        analyzed_ (false)
+    {
+    }
+
+    inline void
+    NormalEquations<EigenMatrixSparse>::resize (size_type n)
+    {
+      damped_.resize (n, n);
+      analyzed_ = false;
+    }
+
+    inline bool
+    NormalEquations<EigenMatrixSparse>::samePattern
+    (const jacobian_t& jacobian) const
+    {
+      if (!analyzed_
+          || outerIndices_.size ()
+          != static_cast<std::size_t> (jacobian.outerSize ()) + 1)
+        return false;
+
+      std::size_t k = 0;
+      for (jacobian_t::Index o = 0; o < jacobian.outerSize (); ++o)
+        {
+          for (jacobian_t::InnerIterator it (jacobian, o); it; ++it, ++k)
+            if (k >= innerIndices_.size ()
+                || innerIndices_[k] != it.index ())
+              return false;
+          if (k != static_cast<std::size_t>
+              (outerIndices_[static_cast<std::size_t> (o) + 1]))
+            return false;
+        }
+      return true;
+    }
+
+    inline void
+    NormalEquations<EigenMatrixSparse>::analyzePattern
+    (const jacobian_t& jacobian)
+    {
+      typedef Eigen::Triplet<value_type, index_t> triplet_t;
+
+      // Pattern of J, and coefficients of each row of J (column, index).
+      const std::size_t rows = static_cast<std::size_t> (jacobian.rows ());
+      std::vector<std::vector<std::pair<index_t, index_t> > > entries (rows);
+      outerIndices_.assign (1, 0);
+      innerIndices_.clear ();
+      for (jacobian_t::Index o = 0; o < jacobian.outerSize (); ++o)
+        {
+          for (jacobian_t::InnerIterator it (jacobian, o); it; ++it)
+            {
+              const index_t k = static_cast<index_t> (innerIndices_.size ());
+              entries[static_cast<std::size_t> (it.row ())].push_back
+                (std::make_pair (static_cast<index_t> (it.col ()), k));
+              innerIndices_.push_back (static_cast<index_t> (it.index ()));
+            }
+          outerIndices_.push_back
+            (static_cast<index_t> (innerIndices_.size ()));
+        }
+
+      // Pattern of J^T J + I.
+      const index_t n = static_cast<index_t> (jacobian.cols ());
+      std::vector<triplet_t> triplets;
+      for (index_t i = 0; i < n; ++i)
+        triplets.push_back (triplet_t (i, i, 0.));
+      for (std::size_t r = 0; r < rows; ++r)
+        for (std::size_t a = 0; a < entries[r].size (); ++a)
+          for (std::size_t b = 0; b < entries[r].size (); ++b)
+            triplets.push_back
+              (triplet_t (entries[r][a].first, entries[r][b].first, 0.));
+      damped_.resize (n, n);
+      damped_.setFromTriplets (triplets.begin (), triplets.end ());
+      damped_.makeCompressed ();
+
+      // Index of the (row, col) coefficient in the values of damped_.
+      const index_t* outer = damped_.outerIndexPtr ();
+      const index_t* inner = damped_.innerIndexPtr ();
+      products_.clear ();
+      for (std::size_t r = 0; r < rows; ++r)
+        for (std::size_t a = 0; a < entries[r].size (); ++a)
+          for (std::size_t b = 0; b < entries[r].size (); ++b)
+            {
+              const index_t row = entries[r][a].first;
+              const index_t col = entries[r][b].first;
+              Product product;
+              product.lhs = entries[r][a].second;
+              product.rhs = entries[r][b].second;
+              product.target = static_cast<index_t>
+                (std::lower_bound (inner + outer[col], inner + outer[col + 1],
+                                   row) - inner);
+              products_.push_back (product);
+            }
+      diagonal_.resize (static_cast<std::size_t> (n));
+      for (index_t i = 0; i < n; ++i)
+        diagonal_[static_cast<std::size_t> (i)] = static_cast<index_t>
+          (std::lower_bound (inner + outer[i], inner + outer[i + 1], i)
+           - inner);
+
+      normal_.resize (damped_.nonZeros ());
+      jacobianValues_.resize
+        (static_cast<size_type> (innerIndices_.size ()));
+
+      ldlt_.analyzePattern (damped_);
+      analyzed_ = true;
+    }
+
+    inline void
+    NormalEquations<EigenMatrixSparse>::update (const jacobian_t& jacobian)
+    {
+      if (!samePattern (jacobian))
+        analyzePattern (jacobian);
+
+      size_type k = 0;
+      for (jacobian_t::Index o = 0; o < jacobian.outerSize (); ++o)
+        for (jacobian_t::InnerIterator it (jacobian, o); it; ++it, ++k)
+          jacobianValues_[k] = it.value ();
+
+      normal_.setZero ();
+      for (std::size_t i = 0; i < products_.size (); ++i)
+        normal_[products_[i].target] +=
+          jacobianValues_[products_[i].lhs]
+          * jacobianValues_[products_[i].rhs];
+    }
+
+    inline NormalEquations<EigenMatrixSparse>::value_type
+    NormalEquations<EigenMatrixSparse>::maxDiagonal () const
+    {
+      value_type max = 0.;
+      for (std::size_t i = 0; i < diagonal_.size (); ++i)
+        max = std::max (max, normal_[diagonal_[i]]);
+      return max;
+    }
+
+    inline bool
+    NormalEquations<EigenMatrixSparse>::solve (value_type mu,
+                                               const vector_t& gradient,
+                                               const std::vector<bool>& fixed,
+                                               vector_t& delta)
+    {
+      // Refill the values of the damped matrix, whose pattern was analyzed.
+      Eigen::Map<vector_t> (damped_.valuePtr (), damped_.nonZeros ()) =
+        normal_;
+      for (std::size_t i = 0; i < diagonal_.size (); ++i)
+        damped_.valuePtr ()[diagonal_[i]] += mu;
+
+      // Decouple the fixed variables, without changing the pattern.
+      for (matrix_t::Index k = 0; k < damped_.outerSize (); ++k)
+        for (matrix_t::InnerIterator it (damped_, k); it; ++it)
+          if (fixed[static_cast<std::size_t> (it.row ())]
+              || fixed[static_cast<std::size_t> (it.col ())])
+            it.valueRef () = it.row () == it.col () ? 1. : 0.;
+
+      ldlt_.factorize (damped_);
+      if (ldlt_.info () != Eigen::Success)
+        return false;
+
+      delta = ldlt_.solve (gradient);
+      delta = -delta;
+      return true;
+    }
+  } // end of namespace detail
+
+  template <typename T>
+  GenericLevenbergMarquardtSolver<T>::GenericLevenbergMarquardtSolver
+  (const problem_t& pb)
+    : parent_t (pb),
+      callback_ (),
+      state_ (pb),
+      stop_ (),
+      iteration_ (),
+      damping_ (),
+      residuals_ (0),
+      normalEquations_ (),
+      x_ (),
+      r_ (),
+      J_ (),
+      g_ (),
+      gFree_ (),
+      fixed_ (),
+      delta_ (),
+      xTrial_ (),
+      rTrial_ (),
+      Jdelta_ ()
+  {
+    parent_t::parameters_["lm.max-iterations"].description =
+      "maximum number of iterations";
+    parent_t::parameters_["lm.max-iterations"].value = 100;
+
+    parent_t::parameters_["lm.initial-damping"].description =
+      "initial damping, relative to the largest diagonal coefficient"
+      " of J^T J";
+    parent_t::parameters_["lm.initial-damping"].value = 1e-3;
+
+    parent_t::parameters_["lm.gtol"].description =
+      "tolerance on the infinity norm of the projected gradient";
+    parent_t::parameters_["lm.gtol"].value = 1e-10;
+
+    parent_t::parameters_["lm.xtol"].description =
+      "tolerance on the relative norm of the step";
+    parent_t::parameters_["lm.xtol"].value = 1e-10;
+
+    parent_t::parameters_["lm.ftol"].description =
+      "tolerance on the relative reduction of the cost";
+    parent_t::parameters_["lm.ftol"].value = 1e-10;
+
+    stop_ = state_.registerParameter
+      ("lm.stop", "whether to stop the optimization", false);
+    iteration_ = state_.registerParameter
+      ("lm.iteration", "current iteration", 0);
+    damping_ = state_.registerParameter
+      ("lm.damping", "current damping", value_type (0.));
+  }
+
+  template <typename T>
+  GenericLevenbergMarquardtSolver<T>::~GenericLevenbergMarquardtSolver ()
+  {
+  }
+
+  template <typename T>
+  void
+  GenericLevenbergMarquardtSolver<T>::setIterationCallback
+  (callback_t callback)
+  {
+    callback_ = callback;
+  }
+
+  template <typename T>
+  const typename GenericLevenbergMarquardtSolver<T>::solverState_t&
+  GenericLevenbergMarquardtSolver<T>::solverState () const
+  {
+    return state_;
+  }
+
+  template <typename T>
+  void
+  GenericLevenbergMarquardtSolver<T>::solve ()
+  {
+    const problem_t& pb = this->problem ();
+
+    if (!pb.constraints ().empty ())
+      {
+        this->result_ = SolverError
+          ("levenberg-marquardt: only argument bounds are supported");
+        return;
+      }
+
+    const sumOfSquares_t* cost =
+      dynamic_cast<const sumOfSquares_t*> (&pb.function ());
+    if (!cost)
+      {
+        this->result_ = SolverError
+          ("levenberg-marquardt: the cost function must be a sum of C1"
+           " squares");
+        return;
+      }
+    residuals_ = cost->baseFunction ().get ();
+
+    const int maxIterations = this->template getParameter<int>
+      ("lm.max-iterations");
+    const value_type tau = this->template getParameter<value_type>
+      ("lm.initial-damping");
+    const value_type gtol = this->template getParameter<value_type>
+      ("lm.gtol");
+    const value_type xtol = this->template getParameter<value_type>
+      ("lm.xtol");
+    const value_type ftol = this->template getParameter<value_type>
+      ("lm.ftol");
+
+    const size_type n = residuals_->inputSize ();
+    const size_type m = residuals_->outputSize ();
+
+    x_.resize (n);
+    r_.resize (m);
+    J_.resize (m, n);
+    g_.resize (n);
+    gFree_.resize (n);
+    fixed_.resize (static_cast<std::size_t> (n));
+    delta_.resize (n);
+    xTrial_.resize (n);
+    rTrial_.resize (m);
+    Jdelta_.resize (m);
+    normalEquations_.resize (n);
+
+    if (pb.startingPoint ())
+      x_ = *pb.startingPoint ();
+    else
+      x_.setZero ();
+    project (x_);
+
+    state_.setParameter (stop_, false);
+    state_.setParameter (iteration_, 0);
+
+    // Half of the sum of squares.
+    value_type f = evaluate (x_, r_);
+    J_.setZero ();
+    residuals_->jacobian (J_, x_);
+    g_ = J_.transpose () * r_;
+    normalEquations_.update (J_);
+
+    value_type mu = tau * normalEquations_.maxDiagonal ();
+    if (!(mu > 0.))
+      mu = tau;
+    value_type nu = 2.;
+    state_.setParameter (damping_, mu);
+
+    const char* warning = 0;
+    bool converged = false;
+    int iter = 0;
+    while (iter < maxIterations)
+      {
+        // Projected gradient and active bounds.
+        value_type pgNorm = 0.;
+        for (size_type i = 0; i < n; ++i)
+          {
+            const value_type lb = pb.argumentLowerBounds ()[i];
+            const value_type ub = pb.argumentUpperBounds ()[i];
+            const value_type xi = std::min (std::max (x_[i] - g_[i], lb), ub);
+            pgNorm = std::max (pgNorm, std::abs (xi - x_[i]));
+
+            const bool fixed =
+              (x_[i] <= lb && g_[i] > 0.) || (x_[i] >= ub && g_[i] < 0.);
+            fixed_[static_cast<std::size_t> (i)] = fixed;
+            gFree_[i] = fixed ? 0. : g_[i];
+          }
+        if (pgNorm <= gtol)
+          {
+            converged = true;
+            break;
+          }
+
+        ++iter;
+        bool accepted = false;
+        bool small = false;
+        value_type reduction = 0.;
+
+        if (normalEquations_.solve (mu, gFree_, fixed_, delta_))
+          {
+            xTrial_ = x_ + delta_;
+            project (xTrial_);
+            delta_ = xTrial_ - x_;
+
+            if (delta_.norm () <= xtol * (x_.norm () + xtol))
+              small = true;
+            else
+              {
+                const value_type fTrial = evaluate (xTrial_, rTrial_);
+
+                // Reduction predicted by the Gauss-Newton model.
+                Jdelta_ = J_ * delta_;
+                const value_type predicted =
+                  -g_.dot (delta_) - .5 * Jdelta_.squaredNorm ();
+                const value_type rho =
+                  predicted > 0. ? (f - fTrial) / predicted : -1.;
+
+                if (rho > 0.)
+                  {
+                    accepted = true;
+                    reduction = f - fTrial;
+                    x_.swap (xTrial_);
+                    r_.swap (rTrial_);
+                    f = fTrial;
+
+                    J_.setZero ();
+                    residuals_->jacobian (J_, x_);
+                    g_ = J_.transpose () * r_;
+                    normalEquations_.update (J_);
+
+                    const value_type t = 2. * rho - 1.;
+                    mu *= std::max (1. / 3., 1. - t * t * t);
+                    nu = 2.;
+                  }
+              }
+          }
+
+        if (!accepted && !small)
+          {
+            mu *= nu;
+            nu *= 2.;
+          }
+        state_.setParameter (damping_, mu);
+
+        state_.x () = x_;
+        state_.cost () = 2. * f;
+        state_.constraintViolation () = 0.;
+        state_.setParameter (iteration_, iter);
+
+        if (callback_)
+          callback_ (pb, state_);
+
+        if (state_.parameter (stop_))
+          {
+            warning = "levenberg-marquardt: stopped by the iteration callback";
+            break;
+          }
+
+        if (small || (accepted && reduction <= ftol * (f + reduction)))
+          {
+            converged = true;
+            break;
+          }
+      }
+
+    if (!converged && !warning)
+      warning = "levenberg-marquardt: maximum number of iterations reached";
+
+    Result res (n, 1);
+    res.x = x_;
+    res.value[0] = 2. * f;
+    res.constraint_violation = 0.;
+    if (warning)
+      res.warnings.push_back (SolverWarning (warning));
+    this->result_ = res;
+  }
+
+  template <typename T>
+  typename GenericLevenbergMarquardtSolver<T>::value_type
+  GenericLevenbergMarquardtSolver<T>::evaluate (const vector_t& x,
+                                                vector_t& residuals)
+  {
+    (*residuals_) (residuals, x);
+    return .5 * residuals.squaredNorm ();
+  }
+
+  template <typename T>
+  void
+  GenericLevenbergMarquardtSolver<T>::project (vector_t& x) const
+  {
+    x = x.cwiseMax (this->problem ().argumentLowerBounds ())
+      .cwiseMin (this->problem ().argumentUpperBounds ());
+  }
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_PLUGIN_LEVENBERG_MARQUARDT_HXX
@@ -0,0 +1,231 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_PORTFOLIO_SOLVER_HH
+# define ROBOPTIM_CORE_PORTFOLIO_SOLVER_HH
+
+# include <cstddef>
+# include <string>
+# include <vector>
+
+# include <boost/function.hpp>
+# include <boost/optional.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/condition_variable.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/thread.hpp>
+
+# include <roboptim/core/fwd.hh>
+# include <roboptim/core/portability.hh>
+# include <roboptim/core/solver.hh>
+# include <roboptim/core/solver-factory.hh>
+
+namespace roboptim
+{
+  /// \addtogroup roboptim_solver
+  /// @{
+
+  /// \brief Portfolio of solvers racing on the same problem.
+  ///
+  /// Which plug-in performs best usually depends on the problem instance.
+  /// This solver runs several plug-ins concurrently (one thread per
+  /// plug-in) on the same problem, and keeps the first result that meets a
+  /// convergence criterion. The other solvers are then cancelled
+  /// cooperatively: their iteration callback requests them to stop (see
+  /// SolverState::requestStop).
+  ///
+  /// solve () returns as soon as a plug-in wins the race (or once all the
+  /// plug-ins failed). The other plug-ins keep running in the background
+  /// until they stop: plug-ins that support neither the iteration callback
+  /// nor cooperative interruption run to completion. They are joined by
+  /// join (), the next solve () or the destructor.
+  ///
+  /// The functions of the problem are shared between the threads, so they
+  /// have to be reentrant.
+  ///
+  /// The solver parameters are forwarded to the plug-in solvers (except the
+  /// ``portfolio.'' ones), so that plug-in specific parameters can be set
+  /// on the portfolio.
+  ///
+  /// \tparam T matrix type
+  template <typename T>
+  class PortfolioSolver : public Solver<T>
+  {
+  public:
+    /// \brief Parent type.
+    typedef Solver<T> parent_t;
+
+    /// \brief Problem type.
+    typedef typename parent_t::problem_t problem_t;
+
+    /// \brief Value type.
+    typedef typename problem_t::value_type value_type;
+
+    /// \brief Callback type.
+    typedef typename parent_t::callback_t callback_t;
+
+    /// \brief Solver state type.
+    typedef typename parent_t::solverState_t solverState_t;
+
+    /// \brief Result type.
+    typedef typename parent_t::result_t result_t;
+
+    /// \brief Factory of the solvers of the plug-ins.
+    typedef SolverFactory<parent_t> factory_t;
+
+    /// \brief Vector of plug-in names.
+    typedef std::vector<std::string> plugins_t;
+
+    /// \brief Convergence criterion.
+    ///
+    /// Return whether the result of a solver is acceptable. By default, any
+    /// Result is accepted.
+    typedef boost::function<bool (const Result&)> criterion_t;
+
+    /// \brief Statistics of a plug-in of the portfolio.
+    struct PluginStatistics
+    {
+      PluginStatistics ();
+
+      /// \brief Name of the plug-in.
+      std::string plugin;
+
+      /// \brief Kind of result of the plug-in.
+      GenericSolver::solutions status;
+
+      /// \brief Final cost (NaN if the plug-in failed).
+      value_type cost;
+
+      /// \brief Number of iterations (i.e. calls to the iteration callback).
+      std::size_t iterations;
+
+      /// \brief Whether the result met the convergence criterion.
+      bool converged;
+
+      /// \brief Whether the plug-in was cancelled.
+      bool cancelled;
+
+      /// \brief Wall-clock time of the plug-in (in seconds).
+      double time;
+
+      /// \brief Error message (if the plug-in failed).
+      std::string error;
+    };
+
+    /// \brief Vector of plug-in statistics.
+    typedef std::vector<PluginStatistics> statistics_t;
+
+    /// \brief Build a portfolio solver.
+    ///
+    /// \param problem problem that will be solved
+    /// \param plugins names of the plug-ins of the portfolio
+    /// \throw std::runtime_error if the portfolio is empty.
+    PortfolioSolver (const problem_t& problem, const plugins_t& plugins);
+
+    virtual ~PortfolioSolver ();
+
+    /// \brief Race the plug-ins on the problem.
+    ///
+    /// The result is the result of the winner, or a SolverError if no
+    /// plug-in converged.
+    ///
+    /// \throw std::runtime_error if a plug-in can not be loaded.
+    virtual void solve ();
+
+    /// \brief Wait for the plug-ins still running after the last solve.
+    ///
+    /// The statistics of these plug-ins are updated until they stop, so
+    /// they should only be read after joining them.
+    void join ();
+
+    /// \brief Set the per-iteration callback.
+    ///
+    /// The callback is called for the iterations of all the plug-ins,
+    /// including the ones still running after solve () returned. Calls are
+    /// serialized.
+    virtual void setIterationCallback (callback_t callback);
+
+    /// \brief Set the convergence criterion.
+    void setConvergenceCriterion (criterion_t criterion);
+
+    /// \brief Names of the plug-ins of the portfolio.
+    const plugins_t& plugins () const;
+
+    /// \brief Statistics of each plug-in for the last solve.
+    const statistics_t& statistics () const;
+
+    /// \brief Index of the plug-in that won the last solve (if any).
+    const boost::optional<std::size_t>& winner () const;
+
+    /// \brief Display the solver on the specified output stream.
+    ///
+    /// \param o output stream used for display
+    /// \return output stream
+    virtual std::ostream& print (std::ostream& o) const;
+
+  private:
+    /// \brief Solve the problem with the i-th plug-in.
+    void run (std::size_t i, parent_t& solver);
+
+    /// \brief Iteration callback of the plug-in solvers.
+    void iterate (std::size_t i, const problem_t& problem,
+                  solverState_t& state);
+
+    /// \brief Forward the solver parameters to a plug-in solver.
+    void forwardParameters (parent_t& solver) const;
+
+    /// \brief Names of the plug-ins.
+    plugins_t plugins_;
+
+    /// \brief Convergence criterion.
+    criterion_t criterion_;
+
+    /// \brief User iteration callback.
+    callback_t callback_;
+
+    /// \brief Statistics of the plug-ins.
+    statistics_t statistics_;
+
+    /// \brief Winner of the race.
+    boost::optional<std::size_t> winner_;
+
+    /// \brief Factories of the solvers of the last solve.
+    std::vector<boost::shared_ptr<factory_t> > factories_;
+
+    /// \brief Threads of the plug-ins of the last solve.
+    std::vector<boost::shared_ptr<boost::thread> > threads_;
+
+    /// \brief Number of plug-ins still running.
+    std::size_t running_;
+
+    /// \brief Protects the winner, the statistics, the result and the
+    /// number of plug-ins still running.
+    boost::mutex mutex_;
+
+    /// \brief Notified when a plug-in stops.
+    boost::condition_variable finished_;
+
+    /// \brief Serializes the calls to the user iteration callback.
+    boost::mutex callbackMutex_;
+  };
+
+  /// @}
+
+} // end of namespace roboptim
+
+# include <roboptim/core/portfolio-solver.hxx>
+#endif //! ROBOPTIM_CORE_PORTFOLIO_SOLVER_HH
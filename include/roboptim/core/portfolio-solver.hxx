@@ -0,0 +1,290 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_PORTFOLIO_SOLVER_HXX
+# define ROBOPTIM_CORE_PORTFOLIO_SOLVER_HXX
+
+# include <limits>
+# include <stdexcept>
+
+# include <boost/bind.hpp>
+# include <boost/date_time/posix_time/posix_time_types.hpp>
+# include <boost/make_shared.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/locks.hpp>
+# include <boost/thread/thread.hpp>
+
+# include <roboptim/core/io.hh>
+
+namespace roboptim
+{
+  template <typename T>
+  PortfolioSolver<T>::PluginStatistics::PluginStatistics ()
+    : plugin (),
+      status (GenericSolver::SOLVER_NO_SOLUTION),
+      cost (std::numeric_limits<value_type>::quiet_NaN ()),
+      iterations (0),
+      converged (false),
+      cancelled (false),
+      time (0.),
+      error ()
+  {
+  }
+
+  template <typename T>
+  PortfolioSolver<T>::PortfolioSolver (const problem_t& pb,
+                                       const plugins_t& plugins)
+    : parent_t (pb),
+      plugins_ (plugins),
+      criterion_ (),
+      callback_ (),
+      statistics_ (),
+      winner_ (),
+      factories_ (),
+      threads_ (),
+      running_ (0),
+      mutex_ (),
+      finished_ (),
+      callbackMutex_ ()
+  {
+    if (plugins_.empty ())
+      throw std::runtime_error ("portfolio: no plug-in");
+  }
+
+  template <typename T>
+  PortfolioSolver<T>::~PortfolioSolver ()
+  {
+    join ();
+  }
+
+  template <typename T>
+  void
+  PortfolioSolver<T>::solve ()
+  {
+    // The plug-ins still running from the last solve use the statistics.
+    join ();
+
+    std::size_t n = plugins_.size ();
+
+    statistics_.assign (n, PluginStatistics ());
+    winner_.reset ();
+
+    // Create the solvers in the calling thread, so that plug-in errors are
+    // reported to the caller.
+    for (std::size_t i = 0; i < n; ++i)
+      {
+        statistics_[i].plugin = plugins_[i];
+
+        factories_.push_back (boost::make_shared<factory_t>
+                              (plugins_[i], this->problem_));
+        parent_t& solver = (*factories_[i]) ();
+        forwardParameters (solver);
+
+        try
+          {
+            solver.setIterationCallback
+              (boost::bind (&PortfolioSolver<T>::iterate, this, i, _1, _2));
+          }
+        catch (const std::runtime_error&)
+          {
+            // Iteration callbacks are not supported: this solver can not be
+            // cancelled.
+          }
+      }
+
+    // Return as soon as a plug-in wins: the others keep running in the
+    // background until they stop.
+    boost::unique_lock<boost::mutex> lock (mutex_);
+    running_ = n;
+    for (std::size_t i = 0; i < n; ++i)
+      threads_.push_back
+        (boost::make_shared<boost::thread>
+         (boost::bind (&PortfolioSolver<T>::run, this, i,
+                       boost::ref ((*factories_[i]) ()))));
+    while (!winner_ && running_ > 0)
+      finished_.wait (lock);
+
+    if (!winner_)
+      this->result_ = SolverError ("portfolio: no plug-in converged");
+  }
+
+  template <typename T>
+  void
+  PortfolioSolver<T>::join ()
+  {
+    for (std::size_t i = 0; i < threads_.size (); ++i)
+      threads_[i]->join ();
+    threads_.clear ();
+    factories_.clear ();
+  }
+
+  template <typename T>
+  void
+  PortfolioSolver<T>::run (std::size_t i, parent_t& solver)
+  {
+    PluginStatistics stats;
+
+    result_t result;
+    boost::posix_time::ptime start =
+      boost::posix_time::microsec_clock::universal_time ();
+    try
+      {
+        result = solver.minimum ();
+
+        switch (result.which ())
+          {
+          case GenericSolver::SOLVER_VALUE:
+            stats.status = GenericSolver::SOLVER_VALUE;
+            stats.cost = boost::get<Result> (result).value[0];
+            break;
+          case GenericSolver::SOLVER_ERROR:
+            stats.status = GenericSolver::SOLVER_ERROR;
+            stats.error = boost::get<SolverError> (result).what ();
+            break;
+          default:
+            break;
+          }
+      }
+    catch (const std::exception& e)
+      {
+        stats.status = GenericSolver::SOLVER_ERROR;
+        stats.error = e.what ();
+      }
+    catch (...)
+      {
+        stats.status = GenericSolver::SOLVER_ERROR;
+        stats.error = "unknown exception";
+      }
+    stats.time = static_cast<double>
+      ((boost::posix_time::microsec_clock::universal_time () - start)
+       .total_microseconds ()) * 1e-6;
+
+    // The criterion is evaluated under the lock, so that it does not have
+    // to be thread-safe.
+    boost::mutex::scoped_lock lock (mutex_);
+    PluginStatistics& shared = statistics_[i];
+    shared.status = stats.status;
+    shared.cost = stats.cost;
+    shared.time = stats.time;
+    shared.error = stats.error;
+    if (shared.status == GenericSolver::SOLVER_VALUE)
+      shared.converged = !criterion_
+        || criterion_ (boost::get<Result> (result));
+
+    if (shared.converged && !winner_ && !shared.cancelled)
+      {
+        winner_ = i;
+        this->result_ = result;
+      }
+
+    --running_;
+    finished_.notify_all ();
+  }
+
+  template <typename T>
+  void
+  PortfolioSolver<T>::iterate (std::size_t i, const problem_t& problem,
+                               solverState_t& state)
+  {
+    bool cancel;
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      PluginStatistics& stats = statistics_[i];
+      ++stats.iterations;
+      cancel = winner_ && !stats.cancelled;
+    }
+
+    if (callback_)
+      {
+        boost::mutex::scoped_lock lock (callbackMutex_);
+        callback_ (problem, state);
+      }
+
+    if (cancel && state.requestStop ())
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        statistics_[i].cancelled = true;
+      }
+  }
+
+  template <typename T>
+  void
+  PortfolioSolver<T>::forwardParameters (parent_t& solver) const
+  {
+    static const std::string prefix ("portfolio.");
+
+    typedef typename parent_t::parameters_t::const_iterator citer_t;
+    for (citer_t it = this->parameters_.begin ();
+         it != this->parameters_.end (); ++it)
+      if (it->first.compare (0, prefix.size (), prefix) != 0)
+        solver.parameters ()[it->first] = it->second;
+  }
+
+  template <typename T>
+  void
+  PortfolioSolver<T>::setIterationCallback (callback_t callback)
+  {
+    callback_ = callback;
+  }
+
+  template <typename T>
+  void
+  PortfolioSolver<T>::setConvergenceCriterion (criterion_t criterion)
+  {
+    criterion_ = criterion;
+  }
+
+  template <typename T>
+  const typename PortfolioSolver<T>::plugins_t&
+  PortfolioSolver<T>::plugins () const
+  {
+    return plugins_;
+  }
+
+  template <typename T>
+  const typename PortfolioSolver<T>::statistics_t&
+  PortfolioSolver<T>::statistics () const
+  {
+    return statistics_;
+  }
+
+  template <typename T>
+  const boost::optional<std::size_t>&
+  PortfolioSolver<T>::winner () const
+  {
+    return winner_;
+  }
+
+  template <typename T>
+  std::ostream&
+  PortfolioSolver<T>::print (std::ostream& o) const
+  {
+    parent_t::print (o);
+
+    o << incindent << iendl << "Portfolio:" << incindent;
+    for (std::size_t i = 0; i < plugins_.size (); ++i)
+      o << iendl << plugins_[i];
+    o << decindent;
+    if (winner_)
+      o << iendl << "Winner: " << plugins_[*winner_];
+    o << decindent;
+    return o;
+  }
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_PORTFOLIO_SOLVER_HXX
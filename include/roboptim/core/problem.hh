@@ -35,6 +35,83 @@
 
 namespace roboptim
 {
+  namespace detail
+  {
+    /// \brief Cache used by Problem::jacobian to fill a Jacobian matrix in
+    /// place.
+    ///
+    /// Dense Jacobian matrices are filled block by block and do not need
+    /// any cached data.
+    ///
+    /// \tparam T matrix type
+    template <typename T>
+    struct ProblemJacobianCache
+    {
+      /// \brief Invalidate the cache (e.g. when constraints change).
+      void invalidate ()
+      {}
+    };
+
+    /// \brief Cache used by Problem::jacobian to fill a sparse Jacobian
+    /// matrix in place.
+    ///
+    /// The stacked sparsity pattern is computed during the first evaluation.
+    /// Later evaluations reuse the per-constraint buffers and only copy the
+    /// nonzero values to their precomputed location in the stacked matrix.
+    template <>
+    struct ProblemJacobianCache<EigenMatrixSparse>
+    {
+      /// \brief Sparse Jacobian type.
+      typedef GenericFunctionTraits<EigenMatrixSparse>::jacobian_t jacobian_t;
+
+      /// \brief Index type used by the mapping.
+      typedef jacobian_t::Index index_t;
+
+      /// \brief Differentiable function type.
+      typedef GenericDifferentiableFunction<EigenMatrixSparse>
+      differentiableFunction_t;
+
+      ProblemJacobianCache ()
+        : valid (false),
+          functionsValid (false),
+          functions (),
+          buffers (),
+          patterns (),
+          pattern (),
+          map ()
+      {}
+
+      /// \brief Invalidate the cache (e.g. when constraints change).
+      void invalidate ()
+      {
+        valid = false;
+        functionsValid = false;
+      }
+
+      /// \brief Whether the cached sparsity patterns can be used.
+      bool valid;
+
+      /// \brief Whether the list of differentiable functions is up to date.
+      bool functionsValid;
+
+      /// \brief Differentiable functions whose Jacobians are stacked.
+      std::vector<const differentiableFunction_t*> functions;
+
+      /// \brief Jacobian buffer of each differentiable constraint.
+      std::vector<jacobian_t> buffers;
+
+      /// \brief Sparsity pattern of each differentiable constraint (as
+      /// evaluated during the last structure update).
+      std::vector<jacobian_t> patterns;
+
+      /// \brief Stacked sparsity pattern.
+      jacobian_t pattern;
+
+      /// \brief Position in the stacked value array of each nonzero value of
+      /// the constraint buffers (in the order of the buffers).
+      std::vector<index_t> map;
+    };
+  } // end of namespace detail
 
   /// \addtogroup roboptim_problem
   /// @{
@@ -103,6 +180,12 @@ namespace roboptim
     /// \brief Result type.
     typedef typename function_t::result_t result_t;
 
+    /// \brief Reference to a result vector.
+    typedef typename function_t::result_ref result_ref;
+
+    /// \brief Constant reference to a result vector.
+    typedef typename function_t::const_result_ref const_result_ref;
+
     /// \brief Size type.
     typedef typename function_t::size_type size_type;
 
@@ -153,6 +236,9 @@ namespace roboptim
     /// \brief Jacobian matrix type.
     typedef typename GenericFunctionTraits<T>::jacobian_t jacobian_t;
 
+    /// \brief Reference to a Jacobian matrix.
+    typedef typename GenericFunctionTraits<T>::jacobian_ref jacobian_ref;
+
     /// \brief Constant reference to an argument vector.
     typedef typename GenericFunctionTraits<T>::const_argument_ref
     const_argument_ref;
@@ -174,6 +260,12 @@ namespace roboptim
     ROBOPTIM_CORE_DEPRECATED explicit Problem (const function_t& cost);
 
     /// \brief Copy constructor.
+    ///
+    /// The copy shares the data of pb until one of the problems is modified,
+    /// so copying a problem does not copy its bounds, scaling, names, etc.
+    /// Note that references previously obtained through non-const accessors
+    /// of pb should not be used to modify it once it has been copied.
+    ///
     /// \param pb problem to copy.
     explicit Problem (const Problem<T>& pb);
 
@@ -195,6 +287,14 @@ namespace roboptim
 
     /// \brief Retrieve arguments bounds.
     /// Arguments bounds define in which interval each argument is valid.
+    ///
+    /// The data of the problem is no longer shared by the copies made
+    /// after this call, since it may be modified through the returned
+    /// reference (see setArgumentBounds). Modifications made through the
+    /// reference after a call to argumentLowerBounds () or
+    /// argumentUpperBounds () are only seen by these methods once this
+    /// method is called again.
+    ///
     /// \return arguments bounds
     intervals_t& argumentBounds ();
 
@@ -203,6 +303,35 @@ namespace roboptim
     /// \return arguments bounds
     const intervals_t& argumentBounds () const;
 
+    /// \brief Change the arguments bounds.
+    ///
+    /// Contrary to argumentBounds (), this does not prevent the copies of
+    /// the problem from sharing its data.
+    ///
+    /// \param bounds new arguments bounds
+    void setArgumentBounds (const intervals_t& bounds);
+
+    /// \brief Change the bounds of an argument.
+    ///
+    /// \param i index of the argument
+    /// \param bounds new bounds of the argument
+    /// \throw std::runtime_error if the index is invalid.
+    void setArgumentBounds (std::size_t i, const interval_t& bounds);
+
+    /// \brief Retrieve the lower bounds of the arguments.
+    ///
+    /// This is a structure-of-arrays view of argumentBounds (), which is
+    /// updated lazily, after setArgumentBounds () or argumentBounds () (non
+    /// const) were called.
+    ///
+    /// \return lower bounds of the arguments
+    const vector_t& argumentLowerBounds () const;
+
+    /// \brief Retrieve the upper bounds of the arguments.
+    /// \see argumentLowerBounds
+    /// \return upper bounds of the arguments
+    const vector_t& argumentUpperBounds () const;
+
     /// \brief Retrieve arguments scaling.
     /// Arguments scaling define which scale factor is applied for each argument.
     /// \return arguments scaling
@@ -273,6 +402,29 @@ namespace roboptim
     /// \return constraints bounds vector
     const intervalsVect_t& boundsVector () const;
 
+    /// \brief Change the bounds of a constraint.
+    ///
+    /// This updates both boundsVector () and the stacked bounds, and does
+    /// not change the structure of the problem.
+    ///
+    /// \param i index of the constraint
+    /// \param intervals new interval vector of the constraint
+    /// \throw std::runtime_error
+    void setConstraintBounds (std::size_t i, const intervals_t& intervals);
+
+    /// \brief Retrieve the lower bounds of the stacked constraints.
+    ///
+    /// This is a structure-of-arrays view of boundsVector (), i.e. the
+    /// lower bounds of all the constraints stacked in a single vector.
+    ///
+    /// \return lower bounds of the stacked constraints
+    const vector_t& constraintsLowerBounds () const;
+
+    /// \brief Retrieve the upper bounds of the stacked constraints.
+    /// \see constraintsLowerBounds
+    /// \return upper bounds of the stacked constraints
+    const vector_t& constraintsUpperBounds () const;
+
     /// \brief Retrieve constraints scaling vector.
     /// \return constraints scaling vector
     const scalingVect_t& scalingVector () const;
@@ -297,6 +449,10 @@ namespace roboptim
     /// \{
 
     /// \brief Set the initial guess.
+    ///
+    /// The data of the problem is no longer shared by the copies made
+    /// after this call (see setStartingPoint).
+    ///
     /// \return reference on the initial guess
     /// \throw std::runtime_error
     startingPoint_t& startingPoint ();
@@ -306,6 +462,15 @@ namespace roboptim
     /// \throw std::runtime_error
     const startingPoint_t& startingPoint () const;
 
+    /// \brief Change the initial guess.
+    ///
+    /// Contrary to startingPoint (), this does not prevent the copies of
+    /// the problem from sharing its data.
+    ///
+    /// \param x new initial guess
+    /// \throw std::runtime_error
+    void setStartingPoint (const_argument_ref x);
+
     /// \}
 
 
@@ -320,16 +485,56 @@ namespace roboptim
     /// \return jacobian matrix evaluated at x.
     jacobian_t jacobian (const_argument_ref x) const;
 
+    /// \brief Evaluate the Jacobian matrix of the problem for a given x,
+    /// and store it in a preallocated matrix.
+    ///
+    /// Dense matrices have to be of the proper size, i.e.
+    /// (differentiableConstraintsOutputSize (), n).
+    ///
+    /// For sparse matrices, the stacked sparsity pattern is computed during
+    /// the first call and cached in the problem. Later calls only update the
+    /// nonzero values of the matrix, as long as the sparsity pattern of the
+    /// constraints does not change. The matrix should either be empty, or a
+    /// matrix that was previously filled by this method.
+    ///
+    /// Note: since the cache is updated by this method, a given problem
+    /// should not be used concurrently by several threads.
+    ///
+    /// \param jac Jacobian matrix evaluated at x.
+    /// \param x evaluation point.
+    void jacobian (jacobian_ref jac, const_argument_ref x) const;
+
+    /// \brief Evaluate all the constraints for a given x, and stack their
+    /// values in a single vector.
+    ///
+    /// \param g stacked constraint values, of size constraintsOutputSize ().
+    /// \param x evaluation point.
+    void constraints (result_ref g, const_argument_ref x) const;
+
     /// \brief Evaluate the sum of constraint violations for a given x.
     /// This takes into account both argument bounds and constraint bounds.
     ///
     /// \param x evaluation point.
     /// \return constraint violation at x.
-    /// \tparam ALG Eigen norm used for the reduction, e.g. 1 or
+    /// \tparam NORM Eigen norm used for the reduction, e.g. 1 or
     /// Eigen::Infinity.
     template <int NORM>
     value_type constraintsViolation (const_argument_ref x) const;
 
+    /// \brief Evaluate the sum of constraint violations for a given x and
+    /// the stacked constraint values g(x).
+    /// This takes into account both argument bounds and constraint bounds,
+    /// and does not allocate any memory.
+    ///
+    /// \param x evaluation point.
+    /// \param g stacked constraint values at x (see constraints ()).
+    /// \return constraint violation at x.
+    /// \tparam NORM Eigen norm used for the reduction, e.g. 1 or
+    /// Eigen::Infinity.
+    template <int NORM>
+    value_type constraintsViolation (const_argument_ref x,
+                                     const_result_ref g) const;
+
     /// \}
 
 
@@ -343,6 +548,90 @@ namespace roboptim
     /// \brief Initialize attributes and do some checking.
     void initialize ();
 
+    /// \brief Update the structure-of-arrays arguments bounds if needed.
+    void updateArgumentBounds () const;
+
+    /// \brief Append constraint bounds to the stacked constraints bounds.
+    /// \param bounds bounds of the new constraint.
+    void appendConstraintBounds (const intervals_t& bounds);
+
+  private:
+    /// \brief Data of the problem, shared between copies.
+    ///
+    /// Copying a problem is cheap: copies share the same data until one of
+    /// them is modified through a non-const method (copy-on-write).
+    ///
+    /// Once a mutable reference on the data has been handed out, the data
+    /// may be modified at any time through it: it is then unshareable, and
+    /// copying the problem copies the data.
+    struct Data
+    {
+      Data ()
+        : startingPoint (),
+          constraints (),
+          boundsVect (),
+          argumentBounds (),
+          argumentLowerBounds (),
+          argumentUpperBounds (),
+          argumentBoundsChanged (true),
+          constraintsLowerBounds (),
+          constraintsUpperBounds (),
+          scalingVect (),
+          argumentScaling (),
+          argumentNames (),
+          shareable (true)
+      {}
+
+      /// \brief Starting point.
+      startingPoint_t startingPoint;
+
+      /// \brief Vector of constraints.
+      constraints_t constraints;
+
+      /// \brief Constraints intervals vector.
+      intervalsVect_t boundsVect;
+
+      /// \brief Arguments intervals.
+      intervals_t argumentBounds;
+
+      /// \brief Lower bounds of the arguments (lazily updated).
+      vector_t argumentLowerBounds;
+
+      /// \brief Upper bounds of the arguments (lazily updated).
+      vector_t argumentUpperBounds;
+
+      /// \brief Whether the arguments bounds may have been modified since
+      /// the last update of argumentLowerBounds and argumentUpperBounds.
+      bool argumentBoundsChanged;
+
+      /// \brief Lower bounds of the stacked constraints.
+      vector_t constraintsLowerBounds;
+
+      /// \brief Upper bounds of the stacked constraints.
+      vector_t constraintsUpperBounds;
+
+      /// \brief Constraints scaling vector.
+      scalingVect_t scalingVect;
+
+      /// \brief Arguments scaling.
+      scaling_t argumentScaling;
+
+      /// \brief Arguments names.
+      names_t argumentNames;
+
+      /// \brief Whether the data may be shared with a copy, i.e. no
+      /// mutable reference on it has been handed out.
+      bool shareable;
+    };
+
+    /// \brief Make sure the data of the problem is not shared with another
+    /// problem before modifying it.
+    void detach ();
+
+    /// \brief Detach the data before handing out a mutable reference on
+    /// it, and mark it unshareable.
+    void detachUnshareable ();
+
   private:
     /// \brief Objective function.
     /// Note: do not give access to this shared_ptr, since for now the legacy
@@ -350,26 +639,15 @@ namespace roboptim
     /// management.
     const boost::shared_ptr<const function_t> function_;
 
-    /// \brief Starting point.
-    startingPoint_t startingPoint_;
-
-    /// \brief Vector of constraints.
-    constraints_t constraints_;
-
-    /// \brief Constraints intervals vector.
-    intervalsVect_t boundsVect_;
-
-    /// \brief Arguments intervals.
-    intervals_t argumentBounds_;
-
-    /// \brief Constraints scaling vector.
-    scalingVect_t scalingVect_;
-
-    /// \brief Arguments scaling.
-    scaling_t argumentScaling_;
+    /// \brief Data of the problem (possibly shared with copies).
+    ///
+    /// The lazily-updated members of the data are only modified while the
+    /// data is not shared (see the copy constructor). Unshareable data is
+    /// never shared.
+    boost::shared_ptr<Data> data_;
 
-    /// \brief Arguments names.
-    names_t argumentNames_;
+    /// \brief Cache used to fill the Jacobian matrix in place.
+    mutable detail::ProblemJacobianCache<T> jacobianCache_;
   };
 
   /// Example shows problem class use.
@@ -19,9 +19,11 @@
 # define ROBOPTIM_CORE_PROBLEM_HXX
 
 # include <algorithm>
+# include <cmath>
 # include <stdexcept>
 
 # include <boost/format.hpp>
+# include <boost/make_shared.hpp>
 # include <boost/variant.hpp>
 # include <boost/variant/get.hpp>
 # include <boost/static_assert.hpp>
@@ -49,13 +51,8 @@ namespace roboptim
     // the function passed, which is just as bad. This prepares the transition
     // to the safer shared_ptr version.
     : function_ (&f, detail::NoopDeleter<function_t> ()),
-      startingPoint_ (),
-      constraints_ (),
-      boundsVect_ (),
-      argumentBounds_ (),
-      scalingVect_ (),
-      argumentScaling_ (),
-      argumentNames_ ()
+      data_ (boost::make_shared<Data> ()),
+      jacobianCache_ ()
   {
     // Initialize attributes.
     initialize ();
@@ -64,13 +61,8 @@ namespace roboptim
   template <typename T>
   Problem<T>::Problem (const boost::shared_ptr<const function_t>& f)
     : function_ (f),
-      startingPoint_ (),
-      constraints_ (),
-      boundsVect_ (),
-      argumentBounds_ (),
-      scalingVect_ (),
-      argumentScaling_ (),
-      argumentNames_ ()
+      data_ (boost::make_shared<Data> ()),
+      jacobianCache_ ()
   {
     // Initialize attributes.
     initialize ();
@@ -83,12 +75,13 @@ namespace roboptim
     ROBOPTIM_ASSERT_MSG (function_.get () != 0, "cost function is unset");
 
     // Initialize bound.
-    argumentBounds_.resize (static_cast<std::size_t> (function_->inputSize ()),
-                            function_t::makeInfiniteInterval ());
+    data_->argumentBounds.resize
+      (static_cast<std::size_t> (function_->inputSize ()),
+       function_t::makeInfiniteInterval ());
 
     // Initialize scaling.
-    argumentScaling_.resize (static_cast<std::size_t> (function_->inputSize ()),
-                             1.);
+    data_->argumentScaling.resize
+      (static_cast<std::size_t> (function_->inputSize ()), 1.);
   }
 
   template <typename T>
@@ -100,14 +93,39 @@ namespace roboptim
   template <typename T>
   Problem<T>::Problem (const Problem<T>& pb)
     : function_ (pb.function_),
-      startingPoint_ (pb.startingPoint_),
-      constraints_ (pb.constraints_),
-      boundsVect_ (pb.boundsVect_),
-      argumentBounds_ (pb.argumentBounds_),
-      scalingVect_ (pb.scalingVect_),
-      argumentScaling_ (pb.argumentScaling_),
-      argumentNames_ (pb.argumentNames_)
+      data_ (),
+      jacobianCache_ ()
   {
+    if (pb.data_->shareable)
+      {
+	// Make sure the shared data will not be modified by const methods.
+	pb.updateArgumentBounds ();
+	data_ = pb.data_;
+      }
+    else
+      {
+	// The data of pb may still be modified through a reference: copy it.
+	// Its arguments bounds cache may be stale.
+	data_ = boost::make_shared<Data> (*pb.data_);
+	data_->shareable = true;
+	data_->argumentBoundsChanged = true;
+      }
+  }
+
+  template <typename T>
+  void
+  Problem<T>::detach ()
+  {
+    if (!data_.unique ())
+      data_ = boost::make_shared<Data> (*data_);
+  }
+
+  template <typename T>
+  void
+  Problem<T>::detachUnshareable ()
+  {
+    detach ();
+    data_->shareable = false;
   }
 
   template <typename T>
@@ -121,7 +139,7 @@ namespace roboptim
   const typename Problem<T>::constraints_t&
   Problem<T>::constraints () const
   {
-    return constraints_;
+    return data_->constraints;
   }
 
   template <typename T>
@@ -139,13 +157,17 @@ namespace roboptim
     // Check that the pointer is not null.
     assert (!!x.get ());
     assert (b.first <= b.second);
-    constraints_.push_back (x);
+    detach ();
+    data_->constraints.push_back (x);
     intervals_t bounds;
     bounds.push_back (b);
-    boundsVect_.push_back (bounds);
+    data_->boundsVect.push_back (bounds);
+    appendConstraintBounds (bounds);
     scaling_t scaling;
     scaling.push_back (s);
-    scalingVect_.push_back (scaling);
+    data_->scalingVect.push_back (scaling);
+
+    jacobianCache_.invalidate ();
   }
 
   template <typename T>
@@ -198,7 +220,8 @@ namespace roboptim
 
     // Check that the pointer is not null.
     assert (!!x.get ());
-    constraints_.push_back (x);
+    detach ();
+    data_->constraints.push_back (x);
 
     // Check that the bounds are correctly defined.
     for (std::size_t i = 0; i < static_cast<std::size_t> (x->outputSize ());
@@ -208,8 +231,11 @@ namespace roboptim
 	assert (interval.first <= interval.second);
       }
 
-    boundsVect_.push_back (b);
-    scalingVect_.push_back (s);
+    data_->boundsVect.push_back (b);
+    appendConstraintBounds (b);
+    data_->scalingVect.push_back (s);
+
+    jacobianCache_.invalidate ();
   }
 
   template <typename T>
@@ -217,7 +243,7 @@ namespace roboptim
   {
     size_type m = 0;
     for (typename constraints_t::const_iterator
-	   c = constraints_.begin (); c != constraints_.end (); ++c)
+	   c = data_->constraints.begin (); c != data_->constraints.end (); ++c)
       {
 	m += (*c)->outputSize ();
       }
@@ -230,7 +256,7 @@ namespace roboptim
   {
     size_type m = 0;
     for (typename constraints_t::const_iterator
-	   c = constraints_.begin (); c != constraints_.end (); ++c)
+	   c = data_->constraints.begin (); c != data_->constraints.end (); ++c)
       {
 	if ((*c)->template asType<GenericDifferentiableFunction<T> > ())
 	  m += (*c)->outputSize ();
@@ -242,57 +268,202 @@ namespace roboptim
   template <typename T>
   void Problem<T>::clearConstraints ()
   {
-    constraints_.clear ();
-    boundsVect_.clear ();
-    scalingVect_.clear ();
+    detach ();
+    data_->constraints.clear ();
+    data_->boundsVect.clear ();
+    data_->constraintsLowerBounds.resize (0);
+    data_->constraintsUpperBounds.resize (0);
+    data_->scalingVect.clear ();
+
+    jacobianCache_.invalidate ();
   }
 
   template <typename T>
   typename Problem<T>::startingPoint_t&
   Problem<T>::startingPoint ()
   {
-    if (startingPoint_ && startingPoint_->size ()
+    detachUnshareable ();
+    if (data_->startingPoint && data_->startingPoint->size ()
 	!= this->function ().inputSize ())
       throw std::runtime_error ("invalid starting point (wrong size)");
-    return startingPoint_;
+    return data_->startingPoint;
   }
 
   template <typename T>
   const typename Problem<T>::startingPoint_t&
   Problem<T>::startingPoint () const
   {
-    if (startingPoint_ && startingPoint_->size ()
+    if (data_->startingPoint && data_->startingPoint->size ()
 	!= this->function ().inputSize ())
       throw std::runtime_error ("invalid starting point (wrong size)");
-    return startingPoint_;
+    return data_->startingPoint;
+  }
+
+  template <typename T>
+  void
+  Problem<T>::setStartingPoint (const_argument_ref x)
+  {
+    if (x.size () != this->function ().inputSize ())
+      throw std::runtime_error ("invalid starting point (wrong size)");
+
+    detach ();
+    data_->startingPoint = argument_t (x);
   }
 
   template <typename T>
   const typename Problem<T>::intervalsVect_t&
   Problem<T>::boundsVector () const
   {
-    return boundsVect_;
+    return data_->boundsVect;
+  }
+
+  template <typename T>
+  void
+  Problem<T>::setConstraintBounds (std::size_t i, const intervals_t& intervals)
+  {
+    if (i >= data_->constraints.size ())
+      throw std::runtime_error ("invalid constraint index");
+
+    if (intervals.size () != data_->boundsVect[i].size ())
+      {
+	boost::format fmt
+	  ("failed to set bounds of constraint '%s': interval vector size is "
+	   "invalid (%d, expected size is %d)");
+	fmt
+	  % data_->constraints[i]->getName ()
+	  % intervals.size ()
+	  % data_->boundsVect[i].size ();
+	throw std::runtime_error (fmt.str ());
+      }
+
+    detach ();
+
+    size_type offset = 0;
+    for (std::size_t j = 0; j < i; ++j)
+      offset += data_->constraints[j]->outputSize ();
+
+    data_->boundsVect[i] = intervals;
+    for (std::size_t j = 0; j < intervals.size (); ++j)
+      {
+        size_type k = offset + static_cast<size_type> (j);
+        data_->constraintsLowerBounds[k] = intervals[j].first;
+        data_->constraintsUpperBounds[k] = intervals[j].second;
+      }
+  }
+
+  template <typename T>
+  void
+  Problem<T>::appendConstraintBounds (const intervals_t& bounds)
+  {
+    size_type m = data_->constraintsLowerBounds.size ();
+    size_type k = static_cast<size_type> (bounds.size ());
+
+    data_->constraintsLowerBounds.conservativeResize (m + k);
+    data_->constraintsUpperBounds.conservativeResize (m + k);
+    for (size_type i = 0; i < k; ++i)
+      {
+        const interval_t& interval = bounds[static_cast<std::size_t> (i)];
+        data_->constraintsLowerBounds[m + i] = interval.first;
+        data_->constraintsUpperBounds[m + i] = interval.second;
+      }
+  }
+
+  template <typename T>
+  const typename Problem<T>::vector_t&
+  Problem<T>::constraintsLowerBounds () const
+  {
+    return data_->constraintsLowerBounds;
+  }
+
+  template <typename T>
+  const typename Problem<T>::vector_t&
+  Problem<T>::constraintsUpperBounds () const
+  {
+    return data_->constraintsUpperBounds;
   }
 
   template <typename T>
   typename Problem<T>::intervals_t&
   Problem<T>::argumentBounds ()
   {
-    return argumentBounds_;
+    // The bounds may be modified through the returned reference.
+    detachUnshareable ();
+    data_->argumentBoundsChanged = true;
+    return data_->argumentBounds;
+  }
+
+  template <typename T>
+  void
+  Problem<T>::setArgumentBounds (const intervals_t& bounds)
+  {
+    detach ();
+    data_->argumentBounds = bounds;
+    data_->argumentBoundsChanged = true;
+  }
+
+  template <typename T>
+  void
+  Problem<T>::setArgumentBounds (std::size_t i, const interval_t& bounds)
+  {
+    if (i >= data_->argumentBounds.size ())
+      throw std::runtime_error ("invalid argument index");
+
+    detach ();
+    data_->argumentBounds[i] = bounds;
+    data_->argumentBoundsChanged = true;
+  }
+
+  template <typename T>
+  void
+  Problem<T>::updateArgumentBounds () const
+  {
+    // The flag is only set on data that is not shared (see detach and the
+    // copy constructor), so const calls never modify shared data.
+    if (!data_->argumentBoundsChanged)
+      return;
+
+    size_type n = static_cast<size_type> (data_->argumentBounds.size ());
+    data_->argumentLowerBounds.resize (n);
+    data_->argumentUpperBounds.resize (n);
+    for (size_type i = 0; i < n; ++i)
+      {
+        const interval_t&
+          interval = data_->argumentBounds[static_cast<std::size_t> (i)];
+        data_->argumentLowerBounds[i] = interval.first;
+        data_->argumentUpperBounds[i] = interval.second;
+      }
+
+    data_->argumentBoundsChanged = false;
+  }
+
+  template <typename T>
+  const typename Problem<T>::vector_t&
+  Problem<T>::argumentLowerBounds () const
+  {
+    updateArgumentBounds ();
+    return data_->argumentLowerBounds;
+  }
+
+  template <typename T>
+  const typename Problem<T>::vector_t&
+  Problem<T>::argumentUpperBounds () const
+  {
+    updateArgumentBounds ();
+    return data_->argumentUpperBounds;
   }
 
   template <typename T>
   const typename Problem<T>::intervals_t&
   Problem<T>::argumentBounds () const
   {
-    return argumentBounds_;
+    return data_->argumentBounds;
   }
 
   template <typename T>
   const typename Problem<T>::scalingVect_t&
   Problem<T>::scalingVector () const
   {
-    return scalingVect_;
+    return data_->scalingVect;
   }
 
   template <typename T>
@@ -306,14 +477,15 @@ namespace roboptim
   typename Problem<T>::scaling_t&
   Problem<T>::argumentScaling ()
   {
-    return argumentScaling_;
+    detachUnshareable ();
+    return data_->argumentScaling;
   }
 
   template <typename T>
   const typename Problem<T>::scaling_t&
   Problem<T>::argumentScaling () const
   {
-    return argumentScaling_;
+    return data_->argumentScaling;
   }
 
   template <typename T>
@@ -334,32 +506,45 @@ namespace roboptim
   typename Problem<T>::names_t&
   Problem<T>::argumentNames ()
   {
-    return argumentNames_;
+    detachUnshareable ();
+    return data_->argumentNames;
   }
 
   template <typename T>
   const typename Problem<T>::names_t&
   Problem<T>::argumentNames () const
   {
-    return argumentNames_;
+    return data_->argumentNames;
   }
 
   template <typename T>
   typename Problem<T>::jacobian_t
   Problem<T>::jacobian (const_argument_ref x) const
+  {
+    jacobian_t jac (differentiableConstraintsOutputSize (),
+                    function_->inputSize ());
+    jacobian (jac, x);
+    return jac;
+  }
+
+  template <typename T>
+  void
+  Problem<T>::jacobian (jacobian_ref jac, const_argument_ref x) const
   {
     typedef GenericDifferentiableFunction<T> differentiableFunction_t;
 
     size_type n = function_->inputSize ();
-    size_type m = differentiableConstraintsOutputSize ();
 
-    jacobian_t jac (m, n);
+    ROBOPTIM_ASSERT_MSG (jac.rows () == differentiableConstraintsOutputSize ()
+                         && jac.cols () == n,
+                         "invalid Jacobian size");
+
     jac.setZero ();
 
     // For each constraint of the problem
     size_type global_row = 0;
     for (typename constraints_t::const_iterator
-	   c = constraints_.begin (); c != constraints_.end (); ++c)
+	   c = data_->constraints.begin (); c != data_->constraints.end (); ++c)
       {
 	// If the constraint is differentiable
         if ((*c)->template asType<differentiableFunction_t> ())
@@ -370,116 +555,298 @@ namespace roboptim
 	    global_row += df->outputSize ();
 	  }
       }
-
-    return jac;
   }
 
-  template <>
-  inline typename Problem<EigenMatrixSparse>::jacobian_t
-  Problem<EigenMatrixSparse>::jacobian (const_argument_ref x) const
+  namespace detail
   {
-    typedef GenericDifferentiableFunction<EigenMatrixSparse>
-      differentiableFunction_t;
-    typedef Eigen::Triplet<double> triplet_t;
+    /// \brief Check whether two compressed sparse matrices share the same
+    /// sparsity pattern.
+    ///
+    /// \param a first matrix.
+    /// \param b second matrix.
+    /// \return true if the patterns are identical.
+    template <typename M>
+    bool sameSparsityPattern (const M& a, const M& b)
+    {
+      assert (a.isCompressed () && b.isCompressed ());
+
+      if (a.rows () != b.rows () || a.cols () != b.cols ()
+          || a.nonZeros () != b.nonZeros ())
+        return false;
+
+      return std::equal (a.outerIndexPtr (),
+                         a.outerIndexPtr () + a.outerSize () + 1,
+                         b.outerIndexPtr ())
+        && std::equal (a.innerIndexPtr (),
+                       a.innerIndexPtr () + a.nonZeros (),
+                       b.innerIndexPtr ());
+    }
+  } // end of namespace detail
 
-    size_type n = function_->inputSize ();
-    size_type m = differentiableConstraintsOutputSize ();
+  namespace detail
+  {
+    /// \brief Fill a stacked sparse Jacobian matrix in place.
+    ///
+    /// The Jacobians of the functions stored in the cache are stacked
+    /// vertically, in order. The sparsity pattern is only recomputed when
+    /// the structure of one of the Jacobians changes.
+    ///
+    /// \param cache Jacobian cache (with an up-to-date list of functions).
+    /// \param n input size of the functions.
+    /// \param jac output Jacobian matrix.
+    /// \param x point where the Jacobians are evaluated.
+    inline void
+    fillStackedJacobian
+    (ProblemJacobianCache<EigenMatrixSparse>& cache,
+     ProblemJacobianCache<EigenMatrixSparse>::index_t n,
+     GenericFunctionTraits<EigenMatrixSparse>::jacobian_t& jac,
+     GenericFunctionTraits<EigenMatrixSparse>::const_argument_ref x)
+    {
+      typedef ProblemJacobianCache<EigenMatrixSparse>::differentiableFunction_t
+        differentiableFunction_t;
+      typedef ProblemJacobianCache<EigenMatrixSparse>::jacobian_t jacobian_t;
+      typedef ProblemJacobianCache<EigenMatrixSparse>::index_t index_t;
+      typedef index_t size_type;
+      typedef Eigen::Triplet<double> triplet_t;
+
+      // Evaluate the Jacobian of each differentiable function in its own
+      // buffer, and check whether the sparsity patterns are unchanged.
+      std::size_t k = 0;
+      for (; k < cache.functions.size (); ++k)
+        {
+          const differentiableFunction_t* df = cache.functions[k];
+
+          if (k >= cache.buffers.size ())
+            {
+              cache.buffers.push_back (jacobian_t (df->outputSize (), n));
+              cache.valid = false;
+            }
+
+          jacobian_t& buffer = cache.buffers[k];
+          if (buffer.rows () != df->outputSize () || buffer.cols () != n)
+            {
+              buffer.resize (df->outputSize (), n);
+              cache.valid = false;
+            }
+
+          buffer.setZero ();
+          df->jacobian (buffer, x);
+          buffer.makeCompressed ();
+
+          if (cache.valid
+              && !sameSparsityPattern (buffer, cache.patterns[k]))
+            cache.valid = false;
+        }
+
+      if (k != cache.buffers.size ())
+        {
+          cache.buffers.resize (k);
+          cache.valid = false;
+        }
+
+      // Compute the stacked sparsity pattern, and the position of each nonzero
+      // value of the buffers in the stacked matrix.
+      if (!cache.valid)
+        {
+          std::vector<triplet_t> coeffs;
+          size_type global_row = 0;
+          for (std::size_t i = 0; i < cache.buffers.size (); ++i)
+            {
+              const jacobian_t& buffer = cache.buffers[i];
+              for (int o = 0; o < buffer.outerSize (); ++o)
+                for (jacobian_t::InnerIterator it (buffer, o); it; ++it)
+                  {
+                    const int row = static_cast<int> (global_row + it.row ());
+                    const int col = static_cast<int> (it.col ());
+                    coeffs.push_back (triplet_t (row, col, it.value ()));
+                  }
+              global_row += buffer.rows ();
+            }
+
+          cache.pattern.resize (global_row, n);
+          cache.pattern.setFromTriplets (coeffs.begin (), coeffs.end ());
+          cache.pattern.makeCompressed ();
+
+          // Since constraints are stacked vertically, the nonzero values of
+          // each buffer are stored in order in the stacked matrix, for any
+          // storage order: we only need a cursor per outer index.
+          std::vector<index_t> cursor
+            (cache.pattern.outerIndexPtr (),
+             cache.pattern.outerIndexPtr () + cache.pattern.outerSize ());
+          cache.map.clear ();
+          cache.map.reserve (static_cast<std::size_t>
+                             (cache.pattern.nonZeros ()));
+          global_row = 0;
+          for (std::size_t i = 0; i < cache.buffers.size (); ++i)
+            {
+              const jacobian_t& buffer = cache.buffers[i];
+              for (index_t o = 0; o < buffer.outerSize (); ++o)
+                {
+                  const index_t stacked_o = jacobian_t::IsRowMajor?
+                    static_cast<index_t> (global_row) + o : o;
+                  for (jacobian_t::InnerIterator it (buffer, o); it; ++it)
+                    cache.map.push_back (cursor[stacked_o]++);
+                }
+              global_row += buffer.rows ();
+            }
+
+          cache.patterns = cache.buffers;
+          cache.valid = true;
+        }
+
+      // Make sure the structure of the output matrix is the expected one.
+      // This only allocates memory during the first call.
+      if (!jac.isCompressed ()
+          || !sameSparsityPattern (jac, cache.pattern))
+        jac = cache.pattern;
+
+      // Copy the nonzero values.
+      double* values = jac.valuePtr ();
+      std::size_t idx = 0;
+      for (std::size_t i = 0; i < cache.buffers.size (); ++i)
+        {
+          const jacobian_t& buffer = cache.buffers[i];
+          const double* bufferValues = buffer.valuePtr ();
+          for (index_t j = 0; j < buffer.nonZeros (); ++j)
+            values[cache.map[idx++]] = bufferValues[j];
+        }
+    }
+  } // end of namespace detail
 
-    jacobian_t jac (m, n);
-    jac.setZero ();
+  template <>
+  inline void
+  Problem<EigenMatrixSparse>::jacobian (jacobian_ref jac,
+                                       const_argument_ref x) const
+  {
+    typedef detail::ProblemJacobianCache<EigenMatrixSparse>::
+      differentiableFunction_t differentiableFunction_t;
 
-    jacobian_t tmp;
-    std::vector<triplet_t> coeffs;
+    detail::ProblemJacobianCache<EigenMatrixSparse>& cache = jacobianCache_;
 
-    // For each constraint of the problem
-    size_type global_row = 0;
-    for (constraints_t::const_iterator
-	   c = constraints_.begin (); c != constraints_.end (); ++c)
+    // Collect the differentiable constraints (only done when the
+    // constraints change).
+    if (!cache.functionsValid)
       {
-	// If the constraint is differentiable
-        if ((*c)->asType<differentiableFunction_t> ())
-	  {
-	    const differentiableFunction_t*
-	      df = (*c)->castInto<differentiableFunction_t> ();
-
-            tmp.resize (df->outputSize (), n);
-            tmp.setZero ();
-	    df->jacobian (tmp, x);
-            tmp.makeCompressed ();
-
-	    for (int k = 0; k < tmp.outerSize (); ++k)
-	      for (differentiableFunction_t::jacobian_t::InnerIterator
-		     it (tmp, k); it; ++it)
-		{
-		  const int row = static_cast<int> (global_row + it.row ());
-		  const int col = static_cast<int> (it.col ());
-		  coeffs.push_back (triplet_t (row, col, it.value ()));
-		}
-
-	    global_row += df->outputSize ();
-	  }
+        cache.functions.clear ();
+        for (constraints_t::const_iterator
+               c = data_->constraints.begin (); c != data_->constraints.end (); ++c)
+          {
+            if ((*c)->asType<differentiableFunction_t> ())
+              cache.functions.push_back
+                ((*c)->castInto<differentiableFunction_t> ());
+          }
+        cache.functionsValid = true;
       }
 
-    jac.setFromTriplets (coeffs.begin (), coeffs.end ());
-    jac.makeCompressed ();
-
-    return jac;
+    detail::fillStackedJacobian (cache, function_->inputSize (), jac, x);
   }
 
   template <typename T>
-  template <int NORM>
-  typename Problem<T>::value_type
-  Problem<T>::constraintsViolation (const_argument_ref x) const
+  void
+  Problem<T>::constraints (result_ref g, const_argument_ref x) const
   {
-    BOOST_STATIC_ASSERT (NORM != 0);
+    assert (g.size () == constraintsOutputSize ());
 
-    size_type n = function_->inputSize ();
-    size_type m = constraintsOutputSize ();
+    size_type offset = 0;
+    for (typename constraints_t::const_iterator
+	   c = data_->constraints.begin (); c != data_->constraints.end (); ++c)
+      {
+        size_type m = (*c)->outputSize ();
+        (*(*c)) (g.segment (offset, m), x);
+        offset += m;
+      }
+  }
 
-    vector_t violations (n + m);
-    violations.setZero ();
-    size_type i = 0;
-    result_t res;
+  namespace detail
+  {
+    /// \brief Compute the norm of the violation of the bounds [l, u] by v.
+    ///
+    /// The violation of a bound is \f$\max(l - v, v - u, 0)\f$. This
+    /// relies on coefficient-wise Eigen expressions, which are vectorized
+    /// and do not allocate any memory. Infinite bounds are handled
+    /// naturally as long as v is finite.
+    ///
+    /// \tparam NORM Eigen norm used for the reduction, e.g. 1 or
+    /// Eigen::Infinity.
+    /// \param v values.
+    /// \param l lower bounds.
+    /// \param u upper bounds.
+    /// \return norm of the violation.
+    template <int NORM, typename V, typename L, typename U>
+    typename V::Scalar boundsViolation (const Eigen::MatrixBase<V>& v,
+                                        const Eigen::MatrixBase<L>& l,
+                                        const Eigen::MatrixBase<U>& u)
+    {
+      assert (v.size () == l.size () && v.size () == u.size ());
 
-    for (size_type j = 0; j < n; ++j)
-      {
-	value_type inf_viol = 0.;
-	value_type sup_viol = 0.;
+      if (v.size () == 0)
+        return 0.;
 
-	const interval_t& bounds = argumentBounds_[static_cast<size_t> (j)];
+      return (l - v).cwiseMax (v - u).cwiseMax
+        (typename V::Scalar (0.)).template lpNorm<NORM> ();
+    }
 
-	if (bounds.first != -Function::infinity ())
-	  inf_viol = std::max (bounds.first - x[j], 0.);
-	if (bounds.second != Function::infinity ())
-	  sup_viol = std::max (x[j] - bounds.second, 0.);
+    /// \brief Merge the norms of two vectors a and b into the norm of
+    /// the stacked vector (a, b).
+    ///
+    /// \tparam NORM Eigen norm, e.g. 1 or Eigen::Infinity.
+    template <int NORM>
+    struct StackedNorm
+    {
+      template <typename U>
+      static U merge (U a, U b)
+      {
+        return std::pow (std::pow (a, NORM) + std::pow (b, NORM), U (1.) / NORM);
+      }
+    };
 
-	violations[i++] = std::max (inf_viol, sup_viol);
+    template <>
+    struct StackedNorm<1>
+    {
+      template <typename U>
+      static U merge (U a, U b)
+      {
+        return a + b;
       }
+    };
 
-    size_t c_idx = 0;
-    for (typename constraints_t::const_iterator
-	   c = constraints_.begin (); c != constraints_.end (); ++c, ++c_idx)
+    template <>
+    struct StackedNorm<Eigen::Infinity>
+    {
+      template <typename U>
+      static U merge (U a, U b)
       {
-	const intervals_t& bounds = boundsVect_[c_idx];
-	res.resize ((*c)->outputSize ());
-	(*(*c)) (res, x);
+        return std::max (a, b);
+      }
+    };
+  } // end of namespace detail
 
-	for (size_type j = 0; j < (*c)->outputSize (); ++j)
-	  {
-	    size_t jj = static_cast<size_t> (j);
-	    value_type inf_viol = 0.;
-	    value_type sup_viol = 0.;
+  template <typename T>
+  template <int NORM>
+  typename Problem<T>::value_type
+  Problem<T>::constraintsViolation (const_argument_ref x) const
+  {
+    result_t g (constraintsOutputSize ());
+    constraints (g, x);
+    return constraintsViolation<NORM> (x, g);
+  }
 
-	    if (bounds[jj].first != -Function::infinity ())
-	      inf_viol = std::max (bounds[jj].first - res[j], 0.);
-	    if (bounds[jj].second != Function::infinity ())
-	      sup_viol = std::max (res[j] - bounds[jj].second, 0.);
+  template <typename T>
+  template <int NORM>
+  typename Problem<T>::value_type
+  Problem<T>::constraintsViolation (const_argument_ref x,
+                                    const_result_ref g) const
+  {
+    BOOST_STATIC_ASSERT (NORM != 0);
 
-	    violations[i++] = std::max (inf_viol, sup_viol);
-	  }
-      }
+    assert (x.size () == function_->inputSize ());
+    assert (g.size () == data_->constraintsLowerBounds.size ());
 
-    return violations.template lpNorm<NORM> ();
+    return detail::StackedNorm<NORM>::merge
+      (detail::boundsViolation<NORM> (x, argumentLowerBounds (),
+                                      argumentUpperBounds ()),
+       detail::boundsViolation<NORM> (g, data_->constraintsLowerBounds,
+                                      data_->constraintsUpperBounds));
   }
 
   namespace detail
@@ -611,26 +978,26 @@ namespace roboptim
       }
 
     // Starting point.
-    if (startingPoint_)
+    if (data_->startingPoint)
       {
 	o << iendl << "Starting point: "
-	  << "[" << startingPoint_->size () << "](";
+	  << "[" << data_->startingPoint->size () << "](";
 	for (typename function_t::vector_t::Index i = 0;
-	     i < startingPoint_->size (); ++i)
+	     i < data_->startingPoint->size (); ++i)
 	  {
 	    if (i > 0)
 	      o << ",";
 	    std::size_t i_ = static_cast<std::size_t> (i);
 	    if (function_t::getLowerBound
-		(this->argumentBounds ()[i_]) <= (*startingPoint_)[i] &&
-		(*startingPoint_)[i] <= function_t::getUpperBound
+		(this->argumentBounds ()[i_]) <= (*data_->startingPoint)[i] &&
+		(*data_->startingPoint)[i] <= function_t::getUpperBound
 		(this->argumentBounds ()[i_]))
-	      o << fg::ok << (*startingPoint_)[i];
+	      o << fg::ok << (*data_->startingPoint)[i];
 	    else
-	      o << fg::fail << (*startingPoint_)[i];
+	      o << fg::fail << (*data_->startingPoint)[i];
 	    o << fg::reset;
 	  }
-	typename function_t::argument_t x0 = *startingPoint_;
+	typename function_t::argument_t x0 = *data_->startingPoint;
 	o << ")" << iendl << "Starting value: "
 	  << this->function () (x0);
       }
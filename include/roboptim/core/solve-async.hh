@@ -0,0 +1,103 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_SOLVE_ASYNC_HH
+# define ROBOPTIM_CORE_SOLVE_ASYNC_HH
+
+# include <stdexcept>
+
+# include <boost/date_time/posix_time/posix_time_types.hpp>
+# include <boost/thread/future.hpp>
+
+# include <roboptim/core/fwd.hh>
+# include <roboptim/core/portability.hh>
+# include <roboptim/core/cancellation-token.hh>
+# include <roboptim/core/solver.hh>
+
+namespace roboptim
+{
+  /// \addtogroup roboptim_solver
+  /// @{
+
+  /// \brief Options of an asynchronous solve.
+  ///
+  /// \tparam T matrix type
+  template <typename T>
+  struct AsyncSolveOptions
+  {
+    /// \brief Iteration callback type.
+    typedef typename Solver<T>::callback_t callback_t;
+
+    AsyncSolveOptions ();
+
+    /// \brief Token used to cancel the solve.
+    CancellationToken token;
+
+    /// \brief Wall-clock deadline (universal time, see
+    /// boost::posix_time::microsec_clock::universal_time).
+    ///
+    /// The default value (not_a_date_time) means no deadline.
+    boost::posix_time::ptime deadline;
+
+    /// \brief User iteration callback.
+    ///
+    /// solveAsync sets the iteration callback of the solver, so the user
+    /// callback has to be given here.
+    callback_t callback;
+
+    /// \brief Constraint violation below which an iterate is considered
+    /// feasible (used to select the best iterate).
+    typename Solver<T>::problem_t::value_type feasibilityTolerance;
+  };
+
+  /// \brief Future result of an asynchronous solve.
+  typedef boost::BOOST_THREAD_FUTURE<GenericSolver::result_t> futureResult_t;
+
+  /// \brief Solve a problem in a new thread.
+  ///
+  /// The cancellation token and the deadline are checked after each
+  /// iteration, in the iteration callback of the solver. The solver is then
+  /// asked to stop (see SolverState::requestStop). If the plug-in does not
+  /// support cooperative interruption, an exception is thrown from the
+  /// iteration callback instead.
+  ///
+  /// When the solve is interrupted (cancellation or deadline), the result
+  /// is the best iterate so far (i.e. the feasible iterate with the lowest
+  /// cost, or the least infeasible one), as a Result with a warning giving
+  /// the reason of the interruption. If no iteration was done, the result
+  /// is a SolverError.
+  ///
+  /// Solvers that do not support the iteration callback can not be
+  /// interrupted: the deadline and the token are then ignored.
+  ///
+  /// The solver is used by the solving thread until the future is ready, so
+  /// it must not be used or destroyed in the meantime.
+  ///
+  /// \param solver solver
+  /// \param options cancellation token, deadline and iteration callback
+  /// \return future result of the solver
+  template <typename T>
+  futureResult_t
+  solveAsync (Solver<T>& solver,
+              const AsyncSolveOptions<T>& options = AsyncSolveOptions<T> ());
+
+  /// @}
+
+} // end of namespace roboptim
+
+# include <roboptim/core/solve-async.hxx>
+#endif //! ROBOPTIM_CORE_SOLVE_ASYNC_HH
@@ -0,0 +1,282 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_SOLVE_ASYNC_HXX
+# define ROBOPTIM_CORE_SOLVE_ASYNC_HXX
+
+# include <string>
+
+# include <boost/bind.hpp>
+# include <boost/exception_ptr.hpp>
+# include <boost/make_shared.hpp>
+# include <boost/optional.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/thread.hpp>
+
+# include <roboptim/core/result.hh>
+# include <roboptim/core/solver-error.hh>
+# include <roboptim/core/solver-warning.hh>
+
+namespace roboptim
+{
+  template <typename T>
+  AsyncSolveOptions<T>::AsyncSolveOptions ()
+    : token (),
+      deadline (boost::posix_time::not_a_date_time),
+      callback (),
+      feasibilityTolerance (1e-6)
+  {
+  }
+
+  namespace detail
+  {
+    /// \brief Exception thrown from the iteration callback to interrupt
+    /// solvers that do not support cooperative interruption.
+    struct SolveInterrupted : public std::runtime_error
+    {
+      SolveInterrupted ()
+        : std::runtime_error ("solve interrupted")
+      {
+      }
+    };
+
+    /// \brief Asynchronous solve of a problem (see solveAsync).
+    template <typename T>
+    class AsyncSolveTask
+    {
+    public:
+      typedef Solver<T> solver_t;
+      typedef typename solver_t::problem_t problem_t;
+      typedef typename solver_t::solverState_t solverState_t;
+      typedef typename solver_t::result_t result_t;
+      typedef typename problem_t::value_type value_type;
+      typedef typename problem_t::vector_t vector_t;
+
+      AsyncSolveTask (solver_t& solver, const AsyncSolveOptions<T>& options)
+        : solver_ (solver),
+          options_ (options),
+          promise_ (),
+          interruption_ (),
+          hasBest_ (false),
+          bestX_ (),
+          bestCost_ (),
+          bestViolation_ ()
+      {
+      }
+
+      /// \brief Future result.
+      futureResult_t future ()
+      {
+        return promise_.get_future ();
+      }
+
+      /// \brief Solve the problem (in the solving thread).
+      ///
+      /// Exceptions that can not be turned into a SolverError are forwarded
+      /// to the future, so that none escapes the solving thread.
+      void run ()
+      {
+        try
+          {
+            result_t result;
+
+            try
+              {
+                try
+                  {
+                    solver_.setIterationCallback
+                      (boost::bind (&AsyncSolveTask<T>::iterate,
+                                    this, _1, _2));
+                  }
+                catch (const std::runtime_error&)
+                  {
+                    // No iteration callback: the solve can not be
+                    // interrupted.
+                  }
+
+                solver_.reset ();
+                result = solver_.minimum ();
+              }
+            catch (const SolveInterrupted&)
+              {
+              }
+            catch (const std::exception& e)
+              {
+                if (!interruption_)
+                  result = SolverError (e.what ());
+              }
+
+            if (interruption_)
+              result = interruptedResult (result);
+
+            restoreCallback ();
+            promise_.set_value (result);
+          }
+        catch (...)
+          {
+            const boost::exception_ptr error = boost::current_exception ();
+            try
+              {
+                restoreCallback ();
+              }
+            catch (...)
+              {
+              }
+            promise_.set_exception (error);
+          }
+      }
+
+    private:
+      /// \brief Restore the user callback.
+      void restoreCallback ()
+      {
+        try
+          {
+            solver_.setIterationCallback (options_.callback);
+          }
+        catch (const std::runtime_error&)
+          {
+          }
+      }
+
+      /// \brief Iteration callback of the solver.
+      void iterate (const problem_t& problem, solverState_t& state)
+      {
+        if (options_.callback)
+          options_.callback (problem, state);
+
+        updateBest (problem, state);
+
+        if (!interruption_)
+          {
+            if (options_.token.cancelled ())
+              interruption_ = std::string ("solve cancelled");
+            else if (!options_.deadline.is_not_a_date_time ()
+                     && boost::posix_time::microsec_clock::universal_time ()
+                     >= options_.deadline)
+              interruption_ = std::string ("deadline reached");
+          }
+
+        if (interruption_ && !state.requestStop ())
+          throw SolveInterrupted ();
+      }
+
+      /// \brief Keep the best iterate: the feasible iterate with the lowest
+      /// cost, or the least infeasible one.
+      void updateBest (const problem_t& problem, const solverState_t& state)
+      {
+        value_type cost = state.cost ()
+          ? *state.cost ()
+          : problem.function () (state.x ())[0];
+        const boost::optional<value_type>& violation =
+          state.constraintViolation ();
+
+        bool feasible =
+          !violation || *violation <= options_.feasibilityTolerance;
+        bool bestFeasible =
+          !bestViolation_ || *bestViolation_ <= options_.feasibilityTolerance;
+
+        bool better = !hasBest_
+          || (feasible && !bestFeasible)
+          || (feasible && bestFeasible && cost < bestCost_)
+          || (!feasible && !bestFeasible && *violation < *bestViolation_);
+
+        if (!better)
+          return;
+
+        hasBest_ = true;
+        bestX_ = state.x ();
+        bestCost_ = cost;
+        bestViolation_ = violation;
+      }
+
+      /// \brief Result of an interrupted solve.
+      ///
+      /// \param result result returned by the solver (if any).
+      result_t interruptedResult (const result_t& result) const
+      {
+        SolverWarning warning (*interruption_);
+
+        if (!hasBest_)
+          {
+            if (result.which () != GenericSolver::SOLVER_VALUE)
+              return SolverError
+                (*interruption_ + " before the first iteration");
+
+            Result res = boost::get<Result> (result);
+            res.warnings.push_back (warning);
+            return res;
+          }
+
+        const problem_t& pb = solver_.problem ();
+        Result res (pb.function ().inputSize (),
+                    pb.function ().outputSize ());
+        res.x = bestX_;
+        res.value = pb.function () (bestX_);
+        res.constraints.resize (pb.constraintsOutputSize ());
+        pb.constraints (res.constraints, bestX_);
+        res.constraint_violation =
+          pb.template constraintsViolation<1> (bestX_, res.constraints);
+        res.warnings.push_back (warning);
+        return res;
+      }
+
+      /// \brief Solver.
+      solver_t& solver_;
+
+      /// \brief Options.
+      AsyncSolveOptions<T> options_;
+
+      /// \brief Promise of the result.
+      boost::promise<result_t> promise_;
+
+      /// \brief Reason of the interruption (if any).
+      boost::optional<std::string> interruption_;
+
+      /// \brief Whether an iterate was recorded.
+      bool hasBest_;
+
+      /// \brief Best iterate.
+      vector_t bestX_;
+
+      /// \brief Cost of the best iterate.
+      value_type bestCost_;
+
+      /// \brief Constraint violation of the best iterate (if known).
+      boost::optional<value_type> bestViolation_;
+    };
+  } // end of namespace detail
+
+  template <typename T>
+  futureResult_t
+  solveAsync (Solver<T>& solver, const AsyncSolveOptions<T>& options)
+  {
+    boost::shared_ptr<detail::AsyncSolveTask<T> > task =
+      boost::make_shared<detail::AsyncSolveTask<T> > (boost::ref (solver),
+                                                      options);
+    futureResult_t future = task->future ();
+
+    // The thread owns the task until the result is set.
+    boost::thread (boost::bind (&detail::AsyncSolveTask<T>::run, task))
+      .detach ();
+
+    return boost::move (future);
+  }
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_SOLVE_ASYNC_HXX
@@ -30,6 +30,7 @@
 # include <roboptim/core/sys.hh>
 # include <roboptim/core/debug.hh>
 # include <roboptim/core/portability.hh>
+# include <roboptim/core/plugin-registry.hh>
 # include <roboptim/core/solver.hh>
 # include <roboptim/core/solver-error.hh>
 
@@ -47,6 +48,10 @@ namespace roboptim
   /// is provided with GNU Libtool and wraps OS specific behavior into
   /// a uniform interface.
   ///
+  /// Plug-ins are loaded once and kept in a process-wide registry (see
+  /// PluginRegistry), so creating several factories for the same plug-in
+  /// does not reload it.
+  ///
   /// \warning The solver lifetime is bound to the factory lifetime,
   /// when the factory goes out of scope, the solver is destroyed too.
   ///
@@ -72,7 +77,7 @@ namespace roboptim
     /// \throw std::runtime_error
     explicit SolverFactory (std::string solver, const problem_t& problem);
 
-    /// Unload the plug-in and free the instantiated solver.
+    /// Free the instantiated solver and release the plug-in.
     ~SolverFactory ();
 
     /// \brief Retrieve a reference on the solver.
@@ -80,8 +85,10 @@ namespace roboptim
     solver_t& operator () ();
 
   private:
-    /// \brief ltdl plug-in handle.
-    lt_dlhandle handle_;
+    /// \brief Plug-in name.
+    std::string pluginName_;
+    /// \brief Plug-in entry points (owned by the registry).
+    const PluginRegistry::Plugin* plugin_;
     /// \brief Allocated solver.
     solver_t* solver_;
   };
@@ -47,131 +47,77 @@ namespace roboptim
 
   template <typename S>
   SolverFactory<S>::SolverFactory (std::string plugin, const problem_t& pb)
-    : handle_ (),
+    : pluginName_ (plugin),
+      plugin_ (),
       solver_ ()
   {
     typedef std::size_t getsizeofproblem_t ();
     typedef const char* gettypeidofconstraintslist_t ();
     typedef solver_t* create_t (const problem_t&);
 
-    if (lt_dlinit () > 0)
-      throw std::runtime_error ("failed to initialize libltdl.");
+    PluginRegistry& registry = PluginRegistry::instance ();
 
-    std::stringstream ss;
-    ss << "roboptim-core-plugin-" << plugin;
-    handle_ = lt_dlopenext (ss.str ().c_str ());
-    if (!handle_)
-      {
-	std::stringstream sserror;
-	std::string err = lt_dlerror ();
-	sserror << "libltdl failed to load plug-in ``" << ss.str () << "'': "
-		<< err;
-	if (err == "file not found")
-	  sserror << "\nIs the plug-in in your LTDL_LIBRARY_PATH or LD_LIBRARY_PATH?";
-	if (lt_dlexit ())
-	  sserror << "\nlt_dlexit failed too";
-	throw std::runtime_error (sserror.str ().c_str ());
-      }
-
-    getsizeofproblem_t* getSizeOfProblem =
-      unionCast<getsizeofproblem_t> (lt_dlsym (handle_, "getSizeOfProblem"));
-    if (!getSizeOfProblem)
-      {
-	std::stringstream sserror;
-	sserror << "libltdl failed to find symbol ``getSizeOfProblem'': "
-		<< lt_dlerror ();
-
-	if (lt_dlclose (handle_))
-	  sserror << " (lt_dlclose failed too)";
-	if (lt_dlexit ())
-	  sserror << " lt_dlexit failed too";
-	throw std::runtime_error (sserror.str ().c_str ());
-      }
-
-    gettypeidofconstraintslist_t* getTypeIdOfConstraintsList =
-      unionCast<gettypeidofconstraintslist_t>
-      (lt_dlsym (handle_, "getTypeIdOfConstraintsList"));
-    if (!getTypeIdOfConstraintsList)
-      {
-        std::stringstream sserror;
-        sserror << "libltdl failed to find symbol"
-                << " ``getTypeIdOfConstraintsList'': "
-                << lt_dlerror ();
-
-	if (lt_dlclose (handle_))
-	  sserror << " (lt_dlclose failed too)";
-	if (lt_dlexit ())
-	  sserror << " lt_dlexit failed too";
-        throw std::runtime_error (sserror.str ().c_str ());
-      }
-
-    std::size_t sizeOfProblem = getSizeOfProblem ();
-    if (sizeOfProblem != sizeof (typename solver_t::problem_t))
-      {
-	std::stringstream sserror;
-	sserror
-	  << "``Problem'' type size does not match in application and plug-in"
-	  << " (size is " << sizeOfProblem
-	  << " byte(s) but " << sizeof (typename solver_t::problem_t)
-	  << " byte(s) was expected by application)";
-
-	if (lt_dlclose (handle_))
-	  sserror << " (lt_dlclose failed too)";
-	if (lt_dlexit ())
-	  sserror << " lt_dlexit failed too";
-	throw std::runtime_error (sserror.str ().c_str ());
-      }
+    // Load the plug-in, or retrieve it if it was already loaded.
+    plugin_ = &registry.acquire (plugin);
 
-    const std::string typeIdOfConstraintsList
-      = demangle(getTypeIdOfConstraintsList ());
-    const std::string expectedTypeIdOfConstraintsList
-      = demangle(typeid
-                 (typename solver_t::problem_t::constraintsList_t).name ());
-    if (typeIdOfConstraintsList != expectedTypeIdOfConstraintsList)
+    // Check that the plug-in matches the application (only done once per
+    // solver type).
+    const std::string solverType = typeid (solver_t).name ();
+    if (!registry.isValidated (plugin, solverType))
       {
-        std::stringstream sserror;
-        sserror
-          << "``Problem::constraintsList_t'' type id does not match in"
-          << " application and plug-in. Type id is:\n"
-          << typeIdOfConstraintsList
-          << "\nbut application expected:\n"
-          << expectedTypeIdOfConstraintsList;
-
-	if (lt_dlclose (handle_))
-	  sserror << " (lt_dlclose failed too)";
-	if (lt_dlexit ())
-	  sserror << " lt_dlexit failed too";
-        throw std::runtime_error (sserror.str ().c_str ());
-      }
-
-    create_t* c =
-      unionCast<create_t> (lt_dlsym (handle_, "create"));
-    if (!c)
-      {
-	std::stringstream sserror;
-	sserror << "libltdl failed to find symbol ``create'': "
-		<< lt_dlerror ();
-
-	if (lt_dlclose (handle_))
-	  sserror << " (lt_dlclose failed too)";
-	if (lt_dlexit ())
-	  sserror << " lt_dlexit failed too";
-	throw std::runtime_error (sserror.str ().c_str ());
+        getsizeofproblem_t* getSizeOfProblem =
+          unionCast<getsizeofproblem_t> (plugin_->getSizeOfProblem);
+        gettypeidofconstraintslist_t* getTypeIdOfConstraintsList =
+          unionCast<gettypeidofconstraintslist_t>
+          (plugin_->getTypeIdOfConstraintsList);
+
+        std::size_t sizeOfProblem = getSizeOfProblem ();
+        if (sizeOfProblem != sizeof (typename solver_t::problem_t))
+          {
+            std::stringstream sserror;
+            sserror
+              << "``Problem'' type size does not match in application and plug-in"
+              << " (size is " << sizeOfProblem
+              << " byte(s) but " << sizeof (typename solver_t::problem_t)
+              << " byte(s) was expected by application)";
+
+            registry.release (plugin);
+            throw std::runtime_error (sserror.str ().c_str ());
+          }
+
+        const std::string typeIdOfConstraintsList
+          = demangle(getTypeIdOfConstraintsList ());
+        const std::string expectedTypeIdOfConstraintsList
+          = demangle(typeid
+                     (typename solver_t::problem_t::constraintsList_t).name ());
+        if (typeIdOfConstraintsList != expectedTypeIdOfConstraintsList)
+          {
+            std::stringstream sserror;
+            sserror
+              << "``Problem::constraintsList_t'' type id does not match in"
+              << " application and plug-in. Type id is:\n"
+              << typeIdOfConstraintsList
+              << "\nbut application expected:\n"
+              << expectedTypeIdOfConstraintsList;
+
+            registry.release (plugin);
+            throw std::runtime_error (sserror.str ().c_str ());
+          }
+
+        registry.setValidated (plugin, solverType);
       }
 
+    create_t* c = unionCast<create_t> (plugin_->create);
     solver_ = c (pb);
 
     if (!solver_)
       {
-	std::stringstream sserror;
-	sserror << "libltdl failed to call ``create'': "
-		<< lt_dlerror ();
-
-	if (lt_dlclose (handle_))
-	  sserror << " (lt_dlclose failed too)";
-	if (lt_dlexit ())
-	  sserror << " lt_dlexit failed too";
-	throw std::runtime_error (sserror.str ().c_str ());
+        std::stringstream sserror;
+        sserror << "failed to call ``create'' in plug-in ``"
+                << plugin_->name << "''";
+
+        registry.release (plugin);
+        throw std::runtime_error (sserror.str ().c_str ());
       }
 
     solver_->pluginName () = plugin;
@@ -182,8 +128,7 @@ namespace roboptim
   {
     typedef void destroy_t (solver_t*);
 
-    destroy_t* destructor =
-      unionCast<destroy_t> (lt_dlsym (handle_, "destroy"));
+    destroy_t* destructor = unionCast<destroy_t> (plugin_->destroy);
     if (destructor)
       {
         destructor (solver_);
@@ -191,27 +136,12 @@ namespace roboptim
       }
     else
       {
-	std::stringstream sserror;
-	sserror << "libltdl failed to call ``destroy'': "
-		<< lt_dlerror ();
-	std::cerr << sserror.str () << std::endl;
-      }
-
-    if (lt_dlclose (handle_))
-      {
-	std::stringstream sserror;
-	sserror << "libltdl failed to close plug-in: "
-		<< lt_dlerror ();
-	std::cerr << sserror.str () << std::endl;
+	std::cerr << "failed to call ``destroy'' in plug-in ``"
+                  << plugin_->name << "''" << std::endl;
       }
 
-    if (lt_dlexit ())
-      {
-	std::stringstream sserror;
-	sserror << "libltdl failed to call ``create'': "
-		<< lt_dlerror ();
-	std::cerr << sserror.str () << std::endl;
-      }
+    // The plug-in stays loaded in the registry.
+    PluginRegistry::instance ().release (pluginName_);
   }
 
   template <typename S>
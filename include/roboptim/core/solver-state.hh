@@ -20,9 +20,13 @@
 # include <roboptim/core/sys.hh>
 # include <roboptim/core/debug.hh>
 
+# include <cstddef>
 # include <map>
 # include <string>
+# include <vector>
 
+# include <boost/container/vector.hpp>
+# include <boost/type.hpp>
 # include <boost/variant/variant.hpp>
 # include <boost/variant/get.hpp>
 # include <boost/optional.hpp>
@@ -71,8 +75,94 @@ namespace roboptim
     stateParameterValues_t value;
   };
 
+  /// \brief Handle of a registered solver state parameter.
+  ///
+  /// Handles are returned by SolverState::registerParameter, and give a
+  /// direct access to the parameter value, without looking up its key.
+  ///
+  /// \tparam T parameter type.
+  template <typename T>
+  struct StateParameterHandle
+  {
+    /// \brief Invalid handle.
+    StateParameterHandle ()
+      : index (invalid ())
+    {}
+
+    /// \brief Handle of the index-th parameter of type T.
+    explicit StateParameterHandle (std::size_t i)
+      : index (i)
+    {}
+
+    /// \brief Whether the handle refers to a registered parameter.
+    bool valid () const
+    {
+      return index != invalid ();
+    }
+
+    /// \brief Index of the invalid handle.
+    static std::size_t invalid ()
+    {
+      return static_cast<std::size_t> (-1);
+    }
+
+    /// \brief Index of the parameter in the store of its type.
+    std::size_t index;
+  };
+
+  namespace detail
+  {
+    /// \brief Flat storage of the registered solver state parameters, one
+    /// vector per parameter type.
+    ///
+    /// \tparam F function type.
+    template <typename F>
+    struct StateParameterStore
+    {
+      typedef typename F::value_type value_type;
+      typedef typename F::vector_t vector_t;
+
+      std::vector<value_type> values;
+      std::vector<vector_t> vectors;
+      std::vector<int> integers;
+      std::vector<std::string> strings;
+      /// \brief Not specialized, so that elements can be referenced.
+      boost::container::vector<bool> booleans;
+
+      std::vector<value_type>& get (boost::type<value_type>)
+      { return values; }
+      std::vector<vector_t>& get (boost::type<vector_t>)
+      { return vectors; }
+      std::vector<int>& get (boost::type<int>)
+      { return integers; }
+      std::vector<std::string>& get (boost::type<std::string>)
+      { return strings; }
+      boost::container::vector<bool>& get (boost::type<bool>)
+      { return booleans; }
+    };
+  } // end of namespace detail
+
   /// \brief State of the solver.
   ///
+  /// Besides x, the cost and the constraint violation, the state holds
+  /// solver-specific parameters. They can be accessed by key with
+  /// parameters (), or registered once with registerParameter and then
+  /// accessed with handles: values of registered parameters live in a flat
+  /// typed store, so that solvers can update them at each iteration without
+  /// key lookup nor allocation.
+  ///
+  /// The parameters map is then a view of the store: it is updated when it
+  /// is accessed, and changes made through it are seen by the next handle
+  /// access. References to entries of registered parameters obtained
+  /// from parameters () are only valid until the next handle access, and
+  /// registered parameters must not be erased from the map.
+  ///
+  /// Registered parameters are modified with setParameter, and read with
+  /// parameter, which never marks them as modified. The non-const
+  /// parameters () and getParameter methods give a write access to the
+  /// map: code that only reads the parameters (e.g. iteration callbacks)
+  /// should use them through a const reference to the state, so that the
+  /// store and the map are not synchronized at each iteration.
   ///
   /// \tparam P problem type.
   template <typename P>
@@ -140,6 +230,69 @@ namespace roboptim
     /// \throw std::out_of_range
     template <typename T>
     T& getParameter (const std::string& key);
+
+    /// \brief Register a parameter, and return its handle.
+    ///
+    /// This may allocate memory, and is meant to be called once, e.g. when
+    /// the solver is created. Registering a key twice with the same type
+    /// returns the same handle.
+    ///
+    /// \tparam T parameter type (value_type, vector_t, int, std::string or
+    /// bool).
+    /// \param key parameter key.
+    /// \param description parameter description.
+    /// \param value initial value.
+    /// \return handle of the parameter.
+    /// \throw std::runtime_error if the key is registered with another type.
+    template <typename T>
+    StateParameterHandle<T> registerParameter (const std::string& key,
+                                               const std::string& description,
+                                               const T& value);
+
+    /// \brief Retrieve the handle of a registered parameter.
+    /// \tparam T parameter type.
+    /// \param key parameter key.
+    /// \return handle of the parameter.
+    /// \throw std::out_of_range if the key is not registered with type T.
+    template <typename T>
+    StateParameterHandle<T> parameterHandle (const std::string& key) const;
+
+    /// \brief Get a registered parameter.
+    /// \tparam T parameter type.
+    /// \param handle parameter handle.
+    /// \return parameter.
+    template <typename T>
+    const T& parameter (StateParameterHandle<T> handle) const;
+
+    /// \brief Set a registered parameter.
+    ///
+    /// Vector parameters are assigned in place, so that setting them to
+    /// an Eigen expression of the same size does not allocate memory.
+    ///
+    /// \tparam T parameter type.
+    /// \tparam U value type (convertible to T).
+    /// \param handle parameter handle.
+    /// \param value new value.
+    template <typename T, typename U>
+    void setParameter (StateParameterHandle<T> handle, const U& value);
+    /// \}
+
+    /// \name Cooperative interruption
+    /// \{
+
+    /// \brief Ask the solver to stop after the current iteration.
+    ///
+    /// Solvers supporting cooperative interruption expose a boolean
+    /// parameter named ``stop'' or ``<solver>.stop'' (e.g. ipopt.stop), and
+    /// check it after each call to the iteration callback. This method sets
+    /// all these parameters, and is meant to be called from the iteration
+    /// callback.
+    ///
+    /// \return whether the solver supports cooperative interruption.
+    bool requestStop ();
+
+    /// \brief Whether the solver was asked to stop (see requestStop).
+    bool stopRequested () const;
     /// \}
 
 
@@ -164,7 +317,51 @@ namespace roboptim
     boost::optional<value_type> constraintViolation_;
 
     /// \brief Solver state extra parameters (solver-specific parameters etc.).
-    parameters_t parameters_;
+    /// For registered parameters, this is a view of the store.
+    mutable parameters_t parameters_;
+
+  private:
+    /// \brief Registered parameter.
+    struct Registration
+    {
+      /// \brief Entry of the parameter in the parameters map.
+      typename parameters_t::iterator entry;
+
+      /// \brief Type of the parameter (index in the variant types).
+      int type;
+
+      /// \brief Index of the parameter in the store of its type.
+      std::size_t index;
+    };
+
+    /// \brief Copy the registered parameters to the parameters map (if
+    /// they changed).
+    void updateView () const;
+
+    /// \brief Copy the registered parameters from the parameters map (if
+    /// it may have changed).
+    void updateStore () const;
+
+    /// \brief Copy a registered parameter to the parameters map.
+    template <typename T>
+    void pushParameter (const Registration& registration) const;
+
+    /// \brief Copy a registered parameter from the parameters map.
+    template <typename T>
+    void pullParameter (const Registration& registration) const;
+
+    /// \brief Values of the registered parameters.
+    mutable detail::StateParameterStore<function_t> store_;
+
+    /// \brief Registered parameters.
+    std::vector<Registration> registrations_;
+
+    /// \brief Whether the store changed since the last view update.
+    mutable bool storeChanged_;
+
+    /// \brief Whether the parameters map may have changed since the last
+    /// store update.
+    mutable bool viewChanged_;
   };
 
   /// \brief Override operator<< to display ``parameters'' objects.
@@ -18,6 +18,9 @@
 #ifndef ROBOPTIM_CORE_SOLVER_STATE_HXX
 # define ROBOPTIM_CORE_SOLVER_STATE_HXX
 
+# include <cassert>
+# include <stdexcept>
+
 # include <boost/foreach.hpp>
 # include <boost/variant/static_visitor.hpp>
 # include <boost/variant/apply_visitor.hpp>
@@ -71,6 +74,28 @@ namespace roboptim
 
       std::ostream& o_;
     };
+
+    /// \brief Type of a state parameter, i.e. its index in the variant
+    /// types.
+    /// \tparam F function type.
+    /// \tparam T parameter type.
+    template <typename F, typename T>
+    int stateParameterType ()
+    {
+      typename StateParameter<F>::stateParameterValues_t value = T ();
+      return value.which ();
+    }
+
+    /// \brief Whether a state parameter key is a stop request key, i.e.
+    /// ``stop'' or ``<solver>.stop''.
+    inline bool isStopKey (const std::string& key)
+    {
+      static const std::string suffix (".stop");
+      return key == "stop"
+        || (key.size () > suffix.size ()
+            && key.compare (key.size () - suffix.size (),
+                            suffix.size (), suffix) == 0);
+    }
   } // end of namespace detail
 
   template <typename F>
@@ -87,7 +112,12 @@ namespace roboptim
   SolverState<P>::SolverState (const problem_t& pb)
     : boost::noncopyable (),
       cost_ (),
-      constraintViolation_ ()
+      constraintViolation_ (),
+      parameters_ (),
+      store_ (),
+      registrations_ (),
+      storeChanged_ (false),
+      viewChanged_ (false)
   {
     x_.resize (pb.function ().inputSize ());
     x_.setZero ();
@@ -144,6 +174,7 @@ namespace roboptim
   const typename SolverState<P>::parameters_t&
   SolverState<P>::parameters () const
   {
+    updateView ();
     return parameters_;
   }
 
@@ -151,6 +182,8 @@ namespace roboptim
   typename SolverState<P>::parameters_t&
   SolverState<P>::parameters ()
   {
+    updateView ();
+    viewChanged_ = true;
     return parameters_;
   }
 
@@ -159,8 +192,9 @@ namespace roboptim
   const T&
   SolverState<P>::getParameter (const std::string& key) const
   {
-    typename parameters_t::const_iterator it = parameters_.find (key);
-    if(it == parameters_.end())
+    const parameters_t& params = parameters ();
+    typename parameters_t::const_iterator it = params.find (key);
+    if(it == params.end())
       throw std::out_of_range("key "+ key +" not found");
     return boost::get<T> (it->second.value);
   }
@@ -170,12 +204,194 @@ namespace roboptim
   T&
   SolverState<P>::getParameter (const std::string& key)
   {
-    typename parameters_t::iterator it = parameters_.find (key);
-    if (it == parameters_.end ())
+    parameters_t& params = parameters ();
+    typename parameters_t::iterator it = params.find (key);
+    if (it == params.end ())
       throw std::out_of_range ("key "+ key +" not found");
     return boost::get<T> (it->second.value);
   }
 
+  template <typename P>
+  template <typename T>
+  StateParameterHandle<T>
+  SolverState<P>::registerParameter (const std::string& key,
+                                     const std::string& description,
+                                     const T& value)
+  {
+    updateStore ();
+
+    // Already registered: only update the value.
+    for (std::size_t i = 0; i < registrations_.size (); ++i)
+      if (registrations_[i].entry->first == key)
+        {
+          if (registrations_[i].type
+              != detail::stateParameterType<function_t, T> ())
+            throw std::runtime_error
+              ("state parameter " + key + " is registered with another type");
+          registrations_[i].entry->second.description = description;
+          store_.get (boost::type<T> ())[registrations_[i].index] = value;
+          storeChanged_ = true;
+          return StateParameterHandle<T> (registrations_[i].index);
+        }
+
+    // New registration (the key may already be in the map).
+    updateView ();
+    Registration registration;
+    registration.entry = parameters_.insert
+      (typename parameters_t::value_type
+       (key, StateParameter<function_t> ())).first;
+    registration.entry->second.description = description;
+    registration.entry->second.value = value;
+    registration.type = registration.entry->second.value.which ();
+    registration.index = store_.get (boost::type<T> ()).size ();
+    store_.get (boost::type<T> ()).push_back (value);
+    registrations_.push_back (registration);
+
+    return StateParameterHandle<T> (registration.index);
+  }
+
+  template <typename P>
+  template <typename T>
+  StateParameterHandle<T>
+  SolverState<P>::parameterHandle (const std::string& key) const
+  {
+    for (std::size_t i = 0; i < registrations_.size (); ++i)
+      if (registrations_[i].entry->first == key)
+        {
+          if (registrations_[i].type
+              != detail::stateParameterType<function_t, T> ())
+            break;
+          return StateParameterHandle<T> (registrations_[i].index);
+        }
+    throw std::out_of_range ("state parameter " + key + " not registered");
+  }
+
+  template <typename P>
+  template <typename T>
+  const T&
+  SolverState<P>::parameter (StateParameterHandle<T> handle) const
+  {
+    assert (handle.index < store_.get (boost::type<T> ()).size ());
+    updateStore ();
+    return store_.get (boost::type<T> ())[handle.index];
+  }
+
+  template <typename P>
+  template <typename T, typename U>
+  void
+  SolverState<P>::setParameter (StateParameterHandle<T> handle,
+                                const U& value)
+  {
+    assert (handle.index < store_.get (boost::type<T> ()).size ());
+    updateStore ();
+    storeChanged_ = true;
+    store_.get (boost::type<T> ())[handle.index] = value;
+  }
+
+  template <typename P>
+  template <typename T>
+  void
+  SolverState<P>::pushParameter (const Registration& registration) const
+  {
+    registration.entry->second.value =
+      store_.get (boost::type<T> ())[registration.index];
+  }
+
+  template <typename P>
+  template <typename T>
+  void
+  SolverState<P>::pullParameter (const Registration& registration) const
+  {
+    // Values whose type was changed through the map are ignored.
+    if (const T* value = boost::get<T> (&registration.entry->second.value))
+      store_.get (boost::type<T> ())[registration.index] = *value;
+  }
+
+  template <typename P>
+  void
+  SolverState<P>::updateView () const
+  {
+    if (!storeChanged_)
+      return;
+
+    typedef typename function_t::value_type value_type;
+    typedef typename function_t::vector_t vector_t;
+
+    for (std::size_t i = 0; i < registrations_.size (); ++i)
+      switch (registrations_[i].type)
+        {
+        case 0: pushParameter<value_type> (registrations_[i]); break;
+        case 1: pushParameter<vector_t> (registrations_[i]); break;
+        case 2: pushParameter<int> (registrations_[i]); break;
+        case 3: pushParameter<std::string> (registrations_[i]); break;
+        case 4: pushParameter<bool> (registrations_[i]); break;
+        }
+    storeChanged_ = false;
+  }
+
+  template <typename P>
+  void
+  SolverState<P>::updateStore () const
+  {
+    if (!viewChanged_)
+      return;
+
+    typedef typename function_t::value_type value_type;
+    typedef typename function_t::vector_t vector_t;
+
+    for (std::size_t i = 0; i < registrations_.size (); ++i)
+      switch (registrations_[i].type)
+        {
+        case 0: pullParameter<value_type> (registrations_[i]); break;
+        case 1: pullParameter<vector_t> (registrations_[i]); break;
+        case 2: pullParameter<int> (registrations_[i]); break;
+        case 3: pullParameter<std::string> (registrations_[i]); break;
+        case 4: pullParameter<bool> (registrations_[i]); break;
+        }
+    viewChanged_ = false;
+  }
+
+  template <typename P>
+  bool
+  SolverState<P>::requestStop ()
+  {
+    bool supported = false;
+    updateView ();
+    for (typename parameters_t::iterator
+           it = parameters_.begin (); it != parameters_.end (); ++it)
+      {
+        if (!detail::isStopKey (it->first))
+          continue;
+        if (bool* stop = boost::get<bool> (&it->second.value))
+          {
+            *stop = true;
+            supported = true;
+          }
+      }
+
+    // Only mark the map as modified if a parameter was set.
+    if (supported)
+      viewChanged_ = true;
+    return supported;
+  }
+
+  template <typename P>
+  bool
+  SolverState<P>::stopRequested () const
+  {
+    const parameters_t& params = parameters ();
+    for (typename parameters_t::const_iterator
+           it = params.begin (); it != params.end (); ++it)
+      {
+        if (!detail::isStopKey (it->first))
+          continue;
+        const bool* stop = boost::get<bool> (&it->second.value);
+        if (stop && *stop)
+          return true;
+      }
+    return false;
+  }
+
   template <typename P>
   std::ostream&
   SolverState<P>::print (std::ostream& o) const
@@ -190,6 +406,7 @@ namespace roboptim
     if (constraintViolation_)
       o << iendl << "Constraint violation: " << *constraintViolation_;
 
+    updateView ();
     if (!parameters_.empty ())
       {
         o << iendl << "Parameters:" << incindent;
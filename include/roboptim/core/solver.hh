@@ -25,6 +25,7 @@
 # include <string>
 
 # include <boost/function.hpp>
+# include <boost/shared_ptr.hpp>
 # include <boost/mpl/assert.hpp>
 # include <boost/mpl/logical.hpp>
 # include <boost/type_traits/is_base_of.hpp>
@@ -73,8 +74,12 @@ namespace roboptim
   /// This class is parametrized by two types:
   /// the cost function type and the constraints type.
   ///
-  /// Solver classes are immutable, the problem can
-  /// not be changed after the class instantiation.
+  /// The structure of the problem (cost function and constraints) can not
+  /// be changed after the class instantiation. However, the starting
+  /// point, the bounds and a vector of problem parameters can be updated,
+  /// and the problem solved again with resolve (). This lets solvers reuse
+  /// their internal workspaces when solving sequences of related problems,
+  /// e.g. in model predictive control.
   ///
   /// \tparam T matrix type
   template <typename T>
@@ -91,12 +96,31 @@ namespace roboptim
     /// \brief Import vector type from cost function
     typedef typename GenericFunction<T>::vector_t vector_t;
 
+    /// \brief Import argument type from problem.
+    typedef typename problem_t::const_argument_ref const_argument_ref;
+
+    /// \brief Import intervals type from problem.
+    typedef typename problem_t::intervals_t intervals_t;
+
     /// \brief Map of parameters.
     typedef std::map<std::string, Parameter> parameters_t;
 
     /// \brief State of the solver.
     typedef SolverState<problem_t> solverState_t;
 
+    /// \brief Kinds of problem updates, see resolve ().
+    enum problemUpdate_t
+      {
+        /// \brief The starting point changed.
+        STARTING_POINT_UPDATE = 1 << 0,
+        /// \brief The argument bounds changed.
+        ARGUMENT_BOUNDS_UPDATE = 1 << 1,
+        /// \brief The bounds of some constraints changed.
+        CONSTRAINT_BOUNDS_UPDATE = 1 << 2,
+        /// \brief The problem parameters changed.
+        PARAMETERS_UPDATE = 1 << 3
+      };
+
     /// Per-iteration callback type
     ///
     /// Callback parameters:
@@ -136,6 +160,66 @@ namespace roboptim
     std::string& pluginName ();
     /// \}
 
+    /// \name Problem updates (warm start)
+    ///
+    /// These methods change the problem in place, without creating a new
+    /// solver. The updates are applied to the solver's copy of the problem,
+    /// and recorded until the next call to resolve ().
+    /// \{
+
+    /// \brief Change the starting point.
+    /// \param x new starting point
+    /// \throw std::runtime_error
+    void updateStartingPoint (const_argument_ref x);
+
+    /// \brief Change the argument bounds.
+    /// \param bounds new argument bounds
+    /// \throw std::runtime_error
+    void updateArgumentBounds (const intervals_t& bounds);
+
+    /// \brief Change the bounds of a constraint.
+    /// \param i index of the constraint
+    /// \param bounds new interval vector of the constraint
+    /// \throw std::runtime_error
+    void updateConstraintBounds (std::size_t i, const intervals_t& bounds);
+
+    /// \brief Change the problem parameters.
+    ///
+    /// Problem parameters are constant data of the problem (e.g. the
+    /// current state in model predictive control). They are written into
+    /// the problem parameters buffer, from which the functions that depend
+    /// on them read them (see setProblemParametersBuffer). The size of the
+    /// parameter vector can only change on the first update.
+    ///
+    /// \param p new problem parameters
+    /// \throw std::runtime_error
+    void updateProblemParameters (const vector_t& p);
+
+    /// \brief Retrieve the problem parameters.
+    const vector_t& problemParameters () const;
+
+    /// \brief Set the buffer of the problem parameters.
+    ///
+    /// The functions that depend on the problem parameters keep a pointer
+    /// on this buffer (e.g. given to their constructor), and read the
+    /// parameters from it when they are evaluated.
+    ///
+    /// \param parameters buffer of the problem parameters
+    /// \throw std::runtime_error
+    void
+    setProblemParametersBuffer (const boost::shared_ptr<vector_t>& parameters);
+
+    /// \brief Updates recorded since the last call to resolve ().
+    /// \return combination of problemUpdate_t flags
+    unsigned int pendingUpdates () const;
+
+    /// \brief Solve the problem again after some updates.
+    ///
+    /// This resets the result, lets the solver process the pending updates
+    /// (see updateProblem) and calls solve ().
+    void resolve ();
+    /// \}
+
     /// \brief Set the per-iteration callback.
     ///
     /// The per-iteration callback is a callback called each time one
@@ -159,8 +243,31 @@ namespace roboptim
     virtual std::ostream& print (std::ostream&) const;
 
   protected:
+    /// \brief Process updates of the problem before solving it again.
+    ///
+    /// This is called by resolve () before solve (), once problem_ and the
+    /// problem parameters have been updated. Solvers can override it to
+    /// update their workspaces instead of rebuilding them (e.g. keep
+    /// factorizations if only the bounds changed, or warm start from the
+    /// previous solution). The default implementation does nothing, so
+    /// solve () starts from scratch on the updated problem.
+    ///
+    /// \param updates combination of problemUpdate_t flags
+    virtual void updateProblem (unsigned int updates);
+
     /// \brief Problem that will be solved.
-    const problem_t problem_;
+    ///
+    /// This copy is cheap since it shares the data of the problem given to
+    /// the constructor (see Problem's copy constructor). It is detached from
+    /// the original problem on the first update.
+    problem_t problem_;
+
+    /// \brief Problem parameters (possibly shared with the functions of
+    /// the problem).
+    boost::shared_ptr<vector_t> problemParameters_;
+
+    /// \brief Updates recorded since the last call to resolve ().
+    unsigned int pendingUpdates_;
 
     /// \brief Solver parameters (run-time configuration).
     parameters_t parameters_;
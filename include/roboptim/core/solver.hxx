@@ -18,6 +18,7 @@
 #ifndef ROBOPTIM_CORE_SOLVER_HXX
 # define ROBOPTIM_CORE_SOLVER_HXX
 # include <boost/foreach.hpp>
+# include <boost/make_shared.hpp>
 
 # include <roboptim/core/io.hh>
 # include <roboptim/core/portability.hh>
@@ -28,6 +29,8 @@ namespace roboptim
   Solver<T>::Solver (const problem_t& pb)
     : GenericSolver (),
       problem_ (pb),
+      problemParameters_ (boost::make_shared<vector_t> ()),
+      pendingUpdates_ (0),
       plugin_name_ ("")
   {
   }
@@ -81,6 +84,92 @@ namespace roboptim
     return plugin_name_;
   }
 
+  template <typename T>
+  void
+  Solver<T>::updateStartingPoint (const_argument_ref x)
+  {
+    if (x.size () != problem_.function ().inputSize ())
+      throw std::runtime_error ("invalid starting point (wrong size)");
+
+    problem_.setStartingPoint (x);
+    pendingUpdates_ |= STARTING_POINT_UPDATE;
+  }
+
+  template <typename T>
+  void
+  Solver<T>::updateArgumentBounds (const intervals_t& bounds)
+  {
+    if (static_cast<typename problem_t::size_type> (bounds.size ())
+        != problem_.function ().inputSize ())
+      throw std::runtime_error ("invalid argument bounds (wrong size)");
+
+    problem_.setArgumentBounds (bounds);
+    pendingUpdates_ |= ARGUMENT_BOUNDS_UPDATE;
+  }
+
+  template <typename T>
+  void
+  Solver<T>::updateConstraintBounds (std::size_t i, const intervals_t& bounds)
+  {
+    problem_.setConstraintBounds (i, bounds);
+    pendingUpdates_ |= CONSTRAINT_BOUNDS_UPDATE;
+  }
+
+  template <typename T>
+  void
+  Solver<T>::updateProblemParameters (const vector_t& p)
+  {
+    if (problemParameters_->size () != 0
+        && p.size () != problemParameters_->size ())
+      throw std::runtime_error ("invalid problem parameters (wrong size)");
+
+    *problemParameters_ = p;
+    pendingUpdates_ |= PARAMETERS_UPDATE;
+  }
+
+  template <typename T>
+  const typename Solver<T>::vector_t&
+  Solver<T>::problemParameters () const
+  {
+    return *problemParameters_;
+  }
+
+  template <typename T>
+  void
+  Solver<T>::setProblemParametersBuffer
+  (const boost::shared_ptr<vector_t>& parameters)
+  {
+    if (!parameters)
+      throw std::runtime_error ("invalid problem parameters buffer");
+
+    problemParameters_ = parameters;
+  }
+
+  template <typename T>
+  unsigned int
+  Solver<T>::pendingUpdates () const
+  {
+    return pendingUpdates_;
+  }
+
+  template <typename T>
+  void
+  Solver<T>::resolve ()
+  {
+    // Same as reset (), without logging: resolve may be called at a high
+    // rate (e.g. batch solving, model predictive control).
+    this->result_ = NoSolution ();
+    updateProblem (pendingUpdates_);
+    pendingUpdates_ = 0;
+    this->solve ();
+  }
+
+  template <typename T>
+  void
+  Solver<T>::updateProblem (unsigned int)
+  {
+  }
+
   template <typename T>
   std::ostream&
   Solver<T>::print (std::ostream& o) const
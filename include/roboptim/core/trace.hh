@@ -0,0 +1,227 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_TRACE_HH
+# define ROBOPTIM_CORE_TRACE_HH
+
+# include <cstddef>
+# include <iosfwd>
+# include <string>
+# include <vector>
+
+# include <boost/atomic.hpp>
+# include <boost/cstdint.hpp>
+# include <boost/noncopyable.hpp>
+
+# include <roboptim/core/portability.hh>
+# include <roboptim/core/instrumentation.hh>
+
+namespace roboptim
+{
+  /// \addtogroup roboptim_function
+  /// @{
+
+  /// \brief Span recorded by the tracer.
+  struct ROBOPTIM_DLLAPI TraceEvent
+  {
+    /// \brief Maximum length of a span name (longer names are truncated).
+    static const std::size_t nameSize = 64;
+
+    /// \brief Name of the span (e.g. function name), null-terminated.
+    char name[nameSize];
+
+    /// \brief Category of the span (e.g. "jacobian", "iteration", "io").
+    /// Categories must have a static storage duration.
+    const char* category;
+
+    /// \brief Start of the span (ns, see monotonicTime).
+    boost::uint64_t start;
+
+    /// \brief Duration of the span (ns).
+    boost::uint64_t duration;
+
+    /// \brief Optional index (e.g. iteration number), -1 if none.
+    boost::int64_t index;
+
+    /// \brief Identifier of the recording thread (starting at 1).
+    unsigned thread;
+  };
+
+  /// \brief Process-wide timeline of function evaluations, solver
+  /// iterations and logger I/O.
+  ///
+  /// Each thread records its spans in its own fixed-size ring buffer:
+  /// recording neither locks nor allocates (except for the first span of
+  /// a thread, which creates its buffer). When a buffer is full, the
+  /// oldest spans are overwritten. The spans can then be exported in the
+  /// Chrome trace format, and displayed in chrome://tracing or Perfetto.
+  ///
+  /// The tracer is disabled by default. Function evaluations are only
+  /// traced if roboptim-core is configured with the
+  /// ROBOPTIM_TRACE_EVALUATION option (see TraceScope and config.hh),
+  /// solver iterations are traced by the callback::Trace solver callback,
+  /// and the OptimizationLogger traces its I/O.
+  class ROBOPTIM_DLLAPI Tracer : public boost::noncopyable
+  {
+  public:
+    /// \brief Default number of spans per thread.
+    static const std::size_t defaultCapacity = 65536;
+
+    /// \brief Retrieve the tracer.
+    static Tracer& instance ();
+
+    /// \brief Start or stop recording spans.
+    void enable (bool enabled = true);
+
+    /// \brief Stop recording spans.
+    void disable ();
+
+    /// \brief Whether spans are recorded.
+    bool isEnabled () const
+    {
+      return enabled_.load (boost::memory_order_relaxed);
+    }
+
+    /// \brief Number of spans per thread of the buffers created afterwards.
+    ///
+    /// \param capacity number of spans, must be positive.
+    void setCapacity (std::size_t capacity);
+
+    /// \brief Number of spans per thread.
+    std::size_t capacity () const;
+
+    /// \brief Name the calling thread in the exported timeline.
+    ///
+    /// \param name thread name.
+    void setThreadName (const std::string& name);
+
+    /// \brief Record a span in the buffer of the calling thread.
+    ///
+    /// \param category category of the span (static string).
+    /// \param name name of the span (copied, possibly truncated).
+    /// \param start start of the span (ns).
+    /// \param end end of the span (ns).
+    /// \param index optional index of the span (e.g. iteration number).
+    void record (const char* category, const char* name,
+                 boost::uint64_t start, boost::uint64_t end,
+                 boost::int64_t index = -1);
+
+    /// \brief Recorded spans of all the threads, sorted by start time.
+    ///
+    /// This can be called while other threads record spans: spans that
+    /// are being overwritten, or were overwritten during the copy, are
+    /// skipped.
+    std::vector<TraceEvent> events () const;
+
+    /// \brief Number of spans overwritten since the last call to clear.
+    boost::uint64_t dropped () const;
+
+    /// \brief Discard the recorded spans.
+    void clear ();
+
+    /// \brief Export the recorded spans as Chrome trace JSON.
+    ///
+    /// \param o output stream
+    /// \return output stream
+    std::ostream& write (std::ostream& o) const;
+
+    /// \brief Export the recorded spans to a Chrome trace JSON file.
+    ///
+    /// \param filename output file.
+    /// \throw std::runtime_error
+    void write (const std::string& filename) const;
+
+  private:
+    /// \brief Ring buffer of a thread.
+    struct Buffer;
+
+    /// \brief Buffers of all the threads.
+    struct Buffers;
+
+    Tracer ();
+    ~Tracer ();
+
+    /// \brief Buffer of the calling thread (created if needed).
+    Buffer& buffer ();
+
+    /// \brief Whether spans are recorded.
+    boost::atomic<bool> enabled_;
+
+    /// \brief Buffers of all the threads.
+    Buffers* buffers_;
+  };
+
+  /// \brief Record a span covering the lifetime of the scope.
+  ///
+  /// Nothing is recorded if the tracer is disabled when the scope is
+  /// created. The evaluation front-ends (e.g. GenericFunction::operator
+  /// ()) use it when roboptim-core is configured with the
+  /// ROBOPTIM_TRACE_EVALUATION option, with the function name as span name
+  /// and the kind of evaluation as category.
+  class ROBOPTIM_DLLAPI TraceScope : public boost::noncopyable
+  {
+  public:
+    /// \param category category of the span (static string).
+    /// \param name name of the span, must outlive the scope.
+    /// \param index optional index of the span.
+    TraceScope (const char* category, const std::string& name,
+                boost::int64_t index = -1)
+      : category_ (category),
+        name_ (name.c_str ()),
+        index_ (index),
+        start_ (Tracer::instance ().isEnabled () ? monotonicTime () : 0)
+    {}
+
+    /// \param category category of the span (static string).
+    /// \param name name of the span, must outlive the scope.
+    /// \param index optional index of the span.
+    TraceScope (const char* category, const char* name,
+                boost::int64_t index = -1)
+      : category_ (category),
+        name_ (name),
+        index_ (index),
+        start_ (Tracer::instance ().isEnabled () ? monotonicTime () : 0)
+    {}
+
+    ~TraceScope ()
+    {
+      if (start_)
+        Tracer::instance ().record (category_, name_, start_,
+                                    monotonicTime (), index_);
+    }
+
+  private:
+    const char* category_;
+    const char* name_;
+    boost::int64_t index_;
+    boost::uint64_t start_;
+  };
+
+  /// \brief Override operator<< to export the trace.
+  ///
+  /// \param o output stream used for display
+  /// \param tracer tracer
+  /// \return output stream
+  ROBOPTIM_DLLAPI std::ostream&
+  operator<< (std::ostream& o, const Tracer& tracer);
+
+  /// @}
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_TRACE_HH
@@ -131,6 +131,19 @@ namespace roboptim
       set_is_malloc_allowed (false);
 #endif //! ROBOPTIM_DO_NOT_CHECK_ALLOCATION
 
+#ifdef ROBOPTIM_INSTRUMENT_EVALUATION
+      EvaluationScope evaluationScope (this->getName (), HESSIAN_EVALUATION);
+#endif //! ROBOPTIM_INSTRUMENT_EVALUATION
+
+#ifdef ROBOPTIM_TRACE_EVALUATION
+      TraceScope traceScope (evaluationName (HESSIAN_EVALUATION),
+                             this->getName ());
+#endif //! ROBOPTIM_TRACE_EVALUATION
+
+#ifdef ROBOPTIM_ACCOUNT_ALLOCATION
+      AllocationScope allocationScope (this->getName ());
+#endif //! ROBOPTIM_ACCOUNT_ALLOCATION
+
       this->impl_hessian (hessian, argument, functionId);
 
 #ifndef ROBOPTIM_DO_NOT_CHECK_ALLOCATION
@@ -15,10 +15,61 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <iomanip>
+#include <map>
+#include <ostream>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/once.hpp>
+
 #include "roboptim/core/alloc.hh"
 
 namespace roboptim
 {
+  namespace
+  {
+    /// \brief Process-wide allocation counters.
+    ///
+    /// These are zero-initialized at compile time, so that allocations made
+    /// before static initialization are counted properly.
+    boost::atomic<unsigned long> allocationCount (0);
+    boost::atomic<unsigned long> allocationBytes (0);
+
+    /// \brief Whether recording is suspended (while a function is added to
+    /// the per-function statistics).
+    boost::atomic<bool> allocationPaused (false);
+
+    typedef std::map<std::string, AllocationStats> functionStats_t;
+
+    /// \brief Per-function statistics, and the mutex guarding them.
+    struct FunctionStats
+    {
+      functionStats_t stats;
+      boost::mutex mutex;
+    };
+
+    /// \brief Flag used to create the per-function statistics once.
+    boost::once_flag functionStatsFlag = BOOST_ONCE_INIT;
+
+    /// \brief Per-function statistics (intentionally leaked, so that they
+    /// can be updated during static destruction).
+    FunctionStats* functionStatsInstance = 0;
+
+    void createFunctionStats ()
+    {
+      functionStatsInstance = new FunctionStats ();
+    }
+
+    /// \brief Per-function statistics (created on first use).
+    FunctionStats& functionStats ()
+    {
+      boost::call_once (functionStatsFlag, &createFunctionStats);
+      return *functionStatsInstance;
+    }
+  } // end of anonymous namespace
+
   bool is_malloc_allowed_update (bool update, bool new_value)
   {
     static bool value = true;
@@ -26,4 +77,124 @@ namespace roboptim
       value = new_value;
     return value;
   }
+
+  AllocationStats::AllocationStats ()
+    : allocations (0),
+      bytes (0),
+      calls (0)
+  {}
+
+  void record_allocation (std::size_t bytes)
+  {
+    if (allocationPaused.load (boost::memory_order_relaxed))
+      return;
+    allocationCount.fetch_add (1, boost::memory_order_relaxed);
+    allocationBytes.fetch_add (bytes, boost::memory_order_relaxed);
+  }
+
+  AllocationStats allocation_stats ()
+  {
+    AllocationStats stats;
+    stats.allocations = allocationCount.load (boost::memory_order_relaxed);
+    stats.bytes = allocationBytes.load (boost::memory_order_relaxed);
+    return stats;
+  }
+
+  bool allocation_accounting_update (bool update, bool new_value)
+  {
+    static bool value = false;
+    if (update)
+      value = new_value;
+    return value;
+  }
+
+  bool is_allocation_accounting_enabled ()
+  {
+    return allocation_accounting_update (false);
+  }
+
+  AllocationScope::AllocationScope ()
+    : start_ (allocation_stats ()),
+      name_ (0)
+  {}
+
+  AllocationScope::AllocationScope (const std::string& name)
+    : start_ (allocation_stats ()),
+      name_ (&name)
+  {}
+
+  AllocationScope::~AllocationScope ()
+  {
+    if (!name_)
+      return;
+
+    AllocationStats delta = stats ();
+    FunctionStats& functions = functionStats ();
+    boost::lock_guard<boost::mutex> lock (functions.mutex);
+
+    // Only adding a function allocates: recording is paused meanwhile, so
+    // that the bookkeeping is not accounted.
+    functionStats_t::iterator it = functions.stats.find (*name_);
+    if (it == functions.stats.end ())
+      {
+        bool paused = allocationPaused.exchange (true);
+        it = functions.stats.insert
+          (functionStats_t::value_type (*name_, AllocationStats ())).first;
+        allocationPaused.store (paused);
+      }
+
+    AllocationStats& total = it->second;
+    total.allocations += delta.allocations;
+    total.bytes += delta.bytes;
+    ++total.calls;
+  }
+
+  AllocationStats AllocationScope::stats () const
+  {
+    AllocationStats stats;
+    AllocationStats now = allocation_stats ();
+    stats.allocations = now.allocations - start_.allocations;
+    stats.bytes = now.bytes - start_.bytes;
+    return stats;
+  }
+
+  AllocationStats function_allocation_stats (const std::string& name)
+  {
+    FunctionStats& functions = functionStats ();
+    boost::lock_guard<boost::mutex> lock (functions.mutex);
+    functionStats_t::const_iterator it = functions.stats.find (name);
+    return it == functions.stats.end () ? AllocationStats () : it->second;
+  }
+
+  void reset_function_allocation_stats ()
+  {
+    FunctionStats& functions = functionStats ();
+    boost::lock_guard<boost::mutex> lock (functions.mutex);
+    bool paused = allocationPaused.exchange (true);
+    functions.stats.clear ();
+    allocationPaused.store (paused);
+  }
+
+  std::ostream& print_function_allocation_stats (std::ostream& o)
+  {
+    // Copy the statistics, so that the stream is not written under the
+    // lock.
+    functionStats_t stats;
+    {
+      FunctionStats& functions = functionStats ();
+      boost::lock_guard<boost::mutex> lock (functions.mutex);
+      stats = functions.stats;
+    }
+    o << std::left << std::setw (40) << "function" << std::right
+      << std::setw (12) << "calls"
+      << std::setw (14) << "allocations"
+      << std::setw (14) << "bytes" << '\n';
+    for (functionStats_t::const_iterator it = stats.begin ();
+         it != stats.end (); ++it)
+      o << std::left << std::setw (40) << it->first << std::right
+        << std::setw (12) << it->second.calls
+        << std::setw (14) << it->second.allocations
+        << std::setw (14) << it->second.bytes << '\n';
+    return o;
+  }
 } // end of namespace roboptim.
@@ -0,0 +1,500 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "debug.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+#include "roboptim/core/function.hh"
+#include "roboptim/core/problem.hh"
+#include "roboptim/core/plugin-registry.hh"
+#include "roboptim/core/result.hh"
+#include "roboptim/core/solver-error.hh"
+#include "roboptim/core/solver-warning.hh"
+#include "roboptim/core/plugin/augmented-lagrangian.hh"
+
+namespace roboptim
+{
+  class AugmentedLagrangianSolver::Lagrangian : public DifferentiableFunction
+  {
+  public:
+    Lagrangian (AugmentedLagrangianSolver* solver, size_type n)
+      : DifferentiableFunction (n, 1, "augmented Lagrangian"),
+        solver_ (solver)
+    {
+    }
+
+  protected:
+    void impl_compute (result_ref result, const_argument_ref x) const
+    {
+      result[0] = solver_->lagrangian (x);
+    }
+
+    void impl_gradient (gradient_ref gradient, const_argument_ref x,
+                        size_type) const
+    {
+      solver_->lagrangianGradient (x, gradient);
+    }
+
+  private:
+    AugmentedLagrangianSolver* solver_;
+  };
+
+  AugmentedLagrangianSolver::AugmentedLagrangianSolver (const problem_t& pb)
+    : parent_t (pb),
+      callback_ (),
+      state_ (pb),
+      stop_ (),
+      iteration_ (),
+      penalty_ (),
+      compiled_ (),
+      cost_ (0),
+      lagrangian_ (),
+      innerFactory_ (),
+      innerPlugin_ (),
+      pool_ (),
+      evaluationTask_ (),
+      partition_ (),
+      evaluateJacobians_ (false),
+      rho_ (1.),
+      valuesValid_ (false),
+      jacobiansValid_ (false)
+  {
+    parameters_["al.max-iterations"].description =
+      "maximum number of outer iterations";
+    parameters_["al.max-iterations"].value = 50;
+
+    parameters_["al.initial-penalty"].description = "initial penalty";
+    parameters_["al.initial-penalty"].value = 10.;
+
+    parameters_["al.max-penalty"].description = "maximum penalty";
+    parameters_["al.max-penalty"].value = 1e12;
+
+    parameters_["al.penalty-increase"].description =
+      "factor applied to the penalty when the constraints do not improve";
+    parameters_["al.penalty-increase"].value = 10.;
+
+    parameters_["al.sufficient-decrease"].description =
+      "required decrease ratio of the infeasibility between two iterations";
+    parameters_["al.sufficient-decrease"].value = .5;
+
+    parameters_["al.max-multiplier"].description =
+      "bound on the absolute value of the multiplier estimates";
+    parameters_["al.max-multiplier"].value = 1e20;
+
+    parameters_["al.feasibility-tolerance"].description =
+      "tolerance on the violation of the constraints and complementarity";
+    parameters_["al.feasibility-tolerance"].value = 1e-6;
+
+    parameters_["al.optimality-tolerance"].description =
+      "tolerance of the last subproblems";
+    parameters_["al.optimality-tolerance"].value = 1e-6;
+
+    parameters_["al.inner-solver"].description =
+      "plug-in solving the bound-constrained subproblems";
+    parameters_["al.inner-solver"].value = std::string ("lbfgsb");
+
+    parameters_["al.threads"].description =
+      "number of threads evaluating the constraints";
+    parameters_["al.threads"].value = 1;
+
+    stop_ = state_.registerParameter
+      ("al.stop", "whether to stop the optimization", false);
+    iteration_ = state_.registerParameter
+      ("al.iteration", "current outer iteration", 0);
+    penalty_ = state_.registerParameter
+      ("al.penalty", "current penalty", value_type (0.));
+
+    evaluationTask_ = boost::bind
+      (&AugmentedLagrangianSolver::evaluateConstraintPartition, this, _1);
+  }
+
+  AugmentedLagrangianSolver::~AugmentedLagrangianSolver ()
+  {
+    // Stop the threads before destroying their data.
+    pool_.reset ();
+  }
+
+  void
+  AugmentedLagrangianSolver::setIterationCallback (callback_t callback)
+  {
+    callback_ = callback;
+  }
+
+  const AugmentedLagrangianSolver::solverState_t&
+  AugmentedLagrangianSolver::solverState () const
+  {
+    return state_;
+  }
+
+  void
+  AugmentedLagrangianSolver::solve ()
+  {
+    const problem_t& pb = problem ();
+
+    if (!pb.function ().asType<function_t> ()
+        || pb.function ().outputSize () != 1)
+      {
+        result_ = SolverError
+          ("augmented-lagrangian: the cost function must be a scalar"
+           " differentiable function");
+        return;
+      }
+    cost_ = pb.function ().castInto<function_t> ();
+
+    compiled_ = boost::make_shared<CompiledProblem<EigenMatrixSparse> > (pb);
+    const CompiledProblem<EigenMatrixSparse>::constraintsInfo_t& constraints =
+      compiled_->constraints ();
+    for (std::size_t i = 0; i < constraints.size (); ++i)
+      if (!constraints[i].differentiable)
+        {
+          result_ = SolverError
+            ("augmented-lagrangian: the constraints must be differentiable");
+          return;
+        }
+
+    const int maxIterations = getParameter<int> ("al.max-iterations");
+    const value_type maxPenalty = getParameter<value_type> ("al.max-penalty");
+    const value_type increase =
+      getParameter<value_type> ("al.penalty-increase");
+    const value_type decrease =
+      getParameter<value_type> ("al.sufficient-decrease");
+    const value_type maxMultiplier =
+      getParameter<value_type> ("al.max-multiplier");
+    const value_type feasibilityTolerance =
+      getParameter<value_type> ("al.feasibility-tolerance");
+    const value_type optimalityTolerance =
+      getParameter<value_type> ("al.optimality-tolerance");
+    const int threads = getParameter<int> ("al.threads");
+    rho_ = getParameter<value_type> ("al.initial-penalty");
+
+    const size_type n = pb.function ().inputSize ();
+    const size_type m = compiled_->constraintsOutputSize ();
+
+    lower_ = compiled_->constraintsLowerBounds ();
+    upper_ = compiled_->constraintsUpperBounds ();
+    if ((lower_.array () > upper_.array ()).any ()
+        || (pb.argumentLowerBounds ().array ()
+            > pb.argumentUpperBounds ().array ()).any ())
+      {
+        result_ = SolverError ("augmented-lagrangian: inconsistent bounds");
+        return;
+      }
+
+    if (!prepareInnerSolver (getParameter<std::string> ("al.inner-solver")))
+      return;
+    innerSolver_t& inner = (*innerFactory_) ();
+
+    mu_.setZero (m);
+    shifted_.setZero (m);
+    g_.resize (m);
+    xEval_.resize (n);
+    costValue_.resize (1);
+    costGradient_.resize (n);
+    jacobians_.resize (constraints.size ());
+    for (std::size_t i = 0; i < constraints.size (); ++i)
+      jacobians_[i].resize (constraints[i].outputSize, n);
+    partitionConstraints
+      (threads > 1 ? static_cast<std::size_t> (threads) : 1);
+    valuesValid_ = false;
+    jacobiansValid_ = false;
+
+    if (pb.startingPoint ())
+      x_ = *pb.startingPoint ();
+    else
+      x_.setZero (n);
+    x_ = x_.cwiseMax (pb.argumentLowerBounds ())
+      .cwiseMin (pb.argumentUpperBounds ());
+
+    state_.setParameter (stop_, false);
+    state_.setParameter (iteration_, 0);
+
+    const bool innerTolerance = inner.parameters ().count ("lbfgsb.pgtol") > 0;
+    value_type tolerance = std::max (1e-2, optimalityTolerance);
+    value_type previousMeasure = std::numeric_limits<value_type>::infinity ();
+    vector_t boundMultipliers = vector_t::Zero (n);
+
+    const char* warning = 0;
+    bool converged = false;
+    int iter = 0;
+    while (iter < maxIterations)
+      {
+        // Bound-constrained subproblem.
+        if (innerTolerance)
+          inner.parameters ()["lbfgsb.pgtol"].value = tolerance;
+        inner.updateStartingPoint (x_);
+        inner.resolve ();
+
+        if (inner.minimumType () != GenericSolver::SOLVER_VALUE)
+          {
+            if (inner.minimumType () == GenericSolver::SOLVER_ERROR)
+              result_ = SolverError
+                ("augmented-lagrangian: inner solver failed: "
+                 + std::string (inner.getMinimum<SolverError> ().what ()));
+            else
+              result_ = SolverError
+                ("augmented-lagrangian: inner solver returned no solution");
+            return;
+          }
+        const Result& innerResult = inner.getMinimum<Result> ();
+        x_ = innerResult.x;
+        if (innerResult.lambda.size () >= n)
+          boundMultipliers = innerResult.lambda.head (n);
+        ++iter;
+
+        // New multipliers, infeasibility and complementarity measure
+        // (g - P (g + mu / rho) = (shifted - mu) / rho).
+        evaluateConstraints (x_, false);
+        computeShiftedMultipliers ();
+        value_type measure = 0.;
+        value_type violation = 0.;
+        for (size_type i = 0; i < m; ++i)
+          {
+            measure = std::max (measure,
+                                std::abs (shifted_[i] - mu_[i]) / rho_);
+            violation = std::max (violation,
+                                  std::max (lower_[i] - g_[i],
+                                            g_[i] - upper_[i]));
+          }
+
+        (*cost_) (costValue_, x_);
+        state_.x () = x_;
+        state_.cost () = costValue_[0];
+        state_.constraintViolation () = violation;
+        state_.setParameter (iteration_, iter);
+        state_.setParameter (penalty_, rho_);
+
+        if (callback_)
+          callback_ (pb, state_);
+
+        if (state_.parameter (stop_))
+          {
+            warning = "augmented-lagrangian: stopped by the iteration callback";
+            break;
+          }
+
+        if (violation <= feasibilityTolerance
+            && measure <= feasibilityTolerance
+            && tolerance <= optimalityTolerance)
+          {
+            converged = true;
+            break;
+          }
+
+        // Safeguarded multipliers, and penalty update.
+        mu_ = shifted_.cwiseMax (-maxMultiplier).cwiseMin (maxMultiplier);
+        if (measure > decrease * previousMeasure)
+          rho_ = std::min (increase * rho_, maxPenalty);
+        previousMeasure = measure;
+        tolerance = std::max (.1 * tolerance, optimalityTolerance);
+      }
+
+    if (!converged && !warning)
+      warning = "augmented-lagrangian: maximum number of iterations reached";
+
+    Result res (n, 1);
+    res.x = x_;
+    (*cost_) (costValue_, x_);
+    res.value = costValue_;
+    evaluateConstraints (x_, false);
+    res.constraints = g_;
+    value_type violation = 0.;
+    for (size_type i = 0; i < m; ++i)
+      violation = std::max (violation, std::max (lower_[i] - g_[i],
+                                                 g_[i] - upper_[i]));
+    res.constraint_violation = violation;
+
+    // With the augmented Lagrangian, grad f + J^T shifted is the gradient
+    // of the active bounds, hence the constraint multipliers -shifted.
+    res.lambda.resize (n + m);
+    res.lambda.head (n) = boundMultipliers;
+    res.lambda.tail (m) = -shifted_;
+
+    if (warning)
+      res.warnings.push_back (SolverWarning (warning));
+    result_ = res;
+  }
+
+  bool
+  AugmentedLagrangianSolver::prepareInnerSolver (const std::string& plugin)
+  {
+    if (innerFactory_ && innerPlugin_ == plugin)
+      {
+        (*innerFactory_) ().updateArgumentBounds (problem ().argumentBounds ());
+        return true;
+      }
+
+    if (!lagrangian_)
+      lagrangian_ = boost::make_shared<Lagrangian>
+        (this, problem ().function ().inputSize ());
+
+    innerSolver_t::problem_t innerProblem (lagrangian_);
+    innerProblem.setArgumentBounds (problem ().argumentBounds ());
+
+    try
+      {
+        innerFactory_ = boost::make_shared<innerFactory_t>
+          (plugin, innerProblem);
+      }
+    catch (const std::runtime_error& e)
+      {
+        innerFactory_.reset ();
+        result_ = SolverError
+          ("augmented-lagrangian: " + std::string (e.what ()));
+        return false;
+      }
+    innerPlugin_ = plugin;
+    return true;
+  }
+
+  void
+  AugmentedLagrangianSolver::partitionConstraints (std::size_t threads)
+  {
+    const CompiledProblem<EigenMatrixSparse>::constraintsInfo_t& constraints =
+      compiled_->constraints ();
+
+    // Functions usually have mutable buffers: constraints sharing a
+    // function object are evaluated by the same thread. Each function is
+    // given to the least loaded thread, the load being the number of rows.
+    typedef std::map<const CompiledProblem<EigenMatrixSparse>::function_t*,
+                     std::size_t> owners_t;
+    owners_t owners;
+    for (std::size_t i = 0; i < constraints.size (); ++i)
+      owners[constraints[i].function] = 0;
+    threads = std::max<std::size_t> (std::min (threads, owners.size ()), 1);
+
+    partition_.assign (threads, std::vector<std::size_t> ());
+    std::vector<size_type> load (threads, 0);
+    owners.clear ();
+    for (std::size_t i = 0; i < constraints.size (); ++i)
+      {
+        owners_t::const_iterator it = owners.find (constraints[i].function);
+        std::size_t t;
+        if (it != owners.end ())
+          t = it->second;
+        else
+          {
+            t = static_cast<std::size_t>
+              (std::min_element (load.begin (), load.end ()) - load.begin ());
+            owners[constraints[i].function] = t;
+          }
+        partition_[t].push_back (i);
+        load[t] += constraints[i].outputSize;
+      }
+
+    if (threads == 1)
+      pool_.reset ();
+    else if (!pool_ || pool_->size () != threads)
+      {
+        pool_.reset ();
+        pool_ = boost::make_shared<detail::ThreadPool> (threads);
+      }
+  }
+
+  void
+  AugmentedLagrangianSolver::evaluateConstraints
+  (DifferentiableFunction::const_argument_ref x, bool jacobian)
+  {
+    const bool samePoint = valuesValid_ && xEval_ == x;
+    if (samePoint && (!jacobian || jacobiansValid_))
+      return;
+    xEval_ = x;
+    evaluateJacobians_ = jacobian;
+
+    if (pool_)
+      pool_->run (evaluationTask_);
+    else
+      evaluateConstraintPartition (0);
+
+    valuesValid_ = true;
+    jacobiansValid_ = jacobian;
+  }
+
+  void
+  AugmentedLagrangianSolver::evaluateConstraintPartition (std::size_t thread)
+  {
+    const CompiledProblem<EigenMatrixSparse>::constraintsInfo_t& constraints =
+      compiled_->constraints ();
+    const std::vector<std::size_t>& indices = partition_[thread];
+    for (std::size_t k = 0; k < indices.size (); ++k)
+      {
+        const std::size_t i = indices[k];
+        const CompiledProblem<EigenMatrixSparse>::ConstraintInfo& c =
+          constraints[i];
+        (*c.differentiable) (g_.segment (c.rowOffset, c.outputSize), xEval_);
+        if (evaluateJacobians_)
+          {
+            jacobians_[i].setZero ();
+            c.differentiable->jacobian (jacobians_[i], xEval_);
+          }
+      }
+  }
+
+  void
+  AugmentedLagrangianSolver::computeShiftedMultipliers ()
+  {
+    for (size_type i = 0; i < g_.size (); ++i)
+      {
+        const value_type s = g_[i] + mu_[i] / rho_;
+        shifted_[i] = rho_ * (s - std::min (std::max (s, lower_[i]),
+                                            upper_[i]));
+      }
+  }
+
+  AugmentedLagrangianSolver::value_type
+  AugmentedLagrangianSolver::lagrangian
+  (DifferentiableFunction::const_argument_ref x)
+  {
+    evaluateConstraints (x, false);
+    computeShiftedMultipliers ();
+    (*cost_) (costValue_, x);
+    return costValue_[0] + .5 * shifted_.squaredNorm () / rho_;
+  }
+
+  void
+  AugmentedLagrangianSolver::lagrangianGradient
+  (DifferentiableFunction::const_argument_ref x,
+   DifferentiableFunction::gradient_ref gradient)
+  {
+    evaluateConstraints (x, true);
+    computeShiftedMultipliers ();
+
+    costGradient_.setZero ();
+    cost_->gradient (costGradient_, x, 0);
+    gradient.setZero ();
+    for (gradient_t::InnerIterator it (costGradient_); it; ++it)
+      gradient[it.index ()] = it.value ();
+
+    const CompiledProblem<EigenMatrixSparse>::constraintsInfo_t& constraints =
+      compiled_->constraints ();
+    for (std::size_t i = 0; i < constraints.size (); ++i)
+      gradient.noalias () += jacobians_[i].transpose ()
+        * shifted_.segment (constraints[i].rowOffset,
+                            constraints[i].outputSize);
+  }
+
+} // end of namespace roboptim
+
+ROBOPTIM_DEFINE_PLUGIN (augmented_lagrangian, "augmented-lagrangian", roboptim::AugmentedLagrangianSolver)
@@ -0,0 +1,731 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "roboptim/core/binary-log.hh"
+
+namespace roboptim
+{
+  namespace
+  {
+    typedef GenericFunctionTraits<EigenMatrixDense>::vector_t vector_t;
+    typedef GenericFunctionTraits<EigenMatrixDense>::matrix_t matrix_t;
+
+    /// \brief Magic number of binary logs.
+    const char fileMagic[8] = {'R', 'B', 'O', 'P', 'T', 'L', 'O', 'G'};
+
+    /// \brief Version of the format.
+    const boost::uint32_t formatVersion = 1;
+
+    /// \brief Byte order marker.
+    const boost::uint32_t byteOrder = 0x01020304;
+
+    /// \brief Magic number of records ("ITER").
+    const boost::uint32_t recordMagic = 0x52455449;
+
+    /// \brief Size of the fixed part of a record: magic, number of Jacobian
+    /// blocks, size, iteration, time, cost and violation.
+    const std::size_t recordHeaderSize = 48;
+
+    /// \brief Size of the header of a Jacobian block: constraint, format
+    /// and number of entries.
+    const std::size_t blockHeaderSize = 16;
+
+    /// \brief Formats of the Jacobian blocks.
+    enum jacobianFormat_t
+      {
+        /// \brief Row-major values.
+        DENSE_JACOBIAN = 0,
+        /// \brief (row, column, value) triplets.
+        SPARSE_JACOBIAN = 1
+      };
+
+    /// \brief Size of a sparse entry: row, column and value.
+    const std::size_t tripletSize = 16;
+
+    std::size_t padded (std::size_t n)
+    {
+      return (n + 7) & ~static_cast<std::size_t> (7);
+    }
+
+    std::size_t entrySize (boost::uint32_t format)
+    {
+      return format == SPARSE_JACOBIAN ? tripletSize : sizeof (double);
+    }
+
+    template <typename U>
+    void put (std::vector<char>& buffer, std::size_t offset, U value)
+    {
+      std::memcpy (&buffer[offset], &value, sizeof (U));
+    }
+
+    template <typename U>
+    void append (std::vector<char>& buffer, U value)
+    {
+      buffer.resize (buffer.size () + sizeof (U));
+      put (buffer, buffer.size () - sizeof (U), value);
+    }
+
+    void appendString (std::vector<char>& buffer, const std::string& s)
+    {
+      append<boost::uint64_t> (buffer, s.size ());
+      const std::size_t offset = buffer.size ();
+      buffer.resize (offset + padded (s.size ()), '\0');
+      if (!s.empty ())
+        std::memcpy (&buffer[offset], s.data (), s.size ());
+    }
+
+    template <typename U>
+    U get (const char* p)
+    {
+      U value;
+      std::memcpy (&value, p, sizeof (U));
+      return value;
+    }
+
+    /// \brief Bounds-checked parser of the header.
+    struct HeaderParser
+    {
+      HeaderParser (const char* data, std::size_t size)
+        : data_ (data),
+          size_ (size),
+          offset_ (0)
+      {}
+
+      void require (std::size_t n) const
+      {
+        if (offset_ + n > size_ || offset_ + n < offset_)
+          throw std::runtime_error ("truncated binary log header");
+      }
+
+      template <typename U>
+      U read ()
+      {
+        require (sizeof (U));
+        const U value = get<U> (data_ + offset_);
+        offset_ += sizeof (U);
+        return value;
+      }
+
+      std::string readString ()
+      {
+        const boost::uint64_t n = read<boost::uint64_t> ();
+        require (static_cast<std::size_t> (n));
+        require (padded (static_cast<std::size_t> (n)));
+        std::string s (data_ + offset_, static_cast<std::size_t> (n));
+        offset_ += padded (static_cast<std::size_t> (n));
+        return s;
+      }
+
+      const char* data_;
+      std::size_t size_;
+      std::size_t offset_;
+    };
+
+    /// \brief Offset of the value of each constraint in a record.
+    std::size_t constraintOffsets (const BinaryLogLayout& layout,
+                                   std::vector<std::size_t>& offsets)
+    {
+      std::size_t offset = recordHeaderSize
+        + sizeof (double) * static_cast<std::size_t> (layout.inputSize);
+      offsets.resize (layout.constraints.size ());
+      for (std::size_t i = 0; i < layout.constraints.size (); ++i)
+        {
+          offsets[i] = offset;
+          offset += sizeof (double)
+            * static_cast<std::size_t> (layout.constraints[i].outputSize);
+        }
+      return offset;
+    }
+
+    template <typename V>
+    void writeVector (std::ostream& o, const V& v)
+    {
+      for (typename V::Index i = 0; i < v.size (); ++i)
+        {
+          o << v[i];
+          if (i < v.size () - 1)
+            o << ", ";
+        }
+      o << "\n";
+    }
+  } // end of anonymous namespace
+
+  BinaryLogLayout::Constraint::Constraint ()
+    : name (),
+      outputSize (0),
+      differentiable (false)
+  {}
+
+  BinaryLogLayout::Constraint::Constraint (const std::string& n,
+                                           boost::uint64_t m,
+                                           bool d)
+    : name (n),
+      outputSize (m),
+      differentiable (d)
+  {}
+
+  BinaryLogLayout::BinaryLogLayout ()
+    : inputSize (0),
+      argumentNames (),
+      constraints ()
+  {}
+
+  boost::uint64_t BinaryLogLayout::constraintsOutputSize () const
+  {
+    boost::uint64_t m = 0;
+    for (std::size_t i = 0; i < constraints.size (); ++i)
+      m += constraints[i].outputSize;
+    return m;
+  }
+
+  BinaryLogWriter::BinaryLogWriter (const boost::filesystem::path& file,
+                                    const BinaryLogLayout& layout)
+    : layout_ (layout),
+      constraintOffsets_ (),
+      recordSize_ (0),
+      file_ (file, std::ios::out | std::ios::binary | std::ios::trunc),
+      record_ (),
+      records_ (0),
+      size_ (0)
+  {
+    if (!file_)
+      throw std::runtime_error ("failed to open binary log "
+                                + file.string ());
+
+    // Header.
+    std::vector<char> header (fileMagic, fileMagic + sizeof (fileMagic));
+    append (header, formatVersion);
+    append (header, byteOrder);
+    const std::size_t headerSizeOffset = header.size ();
+    append<boost::uint64_t> (header, 0);
+    append<boost::uint64_t> (header, layout_.inputSize);
+    append<boost::uint64_t> (header, layout_.argumentNames.size ());
+    append<boost::uint64_t> (header, layout_.constraints.size ());
+    for (std::size_t i = 0; i < layout_.argumentNames.size (); ++i)
+      appendString (header, layout_.argumentNames[i]);
+    for (std::size_t i = 0; i < layout_.constraints.size (); ++i)
+      {
+        append<boost::uint64_t> (header, layout_.constraints[i].outputSize);
+        append<boost::uint64_t> (header,
+                                 layout_.constraints[i].differentiable);
+        appendString (header, layout_.constraints[i].name);
+      }
+    put<boost::uint64_t> (header, headerSizeOffset, header.size ());
+
+    file_.write (&header[0], static_cast<std::streamsize> (header.size ()));
+    if (!file_)
+      throw std::runtime_error ("failed to write binary log "
+                                + file.string ());
+    size_ = header.size ();
+
+    recordSize_ = constraintOffsets (layout_, constraintOffsets_);
+    record_.reserve (recordSize_);
+  }
+
+  BinaryLogWriter::~BinaryLogWriter ()
+  {
+    file_.flush ();
+  }
+
+  const BinaryLogLayout& BinaryLogWriter::layout () const
+  {
+    return layout_;
+  }
+
+  void BinaryLogWriter::beginRecord (boost::uint64_t iteration, double time,
+                                     double cost, double violation,
+                                     const_vector_ref x)
+  {
+    assert (static_cast<boost::uint64_t> (x.size ()) == layout_.inputSize);
+
+    // The capacity of the buffer is kept between records.
+    record_.resize (recordSize_);
+
+    put (record_, 0, recordMagic);
+    put<boost::uint32_t> (record_, 4, 0);
+    put<boost::uint64_t> (record_, 16, iteration);
+    put (record_, 24, time);
+    put (record_, 32, cost);
+    put (record_, 40, violation);
+
+    for (vector_t::Index i = 0; i < x.size (); ++i)
+      put (record_, recordHeaderSize + sizeof (double)
+           * static_cast<std::size_t> (i), x[i]);
+
+    const double nan = std::numeric_limits<double>::quiet_NaN ();
+    for (std::size_t offset = recordHeaderSize
+           + sizeof (double) * static_cast<std::size_t> (layout_.inputSize);
+         offset < recordSize_; offset += sizeof (double))
+      put (record_, offset, nan);
+  }
+
+  void BinaryLogWriter::constraint (std::size_t constraint,
+                                    const_vector_ref value)
+  {
+    assert (constraint < layout_.constraints.size ());
+    assert (static_cast<boost::uint64_t> (value.size ())
+            == layout_.constraints[constraint].outputSize);
+
+    for (vector_t::Index i = 0; i < value.size (); ++i)
+      put (record_, constraintOffsets_[constraint]
+           + sizeof (double) * static_cast<std::size_t> (i), value[i]);
+  }
+
+  std::size_t BinaryLogWriter::beginJacobian (std::size_t constraint,
+                                              boost::uint32_t format,
+                                              std::size_t count,
+                                              std::size_t entry)
+  {
+    assert (constraint < layout_.constraints.size ());
+
+    const std::size_t offset = record_.size ();
+    record_.resize (offset + blockHeaderSize + padded (count * entry));
+    put (record_, offset, static_cast<boost::uint32_t> (constraint));
+    put (record_, offset + 4, format);
+    put<boost::uint64_t> (record_, offset + 8, count);
+    put (record_, 4, get<boost::uint32_t> (&record_[4]) + 1);
+    return offset + blockHeaderSize;
+  }
+
+  void BinaryLogWriter::jacobian (std::size_t constraint,
+                                  const_dense_matrix_ref jacobian)
+  {
+    assert (static_cast<boost::uint64_t> (jacobian.rows ())
+            == layout_.constraints[constraint].outputSize);
+    assert (static_cast<boost::uint64_t> (jacobian.cols ())
+            == layout_.inputSize);
+
+    std::size_t offset =
+      beginJacobian (constraint, DENSE_JACOBIAN,
+                     static_cast<std::size_t> (jacobian.size ()),
+                     sizeof (double));
+    for (matrix_t::Index i = 0; i < jacobian.rows (); ++i)
+      for (matrix_t::Index j = 0; j < jacobian.cols ();
+           ++j, offset += sizeof (double))
+        put (record_, offset, jacobian (i, j));
+  }
+
+  void BinaryLogWriter::jacobian (std::size_t constraint,
+                                  const_sparse_matrix_ref jacobian)
+  {
+    typedef GenericFunctionTraits<EigenMatrixSparse>::matrix_t
+      sparseMatrix_t;
+
+    assert (static_cast<boost::uint64_t> (jacobian.rows ())
+            == layout_.constraints[constraint].outputSize);
+    assert (static_cast<boost::uint64_t> (jacobian.cols ())
+            == layout_.inputSize);
+
+    std::size_t offset =
+      beginJacobian (constraint, SPARSE_JACOBIAN,
+                     static_cast<std::size_t> (jacobian.nonZeros ()),
+                     tripletSize);
+    for (sparseMatrix_t::Index k = 0; k < jacobian.outerSize (); ++k)
+      for (sparseMatrix_t::InnerIterator it (jacobian, k); it;
+           ++it, offset += tripletSize)
+        {
+          put (record_, offset, static_cast<boost::uint32_t> (it.row ()));
+          put (record_, offset + 4, static_cast<boost::uint32_t> (it.col ()));
+          put (record_, offset + 8, it.value ());
+        }
+  }
+
+  void BinaryLogWriter::endRecord ()
+  {
+    put<boost::uint64_t> (record_, 8, record_.size ());
+    file_.write (&record_[0], static_cast<std::streamsize> (record_.size ()));
+    if (!file_)
+      throw std::runtime_error ("failed to write binary log record");
+
+    size_ += record_.size ();
+    ++records_;
+  }
+
+  void BinaryLogWriter::flush ()
+  {
+    file_.flush ();
+  }
+
+  boost::uint64_t BinaryLogWriter::records () const
+  {
+    return records_;
+  }
+
+  boost::uint64_t BinaryLogWriter::size () const
+  {
+    return size_;
+  }
+
+  struct BinaryLogReader::Mapping
+  {
+    explicit Mapping (const boost::filesystem::path& file)
+      : file (file.string ().c_str (), boost::interprocess::read_only),
+        region (this->file, boost::interprocess::read_only)
+    {}
+
+    const char* data () const
+    {
+      return static_cast<const char*> (region.get_address ());
+    }
+
+    std::size_t size () const
+    {
+      return region.get_size ();
+    }
+
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+  };
+
+  BinaryLogReader::BinaryLogReader (const boost::filesystem::path& file)
+    : mapping_ (),
+      layout_ (),
+      constraintOffsets_ (),
+      jacobiansOffset_ (0),
+      offsets_ ()
+  {
+    if (!boost::filesystem::exists (file)
+        || boost::filesystem::file_size (file) < sizeof (fileMagic))
+      throw std::runtime_error ("invalid binary log " + file.string ());
+
+    try
+      {
+        mapping_.reset (new Mapping (file));
+      }
+    catch (const boost::interprocess::interprocess_exception& e)
+      {
+        throw std::runtime_error ("failed to map binary log "
+                                  + file.string () + ": " + e.what ());
+      }
+
+    const char* data = mapping_->data ();
+    const std::size_t size = mapping_->size ();
+
+    // Header.
+    HeaderParser parser (data, size);
+    parser.require (sizeof (fileMagic));
+    if (std::memcmp (data, fileMagic, sizeof (fileMagic)) != 0)
+      throw std::runtime_error ("invalid binary log " + file.string ());
+    parser.offset_ = sizeof (fileMagic);
+    if (parser.read<boost::uint32_t> () != formatVersion)
+      throw std::runtime_error ("unsupported binary log version");
+    if (parser.read<boost::uint32_t> () != byteOrder)
+      throw std::runtime_error ("unsupported binary log byte order");
+
+    const boost::uint64_t headerSize = parser.read<boost::uint64_t> ();
+    layout_.inputSize = parser.read<boost::uint64_t> ();
+    const boost::uint64_t names = parser.read<boost::uint64_t> ();
+    const boost::uint64_t constraints = parser.read<boost::uint64_t> ();
+    for (boost::uint64_t i = 0; i < names; ++i)
+      layout_.argumentNames.push_back (parser.readString ());
+    for (boost::uint64_t i = 0; i < constraints; ++i)
+      {
+        BinaryLogLayout::Constraint c;
+        c.outputSize = parser.read<boost::uint64_t> ();
+        c.differentiable = parser.read<boost::uint64_t> () != 0;
+        c.name = parser.readString ();
+        layout_.constraints.push_back (c);
+      }
+    if (parser.offset_ != headerSize)
+      throw std::runtime_error ("invalid binary log header");
+
+    jacobiansOffset_ = constraintOffsets (layout_, constraintOffsets_);
+
+    // Index the complete records.
+    std::size_t offset = static_cast<std::size_t> (headerSize);
+    while (offset + recordHeaderSize <= size
+           && get<boost::uint32_t> (data + offset) == recordMagic)
+      {
+        const boost::uint64_t recordSize =
+          get<boost::uint64_t> (data + offset + 8);
+        if (recordSize < jacobiansOffset_ || recordSize > size - offset)
+          break;
+        offsets_.push_back (offset);
+        offset += static_cast<std::size_t> (recordSize);
+      }
+  }
+
+  BinaryLogReader::~BinaryLogReader ()
+  {}
+
+  const BinaryLogLayout& BinaryLogReader::layout () const
+  {
+    return layout_;
+  }
+
+  std::size_t BinaryLogReader::size () const
+  {
+    return offsets_.size ();
+  }
+
+  BinaryLogReader::Record BinaryLogReader::operator[] (std::size_t i) const
+  {
+    assert (i < offsets_.size ());
+    return Record (mapping_->data () + offsets_[i], *this);
+  }
+
+  BinaryLogReader::Record::Record (const char* data,
+                                   const BinaryLogReader& reader)
+    : data_ (data),
+      reader_ (&reader)
+  {}
+
+  boost::uint64_t BinaryLogReader::Record::iteration () const
+  {
+    return get<boost::uint64_t> (data_ + 16);
+  }
+
+  double BinaryLogReader::Record::time () const
+  {
+    return get<double> (data_ + 24);
+  }
+
+  double BinaryLogReader::Record::cost () const
+  {
+    return get<double> (data_ + 32);
+  }
+
+  double BinaryLogReader::Record::violation () const
+  {
+    return get<double> (data_ + 40);
+  }
+
+  BinaryLogReader::const_vector_map BinaryLogReader::Record::x () const
+  {
+    return const_vector_map
+      (reinterpret_cast<const double*> (data_ + recordHeaderSize),
+       static_cast<vector_t::Index> (reader_->layout_.inputSize));
+  }
+
+  BinaryLogReader::const_vector_map
+  BinaryLogReader::Record::constraint (std::size_t constraint) const
+  {
+    assert (constraint < reader_->layout_.constraints.size ());
+    return const_vector_map
+      (reinterpret_cast<const double*>
+       (data_ + reader_->constraintOffsets_[constraint]),
+       static_cast<vector_t::Index>
+       (reader_->layout_.constraints[constraint].outputSize));
+  }
+
+  const char*
+  BinaryLogReader::Record::findJacobian (std::size_t constraint) const
+  {
+    const boost::uint32_t blocks = get<boost::uint32_t> (data_ + 4);
+    const std::size_t size =
+      static_cast<std::size_t> (get<boost::uint64_t> (data_ + 8));
+    std::size_t offset = reader_->jacobiansOffset_;
+
+    for (boost::uint32_t i = 0; i < blocks; ++i)
+      {
+        // The block header and entries must lie within the record.
+        if (size - offset < blockHeaderSize)
+          throw std::runtime_error ("corrupt binary log record");
+        const char* p = data_ + offset;
+        const boost::uint32_t format = get<boost::uint32_t> (p + 4);
+        if (format != DENSE_JACOBIAN && format != SPARSE_JACOBIAN)
+          throw std::runtime_error ("corrupt binary log record");
+        const boost::uint64_t count = get<boost::uint64_t> (p + 8);
+        const std::size_t available = size - offset - blockHeaderSize;
+        if (count > available / entrySize (format))
+          throw std::runtime_error ("corrupt binary log record");
+        const std::size_t blockSize = padded
+          (static_cast<std::size_t> (count) * entrySize (format));
+        if (blockSize > available)
+          throw std::runtime_error ("corrupt binary log record");
+
+        if (get<boost::uint32_t> (p) == constraint)
+          return p;
+        offset += blockHeaderSize + blockSize;
+      }
+    return 0;
+  }
+
+  bool BinaryLogReader::Record::hasJacobian (std::size_t constraint) const
+  {
+    return findJacobian (constraint) != 0;
+  }
+
+  void BinaryLogReader::Record::jacobian (std::size_t constraint,
+                                          matrix_t& jacobian) const
+  {
+    const char* block = findJacobian (constraint);
+    if (!block)
+      throw std::runtime_error ("no Jacobian logged for this constraint");
+
+    const boost::uint64_t rows =
+      reader_->layout_.constraints[constraint].outputSize;
+    const boost::uint64_t cols = reader_->layout_.inputSize;
+    const boost::uint32_t format = get<boost::uint32_t> (block + 4);
+    const boost::uint64_t count = get<boost::uint64_t> (block + 8);
+    const char* p = block + blockHeaderSize;
+
+    jacobian.setZero (static_cast<matrix_t::Index> (rows),
+                      static_cast<matrix_t::Index> (cols));
+    if (format == DENSE_JACOBIAN)
+      {
+        // Division rather than product, which may overflow.
+        if (cols == 0 ? count != 0 : count % cols != 0 || count / cols != rows)
+          throw std::runtime_error ("corrupt binary log Jacobian");
+
+        for (matrix_t::Index i = 0; i < jacobian.rows (); ++i)
+          for (matrix_t::Index j = 0; j < jacobian.cols ();
+               ++j, p += sizeof (double))
+            jacobian (i, j) = get<double> (p);
+      }
+    else
+      {
+        for (boost::uint64_t k = 0; k < count; ++k, p += tripletSize)
+          {
+            const boost::uint32_t row = get<boost::uint32_t> (p);
+            const boost::uint32_t col = get<boost::uint32_t> (p + 4);
+            if (row >= rows || col >= cols)
+              throw std::runtime_error ("corrupt binary log Jacobian");
+            jacobian (row, col) = get<double> (p + 8);
+          }
+      }
+  }
+
+  void convertBinaryLog (const boost::filesystem::path& file,
+                         const boost::filesystem::path& directory)
+  {
+    typedef BinaryLogReader::matrix_t matrix_t;
+
+    const BinaryLogReader log (file);
+    const BinaryLogLayout& layout = log.layout ();
+    const std::size_t constraints = layout.constraints.size ();
+
+    boost::filesystem::create_directories (directory);
+
+    // Iterations.
+    matrix_t jacobian;
+    for (std::size_t r = 0; r < log.size (); ++r)
+      {
+        const BinaryLogReader::Record record = log[r];
+        const boost::filesystem::path iterationPath = directory
+          / (boost::format ("iteration-%d") % record.iteration ()).str ();
+        boost::filesystem::create_directories (iterationPath);
+
+        boost::filesystem::ofstream streamX (iterationPath / "x.csv");
+        writeVector (streamX, record.x ());
+
+        boost::filesystem::ofstream streamCost (iterationPath / "cost");
+        streamCost << record.cost () << "\n";
+
+        for (std::size_t k = 0; k < constraints; ++k)
+          {
+            const boost::filesystem::path constraintPath = iterationPath
+              / (boost::format ("constraint-%d") % k).str ();
+            boost::filesystem::create_directories (constraintPath);
+
+            boost::filesystem::ofstream nameStream (constraintPath / "name");
+            nameStream << layout.constraints[k].name << "\n";
+
+            boost::filesystem::ofstream
+              valueStream (constraintPath / "value.csv");
+            writeVector (valueStream, record.constraint (k));
+
+            if (record.hasJacobian (k))
+              {
+                record.jacobian (k, jacobian);
+                boost::filesystem::ofstream
+                  jacobianStream (constraintPath / "jacobian.csv");
+                for (matrix_t::Index i = 0; i < jacobian.rows (); ++i)
+                  writeVector (jacobianStream, jacobian.row (i));
+              }
+          }
+
+        if (constraints > 0)
+          {
+            boost::filesystem::ofstream
+              streamCstrViol (iterationPath / "constraint-violation");
+            streamCstrViol << record.violation () << "\n";
+          }
+      }
+
+    // Cost evolution over time.
+    {
+      boost::filesystem::ofstream streamCost (directory / "cost-evolution.csv");
+      streamCost << "Cost\n";
+      for (std::size_t r = 0; r < log.size (); ++r)
+        streamCost << log[r].cost () << "\n";
+    }
+
+    // Constraint violation evolution over time.
+    if (constraints > 0 && log.size () > 0)
+      {
+        boost::filesystem::ofstream streamCstrViol
+          (directory / "constraint-violation-evolution.csv");
+        streamCstrViol << "Constraint violation\n";
+        for (std::size_t r = 0; r < log.size (); ++r)
+          streamCstrViol << log[r].violation () << "\n";
+      }
+
+    // X evolution over time.
+    {
+      boost::filesystem::ofstream streamX (directory / "x-evolution.csv");
+      const bool printDefaultX =
+        layout.argumentNames.size () != layout.inputSize;
+
+      if (log.size () > 0)
+        {
+          for (std::size_t i = 0; i < layout.inputSize; ++i)
+            {
+              if (i > 0)
+                streamX << ", ";
+              if (printDefaultX)
+                streamX << "X_" << i;
+              else
+                streamX << layout.argumentNames[i];
+            }
+          streamX << "\n";
+          for (std::size_t r = 0; r < log.size (); ++r)
+            writeVector (streamX, log[r].x ());
+        }
+    }
+
+    // Constraints evolution over time.
+    if (log.size () > 0)
+      for (std::size_t k = 0; k < constraints; ++k)
+        {
+          boost::filesystem::ofstream streamConstraint
+            (directory
+             / (boost::format ("constraint-%d-evolution.csv") % k).str ());
+          for (std::size_t i = 0; i < layout.constraints[k].outputSize; ++i)
+            {
+              if (i > 0)
+                streamConstraint << ", ";
+              streamConstraint << "output " << i;
+            }
+          streamConstraint << "\n";
+          for (std::size_t r = 0; r < log.size (); ++r)
+            writeVector (streamConstraint, log[r].constraint (k));
+        }
+  }
+
+} // end of namespace roboptim
@@ -0,0 +1,42 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "debug.hh"
+
+#include <boost/make_shared.hpp>
+
+#include "roboptim/core/cancellation-token.hh"
+
+namespace roboptim
+{
+  CancellationToken::CancellationToken ()
+    : cancelled_ (boost::make_shared<boost::atomic<bool> > (false))
+  {
+  }
+
+  void
+  CancellationToken::cancel ()
+  {
+    cancelled_->store (true, boost::memory_order_release);
+  }
+
+  bool
+  CancellationToken::cancelled () const
+  {
+    return cancelled_->load (boost::memory_order_acquire);
+  }
+} // end of namespace roboptim
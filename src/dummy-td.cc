@@ -21,6 +21,7 @@
 
 #include "roboptim/core/function.hh"
 #include "roboptim/core/problem.hh"
+#include "roboptim/core/plugin-registry.hh"
 #include "roboptim/core/plugin/dummy-td.hh"
 
 namespace roboptim
@@ -57,33 +58,4 @@ namespace roboptim
 
 } // end of namespace roboptim
 
-extern "C"
-{
-  using namespace roboptim;
-  typedef DummySolverTd::parent_t solver_t;
-
-  ROBOPTIM_DLLEXPORT std::size_t getSizeOfProblem ();
-  ROBOPTIM_DLLEXPORT const char* getTypeIdOfConstraintsList ();
-  ROBOPTIM_DLLEXPORT solver_t* create (const DummySolverTd::problem_t& pb);
-  ROBOPTIM_DLLEXPORT void destroy (solver_t* p);
-
-  ROBOPTIM_DLLEXPORT std::size_t getSizeOfProblem ()
-  {
-    return sizeof (solver_t::problem_t);
-  }
-
-  ROBOPTIM_DLLEXPORT const char* getTypeIdOfConstraintsList ()
-  {
-    return typeid (solver_t::problem_t::constraintsList_t).name ();
-  }
-
-  ROBOPTIM_DLLEXPORT solver_t* create (const DummySolverTd::problem_t& pb)
-  {
-    return new DummySolverTd (pb);
-  }
-
-  ROBOPTIM_DLLEXPORT void destroy (solver_t* p)
-  {
-    delete p;
-  }
-}
+ROBOPTIM_DEFINE_PLUGIN (dummy_td, "dummy-td", roboptim::DummySolverTd)
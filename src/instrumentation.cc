@@ -0,0 +1,300 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+#include <boost/functional/hash.hpp>
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <time.h>
+#endif //! _WIN32
+
+#include "roboptim/core/instrumentation.hh"
+
+namespace roboptim
+{
+  const char* evaluationName (evaluation_t kind)
+  {
+    switch (kind)
+      {
+      case COMPUTE_EVALUATION:
+        return "compute";
+      case GRADIENT_EVALUATION:
+        return "gradient";
+      case JACOBIAN_EVALUATION:
+        return "jacobian";
+      case HESSIAN_EVALUATION:
+        return "hessian";
+      default:
+        break;
+      }
+    return "unknown";
+  }
+
+  boost::uint64_t monotonicTime ()
+  {
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency (&frequency);
+    QueryPerformanceCounter (&counter);
+    return static_cast<boost::uint64_t>
+      (static_cast<double> (counter.QuadPart) * 1e9
+       / static_cast<double> (frequency.QuadPart));
+#else
+    timespec t;
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return static_cast<boost::uint64_t> (t.tv_sec) * 1000000000u
+      + static_cast<boost::uint64_t> (t.tv_nsec);
+#endif //! _WIN32
+  }
+
+  EvaluationCounters::EvaluationCounters ()
+  {
+    reset ();
+  }
+
+  std::size_t EvaluationCounters::bin (boost::uint64_t duration)
+  {
+    std::size_t b = 0;
+    while (duration > 1 && b + 1 < bins)
+      {
+        duration >>= 1;
+        ++b;
+      }
+    return b;
+  }
+
+  void EvaluationCounters::record (evaluation_t kind,
+                                   boost::uint64_t duration)
+  {
+    Stats& s = stats_[kind];
+    s.count.fetch_add (1, boost::memory_order_relaxed);
+    s.total.fetch_add (duration, boost::memory_order_relaxed);
+    s.histogram[bin (duration)].fetch_add (1, boost::memory_order_relaxed);
+
+    boost::uint64_t max = s.max.load (boost::memory_order_relaxed);
+    while (duration > max
+           && !s.max.compare_exchange_weak (max, duration,
+                                            boost::memory_order_relaxed))
+      {}
+  }
+
+  boost::uint64_t EvaluationCounters::count (evaluation_t kind) const
+  {
+    return stats_[kind].count.load (boost::memory_order_relaxed);
+  }
+
+  boost::uint64_t EvaluationCounters::totalTime (evaluation_t kind) const
+  {
+    return stats_[kind].total.load (boost::memory_order_relaxed);
+  }
+
+  boost::uint64_t EvaluationCounters::maxTime (evaluation_t kind) const
+  {
+    return stats_[kind].max.load (boost::memory_order_relaxed);
+  }
+
+  boost::uint64_t EvaluationCounters::histogram (evaluation_t kind,
+                                                 std::size_t b) const
+  {
+    return stats_[kind].histogram[b].load (boost::memory_order_relaxed);
+  }
+
+  boost::uint64_t EvaluationCounters::quantile (evaluation_t kind,
+                                                double q) const
+  {
+    const boost::uint64_t n = count (kind);
+    if (n == 0)
+      return 0;
+
+    const double rank = std::max (1., q * static_cast<double> (n));
+    boost::uint64_t cumulated = 0;
+    for (std::size_t b = 0; b < bins; ++b)
+      {
+        cumulated += histogram (kind, b);
+        if (static_cast<double> (cumulated) >= rank)
+          return std::min (boost::uint64_t (2) << b, maxTime (kind));
+      }
+    return maxTime (kind);
+  }
+
+  void EvaluationCounters::reset ()
+  {
+    for (std::size_t k = 0; k < EVALUATION_KINDS; ++k)
+      {
+        stats_[k].count.store (0, boost::memory_order_relaxed);
+        stats_[k].total.store (0, boost::memory_order_relaxed);
+        stats_[k].max.store (0, boost::memory_order_relaxed);
+        for (std::size_t b = 0; b < bins; ++b)
+          stats_[k].histogram[b].store (0, boost::memory_order_relaxed);
+      }
+  }
+
+  EvaluationRegistry::Entry::Entry (const std::string& n, std::size_t h)
+    : name (n),
+      hash (h),
+      counters ()
+  {}
+
+  EvaluationRegistry::EvaluationRegistry ()
+    : overflow_ ("<other>", 0)
+  {
+    for (std::size_t i = 0; i < capacity; ++i)
+      entries_[i].store (0, boost::memory_order_relaxed);
+  }
+
+  EvaluationRegistry::~EvaluationRegistry ()
+  {
+    for (std::size_t i = 0; i < capacity; ++i)
+      delete entries_[i].load (boost::memory_order_relaxed);
+  }
+
+  EvaluationRegistry& EvaluationRegistry::instance ()
+  {
+    // Intentionally leaked, so that functions evaluated during static
+    // destruction can still be recorded.
+    static EvaluationRegistry* registry = new EvaluationRegistry ();
+    return *registry;
+  }
+
+  EvaluationCounters& EvaluationRegistry::counters (const std::string& name)
+  {
+    const std::size_t hash = boost::hash<std::string> () (name);
+    Entry* created = 0;
+
+    for (std::size_t probe = 0; probe < capacity; ++probe)
+      {
+        boost::atomic<Entry*>& slot = entries_[(hash + probe) % capacity];
+        Entry* entry = slot.load (boost::memory_order_acquire);
+
+        if (!entry)
+          {
+            // Publish a complete entry, or use the one published
+            // concurrently by another thread.
+            if (!created)
+              created = new Entry (name, hash);
+            if (slot.compare_exchange_strong (entry, created,
+                                              boost::memory_order_acq_rel))
+              return created->counters;
+          }
+
+        if (entry->hash == hash && entry->name == name)
+          {
+            delete created;
+            return entry->counters;
+          }
+      }
+
+    delete created;
+    return overflow_.counters;
+  }
+
+  const EvaluationCounters*
+  EvaluationRegistry::find (const std::string& name) const
+  {
+    const std::size_t hash = boost::hash<std::string> () (name);
+    for (std::size_t probe = 0; probe < capacity; ++probe)
+      {
+        const Entry* entry =
+          entries_[(hash + probe) % capacity].load (boost::memory_order_acquire);
+        if (!entry)
+          break;
+        if (entry->hash == hash && entry->name == name)
+          return &entry->counters;
+      }
+    return name == overflow_.name ? &overflow_.counters : 0;
+  }
+
+  std::vector<std::string> EvaluationRegistry::names () const
+  {
+    std::vector<std::string> result;
+    for (std::size_t i = 0; i < capacity; ++i)
+      {
+        const Entry* entry = entries_[i].load (boost::memory_order_acquire);
+        if (entry)
+          result.push_back (entry->name);
+      }
+    std::sort (result.begin (), result.end ());
+
+    for (std::size_t k = 0; k < EVALUATION_KINDS; ++k)
+      if (overflow_.counters.count (static_cast<evaluation_t> (k)) > 0)
+        {
+          result.push_back (overflow_.name);
+          break;
+        }
+    return result;
+  }
+
+  void EvaluationRegistry::reset ()
+  {
+    for (std::size_t i = 0; i < capacity; ++i)
+      {
+        Entry* entry = entries_[i].load (boost::memory_order_acquire);
+        if (entry)
+          entry->counters.reset ();
+      }
+    overflow_.counters.reset ();
+  }
+
+  std::ostream& EvaluationRegistry::print (std::ostream& o) const
+  {
+    const std::vector<std::string> functions = names ();
+
+    o << std::left << std::setw (32) << "function"
+      << std::setw (10) << "kind" << std::right
+      << std::setw (12) << "calls"
+      << std::setw (14) << "total (us)"
+      << std::setw (12) << "mean (ns)"
+      << std::setw (12) << "p50 (ns)"
+      << std::setw (12) << "p99 (ns)"
+      << std::setw (12) << "max (ns)" << '\n';
+
+    for (std::size_t i = 0; i < functions.size (); ++i)
+      {
+        const EvaluationCounters* c = find (functions[i]);
+        for (std::size_t k = 0; k < EVALUATION_KINDS; ++k)
+          {
+            const evaluation_t kind = static_cast<evaluation_t> (k);
+            const boost::uint64_t n = c->count (kind);
+            if (n == 0)
+              continue;
+
+            o << std::left << std::setw (32) << functions[i]
+              << std::setw (10) << evaluationName (kind) << std::right
+              << std::setw (12) << n
+              << std::setw (14) << c->totalTime (kind) / 1000
+              << std::setw (12) << c->totalTime (kind) / n
+              << std::setw (12) << c->quantile (kind, .5)
+              << std::setw (12) << c->quantile (kind, .99)
+              << std::setw (12) << c->maxTime (kind) << '\n';
+          }
+      }
+    return o;
+  }
+
+  std::ostream& operator<< (std::ostream& o,
+                            const EvaluationRegistry& registry)
+  {
+    return registry.print (o);
+  }
+} // end of namespace roboptim.
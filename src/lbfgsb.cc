@@ -0,0 +1,585 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "debug.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "roboptim/core/alloc.hh"
+#include "roboptim/core/function.hh"
+#include "roboptim/core/problem.hh"
+#include "roboptim/core/plugin-registry.hh"
+#include "roboptim/core/result.hh"
+#include "roboptim/core/solver-error.hh"
+#include "roboptim/core/solver-warning.hh"
+#include "roboptim/core/plugin/lbfgsb.hh"
+
+namespace roboptim
+{
+  namespace
+  {
+    typedef LbfgsbSolver::value_type value_type;
+
+    const value_type epsilon = std::numeric_limits<value_type>::epsilon ();
+
+    bool
+    breakpointLess (const std::pair<value_type, LbfgsbSolver::size_type>& a,
+                    const std::pair<value_type, LbfgsbSolver::size_type>& b)
+    {
+      return a.first < b.first;
+    }
+  } // end of anonymous namespace
+
+  LbfgsbSolver::LbfgsbSolver (const problem_t& pb)
+    : parent_t (pb),
+      callback_ (),
+      state_ (pb),
+      stop_ (),
+      iteration_ (),
+      projectedGradient_ (),
+      function_ (0),
+      f_ (0.),
+      theta_ (1.),
+      memory_ (0),
+      pairs_ (0)
+  {
+    parameters_["lbfgsb.memory"].description =
+      "number of correction pairs of the Hessian approximation";
+    parameters_["lbfgsb.memory"].value = 5;
+
+    parameters_["lbfgsb.max-iterations"].description =
+      "maximum number of iterations";
+    parameters_["lbfgsb.max-iterations"].value = 1000;
+
+    parameters_["lbfgsb.max-linesearch"].description =
+      "maximum number of cost evaluations per line search";
+    parameters_["lbfgsb.max-linesearch"].value = 20;
+
+    parameters_["lbfgsb.pgtol"].description =
+      "tolerance on the infinity norm of the projected gradient";
+    parameters_["lbfgsb.pgtol"].value = 1e-5;
+
+    parameters_["lbfgsb.ftol"].description =
+      "tolerance on the relative reduction of the cost";
+    parameters_["lbfgsb.ftol"].value = 1e7 * epsilon;
+
+    stop_ = state_.registerParameter
+      ("lbfgsb.stop", "whether to stop the optimization", false);
+    iteration_ = state_.registerParameter
+      ("lbfgsb.iteration", "current iteration", 0);
+    projectedGradient_ = state_.registerParameter
+      ("lbfgsb.projected-gradient", "infinity norm of the projected gradient",
+       value_type (0.));
+  }
+
+  LbfgsbSolver::~LbfgsbSolver ()
+  {
+  }
+
+  void
+  LbfgsbSolver::setIterationCallback (callback_t callback)
+  {
+    callback_ = callback;
+  }
+
+  const LbfgsbSolver::solverState_t&
+  LbfgsbSolver::solverState () const
+  {
+    return state_;
+  }
+
+  void
+  LbfgsbSolver::solve ()
+  {
+    const problem_t& pb = problem ();
+
+    if (!pb.constraints ().empty ())
+      {
+        result_ = SolverError
+          ("lbfgsb: only argument bounds are supported");
+        return;
+      }
+
+    if (!pb.function ().asType<DifferentiableFunction> ()
+        || pb.function ().outputSize () != 1)
+      {
+        result_ = SolverError
+          ("lbfgsb: the cost function must be a scalar differentiable"
+           " function");
+        return;
+      }
+    function_ = pb.function ().castInto<DifferentiableFunction> ();
+
+    const int memory = getParameter<int> ("lbfgsb.memory");
+    const int maxIterations = getParameter<int> ("lbfgsb.max-iterations");
+    const int maxLineSearch = getParameter<int> ("lbfgsb.max-linesearch");
+    const value_type pgtol = getParameter<value_type> ("lbfgsb.pgtol");
+    const value_type ftol = getParameter<value_type> ("lbfgsb.ftol");
+
+    if (memory < 1)
+      {
+        result_ = SolverError ("lbfgsb: lbfgsb.memory must be positive");
+        return;
+      }
+
+    const size_type n = function_->inputSize ();
+    allocate (n, memory);
+
+    lb_ = pb.argumentLowerBounds ();
+    ub_ = pb.argumentUpperBounds ();
+    if ((lb_.array () > ub_.array ()).any ())
+      {
+        result_ = SolverError ("lbfgsb: inconsistent argument bounds");
+        return;
+      }
+
+    if (pb.startingPoint ())
+      x_ = *pb.startingPoint ();
+    else
+      x_.setZero ();
+    x_ = x_.cwiseMax (lb_).cwiseMin (ub_);
+
+    state_.setParameter (stop_, false);
+    state_.setParameter (iteration_, 0);
+    state_.setParameter (projectedGradient_, 0.);
+    state_.x () = x_;
+
+    resetMemory ();
+    f_ = evaluate (x_, g_);
+
+    const char* warning = 0;
+    bool converged = projectedGradientNorm () <= pgtol;
+    int iter = 0;
+
+    set_is_malloc_allowed (false);
+    while (!converged && iter < maxIterations)
+      {
+        computeCauchyPoint ();
+        minimizeSubspace ();
+
+        direction_ = xBar_ - x_;
+        const value_type slope = g_.dot (direction_);
+        if (!(slope < 0.))
+          {
+            // The Hessian approximation is not reliable anymore: restart
+            // from the steepest descent.
+            if (pairs_ > 0)
+              {
+                resetMemory ();
+                continue;
+              }
+            warning = "lbfgsb: no descent direction";
+            break;
+          }
+
+        // Backtracking line search between x and xBar (the segment is
+        // feasible), with a safeguarded quadratic interpolation.
+        xPrevious_ = x_;
+        gPrevious_ = g_;
+        const value_type fPrevious = f_;
+
+        value_type step = 1.;
+        if (pairs_ == 0)
+          step = std::min (1., 1. / direction_.norm ());
+
+        bool accepted = false;
+        for (int i = 0; i < maxLineSearch; ++i)
+          {
+            x_ = xPrevious_ + step * direction_;
+            f_ = evaluate (x_, g_);
+            if (f_ <= fPrevious + 1e-4 * step * slope)
+              {
+                accepted = true;
+                break;
+              }
+
+            const value_type curvature =
+              2. * (f_ - fPrevious - step * slope);
+            const value_type trial = curvature > 0.
+              ? -slope * step * step / curvature
+              : .5 * step;
+            step = std::max (.1 * step, std::min (.5 * step, trial));
+          }
+
+        if (!accepted)
+          {
+            x_ = xPrevious_;
+            g_ = gPrevious_;
+            f_ = fPrevious;
+            if (pairs_ > 0)
+              {
+                resetMemory ();
+                continue;
+              }
+            warning = "lbfgsb: line search failed";
+            break;
+          }
+
+        ++iter;
+        s_ = x_ - xPrevious_;
+        y_ = g_ - gPrevious_;
+        updateMemory ();
+
+        const value_type pgNorm = projectedGradientNorm ();
+
+        state_.x () = x_;
+        state_.cost () = f_;
+        state_.constraintViolation () = 0.;
+        state_.setParameter (iteration_, iter);
+        state_.setParameter (projectedGradient_, pgNorm);
+
+        if (callback_)
+          {
+            set_is_malloc_allowed (true);
+            callback_ (pb, state_);
+            set_is_malloc_allowed (false);
+          }
+
+        if (state_.parameter (stop_))
+          {
+            warning = "lbfgsb: stopped by the iteration callback";
+            break;
+          }
+
+        converged = pgNorm <= pgtol
+          || fPrevious - f_ <= ftol * std::max (std::max (std::abs (fPrevious),
+                                                          std::abs (f_)),
+                                                1.);
+      }
+    set_is_malloc_allowed (true);
+
+    if (!converged && !warning)
+      warning = "lbfgsb: maximum number of iterations reached";
+
+    Result res (n, 1);
+    res.x = x_;
+    res.value[0] = f_;
+    res.constraint_violation = 0.;
+
+    // Multipliers of the active bounds: positive for lower bounds, negative
+    // for upper bounds.
+    res.lambda = vector_t::Zero (n);
+    for (size_type i = 0; i < n; ++i)
+      if ((x_[i] <= lb_[i] && g_[i] > 0.) || (x_[i] >= ub_[i] && g_[i] < 0.))
+        res.lambda[i] = g_[i];
+
+    if (warning)
+      res.warnings.push_back (SolverWarning (warning));
+    result_ = res;
+  }
+
+  void
+  LbfgsbSolver::allocate (size_type n, size_type m)
+  {
+    memory_ = m;
+
+    lb_.resize (n);
+    ub_.resize (n);
+    x_.resize (n);
+    g_.resize (n);
+    xPrevious_.resize (n);
+    gPrevious_.resize (n);
+    value_.resize (1);
+    xCauchy_.resize (n);
+    xBar_.resize (n);
+    direction_.resize (n);
+    d_.resize (n);
+    r_.resize (n);
+    du_.resize (n);
+    s_.resize (n);
+    y_.resize (n);
+
+    S_.resize (n, m);
+    Y_.resize (n, m);
+    SS_.resize (m, m);
+    SY_.resize (m, m);
+    W_.resize (n, 2 * m);
+
+    Minv_.resize (2 * m, 2 * m);
+    M_.resize (2 * m, 2 * m);
+    identity_.setIdentity (2 * m, 2 * m);
+    WtW_.resize (2 * m, 2 * m);
+    N_.resize (2 * m, 2 * m);
+    if (luM_.rows () != 2 * m)
+      {
+        luM_ = Eigen::PartialPivLU<matrix_t> (2 * m);
+        luN_ = Eigen::PartialPivLU<matrix_t> (2 * m);
+      }
+
+    p_.resize (2 * m);
+    c_.resize (2 * m);
+    wb_.resize (2 * m);
+    Mp_.resize (2 * m);
+    Mc_.resize (2 * m);
+    Mw_.resize (2 * m);
+    v_.resize (2 * m);
+    Nv_.resize (2 * m);
+
+    breakpoints_.resize (static_cast<std::size_t> (n));
+    free_.resize (static_cast<std::size_t> (n));
+  }
+
+  void
+  LbfgsbSolver::resetMemory ()
+  {
+    pairs_ = 0;
+    theta_ = 1.;
+    S_.setZero ();
+    Y_.setZero ();
+    SS_.setZero ();
+    SY_.setZero ();
+    W_.setZero ();
+    M_.setIdentity ();
+  }
+
+  bool
+  LbfgsbSolver::updateMemory ()
+  {
+    const value_type sy = s_.dot (y_);
+    const value_type yy = y_.squaredNorm ();
+
+    // Skip the pair if the curvature condition does not hold, so that the
+    // Hessian approximation stays positive definite.
+    if (!(sy > epsilon * yy))
+      return false;
+
+    const size_type m = memory_;
+    if (pairs_ == m)
+      {
+        // Drop the oldest pair.
+        for (size_type j = 0; j + 1 < m; ++j)
+          {
+            S_.col (j) = S_.col (j + 1);
+            Y_.col (j) = Y_.col (j + 1);
+          }
+        for (size_type i = 0; i + 1 < m; ++i)
+          for (size_type j = 0; j + 1 < m; ++j)
+            {
+              SS_ (i, j) = SS_ (i + 1, j + 1);
+              SY_ (i, j) = SY_ (i + 1, j + 1);
+            }
+      }
+    else
+      ++pairs_;
+
+    const size_type k = pairs_ - 1;
+    S_.col (k) = s_;
+    Y_.col (k) = y_;
+    for (size_type i = 0; i <= k; ++i)
+      {
+        SS_ (i, k) = SS_ (k, i) = S_.col (i).dot (s_);
+        SY_ (k, i) = s_.dot (Y_.col (i));
+        SY_ (i, k) = S_.col (i).dot (y_);
+      }
+    theta_ = yy / sy;
+
+    // W = [Y, theta S].
+    W_.leftCols (m) = Y_;
+    W_.rightCols (m) = theta_ * S_;
+
+    // Inverse of the middle matrix:
+    //   [ -D  L^T         ]
+    //   [  L  theta S^T S ]
+    // where D = diag (s_i^T y_i) and L is the strictly lower triangular part
+    // of S^T Y. The unused pairs are replaced by the identity, which does not
+    // change B since the corresponding columns of W are zero.
+    Minv_.setIdentity ();
+    for (size_type i = 0; i < pairs_; ++i)
+      {
+        Minv_ (i, i) = -SY_ (i, i);
+        for (size_type j = 0; j < i; ++j)
+          {
+            Minv_ (m + i, j) = SY_ (i, j);
+            Minv_ (j, m + i) = SY_ (i, j);
+          }
+        for (size_type j = 0; j < pairs_; ++j)
+          Minv_ (m + i, m + j) = theta_ * SS_ (i, j);
+      }
+    luM_.compute (Minv_);
+    M_.noalias () = luM_.solve (identity_);
+    return true;
+  }
+
+  void
+  LbfgsbSolver::computeCauchyPoint ()
+  {
+    const size_type n = x_.size ();
+    const value_type infinity = std::numeric_limits<value_type>::infinity ();
+
+    // Breakpoints of the projected steepest descent path x (t) = P (x - t g).
+    std::size_t breakpoints = 0;
+    xCauchy_ = x_;
+    for (size_type i = 0; i < n; ++i)
+      {
+        value_type t = infinity;
+        if (g_[i] < 0.)
+          t = (x_[i] - ub_[i]) / g_[i];
+        else if (g_[i] > 0.)
+          t = (x_[i] - lb_[i]) / g_[i];
+
+        if (t <= 0.)
+          d_[i] = 0.;
+        else
+          {
+            d_[i] = -g_[i];
+            if (t < infinity)
+              breakpoints_[breakpoints++] = breakpoint_t (t, i);
+          }
+      }
+    std::sort (breakpoints_.begin (),
+               breakpoints_.begin ()
+               + static_cast<std::ptrdiff_t> (breakpoints),
+               &breakpointLess);
+
+    // First and second derivatives of the quadratic model along the path.
+    p_.noalias () = W_.transpose () * d_;
+    c_.setZero ();
+    value_type df = -d_.squaredNorm ();
+    if (!(df < 0.))
+      return;
+
+    Mp_.noalias () = M_ * p_;
+    value_type d2f = -theta_ * df - p_.dot (Mp_);
+    const value_type d2f0 = d2f;
+    value_type dtMin = -df / d2f;
+    value_type tOld = 0.;
+
+    for (std::size_t b = 0; b < breakpoints; ++b)
+      {
+        const value_type t = breakpoints_[b].first;
+        const size_type i = breakpoints_[b].second;
+        const value_type dt = t - tOld;
+        if (dtMin < dt)
+          break;
+
+        // Move to the breakpoint: variable i becomes active.
+        xCauchy_[i] = d_[i] > 0. ? ub_[i] : lb_[i];
+        const value_type z = xCauchy_[i] - x_[i];
+        const value_type gb = g_[i];
+
+        c_ += dt * p_;
+        wb_ = W_.row (i).transpose ();
+        Mc_.noalias () = M_ * c_;
+        Mp_.noalias () = M_ * p_;
+        Mw_.noalias () = M_ * wb_;
+
+        df += dt * d2f + gb * gb + theta_ * gb * z - gb * wb_.dot (Mc_);
+        d2f += -theta_ * gb * gb - 2. * gb * wb_.dot (Mp_)
+          - gb * gb * wb_.dot (Mw_);
+        d2f = std::max (epsilon * d2f0, d2f);
+
+        p_ += gb * wb_;
+        d_[i] = 0.;
+        dtMin = -df / d2f;
+        tOld = t;
+      }
+
+    dtMin = std::max (dtMin, 0.);
+    tOld += dtMin;
+    for (size_type i = 0; i < n; ++i)
+      if (d_[i] != 0.)
+        xCauchy_[i] = std::min (std::max (x_[i] + tOld * d_[i], lb_[i]),
+                                ub_[i]);
+    c_ += dtMin * p_;
+  }
+
+  void
+  LbfgsbSolver::minimizeSubspace ()
+  {
+    const size_type n = x_.size ();
+
+    xBar_ = xCauchy_;
+
+    std::size_t free = 0;
+    for (size_type i = 0; i < n; ++i)
+      if (xCauchy_[i] > lb_[i] && xCauchy_[i] < ub_[i])
+        free_[free++] = i;
+    if (free == 0)
+      return;
+
+    // Reduced gradient of the model at the Cauchy point:
+    //   r = Z^T (g + theta (xc - x) - W M c)
+    Mc_.noalias () = M_ * c_;
+    v_.setZero ();
+    WtW_.setZero ();
+    for (std::size_t f = 0; f < free; ++f)
+      {
+        const size_type i = free_[f];
+        wb_ = W_.row (i).transpose ();
+        r_[i] = g_[i] + theta_ * (xCauchy_[i] - x_[i]) - wb_.dot (Mc_);
+        v_ += r_[i] * wb_;
+        WtW_.noalias () += wb_ * wb_.transpose ();
+      }
+
+    // Newton step on the free variables, using the Sherman-Morrison-Woodbury
+    // formula for the reduced Hessian approximation:
+    //   du = -r / theta - Z^T W N^-1 M W^T Z r / theta^2
+    //   N = I - M W^T Z Z^T W / theta
+    Mp_.noalias () = M_ * v_;
+    N_ = identity_;
+    N_.noalias () -= (1. / theta_) * M_ * WtW_;
+    luN_.compute (N_);
+    Nv_.noalias () = luN_.solve (Mp_);
+
+    // Largest step in [0, 1] keeping the free variables feasible.
+    value_type alpha = 1.;
+    for (std::size_t f = 0; f < free; ++f)
+      {
+        const size_type i = free_[f];
+        wb_ = W_.row (i).transpose ();
+        du_[i] = -r_[i] / theta_ - wb_.dot (Nv_) / (theta_ * theta_);
+
+        if (du_[i] > 0.)
+          alpha = std::min (alpha, (ub_[i] - xCauchy_[i]) / du_[i]);
+        else if (du_[i] < 0.)
+          alpha = std::min (alpha, (lb_[i] - xCauchy_[i]) / du_[i]);
+      }
+
+    for (std::size_t f = 0; f < free; ++f)
+      {
+        const size_type i = free_[f];
+        xBar_[i] = xCauchy_[i] + alpha * du_[i];
+      }
+  }
+
+  LbfgsbSolver::value_type
+  LbfgsbSolver::projectedGradientNorm () const
+  {
+    value_type norm = 0.;
+    for (size_type i = 0; i < x_.size (); ++i)
+      {
+        const value_type pg =
+          std::min (std::max (x_[i] - g_[i], lb_[i]), ub_[i]) - x_[i];
+        norm = std::max (norm, std::abs (pg));
+      }
+    return norm;
+  }
+
+  LbfgsbSolver::value_type
+  LbfgsbSolver::evaluate (const vector_t& x, vector_t& g)
+  {
+    (*function_) (value_, x);
+    g.setZero ();
+    function_->gradient (g, x, 0);
+    return value_[0];
+  }
+
+} // end of namespace roboptim
+
+ROBOPTIM_DEFINE_PLUGIN (lbfgsb, "lbfgsb", roboptim::LbfgsbSolver)
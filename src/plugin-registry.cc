@@ -0,0 +1,269 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "debug.hh"
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/once.hpp>
+
+#include "roboptim/core/plugin-registry.hh"
+
+namespace roboptim
+{
+  namespace
+  {
+    /// \brief Flag used to create the registry once.
+    boost::once_flag registryFlag = BOOST_ONCE_INIT;
+
+    /// \brief Registry instance.
+    PluginRegistry* registry = 0;
+
+    /// \brief Mutex protecting the registry.
+    boost::mutex* registryMutex = 0;
+
+    /// \brief Resolve a plug-in symbol.
+    ///
+    /// \param handle plug-in handle.
+    /// \param symbol symbol name.
+    /// \param required whether a missing symbol is an error.
+    /// \return resolved symbol (null if not found and not required).
+    /// \throw std::runtime_error
+    void* resolve (lt_dlhandle handle, const char* symbol, bool required)
+    {
+      void* ptr = lt_dlsym (handle, symbol);
+      if (!ptr && required)
+	{
+	  std::stringstream sserror;
+	  sserror << "libltdl failed to find symbol ``" << symbol << "'': "
+		  << lt_dlerror ();
+
+	  if (lt_dlclose (handle))
+	    sserror << " (lt_dlclose failed too)";
+	  throw std::runtime_error (sserror.str ().c_str ());
+	}
+      return ptr;
+    }
+  } // end of anonymous namespace
+
+  PluginRegistry::Plugin::Plugin ()
+    : name (),
+      handle (),
+      isStatic (false),
+      getSizeOfProblem (0),
+      getTypeIdOfConstraintsList (0),
+      create (0),
+      destroy (0),
+      validated (),
+      users (0)
+  {
+  }
+
+  PluginRegistry::PluginRegistry ()
+    : ltdlInitialized_ (false),
+      plugins_ ()
+  {
+  }
+
+  PluginRegistry::~PluginRegistry ()
+  {
+    for (plugins_t::iterator
+	   it = plugins_.begin (); it != plugins_.end (); ++it)
+      {
+	if (it->second.handle && lt_dlclose (it->second.handle))
+	  {
+	    std::cerr << "libltdl failed to close plug-in: "
+		      << lt_dlerror () << std::endl;
+	  }
+      }
+    plugins_.clear ();
+
+    if (ltdlInitialized_ && lt_dlexit ())
+      {
+	std::cerr << "libltdl failed to exit: "
+		  << lt_dlerror () << std::endl;
+      }
+  }
+
+  void
+  PluginRegistry::createInstance ()
+  {
+    // The mutex is created before the registry, so that it is destroyed
+    // after it.
+    static boost::mutex mutex;
+    static PluginRegistry instance;
+    registryMutex = &mutex;
+    registry = &instance;
+  }
+
+  PluginRegistry&
+  PluginRegistry::instance ()
+  {
+    boost::call_once (registryFlag, &PluginRegistry::createInstance);
+    return *registry;
+  }
+
+  void
+  PluginRegistry::load (const std::string& plugin, Plugin& entry)
+  {
+    if (!ltdlInitialized_)
+      {
+	if (lt_dlinit () > 0)
+	  throw std::runtime_error ("failed to initialize libltdl.");
+	ltdlInitialized_ = true;
+      }
+
+    std::stringstream ss;
+    ss << "roboptim-core-plugin-" << plugin;
+    lt_dlhandle handle = lt_dlopenext (ss.str ().c_str ());
+    if (!handle)
+      {
+	std::stringstream sserror;
+	std::string err = lt_dlerror ();
+	sserror << "libltdl failed to load plug-in ``" << ss.str () << "'': "
+		<< err;
+	if (err == "file not found")
+	  sserror << "\nIs the plug-in in your LTDL_LIBRARY_PATH or LD_LIBRARY_PATH?";
+	throw std::runtime_error (sserror.str ().c_str ());
+      }
+
+    entry.name = ss.str ();
+    entry.getSizeOfProblem = resolve (handle, "getSizeOfProblem", true);
+    entry.getTypeIdOfConstraintsList =
+      resolve (handle, "getTypeIdOfConstraintsList", true);
+    entry.create = resolve (handle, "create", true);
+    entry.destroy = resolve (handle, "destroy", false);
+    entry.handle = handle;
+  }
+
+  const PluginRegistry::Plugin&
+  PluginRegistry::acquire (const std::string& plugin)
+  {
+    boost::mutex::scoped_lock lock (*registryMutex);
+
+    plugins_t::iterator it = plugins_.find (plugin);
+    if (it == plugins_.end ())
+      {
+	Plugin entry;
+	load (plugin, entry);
+	it = plugins_.insert (std::make_pair (plugin, entry)).first;
+      }
+
+    ++it->second.users;
+    return it->second;
+  }
+
+  void
+  PluginRegistry::release (const std::string& plugin)
+  {
+    boost::mutex::scoped_lock lock (*registryMutex);
+
+    plugins_t::iterator it = plugins_.find (plugin);
+    if (it != plugins_.end () && it->second.users > 0)
+      --it->second.users;
+  }
+
+  bool
+  PluginRegistry::isLoaded (const std::string& plugin) const
+  {
+    boost::mutex::scoped_lock lock (*registryMutex);
+    return plugins_.find (plugin) != plugins_.end ();
+  }
+
+  bool
+  PluginRegistry::isStatic (const std::string& plugin) const
+  {
+    boost::mutex::scoped_lock lock (*registryMutex);
+
+    plugins_t::const_iterator it = plugins_.find (plugin);
+    return it != plugins_.end () && it->second.isStatic;
+  }
+
+  bool
+  PluginRegistry::isValidated (const std::string& plugin,
+			       const std::string& solver) const
+  {
+    boost::mutex::scoped_lock lock (*registryMutex);
+
+    plugins_t::const_iterator it = plugins_.find (plugin);
+    return it != plugins_.end ()
+      && it->second.validated.find (solver) != it->second.validated.end ();
+  }
+
+  void
+  PluginRegistry::setValidated (const std::string& plugin,
+				const std::string& solver)
+  {
+    boost::mutex::scoped_lock lock (*registryMutex);
+
+    plugins_t::iterator it = plugins_.find (plugin);
+    if (it != plugins_.end ())
+      it->second.validated.insert (solver);
+  }
+
+  std::size_t
+  PluginRegistry::unloadUnused ()
+  {
+    boost::mutex::scoped_lock lock (*registryMutex);
+
+    std::size_t n = 0;
+    for (plugins_t::iterator it = plugins_.begin (); it != plugins_.end ();)
+      {
+	if (it->second.users == 0 && !it->second.isStatic)
+	  {
+	    if (it->second.handle && lt_dlclose (it->second.handle))
+	      {
+		std::cerr << "libltdl failed to close plug-in: "
+			  << lt_dlerror () << std::endl;
+	      }
+	    plugins_.erase (it++);
+	    ++n;
+	  }
+	else
+	  ++it;
+      }
+    return n;
+  }
+
+  void
+  PluginRegistry::registerStatic (const std::string& plugin,
+				  void* getSizeOfProblem,
+				  void* getTypeIdOfConstraintsList,
+				  void* create,
+				  void* destroy)
+  {
+    boost::mutex::scoped_lock lock (*registryMutex);
+
+    // Keep the existing plug-in: solvers may depend on it.
+    if (plugins_.find (plugin) != plugins_.end ())
+      return;
+
+    Plugin entry;
+    entry.name = plugin;
+    entry.isStatic = true;
+    entry.getSizeOfProblem = getSizeOfProblem;
+    entry.getTypeIdOfConstraintsList = getTypeIdOfConstraintsList;
+    entry.create = create;
+    entry.destroy = destroy;
+    plugins_.insert (std::make_pair (plugin, entry));
+  }
+
+} // end of namespace roboptim
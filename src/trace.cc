@@ -0,0 +1,383 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <fstream>
+#include <ios>
+#include <ostream>
+#include <stdexcept>
+
+#include <boost/scoped_array.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+#ifdef _WIN32
+# include <process.h>
+#else
+# include <unistd.h>
+#endif //! _WIN32
+
+#include "roboptim/core/trace.hh"
+
+namespace roboptim
+{
+  namespace
+  {
+    int processId ()
+    {
+#ifdef _WIN32
+      return _getpid ();
+#else
+      return static_cast<int> (getpid ());
+#endif //! _WIN32
+    }
+
+    /// \brief Write a JSON string.
+    void writeString (std::ostream& o, const char* s)
+    {
+      static const char hex[] = "0123456789abcdef";
+
+      o << '"';
+      for (; s && *s; ++s)
+        {
+          const unsigned char c = static_cast<unsigned char> (*s);
+          switch (c)
+            {
+            case '"':
+              o << "\\\"";
+              break;
+            case '\\':
+              o << "\\\\";
+              break;
+            case '\n':
+              o << "\\n";
+              break;
+            case '\t':
+              o << "\\t";
+              break;
+            default:
+              if (c < 0x20)
+                o << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+              else
+                o << *s;
+            }
+        }
+      o << '"';
+    }
+
+    /// \brief Write a time in microseconds, the unit of Chrome traces.
+    void writeTime (std::ostream& o, boost::uint64_t t)
+    {
+      o << t / 1000 << '.';
+      const boost::uint64_t ns = t % 1000;
+      if (ns < 100)
+        o << '0';
+      if (ns < 10)
+        o << '0';
+      o << ns;
+    }
+
+    bool startsBefore (const TraceEvent& a, const TraceEvent& b)
+    {
+      return a.start < b.start;
+    }
+  } // end of anonymous namespace
+
+  struct Tracer::Buffer : public boost::noncopyable
+  {
+    Buffer (std::size_t capacity, unsigned t)
+      : events (capacity),
+        sequences (new boost::atomic<boost::uint64_t>[capacity]),
+        thread (t),
+        name (),
+        head (0),
+        tail (0)
+    {
+      for (std::size_t i = 0; i < capacity; ++i)
+        sequences[i].store (0, boost::memory_order_relaxed);
+    }
+
+    /// \brief Ring buffer of spans.
+    std::vector<TraceEvent> events;
+
+    /// \brief Sequence numbers of the slots of the ring buffer: 2 i + 1
+    /// while the i-th span is written, 2 i + 2 once it is complete.
+    boost::scoped_array<boost::atomic<boost::uint64_t> > sequences;
+
+    /// \brief Thread identifier.
+    unsigned thread;
+
+    /// \brief Thread name (guarded by the mutex of the tracer).
+    std::string name;
+
+    /// \brief Number of spans recorded by the thread. Only the owning
+    /// thread writes it, after writing the span.
+    boost::atomic<boost::uint64_t> head;
+
+    /// \brief Index of the first span that was not cleared.
+    boost::atomic<boost::uint64_t> tail;
+  };
+
+  struct Tracer::Buffers : public boost::noncopyable
+  {
+    Buffers ()
+      : mutex (),
+        capacity (Tracer::defaultCapacity),
+        all (),
+        local (&release)
+    {}
+
+    /// \brief Buffers are owned by the tracer, and survive their thread
+    /// so that they can be exported.
+    static void release (Buffer*)
+    {}
+
+    /// \brief Mutex guarding the list of buffers and the thread names.
+    mutable boost::mutex mutex;
+
+    /// \brief Capacity of the new buffers.
+    std::size_t capacity;
+
+    /// \brief Buffers of all the threads.
+    std::vector<Buffer*> all;
+
+    /// \brief Buffer of the calling thread.
+    boost::thread_specific_ptr<Buffer> local;
+  };
+
+  Tracer::Tracer ()
+    : enabled_ (false),
+      buffers_ (new Buffers ())
+  {}
+
+  Tracer::~Tracer ()
+  {
+    for (std::size_t i = 0; i < buffers_->all.size (); ++i)
+      delete buffers_->all[i];
+    delete buffers_;
+  }
+
+  Tracer& Tracer::instance ()
+  {
+    // Intentionally leaked, so that spans recorded during static
+    // destruction or by detached threads remain valid.
+    static Tracer* tracer = new Tracer ();
+    return *tracer;
+  }
+
+  void Tracer::enable (bool enabled)
+  {
+    enabled_.store (enabled, boost::memory_order_relaxed);
+  }
+
+  void Tracer::disable ()
+  {
+    enable (false);
+  }
+
+  void Tracer::setCapacity (std::size_t capacity)
+  {
+    if (capacity == 0)
+      throw std::runtime_error ("trace buffer capacity must be positive");
+
+    boost::lock_guard<boost::mutex> lock (buffers_->mutex);
+    buffers_->capacity = capacity;
+  }
+
+  std::size_t Tracer::capacity () const
+  {
+    boost::lock_guard<boost::mutex> lock (buffers_->mutex);
+    return buffers_->capacity;
+  }
+
+  Tracer::Buffer& Tracer::buffer ()
+  {
+    Buffer* b = buffers_->local.get ();
+    if (b)
+      return *b;
+
+    boost::lock_guard<boost::mutex> lock (buffers_->mutex);
+    b = new Buffer (buffers_->capacity,
+                    static_cast<unsigned> (buffers_->all.size () + 1));
+    buffers_->all.push_back (b);
+    buffers_->local.reset (b);
+    return *b;
+  }
+
+  void Tracer::setThreadName (const std::string& name)
+  {
+    Buffer& b = buffer ();
+    boost::lock_guard<boost::mutex> lock (buffers_->mutex);
+    b.name = name;
+  }
+
+  void Tracer::record (const char* category, const char* name,
+                       boost::uint64_t start, boost::uint64_t end,
+                       boost::int64_t index)
+  {
+    Buffer& b = buffer ();
+    const boost::uint64_t head = b.head.load (boost::memory_order_relaxed);
+    const std::size_t slot = static_cast<std::size_t> (head % b.events.size ());
+    TraceEvent& event = b.events[slot];
+
+    // Mark the slot as being written, so that concurrent readers discard
+    // it (seqlock).
+    b.sequences[slot].store (2 * head + 1, boost::memory_order_relaxed);
+    boost::atomic_thread_fence (boost::memory_order_release);
+
+    std::size_t i = 0;
+    for (; name && name[i] && i + 1 < TraceEvent::nameSize; ++i)
+      event.name[i] = name[i];
+    event.name[i] = '\0';
+    event.category = category;
+    event.start = start;
+    event.duration = end > start ? end - start : 0;
+    event.index = index;
+    event.thread = b.thread;
+
+    // Publish the span.
+    b.sequences[slot].store (2 * head + 2, boost::memory_order_release);
+    b.head.store (head + 1, boost::memory_order_release);
+  }
+
+  std::vector<TraceEvent> Tracer::events () const
+  {
+    std::vector<TraceEvent> events;
+    boost::lock_guard<boost::mutex> lock (buffers_->mutex);
+
+    for (std::size_t k = 0; k < buffers_->all.size (); ++k)
+      {
+        const Buffer& b = *buffers_->all[k];
+        const boost::uint64_t capacity = b.events.size ();
+        const boost::uint64_t end = b.head.load (boost::memory_order_acquire);
+        const boost::uint64_t begin =
+          std::max (b.tail.load (boost::memory_order_acquire),
+                    end > capacity ? end - capacity : 0);
+
+        for (boost::uint64_t i = begin; i < end; ++i)
+          {
+            const std::size_t slot = static_cast<std::size_t> (i % capacity);
+            const boost::atomic<boost::uint64_t>& sequence = b.sequences[slot];
+
+            // Skip the spans that are being overwritten, or were
+            // overwritten during the copy.
+            if (sequence.load (boost::memory_order_acquire) != 2 * i + 2)
+              continue;
+            const TraceEvent event = b.events[slot];
+            boost::atomic_thread_fence (boost::memory_order_acquire);
+            if (sequence.load (boost::memory_order_relaxed) != 2 * i + 2)
+              continue;
+
+            events.push_back (event);
+          }
+      }
+
+    std::stable_sort (events.begin (), events.end (), &startsBefore);
+    return events;
+  }
+
+  boost::uint64_t Tracer::dropped () const
+  {
+    boost::uint64_t dropped = 0;
+    boost::lock_guard<boost::mutex> lock (buffers_->mutex);
+
+    for (std::size_t k = 0; k < buffers_->all.size (); ++k)
+      {
+        const Buffer& b = *buffers_->all[k];
+        const boost::uint64_t recorded =
+          b.head.load (boost::memory_order_acquire)
+          - b.tail.load (boost::memory_order_acquire);
+        if (recorded > b.events.size ())
+          dropped += recorded - b.events.size ();
+      }
+    return dropped;
+  }
+
+  void Tracer::clear ()
+  {
+    boost::lock_guard<boost::mutex> lock (buffers_->mutex);
+
+    for (std::size_t k = 0; k < buffers_->all.size (); ++k)
+      {
+        Buffer& b = *buffers_->all[k];
+        b.tail.store (b.head.load (boost::memory_order_acquire),
+                      boost::memory_order_release);
+      }
+  }
+
+  std::ostream& Tracer::write (std::ostream& o) const
+  {
+    const std::vector<TraceEvent> spans = events ();
+    const int pid = processId ();
+
+    o << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    {
+      boost::lock_guard<boost::mutex> lock (buffers_->mutex);
+      for (std::size_t k = 0; k < buffers_->all.size (); ++k)
+        {
+          const Buffer& b = *buffers_->all[k];
+          if (b.name.empty ())
+            continue;
+
+          o << (first ? "\n" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":" << b.thread << ",\"args\":{\"name\":";
+          writeString (o, b.name.c_str ());
+          o << "}}";
+          first = false;
+        }
+    }
+
+    for (std::size_t i = 0; i < spans.size (); ++i)
+      {
+        const TraceEvent& e = spans[i];
+        o << (first ? "\n" : ",\n") << "{\"name\":";
+        writeString (o, e.name);
+        o << ",\"cat\":";
+        writeString (o, e.category);
+        o << ",\"ph\":\"X\",\"ts\":";
+        writeTime (o, e.start);
+        o << ",\"dur\":";
+        writeTime (o, e.duration);
+        o << ",\"pid\":" << pid << ",\"tid\":" << e.thread;
+        if (e.index >= 0)
+          o << ",\"args\":{\"index\":" << e.index << "}";
+        o << "}";
+        first = false;
+      }
+
+    return o << "\n]}\n";
+  }
+
+  void Tracer::write (const std::string& filename) const
+  {
+    std::ofstream file (filename.c_str ());
+    if (!file)
+      throw std::runtime_error ("failed to open trace file " + filename);
+    write (file);
+  }
+
+  std::ostream& operator<< (std::ostream& o, const Tracer& tracer)
+  {
+    return tracer.write (o);
+  }
+
+} // end of namespace roboptim
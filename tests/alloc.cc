@@ -0,0 +1,304 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "shared-tests/fixture.hh"
+
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/mpl/list.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <roboptim/core/differentiable-function.hh>
+#include <roboptim/core/function-pool.hh>
+#include <roboptim/core/decorator/cached-function.hh>
+#include <roboptim/core/decorator/finite-difference-gradient.hh>
+#include <roboptim/core/operator/bind.hh>
+#include <roboptim/core/operator/chain.hh>
+#include <roboptim/core/operator/concatenate.hh>
+#include <roboptim/core/operator/map.hh>
+#include <roboptim/core/operator/minus.hh>
+#include <roboptim/core/operator/plus.hh>
+#include <roboptim/core/operator/product.hh>
+#include <roboptim/core/operator/scalar.hh>
+#include <roboptim/core/operator/selection.hh>
+#include <roboptim/core/operator/split.hh>
+
+#include "allocation.hh"
+
+using namespace roboptim;
+
+ROBOPTIM_DEFINE_ALLOCATION_HOOKS
+
+typedef boost::mpl::list< ::roboptim::EigenMatrixDense,
+			  ::roboptim::EigenMatrixSparse> functionTypes_t;
+
+// f_i (x) = x_i^2 + x_{i+1}.
+template <typename T>
+struct Banded : public GenericDifferentiableFunction<T>
+{
+  ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+  (GenericDifferentiableFunction<T>);
+
+  explicit Banded (size_type n)
+    : GenericDifferentiableFunction<T> (n, n, "banded")
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    const size_type n = this->inputSize ();
+    for (size_type i = 0; i < n; ++i)
+      res[i] = x[i] * x[i] + x[(i + 1) % n];
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+		      size_type i) const
+  {
+    const size_type n = this->inputSize ();
+    grad.coeffRef (i) = 2. * x[i];
+    grad.coeffRef ((i + 1) % n) += 1.;
+  }
+};
+
+// Function allocating a temporary at each evaluation.
+struct Allocating : public DifferentiableFunction
+{
+  Allocating ()
+    : DifferentiableFunction (2, 1, "allocating")
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    vector_t tmp = 2. * x;
+    res[0] = tmp.sum ();
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref,
+		      size_type) const
+  {
+    grad.setConstant (2.);
+  }
+};
+
+enum evaluation_t
+{
+  VALUE = 1,
+  GRADIENT = 2,
+  JACOBIAN = 4,
+  ALL = VALUE | GRADIENT | JACOBIAN
+};
+
+// Check that the evaluations of a function do not allocate.
+template <typename T>
+void audit (const boost::shared_ptr<GenericDifferentiableFunction<T> >& f,
+	    int evaluations)
+{
+  typedef GenericDifferentiableFunction<T> function_t;
+
+  BOOST_TEST_MESSAGE ("auditing " << f->getName ());
+
+  typename function_t::argument_t x (f->inputSize ());
+  x.setConstant (.5);
+  typename function_t::result_t res (f->outputSize ());
+  typename function_t::gradient_t grad (f->inputSize ());
+  typename function_t::jacobian_t jac = f->jacobian (x);
+
+  // The first evaluation is a warm-up (e.g. for caches).
+  if (evaluations & VALUE)
+    {
+      (*f) (res, x);
+      ROBOPTIM_CHECK_NO_ALLOCATION ((*f) (res, x));
+    }
+  if (evaluations & GRADIENT)
+    {
+      f->gradient (grad, x, 0);
+      ROBOPTIM_CHECK_NO_ALLOCATION (f->gradient (grad, x, 0));
+    }
+  if (evaluations & JACOBIAN)
+    {
+      f->jacobian (jac, x);
+      ROBOPTIM_CHECK_NO_ALLOCATION (f->jacobian (jac, x));
+    }
+}
+
+// Operators that only support dense matrices.
+void auditDense (const boost::shared_ptr<DifferentiableFunction>& f, int)
+{
+  audit<EigenMatrixDense> (chain (f, f), ALL);
+  audit<EigenMatrixDense>
+    (boost::make_shared<Split<DifferentiableFunction> > (f, 1), ALL);
+}
+
+void auditDense (const boost::shared_ptr<DifferentiableSparseFunction>&, int)
+{}
+
+// Allocate in named scopes, as concurrent function evaluations do.
+void allocateInScopes (const std::vector<std::string>* names, int scopes)
+{
+  for (int i = 0; i < scopes; ++i)
+    {
+      AllocationScope scope ((*names)[static_cast<std::size_t> (i)
+				      % names->size ()]);
+      std::vector<double> v (10);
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (allocation_accounting)
+{
+  BOOST_REQUIRE (is_allocation_accounting_enabled ());
+
+  // Scopes.
+  {
+    AllocationScope scope;
+    std::vector<double> v (10);
+    BOOST_CHECK_EQUAL (scope.stats ().allocations, 1);
+    BOOST_CHECK (scope.stats ().bytes >= 10 * sizeof (double));
+  }
+  ROBOPTIM_CHECK_NO_ALLOCATION (double x = 1.; x *= 2.);
+
+  // Explicit per-function accounting.
+  reset_function_allocation_stats ();
+  const std::string name ("scope");
+  {
+    AllocationScope scope (name);
+    std::vector<double> v (10);
+  }
+  BOOST_CHECK_EQUAL (function_allocation_stats ("scope").calls, 1);
+  BOOST_CHECK_EQUAL (function_allocation_stats ("scope").allocations, 1);
+
+#ifdef ROBOPTIM_ACCOUNT_ALLOCATION
+  // Evaluations are accounted to the function name.
+  reset_function_allocation_stats ();
+  boost::shared_ptr<DifferentiableFunction> f =
+    boost::make_shared<Allocating> ();
+  Function::vector_t x (2);
+  x << 1., 2.;
+  Function::vector_t res (1);
+  (*f) (res, x);
+  (*f) (res, x);
+
+  AllocationStats stats = function_allocation_stats ("allocating");
+  BOOST_CHECK_EQUAL (stats.calls, 2);
+  BOOST_CHECK_EQUAL (stats.allocations, 2);
+  BOOST_CHECK (stats.bytes >= 4 * sizeof (double));
+
+  // Non-allocating evaluations are accounted too.
+  DifferentiableFunction::gradient_t grad (2);
+  f->gradient (grad, x, 0);
+  BOOST_CHECK_EQUAL (function_allocation_stats ("allocating").calls, 3);
+  BOOST_CHECK_EQUAL (function_allocation_stats ("allocating").allocations, 2);
+
+  // Operators include the allocations of their operands.
+  boost::shared_ptr<DifferentiableFunction> g = 2. * f;
+  (*g) (res, x);
+  stats = function_allocation_stats (g->getName ());
+  BOOST_CHECK_EQUAL (stats.calls, 1);
+  BOOST_CHECK_EQUAL (stats.allocations, 1);
+  BOOST_CHECK_EQUAL (function_allocation_stats ("allocating").calls, 4);
+
+  print_function_allocation_stats (std::cout);
+#endif //! ROBOPTIM_ACCOUNT_ALLOCATION
+
+  BOOST_CHECK_EQUAL (function_allocation_stats ("unknown").calls, 0);
+
+  reset_function_allocation_stats ();
+  BOOST_CHECK_EQUAL (function_allocation_stats ("scope").calls, 0);
+}
+
+BOOST_AUTO_TEST_CASE (concurrent_allocation_accounting)
+{
+  BOOST_REQUIRE (is_allocation_accounting_enabled ());
+  reset_function_allocation_stats ();
+
+  std::vector<std::string> names;
+  for (int i = 0; i < 8; ++i)
+    names.push_back ((boost::format ("concurrent-%d") % i).str ());
+
+  const int threads = 4;
+  const int scopes = 1000;
+  boost::thread_group group;
+  for (int i = 0; i < threads; ++i)
+    group.create_thread (boost::bind (&allocateInScopes, &names, scopes));
+  group.join_all ();
+
+  for (std::size_t i = 0; i < names.size (); ++i)
+    BOOST_CHECK_EQUAL (function_allocation_stats (names[i]).calls,
+		       threads * scopes / names.size ());
+
+  reset_function_allocation_stats ();
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (operators_do_not_allocate, T, functionTypes_t)
+{
+  typedef GenericDifferentiableFunction<T> function_t;
+  typedef boost::shared_ptr<function_t> functionPtr_t;
+  typedef typename function_t::size_type size_type;
+
+  // Sparse gradients and Jacobians of composite functions are assembled
+  // in temporaries, so only the values are audited for sparse functions.
+  const int evaluations =
+    boost::is_same<T, EigenMatrixDense>::value ? ALL : VALUE;
+
+  const size_type n = 10;
+  functionPtr_t f = boost::make_shared<Banded<T> > (n);
+
+  audit<T> (f, evaluations);
+  auditDense (f, evaluations);
+  audit<T> (roboptim::map<function_t>
+	    (boost::make_shared<Banded<T> > (1), n), evaluations);
+
+  typename Bind<function_t>::boundValues_t bound
+    (static_cast<std::size_t> (n));
+  bound[0] = 1.;
+  bound[3] = 2.;
+  audit<T> (roboptim::bind (f, bound), evaluations);
+
+  audit<T> (concatenate (f, f), evaluations);
+  audit<T> (boost::make_shared<Product<function_t, function_t> > (f, f),
+	    evaluations);
+  audit<T> (selection (f, 2, 3), evaluations);
+  audit<T> (2. * f, evaluations);
+  audit<T> (f + f, evaluations);
+  audit<T> (f - f, evaluations);
+
+  // Cached function (at the same point: cache hits).
+  audit<T> (boost::make_shared<CachedFunction<function_t> > (f), evaluations);
+
+  // Function pool (no gradient).
+  typedef FunctionPool<function_t, boost::mpl::list<function_t> > pool_t;
+  typename pool_t::functionList_t functions;
+  functions.push_back (selection (f, 0, n / 2));
+  functions.push_back (selection (f, n / 2, n / 2));
+  audit<T> (boost::make_shared<pool_t> (f, functions),
+	    evaluations & ~GRADIENT);
+
+  // Finite differences.
+  audit<T> (boost::make_shared<GenericFiniteDifferenceGradient
+	    <T, finiteDifferenceGradientPolicies::Simple<T> > > (f),
+	    evaluations);
+  audit<T> (boost::make_shared<GenericFiniteDifferenceGradient
+	    <T, finiteDifferenceGradientPolicies::FivePointsRule<T> > > (f),
+	    evaluations);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,47 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ROBOPTIM_CORE_TESTS_ALLOCATION_HH
+# define ROBOPTIM_CORE_TESTS_ALLOCATION_HH
+
+# include <boost/test/unit_test.hpp>
+
+# include <roboptim/core/alloc.hh>
+
+/// \brief Check that a statement does not allocate memory.
+///
+/// The test program has to install the allocation hooks (see
+/// ROBOPTIM_DEFINE_ALLOCATION_HOOKS), otherwise the check is vacuous.
+///
+/// \param STATEMENT statement to check.
+# define ROBOPTIM_CHECK_NO_ALLOCATION(STATEMENT)			\
+  do									\
+    {									\
+      unsigned long roboptimAllocations_;				\
+      {									\
+	::roboptim::AllocationScope roboptimAllocationScope_;		\
+	STATEMENT;							\
+	roboptimAllocations_ = roboptimAllocationScope_.stats ().allocations; \
+      }									\
+      BOOST_CHECK_MESSAGE (roboptimAllocations_ == 0,			\
+			   #STATEMENT " made " << roboptimAllocations_	\
+			   << " allocation(s)");			\
+    }									\
+  while (0)
+
+#endif //! ROBOPTIM_CORE_TESTS_ALLOCATION_HH
@@ -0,0 +1,124 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "shared-tests/fixture.hh"
+
+#include "gradient-descent-solver.hh"
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/batch-solver.hh>
+
+using namespace roboptim;
+
+typedef BatchSolver<EigenMatrixDense> batchSolver_t;
+typedef batchSolver_t::problem_t problem_t;
+
+// f(x) = (x - 1)^2
+struct F : public DifferentiableFunction
+{
+  F () : DifferentiableFunction (1, 1, "(x - 1)^2")
+  {}
+
+  void impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = (x[0] - 1.) * (x[0] - 1.);
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+                      size_type) const
+  {
+    grad[0] = 2. * (x[0] - 1.);
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (batch_solver)
+{
+  boost::shared_ptr<F> f = boost::make_shared<F> ();
+  problem_t pb (f);
+
+  // Copies of the same problem: the minimum is the projection of 1 on
+  // [-2, i / 100].
+  const std::size_t n = 200;
+  std::vector<boost::shared_ptr<problem_t> > storage;
+  batchSolver_t::problems_t problems;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      boost::shared_ptr<problem_t> pb_i = boost::make_shared<problem_t> (pb);
+      pb_i->setStartingPoint (Function::vector_t::Constant (1, -1.));
+      pb_i->setArgumentBounds
+        (0, Function::makeInterval (-2., static_cast<double> (i) / 100.));
+      storage.push_back (pb_i);
+      problems.push_back (pb_i.get ());
+    }
+
+  // A problem with different functions.
+  problem_t other (boost::make_shared<F> ());
+  other.setStartingPoint (Function::vector_t::Constant (1, 3.));
+  problems[n / 2] = &other;
+
+  batchSolver_t solver ("test-gd", 2);
+  BOOST_CHECK_EQUAL (solver.plugin (), "test-gd");
+  BOOST_CHECK_EQUAL (solver.threads (), 2);
+  solver.parameters ()["gd.step"].value = 0.1;
+  solver.parameters ()["gd.tolerance"].value = 1e-6;
+
+  batchSolver_t::results_t results;
+  solver.solve (problems, results);
+  BOOST_REQUIRE_EQUAL (results.size (), n);
+
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      BOOST_REQUIRE_EQUAL (results[i].which (), GenericSolver::SOLVER_VALUE);
+      const Result& res = boost::get<Result> (results[i]);
+      double expected = (i == n / 2)
+        ? 1. : std::min (1., static_cast<double> (i) / 100.);
+      BOOST_CHECK_SMALL (res.x[0] - expected, 1e-4);
+    }
+
+  // Solvers are reused for copies of the same problem: one solver per
+  // thread, plus the solvers created for the other problem and for the
+  // problem following it.
+  BOOST_CHECK (solver.solversCreated () <= 4);
+
+  // Solvers are kept between batches.
+  solver.solve (problems, results);
+  BOOST_CHECK (solver.solversCreated () <= 3);
+
+  // Many small batches, run by the same threads.
+  batchSolver_t::problems_t small (problems.begin (), problems.begin () + 3);
+  for (int k = 0; k < 20; ++k)
+    {
+      solver.solve (small, results);
+      BOOST_REQUIRE_EQUAL (results.size (), 3);
+      for (std::size_t i = 0; i < 3; ++i)
+        BOOST_CHECK_EQUAL (results[i].which (), GenericSolver::SOLVER_VALUE);
+    }
+
+  // Empty batch.
+  batchSolver_t::problems_t empty;
+  solver.solve (empty, results);
+  BOOST_CHECK (results.empty ());
+
+  // Invalid plug-in.
+  BOOST_CHECK_THROW (batchSolver_t ("invalid-plugin"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,353 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "shared-tests/fixture.hh"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/util.hh>
+#include <roboptim/core/binary-log.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/optimization-logger.hh>
+#include <roboptim/core/differentiable-function.hh>
+
+using namespace roboptim;
+
+typedef BinaryLogReader::vector_t vector_t;
+typedef BinaryLogReader::matrix_t matrix_t;
+
+// Define a simple function (sparse differentiable)
+struct F : public DifferentiableSparseFunction
+{
+  typedef DifferentiableSparseFunction parent_t;
+
+  F () : parent_t (4, 1, "a + 2 b + 3 c + 4 d")
+  {}
+
+  void impl_compute (result_ref result, const_argument_ref x)
+    const
+  {
+    result (0) = x[0] + 2. * x[1] + 3. * x[2] + 4. * x[3];
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref, size_type)
+    const
+  {
+    grad.insert (0) = 1.;
+    grad.insert (1) = 2.;
+    grad.insert (2) = 3.;
+    grad.insert (3) = 4.;
+  }
+};
+
+std::string readFile (const boost::filesystem::path& path)
+{
+  std::ifstream file (path.string ().c_str ());
+  std::stringstream ss;
+  ss << file.rdbuf ();
+  return ss.str ();
+}
+
+BinaryLogLayout makeLayout ()
+{
+  BinaryLogLayout layout;
+  layout.inputSize = 3;
+  layout.argumentNames.push_back ("a");
+  layout.argumentNames.push_back ("b");
+  layout.argumentNames.push_back ("c");
+  layout.constraints.push_back (BinaryLogLayout::Constraint ("g0", 2, true));
+  layout.constraints.push_back (BinaryLogLayout::Constraint ("g1", 1, false));
+  layout.constraints.push_back (BinaryLogLayout::Constraint ("g2", 2, true));
+  return layout;
+}
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (binary_log)
+{
+  const boost::filesystem::path directory =
+    "/tmp/roboptim-core-tests/binary-log";
+  boost::filesystem::remove_all (directory);
+  boost::filesystem::create_directories (directory);
+  const boost::filesystem::path file = directory / "log.bin";
+
+  vector_t x (3);
+  x << 1., 2., 3.;
+  vector_t g0 (2);
+  g0 << -1., 0.5;
+  vector_t g1 (1);
+  g1 << 4.;
+  vector_t g2 (2);
+  g2 << 7., 8.;
+  matrix_t j0 (2, 3);
+  j0 << 1., 2., 3.,
+        4., 5., 6.;
+  Eigen::MatrixXd j2 (2, 3);
+  j2 << 0., 9., 0.,
+        0., 0., -1.;
+  GenericFunctionTraits<EigenMatrixSparse>::matrix_t j2s = j2.sparseView ();
+
+  boost::uint64_t size = 0;
+  {
+    BinaryLogWriter writer (file, makeLayout ());
+    BOOST_CHECK_EQUAL (writer.records (), 0u);
+
+    for (int i = 0; i < 3; ++i)
+      {
+	writer.beginRecord (static_cast<boost::uint64_t> (i), 0.1 * i,
+			    10. - i, 0.5 * i, x * (i + 1.));
+	writer.constraint (0, g0);
+	// The value of g1 is only logged at the first iteration.
+	if (i == 0)
+	  writer.constraint (1, g1);
+	writer.constraint (2, g2);
+	writer.jacobian (0, j0);
+	writer.jacobian (2, j2s);
+	writer.endRecord ();
+      }
+    BOOST_CHECK_EQUAL (writer.records (), 3u);
+    size = writer.size ();
+  }
+  BOOST_CHECK_EQUAL (size, boost::filesystem::file_size (file));
+
+  {
+    BinaryLogReader reader (file);
+    BOOST_CHECK_EQUAL (reader.layout ().inputSize, 3u);
+    BOOST_REQUIRE_EQUAL (reader.layout ().argumentNames.size (), 3u);
+    BOOST_CHECK_EQUAL (reader.layout ().argumentNames[2], "c");
+    BOOST_REQUIRE_EQUAL (reader.layout ().constraints.size (), 3u);
+    BOOST_CHECK_EQUAL (reader.layout ().constraints[2].name, "g2");
+    BOOST_CHECK_EQUAL (reader.layout ().constraints[2].outputSize, 2u);
+    BOOST_CHECK (!reader.layout ().constraints[1].differentiable);
+    BOOST_REQUIRE_EQUAL (reader.size (), 3u);
+
+    matrix_t jac;
+    for (std::size_t i = 0; i < reader.size (); ++i)
+      {
+	const BinaryLogReader::Record record = reader[i];
+	const double k = static_cast<double> (i);
+	BOOST_CHECK_EQUAL (record.iteration (), i);
+	BOOST_CHECK_CLOSE (record.time (), 0.1 * k, 1e-12);
+	BOOST_CHECK_EQUAL (record.cost (), 10. - k);
+	BOOST_CHECK_EQUAL (record.violation (), 0.5 * k);
+	BOOST_CHECK (allclose (vector_t (record.x ()), x * (k + 1.)));
+	BOOST_CHECK (allclose (vector_t (record.constraint (0)), g0));
+	BOOST_CHECK (allclose (vector_t (record.constraint (2)), g2));
+	if (i == 0)
+	  BOOST_CHECK_EQUAL (record.constraint (1)[0], 4.);
+	else
+	  BOOST_CHECK (std::isnan (record.constraint (1)[0]));
+
+	BOOST_CHECK (record.hasJacobian (0));
+	BOOST_CHECK (!record.hasJacobian (1));
+	BOOST_CHECK (record.hasJacobian (2));
+	record.jacobian (0, jac);
+	BOOST_CHECK (allclose (jac, j0));
+	record.jacobian (2, jac);
+	BOOST_CHECK (allclose (jac, matrix_t (j2)));
+	BOOST_CHECK_THROW (record.jacobian (1, jac), std::runtime_error);
+      }
+  }
+
+  // Conversion to the CSV layout.
+  const boost::filesystem::path csv = directory / "csv";
+  convertBinaryLog (file, csv);
+  BOOST_CHECK_EQUAL (readFile (csv / "iteration-0" / "x.csv"), "1, 2, 3\n");
+  BOOST_CHECK_EQUAL (readFile (csv / "iteration-1" / "cost"), "9\n");
+  BOOST_CHECK_EQUAL (readFile (csv / "iteration-0" / "constraint-1" / "name"),
+		     "g1\n");
+  BOOST_CHECK_EQUAL (readFile (csv / "iteration-0" / "constraint-0"
+			       / "jacobian.csv"), "1, 2, 3\n4, 5, 6\n");
+  BOOST_CHECK (!boost::filesystem::exists (csv / "iteration-0"
+					   / "constraint-1" / "jacobian.csv"));
+  BOOST_CHECK_EQUAL (readFile (csv / "iteration-2" / "constraint-violation"),
+		     "1\n");
+  BOOST_CHECK_EQUAL (readFile (csv / "cost-evolution.csv"),
+		     "Cost\n10\n9\n8\n");
+  BOOST_CHECK_EQUAL (readFile (csv / "x-evolution.csv"),
+		     "a, b, c\n1, 2, 3\n2, 4, 6\n3, 6, 9\n");
+  BOOST_CHECK_EQUAL (readFile (csv / "constraint-2-evolution.csv"),
+		     "output 0, output 1\n7, 8\n7, 8\n7, 8\n");
+
+  // A truncated record is ignored.
+  boost::filesystem::resize_file (file,
+				  boost::filesystem::file_size (file) - 8);
+  BOOST_CHECK_EQUAL (BinaryLogReader (file).size (), 2u);
+
+  // Invalid files.
+  {
+    std::ofstream invalid ((directory / "invalid.bin").string ().c_str ());
+    invalid << "not a binary log";
+  }
+  BOOST_CHECK_THROW (BinaryLogReader (directory / "invalid.bin"),
+		     std::runtime_error);
+  BOOST_CHECK_THROW (BinaryLogReader (directory / "missing.bin"),
+		     std::runtime_error);
+}
+
+// Copy a log and overwrite a value of its first record.
+template <typename U>
+boost::filesystem::path corrupt (const boost::filesystem::path& file,
+				 std::size_t offset, U value)
+{
+  const boost::filesystem::path copy =
+    file.parent_path () / "corrupt.bin";
+  boost::filesystem::remove (copy);
+  boost::filesystem::copy_file (file, copy);
+
+  boost::uint64_t headerSize;
+  std::fstream stream (copy.string ().c_str (),
+		       std::ios::in | std::ios::out | std::ios::binary);
+  stream.seekg (16);
+  stream.read (reinterpret_cast<char*> (&headerSize), sizeof (headerSize));
+  stream.seekp (static_cast<std::streamoff> (headerSize + offset));
+  stream.write (reinterpret_cast<const char*> (&value), sizeof (value));
+  return copy;
+}
+
+BOOST_AUTO_TEST_CASE (corrupt_binary_log)
+{
+  const boost::filesystem::path directory =
+    "/tmp/roboptim-core-tests/binary-log-corrupt";
+  boost::filesystem::remove_all (directory);
+  boost::filesystem::create_directories (directory);
+  const boost::filesystem::path file = directory / "log.bin";
+
+  Eigen::MatrixXd j2 (2, 3);
+  j2 << 0., 9., 0.,
+        0., 0., -1.;
+  GenericFunctionTraits<EigenMatrixSparse>::matrix_t j2s = j2.sparseView ();
+  {
+    BinaryLogWriter writer (file, makeLayout ());
+    writer.beginRecord (0, 0., 1., 0., vector_t::Zero (3));
+    writer.jacobian (0, matrix_t::Ones (2, 3));
+    writer.jacobian (2, j2s);
+    writer.endRecord ();
+  }
+
+  // Record: 48 bytes of header, x (3), constraints (5), then the dense
+  // block of g0 (16 + 6 * 8 bytes) and the sparse block of g2.
+  const std::size_t dense = 48 + 8 * 3 + 8 * 5;
+  const std::size_t sparse = dense + 16 + 8 * 6;
+
+  matrix_t jac;
+  {
+    BinaryLogReader reader (file);
+    BOOST_REQUIRE_EQUAL (reader.size (), 1u);
+    reader[0].jacobian (0, jac);
+    BOOST_CHECK (allclose (jac, matrix_t::Ones (2, 3)));
+    reader[0].jacobian (2, jac);
+    BOOST_CHECK (allclose (jac, matrix_t (j2)));
+  }
+
+  // Number of dense entries not matching the size of the Jacobian.
+  {
+    BinaryLogReader reader
+      (corrupt<boost::uint64_t> (file, dense + 8, 5));
+    BOOST_CHECK_THROW (reader[0].jacobian (0, jac), std::runtime_error);
+  }
+
+  // Block extending past the end of the record.
+  {
+    BinaryLogReader reader
+      (corrupt<boost::uint64_t> (file, dense + 8, static_cast<boost::uint64_t> (1) << 60));
+    BOOST_CHECK_THROW (reader[0].hasJacobian (0), std::runtime_error);
+    BOOST_CHECK_THROW (reader[0].jacobian (2, jac), std::runtime_error);
+  }
+  {
+    BinaryLogReader reader
+      (corrupt<boost::uint64_t> (file, sparse + 8, 3));
+    BOOST_CHECK_THROW (reader[0].jacobian (2, jac), std::runtime_error);
+  }
+
+  // Unknown format.
+  {
+    BinaryLogReader reader
+      (corrupt<boost::uint32_t> (file, dense + 4, 7));
+    BOOST_CHECK_THROW (reader[0].hasJacobian (0), std::runtime_error);
+  }
+
+  // Sparse entries out of the Jacobian.
+  {
+    BinaryLogReader reader
+      (corrupt<boost::uint32_t> (file, sparse + 16, 2));
+    BOOST_CHECK_THROW (reader[0].jacobian (2, jac), std::runtime_error);
+  }
+  {
+    BinaryLogReader reader
+      (corrupt<boost::uint32_t> (file, sparse + 16 + 4, 3));
+    BOOST_CHECK_THROW (reader[0].jacobian (2, jac), std::runtime_error);
+  }
+}
+
+BOOST_AUTO_TEST_CASE (binary_optimization_logger)
+{
+  typedef Solver<EigenMatrixSparse> solver_t;
+
+  boost::shared_ptr<F> f = boost::make_shared<F> ();
+  solver_t::problem_t pb (f);
+  pb.addConstraint (f, F::makeInterval (-1., 1.));
+
+  F::argument_t x (f->inputSize ());
+  x << 1., 0., 0., 1.;
+  pb.setStartingPoint (x);
+
+  SolverFactory<solver_t> factory ("dummy-d-sparse-laststate", pb);
+  solver_t& solver = factory ();
+
+  const boost::filesystem::path path =
+    "/tmp/roboptim-core-tests/binary-optimization-logger";
+  {
+    OptimizationLogger<solver_t> logger (solver, path, true, BINARY_LOG);
+    BOOST_CHECK_EQUAL (logger.format (), BINARY_LOG);
+    solver.minimum ();
+    std::cout << logger << std::endl;
+  }
+
+  // No directory is created per iteration.
+  BOOST_CHECK (boost::filesystem::exists (path / "journal.log"));
+  BOOST_CHECK (!boost::filesystem::exists (path / "iteration-0"));
+
+  BinaryLogReader reader (path / "log.bin");
+  BOOST_REQUIRE_EQUAL (reader.layout ().constraints.size (), 1u);
+  BOOST_CHECK (reader.layout ().constraints[0].differentiable);
+  BOOST_REQUIRE (reader.size () > 0);
+
+  const BinaryLogReader::Record record = reader[0];
+  BOOST_CHECK_EQUAL (record.iteration (), 0u);
+  BOOST_CHECK_EQUAL (record.constraint (0)[0], (*f) (record.x ())[0]);
+  // The violation given by the solver is used.
+  BOOST_CHECK_EQUAL (record.violation (), 42.);
+
+  matrix_t jac;
+  record.jacobian (0, jac);
+  BOOST_CHECK (allclose (jac, matrix_t (toDense (f->jacobian (x)))));
+
+  convertBinaryLog (path / "log.bin", path);
+  BOOST_CHECK (boost::filesystem::exists
+	       (path / "iteration-0" / "constraint-0" / "jacobian.csv"));
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,248 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "shared-tests/fixture.hh"
+
+#include <boost/make_shared.hpp>
+#include <boost/type_traits/is_same.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/util.hh>
+#include <roboptim/core/problem.hh>
+#include <roboptim/core/compiled-problem.hh>
+#include <roboptim/core/numeric-linear-function.hh>
+
+using namespace roboptim;
+
+typedef boost::mpl::list< ::roboptim::EigenMatrixDense,
+			  ::roboptim::EigenMatrixSparse> functionTypes_t;
+
+// Non-differentiable function.
+template <typename T>
+struct F : public GenericFunction<T>
+{
+  ROBOPTIM_FUNCTION_FWD_TYPEDEFS_ (GenericFunction<T>);
+
+  F () : GenericFunction<T> (3, 1, "max (a, b, c)")
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    res[0] = x.maxCoeff ();
+  }
+};
+
+// Nonlinear differentiable function.
+template <typename T>
+struct G : public GenericDifferentiableFunction<T>
+{
+  ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+  (GenericDifferentiableFunction<T>);
+
+  G () : GenericDifferentiableFunction<T> (3, 2, "a * b, c^2")
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    res[0] = x[0] * x[1];
+    res[1] = x[2] * x[2];
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+		      size_type i) const
+  {
+    grad.setZero ();
+    if (i == 0)
+      {
+	grad.coeffRef (0) = x[1];
+	grad.coeffRef (1) = x[0];
+      }
+    else
+      grad.coeffRef (2) = 2. * x[2];
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (compiled_problem, T, functionTypes_t)
+{
+  typedef Problem<T> problem_t;
+  typedef CompiledProblem<T> compiledProblem_t;
+  typedef GenericNumericLinearFunction<T> numericLinearFunction_t;
+  typedef typename problem_t::function_t function_t;
+  typedef typename problem_t::intervals_t intervals_t;
+  typedef typename problem_t::scaling_t scaling_t;
+  typedef typename problem_t::vector_t vector_t;
+  typedef typename problem_t::jacobian_t jacobian_t;
+  typedef typename numericLinearFunction_t::matrix_t matrix_t;
+
+  Eigen::MatrixXd A0 (2, 3);
+  A0 << 1., 0., 2.,
+        0., 3., 0.;
+  vector_t b0 (2);
+  b0 << -1., 1.;
+  Eigen::MatrixXd A1 (1, 3);
+  A1 << 0., 4., 5.;
+  vector_t b1 (1);
+  b1 << 2.;
+
+  matrix_t A0_;
+  matrix_t A1_;
+  A0_ = A0.sparseView ();
+  A1_ = A1.sparseView ();
+
+  boost::shared_ptr<numericLinearFunction_t>
+    cost = boost::make_shared<numericLinearFunction_t> (A1_, b1);
+  boost::shared_ptr<numericLinearFunction_t>
+    g0 = boost::make_shared<numericLinearFunction_t> (A0_, b0);
+  boost::shared_ptr<F<T> > g1 = boost::make_shared<F<T> > ();
+  boost::shared_ptr<G<T> > g2 = boost::make_shared<G<T> > ();
+  boost::shared_ptr<numericLinearFunction_t>
+    g3 = boost::make_shared<numericLinearFunction_t> (A1_, b1);
+
+  problem_t pb (cost);
+  pb.setArgumentBounds (1, function_t::makeInterval (-1., 1.));
+  pb.argumentScaling ()[2] = 2.;
+
+  intervals_t bounds0 (2, function_t::makeInterval (0., 1.));
+  scaling_t scaling0 (2, 1.);
+  scaling0[1] = 0.5;
+  pb.addConstraint (g0, bounds0, scaling0);
+  pb.addConstraint (g1, intervals_t (1, function_t::makeLowerInterval (-2.)),
+                    scaling_t (1, 3.));
+  pb.addConstraint (g2, intervals_t (2, function_t::makeUpperInterval (4.)),
+                    scaling_t (2, 1.));
+  pb.addConstraint (g3, intervals_t (1, function_t::makeInterval (-3., 3.)),
+                    scaling_t (1, 1.));
+  vector_t x0 (3);
+  x0 << 1., -.5, 2.;
+  pb.setStartingPoint (x0);
+
+  compiledProblem_t cpb (pb);
+  std::cout << cpb << std::endl;
+
+  // The Jacobian pattern is computed during the compilation.
+  const bool sparse = boost::is_same<T, EigenMatrixSparse>::value;
+  Eigen::MatrixXd pattern (5, 3);
+  pattern << 1., 0., 1.,
+             0., 1., 0.,
+             1., 1., 0.,
+             0., 0., 1.,
+             0., 1., 1.;
+  if (!sparse)
+    pattern.setOnes ();
+  BOOST_CHECK (allclose (toDense (cpb.jacobianPattern ()), pattern));
+
+  BOOST_CHECK (&cpb.problem () == &pb);
+  BOOST_CHECK (cpb.differentiableFunction () != 0);
+  BOOST_CHECK_EQUAL (cpb.inputSize (), 3);
+  BOOST_CHECK_EQUAL (cpb.constraintsOutputSize (), pb.constraintsOutputSize ());
+  BOOST_CHECK_EQUAL (cpb.jacobianRows (),
+                     pb.differentiableConstraintsOutputSize ());
+  BOOST_CHECK_EQUAL (cpb.linearRows (), 3);
+
+  // Classification and offsets.
+  BOOST_REQUIRE_EQUAL (cpb.constraints ().size (), 4);
+  BOOST_CHECK (cpb.constraints ()[0].isLinear ());
+  BOOST_CHECK (cpb.constraints ()[0].numericLinear == g0.get ());
+  BOOST_CHECK (!cpb.constraints ()[1].differentiable);
+  BOOST_CHECK (!cpb.constraints ()[1].isLinear ());
+  BOOST_CHECK (cpb.constraints ()[2].differentiable == g2.get ());
+  BOOST_CHECK (!cpb.constraints ()[2].numericLinear);
+
+  BOOST_CHECK_EQUAL (cpb.constraints ()[0].rowOffset, 0);
+  BOOST_CHECK_EQUAL (cpb.constraints ()[1].rowOffset, 2);
+  BOOST_CHECK_EQUAL (cpb.constraints ()[2].rowOffset, 3);
+  BOOST_CHECK_EQUAL (cpb.constraints ()[3].rowOffset, 5);
+
+  BOOST_CHECK_EQUAL (cpb.constraints ()[0].jacobianRowOffset, 0);
+  BOOST_CHECK_EQUAL (cpb.constraints ()[1].jacobianRowOffset, -1);
+  BOOST_CHECK_EQUAL (cpb.constraints ()[2].jacobianRowOffset, 2);
+  BOOST_CHECK_EQUAL (cpb.constraints ()[3].jacobianRowOffset, 4);
+
+  BOOST_CHECK_EQUAL (cpb.constraints ()[0].linearRowOffset, 0);
+  BOOST_CHECK_EQUAL (cpb.constraints ()[2].linearRowOffset, -1);
+  BOOST_CHECK_EQUAL (cpb.constraints ()[3].linearRowOffset, 2);
+
+  BOOST_REQUIRE_EQUAL (cpb.linearConstraints ().size (), 2);
+  BOOST_CHECK_EQUAL (cpb.linearConstraints ()[0], 0);
+  BOOST_CHECK_EQUAL (cpb.linearConstraints ()[1], 3);
+  BOOST_REQUIRE_EQUAL (cpb.nonlinearConstraints ().size (), 2);
+  BOOST_CHECK_EQUAL (cpb.nonlinearConstraints ()[0], 1);
+  BOOST_CHECK_EQUAL (cpb.nonlinearConstraints ()[1], 2);
+  BOOST_CHECK (!cpb.hasOnlyLinearConstraints ());
+
+  // Bounds and scaling.
+  BOOST_CHECK (cpb.argumentLowerBounds () == pb.argumentLowerBounds ());
+  BOOST_CHECK (cpb.argumentUpperBounds () == pb.argumentUpperBounds ());
+  BOOST_CHECK (cpb.constraintsLowerBounds () == pb.constraintsLowerBounds ());
+  BOOST_CHECK (cpb.constraintsUpperBounds () == pb.constraintsUpperBounds ());
+  BOOST_CHECK_EQUAL (cpb.argumentScaling ()[0], 1.);
+  BOOST_CHECK_EQUAL (cpb.argumentScaling ()[2], 2.);
+  BOOST_CHECK_EQUAL (cpb.constraintsScaling ()[1], 0.5);
+  BOOST_CHECK_EQUAL (cpb.constraintsScaling ()[2], 3.);
+
+  // Stacked linear system.
+  Eigen::MatrixXd A (3, 3);
+  A << A0, A1;
+  vector_t b (3);
+  b << b0, b1;
+  BOOST_CHECK (allclose (toDense (cpb.linearA ()), A));
+  BOOST_CHECK (allclose (cpb.linearB (), b));
+
+  // Evaluation.
+  vector_t x (3);
+  x << 1., -2., 3.;
+
+  vector_t g (cpb.constraintsOutputSize ());
+  vector_t g_ref (pb.constraintsOutputSize ());
+  cpb.constraints (g, x);
+  pb.constraints (g_ref, x);
+  BOOST_CHECK (allclose (g, g_ref));
+  BOOST_CHECK (allclose (g.head (2), A0 * x + b0));
+
+  jacobian_t jac (cpb.jacobianRows (), cpb.inputSize ());
+  for (int i = 0; i < 3; ++i)
+    {
+      x[0] += 1.;
+      cpb.jacobian (jac, x);
+      BOOST_CHECK (allclose (toDense (jac), toDense (pb.jacobian (x))));
+    }
+
+  // Jacobian pattern.
+  cpb.updateJacobianPattern (x);
+  BOOST_CHECK_EQUAL (cpb.jacobianPattern ().rows (), cpb.jacobianRows ());
+  BOOST_CHECK_EQUAL (cpb.jacobianPattern ().cols (), cpb.inputSize ());
+  for (typename jacobian_t::Index i = 0; i < jac.rows (); ++i)
+    for (typename jacobian_t::Index j = 0; j < jac.cols (); ++j)
+      if (toDense (jac) (i, j) != 0.)
+        BOOST_CHECK (toDense (cpb.jacobianPattern ()) (i, j) != 0.);
+
+  // Linear-only problem.
+  problem_t linearPb (cost);
+  linearPb.addConstraint (g0, bounds0, scaling0);
+  compiledProblem_t linearCpb (linearPb);
+  BOOST_CHECK (linearCpb.hasOnlyLinearConstraints ());
+  if (sparse)
+    BOOST_CHECK (allclose (toDense (linearCpb.jacobianPattern ()),
+                           Eigen::MatrixXd (pattern.topRows (2))));
+  else
+    BOOST_CHECK_EQUAL (linearCpb.jacobianPattern ().sum (), 6.);
+  BOOST_CHECK (allclose (toDense (linearCpb.linearA ()), A0));
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -188,7 +188,7 @@ int run_test (boost::shared_ptr<boost::test_tools::output_test_stream>& output)
   // 1. < x_i < 5. (x_i in [1.;5.])
   for (std::size_t i = 0;
        static_cast<Function::size_type> (i) < pb.function ().inputSize (); ++i)
-    pb.argumentBounds ()[i] = Function::makeInterval (1., 5.);
+    pb.setArgumentBounds (i, Function::makeInterval (1., 5.));
 
   // Set the starting point.
   Function::vector_t start (pb.function ().inputSize ());
@@ -0,0 +1,141 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ROBOPTIM_CORE_TESTS_GRADIENT_DESCENT_SOLVER_HH
+# define ROBOPTIM_CORE_TESTS_GRADIENT_DESCENT_SOLVER_HH
+
+# include <algorithm>
+
+# include <roboptim/core/differentiable-function.hh>
+# include <roboptim/core/plugin-registry.hh>
+# include <roboptim/core/result.hh>
+# include <roboptim/core/solver.hh>
+
+namespace roboptim
+{
+  /// \brief Projected gradient descent with a fixed step.
+  ///
+  /// This iterative solver is used to test the solver drivers: it calls the
+  /// iteration callback after each iteration, and supports cooperative
+  /// interruption through the ``gd.stop'' state parameter.
+  class GradientDescentSolver : public Solver<EigenMatrixDense>
+  {
+  public:
+    typedef Solver<EigenMatrixDense> parent_t;
+    typedef problem_t::value_type value_type;
+
+    explicit GradientDescentSolver (const problem_t& pb)
+      : parent_t (pb),
+        callback_ (),
+        state_ (pb)
+    {
+      parameters_["gd.step"].description = "step size";
+      parameters_["gd.step"].value = 0.01;
+      parameters_["gd.max-iterations"].description = "maximum iterations";
+      parameters_["gd.max-iterations"].value = 1000;
+      parameters_["gd.tolerance"].description = "gradient tolerance";
+      parameters_["gd.tolerance"].value = 1e-8;
+    }
+
+    virtual ~GradientDescentSolver ()
+    {
+    }
+
+    virtual void setIterationCallback (callback_t callback)
+    {
+      callback_ = callback;
+    }
+
+    virtual void solve ()
+    {
+      const DifferentiableFunction* f =
+        problem ().function ().castInto<DifferentiableFunction> (true);
+
+      value_type step = getParameter<value_type> ("gd.step");
+      int maxIterations = getParameter<int> ("gd.max-iterations");
+      value_type tolerance = getParameter<value_type> ("gd.tolerance");
+
+      const vector_t& lb = problem ().argumentLowerBounds ();
+      const vector_t& ub = problem ().argumentUpperBounds ();
+
+      vector_t x = problem ().startingPoint ()
+        ? *problem ().startingPoint ()
+        : vector_t::Zero (f->inputSize ());
+      DifferentiableFunction::gradient_t grad (f->inputSize ());
+
+      state_.parameters ()["gd.stop"].value = false;
+      for (int i = 0; i < maxIterations; ++i)
+        {
+          grad.setZero ();
+          f->gradient (grad, x);
+          x = (x - step * grad).cwiseMax (lb).cwiseMin (ub);
+
+          state_.x () = x;
+          state_.cost () = (*f) (x)[0];
+          state_.parameters ()["gd.iteration"].value = i;
+          if (callback_)
+            callback_ (problem (), state_);
+
+          if (state_.getParameter<bool> ("gd.stop")
+              || grad.norm () < tolerance)
+            break;
+        }
+
+      Result res (f->inputSize (), 1);
+      res.x = x;
+      res.value = (*f) (x);
+      result_ = res;
+    }
+
+  private:
+    callback_t callback_;
+    solverState_t state_;
+  };
+
+  /// \brief Gradient descent with a tiny step, that runs until it is
+  /// stopped.
+  class SlowGradientDescentSolver : public GradientDescentSolver
+  {
+  public:
+    explicit SlowGradientDescentSolver (const problem_t& pb)
+      : GradientDescentSolver (pb)
+    {
+      parameters_["gd.step"].value = 1e-9;
+      parameters_["gd.max-iterations"].value = 100000000;
+      parameters_["gd.tolerance"].value = 0.;
+    }
+  };
+
+  /// \brief Register the solvers as the ``test-gd'' and ``test-gd-slow''
+  /// static plug-ins.
+  inline void registerGradientDescentSolver ()
+  {
+    detail::PluginEntryPoints<GradientDescentSolver>::registerStatic
+      ("test-gd");
+    detail::PluginEntryPoints<SlowGradientDescentSolver>::registerStatic
+      ("test-gd-slow");
+  }
+
+  namespace
+  {
+    detail::StaticPluginRegistration
+    gradientDescentSolverRegistration (&registerGradientDescentSolver);
+  } // end of anonymous namespace
+
+} // end of namespace roboptim
+
+#endif //! ROBOPTIM_CORE_TESTS_GRADIENT_DESCENT_SOLVER_HH
@@ -0,0 +1,190 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "shared-tests/fixture.hh"
+
+#include <iostream>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <roboptim/core/instrumentation.hh>
+#include <roboptim/core/twice-differentiable-function.hh>
+#include <roboptim/core/operator/scalar.hh>
+
+using namespace roboptim;
+
+// f (x) = x0^2 + x1^2
+struct F : public TwiceDifferentiableFunction
+{
+  explicit F (const std::string& name)
+    : TwiceDifferentiableFunction (2, 1, name)
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    res[0] = x.squaredNorm ();
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+		      size_type) const
+  {
+    grad = 2. * x;
+  }
+
+  void impl_hessian (hessian_ref h, const_argument_ref, size_type) const
+  {
+    h.setIdentity ();
+    h *= 2.;
+  }
+};
+
+#ifdef ROBOPTIM_INSTRUMENT_EVALUATION
+void evaluate (const F* f, int n)
+{
+  F::vector_t x (2);
+  x << 1., 2.;
+  F::result_t res (1);
+  for (int i = 0; i < n; ++i)
+    (*f) (res, x);
+}
+
+#endif //! ROBOPTIM_INSTRUMENT_EVALUATION
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (evaluation_scopes)
+{
+  EvaluationRegistry& registry = EvaluationRegistry::instance ();
+  registry.reset ();
+
+  const std::string name ("scoped");
+  for (int i = 0; i < 3; ++i)
+    {
+      EvaluationScope scope (name, COMPUTE_EVALUATION);
+    }
+  {
+    EvaluationScope scope (name, HESSIAN_EVALUATION);
+  }
+
+  const EvaluationCounters* c = registry.find ("scoped");
+  BOOST_REQUIRE (c);
+  BOOST_CHECK_EQUAL (c->count (COMPUTE_EVALUATION), 3u);
+  BOOST_CHECK_EQUAL (c->count (GRADIENT_EVALUATION), 0u);
+  BOOST_CHECK_EQUAL (c->count (HESSIAN_EVALUATION), 1u);
+
+  BOOST_CHECK_EQUAL (EvaluationCounters::bin (0), 0u);
+  BOOST_CHECK_EQUAL (EvaluationCounters::bin (1), 0u);
+  BOOST_CHECK_EQUAL (EvaluationCounters::bin (2), 1u);
+  BOOST_CHECK_EQUAL (EvaluationCounters::bin (1000), 9u);
+  BOOST_CHECK_EQUAL (EvaluationCounters::bin (boost::uint64_t (-1)),
+		     EvaluationCounters::bins - 1);
+
+  registry.reset ();
+  BOOST_CHECK_EQUAL (c->count (COMPUTE_EVALUATION), 0u);
+}
+
+// The evaluation front-ends are only instrumented if roboptim-core is
+// configured with ROBOPTIM_INSTRUMENT_EVALUATION.
+#ifdef ROBOPTIM_INSTRUMENT_EVALUATION
+BOOST_AUTO_TEST_CASE (evaluation_counters)
+{
+  EvaluationRegistry& registry = EvaluationRegistry::instance ();
+  registry.reset ();
+
+  F f ("instrumented");
+  F::vector_t x (2);
+  x << 1., 2.;
+  F::result_t res (1);
+  F::gradient_t grad (2);
+  F::jacobian_t jac (1, 2);
+  F::hessian_t h (2, 2);
+
+  BOOST_CHECK (!registry.find ("never evaluated"));
+
+  for (int i = 0; i < 5; ++i)
+    f (res, x);
+  for (int i = 0; i < 3; ++i)
+    f.gradient (grad, x, 0);
+  f.jacobian (jac, x);
+  f.hessian (h, x, 0);
+
+  const EvaluationCounters* c = registry.find ("instrumented");
+  BOOST_REQUIRE (c);
+  BOOST_CHECK_EQUAL (c->count (COMPUTE_EVALUATION), 5u);
+  // The default Jacobian is computed from the gradients.
+  BOOST_CHECK_EQUAL (c->count (GRADIENT_EVALUATION), 4u);
+  BOOST_CHECK_EQUAL (c->count (JACOBIAN_EVALUATION), 1u);
+  BOOST_CHECK_EQUAL (c->count (HESSIAN_EVALUATION), 1u);
+
+  // Histograms and statistics are consistent.
+  for (std::size_t k = 0; k < EVALUATION_KINDS; ++k)
+    {
+      const evaluation_t kind = static_cast<evaluation_t> (k);
+      boost::uint64_t n = 0;
+      for (std::size_t b = 0; b < EvaluationCounters::bins; ++b)
+	n += c->histogram (kind, b);
+      BOOST_CHECK_EQUAL (n, c->count (kind));
+      BOOST_CHECK (c->maxTime (kind) <= c->totalTime (kind));
+      BOOST_CHECK (c->quantile (kind, .5) <= c->maxTime (kind));
+    }
+
+  // Operators are counted separately from their operands.
+  boost::shared_ptr<TwiceDifferentiableFunction> g =
+    boost::make_shared<F> ("operand");
+  boost::shared_ptr<TwiceDifferentiableFunction> scaled = 2. * g;
+  (*scaled) (res, x);
+  BOOST_REQUIRE (registry.find (scaled->getName ()));
+  BOOST_CHECK_EQUAL
+    (registry.find (scaled->getName ())->count (COMPUTE_EVALUATION), 1u);
+  BOOST_CHECK_EQUAL
+    (registry.find ("operand")->count (COMPUTE_EVALUATION), 1u);
+
+  std::cout << registry << std::endl;
+
+  registry.reset ();
+  BOOST_CHECK_EQUAL (c->count (COMPUTE_EVALUATION), 0u);
+  BOOST_CHECK_EQUAL (c->maxTime (COMPUTE_EVALUATION), 0u);
+}
+
+BOOST_AUTO_TEST_CASE (evaluation_counters_threads)
+{
+  EvaluationRegistry& registry = EvaluationRegistry::instance ();
+  registry.reset ();
+
+  // Functions sharing a name share their counters.
+  const int threads = 4;
+  const int evaluations = 1000;
+  std::vector<boost::shared_ptr<F> > functions;
+  boost::thread_group group;
+  for (int i = 0; i < threads; ++i)
+    {
+      functions.push_back (boost::make_shared<F> ("shared"));
+      group.create_thread (boost::bind (&evaluate, functions.back ().get (),
+					evaluations));
+    }
+  group.join_all ();
+
+  BOOST_REQUIRE (registry.find ("shared"));
+  BOOST_CHECK_EQUAL (registry.find ("shared")->count (COMPUTE_EVALUATION),
+		     static_cast<boost::uint64_t> (threads * evaluations));
+}
+#endif //! ROBOPTIM_INSTRUMENT_EVALUATION
+
+BOOST_AUTO_TEST_SUITE_END ()
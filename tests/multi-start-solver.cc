@@ -0,0 +1,157 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "shared-tests/fixture.hh"
+
+#include "gradient-descent-solver.hh"
+
+#include <cmath>
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/multi-start-solver.hh>
+
+using namespace roboptim;
+
+typedef MultiStartSolver<EigenMatrixDense> solver_t;
+
+// Double well: f(x) = (x^2 - 1)^2 + 0.3 x. The global minimum is close to
+// -1, and a local minimum is close to 1.
+struct DoubleWell : public DifferentiableFunction
+{
+  DoubleWell () : DifferentiableFunction (1, 1, "(x^2 - 1)^2 + 0.3 x")
+  {}
+
+  void impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = std::pow (x[0] * x[0] - 1., 2) + 0.3 * x[0];
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+                      size_type) const
+  {
+    grad[0] = 4. * x[0] * (x[0] * x[0] - 1.) + 0.3;
+  }
+};
+
+// Starting points evenly spread in [-2, 2].
+void generate (solver_t::vector_t& x, std::size_t i)
+{
+  x[0] = -2. + 4. * static_cast<double> (i) / 7.;
+}
+
+// Same starting points, but the generator fails for some of them.
+void generateOrThrow (solver_t::vector_t& x, std::size_t i)
+{
+  if (i == 0)
+    throw 42;
+  if (i == 3)
+    throw std::runtime_error ("no starting point");
+  generate (x, i);
+}
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (multi_start_solver)
+{
+  solver_t::problem_t pb (boost::make_shared<DoubleWell> ());
+  pb.setArgumentBounds (0, Function::makeInterval (-2., 2.));
+
+  solver_t solver (pb, "test-gd", &generate);
+  solver.parameters ()["multistart.starts"].value = 8;
+  solver.parameters ()["multistart.threads"].value = 2;
+  solver.parameters ()["gd.max-iterations"].value = 2000;
+
+  // Count the iterations through the user callback.
+  std::size_t iterations = 0;
+  struct Counter
+  {
+    static void count (std::size_t* n, const solver_t::problem_t&,
+                       solver_t::solverState_t&)
+    {
+      ++*n;
+    }
+  };
+  solver.setIterationCallback (boost::bind (&Counter::count, &iterations,
+                                            _1, _2));
+
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  const Result& res = solver.getMinimum<Result> ();
+  std::cout << solver << std::endl;
+
+  BOOST_CHECK_CLOSE (res.x[0], -1.03, 1.);
+  BOOST_REQUIRE (solver.bestStart ());
+  BOOST_CHECK (*solver.bestStart () < 4);
+
+  // Statistics.
+  const solver_t::statistics_t& stats = solver.statistics ();
+  BOOST_REQUIRE_EQUAL (stats.size (), 8);
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < stats.size (); ++i)
+    {
+      BOOST_CHECK_EQUAL (stats[i].start, i);
+      BOOST_CHECK (stats[i].thread < 2);
+      BOOST_CHECK_EQUAL (stats[i].status, GenericSolver::SOLVER_VALUE);
+      BOOST_CHECK (!stats[i].pruned);
+      BOOST_CHECK (stats[i].cost >= res.value[0]);
+      BOOST_CHECK (stats[i].iterations > 0);
+      total += stats[i].iterations;
+    }
+  BOOST_CHECK_EQUAL (total, iterations);
+
+  // Starts in the basin of the local minimum end up there.
+  BOOST_CHECK_CLOSE (stats[7].cost, 0.29, 5.);
+
+  // Pruning: the starts that are worse than the incumbent are stopped.
+  solver.parameters ()["multistart.threads"].value = 1;
+  solver.parameters ()["multistart.prune"].value = true;
+  solver.parameters ()["multistart.prune-after"].value = 5;
+  solver.reset ();
+
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (solver.getMinimum<Result> ().x[0], -1.03, 1.);
+  BOOST_CHECK (!stats[0].pruned);
+  BOOST_CHECK (stats[7].pruned);
+  BOOST_CHECK (stats[7].iterations < 10);
+
+  // Generator errors only fail their start, in the calling thread (start 0)
+  // as in the other threads.
+  solver_t failing (pb, "test-gd", &generateOrThrow);
+  failing.parameters ()["multistart.starts"].value = 8;
+  failing.parameters ()["multistart.threads"].value = 2;
+  failing.parameters ()["gd.max-iterations"].value = 2000;
+
+  BOOST_REQUIRE_EQUAL (failing.minimumType (), GenericSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (failing.getMinimum<Result> ().x[0], -1.03, 1.);
+  const solver_t::statistics_t& failed = failing.statistics ();
+  BOOST_REQUIRE_EQUAL (failed.size (), 8);
+  for (std::size_t i = 0; i < failed.size (); ++i)
+    BOOST_CHECK_EQUAL (failed[i].status, (i == 0 || i == 3)
+                       ? GenericSolver::SOLVER_ERROR
+                       : GenericSolver::SOLVER_VALUE);
+  BOOST_CHECK_EQUAL (failed[0].error, "multi-start: starting point"
+                     " generator failed: unknown exception");
+  BOOST_CHECK_EQUAL (failed[3].error, "multi-start: starting point"
+                     " generator failed: no starting point");
+
+  // Plug-in errors are reported to the caller.
+  solver_t invalid (pb, "invalid-plugin", &generate);
+  BOOST_CHECK_THROW (invalid.solve (), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -27,6 +27,7 @@
 
 #include <roboptim/core/decorator/finite-difference-gradient.hh>
 #include <roboptim/core/io.hh>
+#include <roboptim/core/util.hh>
 #include <roboptim/core/operator/chain.hh>
 #include <roboptim/core/operator/selection.hh>
 #include <roboptim/core/numeric-linear-function.hh>
@@ -210,4 +211,45 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (chain_jacobian_test, T, functionTypes_t)
     }
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE (chain_multi_output_gradient_test, T,
+			       functionTypes_t)
+{
+  typedef typename GenericNumericLinearFunction<T>::matrix_t matrix_t;
+  typedef typename GenericNumericLinearFunction<T>::vector_t vector_t;
+  typedef typename GenericNumericLinearFunction<T>::gradient_t gradient_t;
+  typedef boost::shared_ptr<GenericNumericLinearFunction<T> >
+    linearFunctionShPtr_t;
+
+  // f: R^3 -> R^2, g: R^2 -> R^3: the inner function has several outputs.
+  matrix_t A (2, 3);
+  A << 1., 2., 3.,
+       4., 5., 6.;
+  matrix_t B (3, 2);
+  B << 1., -1.,
+       0., 2.,
+       3., 1.;
+
+  linearFunctionShPtr_t f =
+    boost::make_shared<GenericNumericLinearFunction<T> >
+    (A, vector_t::Zero (2));
+  linearFunctionShPtr_t g =
+    boost::make_shared<GenericNumericLinearFunction<T> >
+    (B, vector_t::Zero (3));
+
+  boost::shared_ptr<GenericLinearFunction<T> > h = chain (f, g);
+  BOOST_CHECK_EQUAL (h->inputSize (), 2);
+  BOOST_CHECK_EQUAL (h->outputSize (), 2);
+
+  vector_t x (2);
+  x << 1., 2.;
+  const matrix_t AB = A * B;
+  for (typename matrix_t::Index i = 0; i < 2; ++i)
+    {
+      const gradient_t grad = h->gradient (x, i);
+      BOOST_CHECK (allclose (grad, gradient_t (AB.row (i))));
+      CHECK_GRADIENT (*h, i, x);
+    }
+  BOOST_CHECK (allclose (h->jacobian (x), AB));
+}
+
 BOOST_AUTO_TEST_SUITE_END ()
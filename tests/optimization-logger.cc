@@ -17,14 +17,19 @@
 
 #include "shared-tests/fixture.hh"
 
+#include <fstream>
 #include <iostream>
+#include <map>
 
 #include <boost/make_shared.hpp>
 #include <boost/mpl/vector.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/test/test_case_template.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/xpressive/xpressive.hpp>
 
 #include <roboptim/core/io.hh>
+#include <roboptim/core/binary-log.hh>
 #include <roboptim/core/solver-factory.hh>
 #include <roboptim/core/optimization-logger.hh>
 #include <roboptim/core/differentiable-function.hh>
@@ -72,6 +77,67 @@ struct F2 : public DifferentiableSparseFunction
   }
 };
 
+// Define a function whose Jacobian only has one coefficient, that depends
+// on x (dense or sparse differentiable)
+template <typename T>
+struct F3 : public GenericDifferentiableFunction<T>
+{
+  ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+  (GenericDifferentiableFunction<T>);
+
+  F3 () : GenericDifferentiableFunction<T> (4, 1, "a or b")
+  {}
+
+  void impl_compute (result_ref result, const_argument_ref x)
+    const
+  {
+    result (0) = (x[0] < 0.) ? x[0] : x[1];
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x, size_type)
+    const
+  {
+    grad.coeffRef ((x[0] < 0.) ? 0 : 1) = 1.;
+  }
+
+  void impl_jacobian (jacobian_ref jac, const_argument_ref x)
+    const
+  {
+    jac.coeffRef (0, (x[0] < 0.) ? 0 : 1) = 1.;
+  }
+};
+
+// Logged iterations, and first coordinate of their argument.
+std::map<unsigned, double>
+loggedIterations (const boost::filesystem::path& path, logFormat_t format,
+		  unsigned iterations)
+{
+  std::map<unsigned, double> logged;
+  if (format == BINARY_LOG)
+    {
+      // Iterations are recorded in order.
+      BinaryLogReader reader (path / "log.bin");
+      for (std::size_t i = 0; i < reader.size (); ++i)
+	{
+	  if (i > 0)
+	    BOOST_CHECK (reader[i].iteration () > reader[i - 1].iteration ());
+	  logged[reader[i].iteration ()] = reader[i].x ()[0];
+	}
+      return logged;
+    }
+
+  for (unsigned i = 0; i < iterations; ++i)
+    {
+      std::ifstream file
+	((path / (boost::format ("iteration-%d") % i).str () / "x.csv")
+	 .string ().c_str ());
+      double x0;
+      if (file >> x0)
+	logged[i] = x0;
+    }
+  return logged;
+}
+
 bool findRegex (const std::string& text, const std::string& r)
 {
   boost::xpressive::sregex rex = boost::xpressive::sregex::compile (r);
@@ -127,7 +193,7 @@ void testLogger
   // Give a dummy starting point
   typename F::argument_t x (f->inputSize ());
   x.setZero ();
-  pb.startingPoint () = x;
+  pb.setStartingPoint (x);
 
   // Instantiate the factory using the dummy solver.
   SolverFactory<solver_t>
@@ -188,4 +254,218 @@ BOOST_AUTO_TEST_CASE (plugin)
   BOOST_CHECK (output->match_pattern ());
 }
 
+BOOST_AUTO_TEST_CASE (decimation)
+{
+  typedef Solver<EigenMatrixSparse> solver_t;
+
+  boost::shared_ptr<F2> f = boost::make_shared<F2> ();
+  solver_t::problem_t pb (f);
+  pb.addConstraint (f, F2::makeInterval (-1., 1.));
+  pb.setStartingPoint (F2::argument_t::Zero (f->inputSize ()));
+
+  SolverFactory<solver_t> factory ("dummy-d-sparse-laststate", pb);
+  solver_t& solver = factory ();
+
+  const boost::filesystem::path path =
+    "/tmp/roboptim-core-tests/optimization-logger-decimation";
+  OptimizationLogger<solver_t> logger (solver, path, false);
+  logger.setDecimation (10, 0.5);
+  std::cout << logger << std::endl;
+
+  // x only changes significantly at iteration 25.
+  solver_t::solverState_t state (pb);
+  state.x ().setZero ();
+  for (unsigned i = 0; i < 50; ++i)
+    {
+      state.x ()[0] = (i < 25) ? 0.01 * i : 10.;
+      logger (pb, state);
+    }
+
+  // Iterations 0, 10, 20, 25, 30, 40.
+  BOOST_CHECK_EQUAL (logger.skippedIterations (), 44u);
+  BOOST_CHECK (boost::filesystem::exists (path / "iteration-25"));
+  BOOST_CHECK (!boost::filesystem::exists (path / "iteration-26"));
+
+  // Evolution files are written while the logger is alive.
+  const char* files[] =
+    {"cost-evolution.csv", "x-evolution.csv",
+     "constraint-violation-evolution.csv", "constraint-0-evolution.csv"};
+  for (std::size_t i = 0; i < 4; ++i)
+    {
+      std::ifstream file ((path / files[i]).string ().c_str ());
+      std::string line;
+      std::size_t lines = 0;
+      while (std::getline (file, line))
+	++lines;
+      BOOST_CHECK_EQUAL (lines, 7u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (updated_bounds)
+{
+  typedef Solver<EigenMatrixSparse> solver_t;
+
+  boost::shared_ptr<F2> f = boost::make_shared<F2> ();
+  solver_t::problem_t pb (f);
+  pb.addConstraint (f, F2::makeInterval (-1., 1.));
+  pb.setStartingPoint (F2::argument_t::Zero (f->inputSize ()));
+
+  SolverFactory<solver_t> factory ("dummy-d-sparse-laststate", pb);
+  solver_t& solver = factory ();
+
+  const boost::filesystem::path path =
+    "/tmp/roboptim-core-tests/optimization-logger-updated-bounds";
+  OptimizationLogger<solver_t> logger (solver, path, false);
+
+  // a + b + c + d = 2: the upper bound is violated by 1.
+  solver_t::solverState_t state (solver.problem ());
+  state.x ().setZero ();
+  state.x ()[0] = 2.;
+  logger (solver.problem (), state);
+
+  // Re-solve with a larger upper bound: the constraint is satisfied.
+  solver_t::intervals_t bounds (1, F2::makeInterval (-1., 3.));
+  solver.updateConstraintBounds (0, bounds);
+  solver.resolve ();
+  logger (solver.problem (), state);
+
+  double violation[2];
+  for (std::size_t i = 0; i < 2; ++i)
+    {
+      std::ifstream file
+	((path / (boost::format ("iteration-%d") % i).str ()
+	  / "constraint-violation").string ().c_str ());
+      BOOST_REQUIRE (file >> violation[i]);
+    }
+  BOOST_CHECK_EQUAL (violation[0], 1.);
+  BOOST_CHECK_EQUAL (violation[1], 0.);
+}
+
+typedef boost::mpl::vector<EigenMatrixDense, EigenMatrixSparse>
+functionTypes_t;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (partial_jacobian, T, functionTypes_t)
+{
+  typedef Solver<T> solver_t;
+
+  boost::shared_ptr<F3<T> > f = boost::make_shared<F3<T> > ();
+  typename solver_t::problem_t pb (f);
+  pb.addConstraint (f, F3<T>::makeInterval (-1., 1.));
+  pb.setStartingPoint (F3<T>::argument_t::Zero (f->inputSize ()));
+
+  SolverFactory<solver_t> factory
+    (boost::is_same<T, EigenMatrixSparse>::value
+     ? "dummy-d-sparse-laststate" : "dummy-laststate", pb);
+  solver_t& solver = factory ();
+
+  const boost::filesystem::path path =
+    std::string ("/tmp/roboptim-core-tests/optimization-logger-partial-")
+    + (boost::is_same<T, EigenMatrixSparse>::value ? "sparse" : "dense");
+  OptimizationLogger<solver_t> logger (solver, path, false);
+
+  // The Jacobian coefficient moves from the first to the second column:
+  // the first one must not be kept from the previous iteration.
+  typename solver_t::solverState_t state (pb);
+  state.x ().setZero ();
+  state.x ()[0] = -1.;
+  logger (pb, state);
+  state.x ()[0] = 1.;
+  logger (pb, state);
+
+  const char* expected[] = {"1, 0, 0, 0", "0, 1, 0, 0"};
+  for (std::size_t i = 0; i < 2; ++i)
+    {
+      std::ifstream file
+	((path / (boost::format ("iteration-%d") % i).str ()
+	  / "constraint-0" / "jacobian.csv").string ().c_str ());
+      std::string line;
+      BOOST_REQUIRE (std::getline (file, line));
+      BOOST_CHECK_EQUAL (line, expected[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (asynchronous_optimization_logger)
+{
+  typedef Solver<EigenMatrixSparse> solver_t;
+
+  boost::shared_ptr<F2> f = boost::make_shared<F2> ();
+  solver_t::problem_t pb (f);
+  pb.addConstraint (f, F2::makeInterval (-1., 1.));
+  pb.setStartingPoint (F2::argument_t::Zero (f->inputSize ()));
+
+  SolverFactory<solver_t> factory ("dummy-d-sparse-laststate", pb);
+  solver_t& solver = factory ();
+
+  const unsigned n = 500;
+  const logFormat_t formats[] = {CSV_LOG, BINARY_LOG};
+  const logOverflowPolicy_t policies[] =
+    {BLOCK_ON_OVERFLOW, DROP_ON_OVERFLOW, SAMPLE_ON_OVERFLOW};
+
+  for (std::size_t k = 0; k < 2; ++k)
+    for (std::size_t p = 0; p < 3; ++p)
+      {
+	const boost::filesystem::path path =
+	  "/tmp/roboptim-core-tests/asynchronous-optimization-logger";
+	std::size_t dropped = 0;
+	{
+	  OptimizationLogger<solver_t> logger
+	    (solver, path, false, formats[k]);
+	  BOOST_CHECK (!logger.isAsynchronous ());
+	  logger.setAsynchronous (4, policies[p]);
+	  BOOST_CHECK (logger.isAsynchronous ());
+	  std::cout << logger << std::endl;
+
+	  solver_t::solverState_t state (pb);
+	  for (unsigned i = 0; i < n; ++i)
+	    {
+	      state.x ()[0] = static_cast<double> (i);
+	      logger (pb, state);
+	    }
+
+	  // The pending iterations are logged.
+	  logger.flush ();
+	  dropped = logger.droppedIterations ();
+	  BOOST_CHECK_EQUAL (loggedIterations (path, formats[k], n).size ()
+			     + dropped, n);
+	  if (policies[p] == BLOCK_ON_OVERFLOW)
+	    BOOST_CHECK_EQUAL (dropped, 0u);
+
+	  logger.setSynchronous ();
+	  BOOST_CHECK (!logger.isAsynchronous ());
+	  logger (pb, state);
+	}
+
+	const std::map<unsigned, double> logged =
+	  loggedIterations (path, formats[k], n + 1);
+	BOOST_REQUIRE_EQUAL (logged.size () + dropped, n + 1);
+
+	// Iterations are logged with the state of their call.
+	for (std::map<unsigned, double>::const_iterator
+	       it = logged.begin (); it != logged.end (); ++it)
+	  if (it->first < n)
+	    BOOST_CHECK_EQUAL (it->second, static_cast<double> (it->first));
+	BOOST_CHECK_EQUAL (logged.rbegin ()->first, n);
+      }
+}
+
+BOOST_AUTO_TEST_CASE (constraint_violation)
+{
+  typedef Function::vector_t vector_t;
+  const double inf = Function::infinity ();
+
+  vector_t g (4);
+  g << 0., 2., -3., 5.;
+  vector_t lower (4);
+  lower << -1., -inf, -1., 0.;
+  vector_t upper (4);
+  upper << 1., 1., inf, inf;
+
+  // Violations: 0, 1, 2, 0.
+  BOOST_CHECK_EQUAL (detail::uniformNormViolation (g, lower, upper), 2.);
+  BOOST_CHECK_EQUAL (detail::uniformNormViolation
+		     (g.head (1), lower.head (1), upper.head (1)), 0.);
+  BOOST_CHECK_EQUAL (detail::uniformNormViolation
+		     (vector_t (), vector_t (), vector_t ()), 0.);
+}
+
 BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,237 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "shared-tests/fixture.hh"
+
+#include <cstdlib>
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/numeric-linear-function.hh>
+#include <roboptim/core/numeric-quadratic-function.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/util.hh>
+
+using namespace roboptim;
+
+typedef boost::mpl::list< ::roboptim::EigenMatrixDense,
+			  ::roboptim::EigenMatrixSparse> functionTypes_t;
+
+template <typename T>
+struct Plugin;
+
+template <>
+struct Plugin<EigenMatrixDense>
+{
+  static const char* name ()
+  {
+    return "active-set-qp";
+  }
+};
+
+template <>
+struct Plugin<EigenMatrixSparse>
+{
+  static const char* name ()
+  {
+    return "active-set-qp-sparse";
+  }
+};
+
+// Check the KKT conditions of a QP solution.
+template <typename T>
+void checkOptimality (const Problem<T>& pb, const Result& res,
+                      const Eigen::MatrixXd& H, const Eigen::VectorXd& q,
+                      const Eigen::MatrixXd& C)
+{
+  typedef typename Problem<T>::size_type size_type;
+  const size_type n = pb.function ().inputSize ();
+  const size_type m = C.rows ();
+  const double tol = 1e-8;
+
+  BOOST_REQUIRE_EQUAL (res.lambda.size (), n + m);
+  BOOST_CHECK_SMALL (res.constraint_violation, tol);
+
+  // Stationarity: the gradient of the cost is a combination of the
+  // gradients of the active constraints.
+  Eigen::VectorXd residual = H * res.x + q - res.lambda.head (n)
+    - C.transpose () * res.lambda.tail (m);
+  BOOST_CHECK_SMALL (residual.lpNorm<Eigen::Infinity> (), tol);
+
+  // Complementarity: positive multipliers on lower bounds, negative
+  // multipliers on upper bounds.
+  for (size_type i = 0; i < n + m; ++i)
+    {
+      const double v = i < n ? res.x[i] : res.constraints[i - n];
+      const double l = i < n ? pb.argumentLowerBounds ()[i]
+        : pb.constraintsLowerBounds ()[i - n];
+      const double u = i < n ? pb.argumentUpperBounds ()[i]
+        : pb.constraintsUpperBounds ()[i - n];
+      if (res.lambda[i] > tol)
+        BOOST_CHECK_SMALL (v - l, tol);
+      else if (res.lambda[i] < -tol)
+        BOOST_CHECK_SMALL (u - v, tol);
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (plugin_active_set_qp, T, functionTypes_t)
+{
+  typedef Solver<T> solver_t;
+  typedef typename solver_t::problem_t problem_t;
+  typedef typename problem_t::function_t function_t;
+  typedef GenericNumericQuadraticFunction<T> quadratic_t;
+  typedef GenericNumericLinearFunction<T> linear_t;
+  typedef typename function_t::vector_t vector_t;
+  typedef typename function_t::matrix_t matrix_t;
+  typedef typename problem_t::intervals_t intervals_t;
+  typedef typename problem_t::scaling_t scaling_t;
+
+  // (x0 - 1)^2 + (x1 - 2)^2
+  Eigen::MatrixXd I = Eigen::MatrixXd::Identity (2, 2);
+  matrix_t A;
+  A = I.sparseView ();
+  vector_t b (2);
+  b << -2., -4.;
+  vector_t c (1);
+  c << 5.;
+  boost::shared_ptr<quadratic_t> cost =
+    boost::make_shared<quadratic_t> (A, b, c);
+
+  // x0 + x1 <= 2
+  Eigen::MatrixXd C (1, 2);
+  C << 1., 1.;
+  matrix_t C_;
+  C_ = C.sparseView ();
+  boost::shared_ptr<linear_t> sum =
+    boost::make_shared<linear_t> (C_, vector_t::Zero (1));
+
+  problem_t pb (cost);
+  pb.addConstraint (sum, function_t::makeUpperInterval (2.));
+
+  SolverFactory<solver_t> factory (Plugin<T>::name (), pb);
+  solver_t& solver = factory ();
+  std::cout << solver << std::endl;
+
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  const Result& res = solver.template getMinimum<Result> ();
+  std::cout << res << std::endl;
+  BOOST_CHECK (res.warnings.empty ());
+  BOOST_CHECK_CLOSE (res.x[0], .5, 1e-8);
+  BOOST_CHECK_CLOSE (res.x[1], 1.5, 1e-8);
+  BOOST_CHECK_CLOSE (res.value[0], .5, 1e-8);
+  BOOST_CHECK_CLOSE (res.lambda[2], -1., 1e-8);
+  checkOptimality (pb, res, 2. * I, b, C);
+
+  // Active lower bound: x0 >= 0.8.
+  intervals_t bounds = pb.argumentBounds ();
+  bounds[0] = function_t::makeLowerInterval (.8);
+  solver.updateArgumentBounds (bounds);
+  solver.resolve ();
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  const Result& bounded = solver.template getMinimum<Result> ();
+  BOOST_CHECK_CLOSE (bounded.x[0], .8, 1e-8);
+  BOOST_CHECK_CLOSE (bounded.x[1], 1.2, 1e-8);
+  BOOST_CHECK_CLOSE (bounded.value[0], .68, 1e-8);
+  BOOST_CHECK_CLOSE (bounded.lambda[0], 1.2, 1e-8);
+  BOOST_CHECK_CLOSE (bounded.lambda[2], -1.6, 1e-8);
+
+  // Equality constraint: x0 - x1 = 0.
+  Eigen::MatrixXd D (1, 2);
+  D << 1., -1.;
+  matrix_t D_;
+  D_ = D.sparseView ();
+  problem_t equality (cost);
+  equality.addConstraint (boost::make_shared<linear_t> (D_, vector_t::Zero (1)),
+                          function_t::makeInterval (0., 0.));
+  SolverFactory<solver_t> equalityFactory (Plugin<T>::name (), equality);
+  solver_t& equalitySolver = equalityFactory ();
+  BOOST_REQUIRE_EQUAL (equalitySolver.minimumType (),
+                       GenericSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (equalitySolver.template getMinimum<Result> ().x[0], 1.5,
+                     1e-8);
+  BOOST_CHECK_CLOSE (equalitySolver.template getMinimum<Result> ().x[1], 1.5,
+                     1e-8);
+
+  // Infeasible problem: x0 >= 3, x1 >= 0 and x0 + x1 <= 2.
+  problem_t infeasible (pb);
+  infeasible.setArgumentBounds (0, function_t::makeLowerInterval (3.));
+  infeasible.setArgumentBounds (1, function_t::makeLowerInterval (0.));
+  SolverFactory<solver_t> infeasibleFactory (Plugin<T>::name (), infeasible);
+  BOOST_CHECK_EQUAL (infeasibleFactory ().minimumType (),
+                     GenericSolver::SOLVER_ERROR);
+
+  // The cost function has to be quadratic.
+  problem_t linear (boost::make_shared<linear_t> (C_, vector_t::Zero (1)));
+  SolverFactory<solver_t> linearFactory (Plugin<T>::name (), linear);
+  BOOST_CHECK_EQUAL (linearFactory ().minimumType (),
+                     GenericSolver::SOLVER_ERROR);
+
+  // Random strictly convex QP with bounds and general constraints.
+  std::srand (0);
+  const int n = 20;
+  const int m = 8;
+  Eigen::MatrixXd M = Eigen::MatrixXd::Random (n, n);
+  Eigen::MatrixXd H = M.transpose () * M
+    + Eigen::MatrixXd::Identity (n, n);
+  Eigen::MatrixXd halfH = .5 * H;
+  matrix_t H_;
+  H_ = halfH.sparseView ();
+  vector_t q = 10. * vector_t::Random (n);
+  Eigen::MatrixXd G = Eigen::MatrixXd::Random (m, n);
+  matrix_t G_;
+  G_ = G.sparseView ();
+
+  problem_t random (boost::make_shared<quadratic_t> (H_, q));
+  for (int i = 0; i < n; ++i)
+    random.setArgumentBounds (i, function_t::makeInterval (-1., 1.));
+  random.addConstraint (boost::make_shared<linear_t> (G_, vector_t::Zero (m)),
+                        intervals_t (m, function_t::makeInterval (-.5, .5)),
+                        scaling_t (m, 1.));
+
+  SolverFactory<solver_t> randomFactory (Plugin<T>::name (), random);
+  solver_t& randomSolver = randomFactory ();
+  BOOST_REQUIRE_EQUAL (randomSolver.minimumType (),
+                       GenericSolver::SOLVER_VALUE);
+  checkOptimality (randomSolver.problem (),
+                   randomSolver.template getMinimum<Result> (), H, q, G);
+
+  // Warm start: the same solution as a new solver.
+  for (int k = 0; k < 5; ++k)
+    {
+      intervals_t randomBounds = randomSolver.problem ().argumentBounds ();
+      randomBounds[k] = function_t::makeInterval (-.1 * k, .1);
+      randomSolver.updateArgumentBounds (randomBounds);
+      randomSolver.resolve ();
+      BOOST_REQUIRE_EQUAL (randomSolver.minimumType (),
+                           GenericSolver::SOLVER_VALUE);
+      const Result& warm = randomSolver.template getMinimum<Result> ();
+      checkOptimality (randomSolver.problem (), warm, H, q, G);
+
+      SolverFactory<solver_t> coldFactory (Plugin<T>::name (),
+                                           randomSolver.problem ());
+      solver_t& cold = coldFactory ();
+      BOOST_REQUIRE_EQUAL (cold.minimumType (), GenericSolver::SOLVER_VALUE);
+      BOOST_CHECK (allclose (warm.x, cold.template getMinimum<Result> ().x,
+                             1e-8, 1e-8));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,247 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "shared-tests/fixture.hh"
+
+#include <cmath>
+
+#include <boost/atomic.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/numeric-linear-function.hh>
+#include <roboptim/core/numeric-quadratic-function.hh>
+#include <roboptim/core/solver-factory.hh>
+
+using namespace roboptim;
+
+typedef Solver<EigenMatrixSparse> solver_t;
+
+// (x0 - 2)^2 + (x1 - 1)^2
+struct Distance : public DifferentiableSparseFunction
+{
+  Distance () : DifferentiableSparseFunction (2, 1, "distance to (2, 1)")
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    res[0] = (x[0] - 2.) * (x[0] - 2.) + (x[1] - 1.) * (x[1] - 1.);
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+                      size_type) const
+  {
+    grad.coeffRef (0) = 2. * (x[0] - 2.);
+    grad.coeffRef (1) = 2. * (x[1] - 1.);
+  }
+};
+
+// x0^2 + x1^2
+struct SquaredNorm : public DifferentiableSparseFunction
+{
+  SquaredNorm () : DifferentiableSparseFunction (2, 1, "x0^2 + x1^2")
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    res[0] = x.squaredNorm ();
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+                      size_type) const
+  {
+    grad.coeffRef (0) = 2. * x[0];
+    grad.coeffRef (1) = 2. * x[1];
+  }
+};
+
+// x0 + x1, with a mutable buffer: it must not be evaluated concurrently.
+struct NonReentrantSum : public DifferentiableSparseFunction
+{
+  NonReentrantSum ()
+    : DifferentiableSparseFunction (2, 1, "x0 + x1"),
+      buffer_ (2),
+      active_ (0),
+      overlaps_ (0)
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    enter ();
+    buffer_ = x;
+    boost::this_thread::yield ();
+    res[0] = buffer_.sum ();
+    leave ();
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref,
+                      size_type) const
+  {
+    enter ();
+    grad.coeffRef (0) = 1.;
+    grad.coeffRef (1) = 1.;
+    leave ();
+  }
+
+  void enter () const
+  {
+    if (active_.fetch_add (1) > 0)
+      ++overlaps_;
+  }
+
+  void leave () const
+  {
+    active_.fetch_sub (1);
+  }
+
+  mutable vector_t buffer_;
+  mutable boost::atomic<int> active_;
+  mutable boost::atomic<int> overlaps_;
+};
+
+// Non-differentiable constraint.
+struct Max : public GenericFunction<EigenMatrixSparse>
+{
+  Max () : GenericFunction<EigenMatrixSparse> (2, 1, "max (x0, x1)")
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    res[0] = x.maxCoeff ();
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (plugin_augmented_lagrangian)
+{
+  // Projection of (2, 1) on the unit disk.
+  solver_t::problem_t pb (boost::make_shared<Distance> ());
+  pb.addConstraint (boost::make_shared<SquaredNorm> (),
+                    DifferentiableSparseFunction::makeUpperInterval (1.));
+  Function::vector_t x0 (2);
+  x0 << 0., 0.;
+  pb.setStartingPoint (x0);
+
+  SolverFactory<solver_t> factory ("augmented-lagrangian", pb);
+  solver_t& solver = factory ();
+  std::cout << solver << std::endl;
+
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  const Result& res = solver.getMinimum<Result> ();
+  std::cout << res << std::endl;
+  BOOST_CHECK (res.warnings.empty ());
+  BOOST_CHECK_CLOSE (res.x[0], 2. / std::sqrt (5.), 1e-4);
+  BOOST_CHECK_CLOSE (res.x[1], 1. / std::sqrt (5.), 1e-4);
+  BOOST_CHECK_SMALL (res.constraint_violation, 1e-6);
+  BOOST_REQUIRE_EQUAL (res.lambda.size (), 3);
+  BOOST_CHECK_CLOSE (res.lambda[2], 1. - std::sqrt (5.), 1e-3);
+
+  // Active lower bound: x1 >= 0.6.
+  solver_t::problem_t::intervals_t bounds = pb.argumentBounds ();
+  bounds[1] = Function::makeLowerInterval (.6);
+  solver.updateArgumentBounds (bounds);
+  solver.resolve ();
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  const Result& bounded = solver.getMinimum<Result> ();
+  BOOST_CHECK_CLOSE (bounded.x[0], .8, 1e-4);
+  BOOST_CHECK_CLOSE (bounded.x[1], .6, 1e-4);
+  BOOST_CHECK (bounded.lambda[1] > 0.);
+
+  // Equality constraints (numeric functions): x0 + x1 = 1, with two
+  // threads evaluating the constraints.
+  Eigen::MatrixXd I = Eigen::MatrixXd::Identity (2, 2);
+  Eigen::MatrixXd A (1, 2);
+  A << 1., 1.;
+  Eigen::MatrixXd B (1, 2);
+  B << 1., -1.;
+  GenericNumericLinearFunction<EigenMatrixSparse>::matrix_t A_ =
+    A.sparseView ();
+  GenericNumericLinearFunction<EigenMatrixSparse>::matrix_t B_ =
+    B.sparseView ();
+  GenericNumericQuadraticFunction<EigenMatrixSparse>::matrix_t I_ =
+    I.sparseView ();
+
+  solver_t::problem_t equality
+    (boost::make_shared<GenericNumericQuadraticFunction<EigenMatrixSparse> >
+     (I_, Function::vector_t::Zero (2)));
+  equality.addConstraint
+    (boost::make_shared<GenericNumericLinearFunction<EigenMatrixSparse> >
+     (A_, Function::vector_t::Zero (1)),
+     Function::makeInterval (1., 1.));
+  equality.addConstraint
+    (boost::make_shared<GenericNumericLinearFunction<EigenMatrixSparse> >
+     (B_, Function::vector_t::Zero (1)),
+     Function::makeInterval (-.2, .2));
+
+  SolverFactory<solver_t> equalityFactory ("augmented-lagrangian", equality);
+  solver_t& equalitySolver = equalityFactory ();
+  Result single = equalitySolver.getMinimum<Result> ();
+  BOOST_CHECK_CLOSE (single.x[0], .5, 1e-4);
+  BOOST_CHECK_CLOSE (single.x[1], .5, 1e-4);
+  BOOST_CHECK_CLOSE (single.lambda[2], 1., 1e-3);
+  BOOST_CHECK_SMALL (single.lambda[3], 1e-6);
+
+  equalitySolver.parameters ()["al.threads"].value = 2;
+  equalitySolver.reset ();
+  equalitySolver.solve ();
+  BOOST_REQUIRE_EQUAL (equalitySolver.minimumType (),
+                       GenericSolver::SOLVER_VALUE);
+  BOOST_CHECK (allclose (equalitySolver.getMinimum<Result> ().x, single.x));
+
+  // Constraints sharing a function object are evaluated by the same
+  // thread: projection of (2, 1) on x0 + x1 <= 1.
+  boost::shared_ptr<NonReentrantSum> sum =
+    boost::make_shared<NonReentrantSum> ();
+  solver_t::problem_t shared (boost::make_shared<Distance> ());
+  shared.addConstraint (sum, Function::makeUpperInterval (1.));
+  shared.addConstraint (boost::make_shared<SquaredNorm> (),
+                        Function::makeUpperInterval (4.));
+  shared.addConstraint (sum, Function::makeLowerInterval (-5.));
+  shared.setStartingPoint (x0);
+
+  SolverFactory<solver_t> sharedFactory ("augmented-lagrangian", shared);
+  solver_t& sharedSolver = sharedFactory ();
+  sharedSolver.parameters ()["al.threads"].value = 3;
+  sharedSolver.solve ();
+  BOOST_REQUIRE_EQUAL (sharedSolver.minimumType (),
+                       GenericSolver::SOLVER_VALUE);
+  const Result& sharedResult = sharedSolver.getMinimum<Result> ();
+  BOOST_CHECK_CLOSE (sharedResult.x[0], 1., 1e-4);
+  BOOST_CHECK_SMALL (sharedResult.x[1], 1e-4);
+  BOOST_CHECK_EQUAL (sum->overlaps_.load (), 0);
+
+  // Errors: non-differentiable constraint, unknown inner solver.
+  solver_t::problem_t nonDifferentiable (boost::make_shared<Distance> ());
+  nonDifferentiable.addConstraint (boost::make_shared<Max> (),
+                                   Function::makeUpperInterval (1.));
+  SolverFactory<solver_t> nonDifferentiableFactory ("augmented-lagrangian",
+                                                    nonDifferentiable);
+  BOOST_CHECK_EQUAL (nonDifferentiableFactory ().minimumType (),
+                     GenericSolver::SOLVER_ERROR);
+
+  equalitySolver.parameters ()["al.inner-solver"].value =
+    std::string ("no-such-plugin");
+  equalitySolver.reset ();
+  equalitySolver.solve ();
+  BOOST_CHECK_EQUAL (equalitySolver.minimumType (),
+                     GenericSolver::SOLVER_ERROR);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
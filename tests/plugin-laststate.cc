@@ -24,6 +24,7 @@
 
 #include <roboptim/core/io.hh>
 #include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin/dummy-laststate.hh>
 
 using namespace roboptim;
 
@@ -46,6 +47,23 @@ struct F : public Function
   // No gradient, hessian.
 };
 
+// Function depending on the problem parameters.
+struct G : public Function
+{
+  explicit G (const boost::shared_ptr<const vector_t>& parameters)
+    : Function (4, 1, "a + b + c + d + p"),
+      parameters_ (parameters)
+  {}
+
+  void impl_compute (result_ref result, const_argument_ref argument)
+    const
+  {
+    result (0) = argument.sum () + (*parameters_)[0];
+  }
+
+  boost::shared_ptr<const vector_t> parameters_;
+};
+
 BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
 
 BOOST_AUTO_TEST_CASE (plugin)
@@ -94,4 +112,84 @@ BOOST_AUTO_TEST_CASE (plugin)
   BOOST_CHECK (output->match_pattern ());
 }
 
+BOOST_AUTO_TEST_CASE (plugin_resolve)
+{
+  // The cost function depends on the problem parameters.
+  boost::shared_ptr<solver_t::vector_t> parameters =
+    boost::make_shared<solver_t::vector_t> ();
+  boost::shared_ptr<F> f = boost::make_shared<F> ();
+  solver_t::problem_t pb (boost::make_shared<G> (parameters));
+  pb.addConstraint (f, F::makeInterval (0., 1.));
+
+  SolverFactory<solver_t> factory ("dummy-laststate", pb);
+  solver_t& solver = factory ();
+  solver.setProblemParametersBuffer (parameters);
+
+  solver.solve ();
+  BOOST_CHECK_EQUAL (solver.pendingUpdates (), 0u);
+
+  // Update the problem in place.
+  solver_t::vector_t x0 (4);
+  x0 << 1., 2., 3., 4.;
+  solver.updateStartingPoint (x0);
+  solver.updateArgumentBounds
+    (solver_t::intervals_t (4, F::makeInterval (-10., 10.)));
+  solver.updateConstraintBounds
+    (0, solver_t::intervals_t (1, F::makeInterval (-1., 2.)));
+
+  solver_t::vector_t p (2);
+  p << 0.5, 1.5;
+  solver.updateProblemParameters (p);
+
+  unsigned int updates = solver_t::STARTING_POINT_UPDATE
+    | solver_t::ARGUMENT_BOUNDS_UPDATE
+    | solver_t::CONSTRAINT_BOUNDS_UPDATE
+    | solver_t::PARAMETERS_UPDATE;
+  BOOST_CHECK_EQUAL (solver.pendingUpdates (), updates);
+
+  // The original problem is not modified.
+  BOOST_CHECK (!pb.startingPoint ());
+  BOOST_CHECK_EQUAL (pb.boundsVector ()[0][0].second, 1.);
+
+  BOOST_CHECK (!!solver.problem ().startingPoint ());
+  BOOST_CHECK_EQUAL (solver.problem ().argumentLowerBounds ()[2], -10.);
+  BOOST_CHECK_EQUAL (solver.problem ().boundsVector ()[0][0].first, -1.);
+  BOOST_CHECK_EQUAL (solver.problem ().constraintsUpperBounds ()[0], 2.);
+  BOOST_CHECK_EQUAL (solver.problemParameters ()[1], 1.5);
+  BOOST_CHECK_EQUAL (solver.problem ().function () (x0)[0], 10.5);
+
+  // Solve again: the dummy solver starts from the new starting point.
+  solver.resolve ();
+  BOOST_CHECK_EQUAL (solver.pendingUpdates (), 0u);
+  const DummySolverLastState* dummy =
+    dynamic_cast<const DummySolverLastState*> (&solver);
+  BOOST_REQUIRE (dummy);
+  BOOST_CHECK_EQUAL (dummy->lastUpdates (), updates);
+
+  const SolverError& err = solver.getMinimum<SolverError> ();
+  BOOST_REQUIRE (err.lastState ());
+  BOOST_CHECK (err.lastState ()->x == x0);
+
+  // Invalid updates.
+  BOOST_CHECK_THROW (solver.updateStartingPoint (p), std::runtime_error);
+  BOOST_CHECK_THROW
+    (solver.updateArgumentBounds
+     (solver_t::intervals_t (2, F::makeInterval (0., 1.))),
+     std::runtime_error);
+  BOOST_CHECK_THROW
+    (solver.updateConstraintBounds
+     (1, solver_t::intervals_t (1, F::makeInterval (0., 1.))),
+     std::runtime_error);
+  BOOST_CHECK_THROW
+    (solver.updateConstraintBounds
+     (0, solver_t::intervals_t (2, F::makeInterval (0., 1.))),
+     std::runtime_error);
+  BOOST_CHECK_THROW (solver.updateProblemParameters (x0),
+                     std::runtime_error);
+  BOOST_CHECK_THROW (solver.setProblemParametersBuffer
+                     (boost::shared_ptr<solver_t::vector_t> ()),
+                     std::runtime_error);
+  BOOST_CHECK_EQUAL (solver.pendingUpdates (), 0u);
+}
+
 BOOST_AUTO_TEST_SUITE_END ()
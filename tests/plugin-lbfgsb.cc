@@ -0,0 +1,163 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "shared-tests/fixture.hh"
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/function/constant.hh>
+
+using namespace roboptim;
+
+typedef Solver<EigenMatrixDense> solver_t;
+
+// Rosenbrock function.
+struct Rosenbrock : public DifferentiableFunction
+{
+  Rosenbrock () : DifferentiableFunction (2, 1, "Rosenbrock")
+  {}
+
+  void impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = 100. * (x[1] - x[0] * x[0]) * (x[1] - x[0] * x[0])
+      + (1. - x[0]) * (1. - x[0]);
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+                      size_type) const
+  {
+    grad[0] = -400. * x[0] * (x[1] - x[0] * x[0]) - 2. * (1. - x[0]);
+    grad[1] = 200. * (x[1] - x[0] * x[0]);
+  }
+};
+
+// (x - 2)^2 + (y - 1)^2 + (x - y)^2
+struct Quadratic : public DifferentiableFunction
+{
+  Quadratic () : DifferentiableFunction (2, 1, "quadratic")
+  {}
+
+  void impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = (x[0] - 2.) * (x[0] - 2.) + (x[1] - 1.) * (x[1] - 1.)
+      + (x[0] - x[1]) * (x[0] - x[1]);
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+                      size_type) const
+  {
+    grad[0] = 2. * (x[0] - 2.) + 2. * (x[0] - x[1]);
+    grad[1] = 2. * (x[1] - 1.) - 2. * (x[0] - x[1]);
+  }
+};
+
+struct StopAfter
+{
+  explicit StopAfter (int iterations)
+    : iterations_ (iterations)
+  {}
+
+  void operator() (const solver_t::problem_t&, solver_t::solverState_t& state)
+  {
+    if (state.getParameter<int> ("lbfgsb.iteration") >= iterations_)
+      state.requestStop ();
+  }
+
+  int iterations_;
+};
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (plugin_lbfgsb)
+{
+  // Unconstrained problem.
+  solver_t::problem_t rosenbrock (boost::make_shared<Rosenbrock> ());
+  Function::vector_t x0 (2);
+  x0 << -1.2, 1.;
+  rosenbrock.setStartingPoint (x0);
+
+  SolverFactory<solver_t> factory ("lbfgsb", rosenbrock);
+  solver_t& solver = factory ();
+  solver.parameters ()["lbfgsb.pgtol"].value = 1e-8;
+  std::cout << solver << std::endl;
+
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  const Result& res = solver.getMinimum<Result> ();
+  std::cout << res << std::endl;
+  BOOST_CHECK (res.warnings.empty ());
+  BOOST_CHECK_CLOSE (res.x[0], 1., 1e-3);
+  BOOST_CHECK_CLOSE (res.x[1], 1., 1e-3);
+  BOOST_CHECK_SMALL (res.value[0], 1e-10);
+
+  // Active bounds: x <= 1, y >= 1.5.
+  solver_t::problem_t quadratic (boost::make_shared<Quadratic> ());
+  quadratic.setArgumentBounds (0, Function::makeUpperInterval (1.));
+  quadratic.setArgumentBounds (1, Function::makeLowerInterval (1.5));
+
+  SolverFactory<solver_t> quadraticFactory ("lbfgsb", quadratic);
+  solver_t& quadraticSolver = quadraticFactory ();
+  BOOST_REQUIRE_EQUAL (quadraticSolver.minimumType (),
+                       GenericSolver::SOLVER_VALUE);
+  const Result& bounded = quadraticSolver.getMinimum<Result> ();
+  BOOST_CHECK_CLOSE (bounded.x[0], 1., 1e-6);
+  BOOST_CHECK_CLOSE (bounded.x[1], 1.5, 1e-6);
+  BOOST_REQUIRE_EQUAL (bounded.lambda.size (), 2);
+  BOOST_CHECK_CLOSE (bounded.lambda[0], -3., 1e-4);
+  BOOST_CHECK_CLOSE (bounded.lambda[1], 2., 1e-4);
+
+  // Only the upper bound on x is active.
+  quadraticSolver.updateArgumentBounds
+    (solver_t::intervals_t (2, Function::makeUpperInterval (1.)));
+  quadraticSolver.resolve ();
+  BOOST_REQUIRE_EQUAL (quadraticSolver.minimumType (),
+                       GenericSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (quadraticSolver.getMinimum<Result> ().x[0], 1., 1e-6);
+  BOOST_CHECK_CLOSE (quadraticSolver.getMinimum<Result> ().x[1], 1., 1e-4);
+
+  // Cooperative interruption.
+  solver.reset ();
+  solver.setIterationCallback (StopAfter (3));
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  BOOST_REQUIRE_EQUAL (solver.getMinimum<Result> ().warnings.size (), 1);
+  std::cout << solver.getMinimum<Result> ().warnings[0] << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE (plugin_lbfgsb_errors)
+{
+  Function::vector_t v (1);
+  v[0] = 1.;
+  boost::shared_ptr<ConstantFunction> f =
+    boost::make_shared<ConstantFunction> (2, v);
+
+  // General constraints are not supported.
+  solver_t::problem_t constrained (boost::make_shared<Rosenbrock> ());
+  constrained.addConstraint (f, Function::makeInterval (0., 2.));
+  SolverFactory<solver_t> constrainedFactory ("lbfgsb", constrained);
+  BOOST_CHECK_EQUAL (constrainedFactory ().minimumType (),
+                     GenericSolver::SOLVER_ERROR);
+
+  // Inconsistent bounds.
+  solver_t::problem_t inconsistent (boost::make_shared<Rosenbrock> ());
+  inconsistent.setArgumentBounds (0, std::make_pair (1., 0.));
+  SolverFactory<solver_t> inconsistentFactory ("lbfgsb", inconsistent);
+  BOOST_CHECK_EQUAL (inconsistentFactory ().minimumType (),
+                     GenericSolver::SOLVER_ERROR);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,193 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "shared-tests/fixture.hh"
+
+#include <cmath>
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/sum-of-c1-squares.hh>
+
+using namespace roboptim;
+
+typedef boost::mpl::list< ::roboptim::EigenMatrixDense,
+			  ::roboptim::EigenMatrixSparse> functionTypes_t;
+
+template <typename T>
+struct Plugin;
+
+template <>
+struct Plugin<EigenMatrixDense>
+{
+  static const char* name ()
+  {
+    return "levenberg-marquardt";
+  }
+};
+
+template <>
+struct Plugin<EigenMatrixSparse>
+{
+  static const char* name ()
+  {
+    return "levenberg-marquardt-sparse";
+  }
+};
+
+// Residuals of the extended Rosenbrock function:
+// r_{2i} = 10 (x_{2i+1} - x_{2i}^2), r_{2i+1} = 1 - x_{2i}
+template <typename T>
+struct Rosenbrock : public GenericDifferentiableFunction<T>
+{
+  ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+  (GenericDifferentiableFunction<T>);
+
+  explicit Rosenbrock (size_type n)
+    : GenericDifferentiableFunction<T> (n, n, "Rosenbrock residuals")
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    for (size_type i = 0; i < this->inputSize (); i += 2)
+      {
+        res[i] = 10. * (x[i + 1] - x[i] * x[i]);
+        res[i + 1] = 1. - x[i];
+      }
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+                      size_type i) const
+  {
+    size_type j = i - i % 2;
+    if (i % 2 == 0)
+      {
+        grad.coeffRef (j) = -20. * x[j];
+        grad.coeffRef (j + 1) = 10.;
+      }
+    else
+      grad.coeffRef (j) = -1.;
+  }
+};
+
+// Residuals of an exponential fit: r_i = a exp (b t_i) - y_i
+struct ExponentialFit : public DifferentiableFunction
+{
+  ExponentialFit (const vector_t& t, const vector_t& y)
+    : DifferentiableFunction (2, t.size (), "exponential fit"),
+      t_ (t),
+      y_ (y)
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    for (size_type i = 0; i < outputSize (); ++i)
+      res[i] = x[0] * std::exp (x[1] * t_[i]) - y_[i];
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+                      size_type i) const
+  {
+    grad[0] = std::exp (x[1] * t_[i]);
+    grad[1] = x[0] * t_[i] * std::exp (x[1] * t_[i]);
+  }
+
+  vector_t t_;
+  vector_t y_;
+};
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (plugin_levenberg_marquardt, T,
+                               functionTypes_t)
+{
+  typedef Solver<T> solver_t;
+  typedef typename solver_t::problem_t problem_t;
+  typedef GenericSumOfC1Squares<T> sumOfSquares_t;
+  typedef typename problem_t::function_t function_t;
+  typedef typename function_t::vector_t vector_t;
+
+  const typename function_t::size_type n = 10;
+  boost::shared_ptr<sumOfSquares_t> cost =
+    boost::make_shared<sumOfSquares_t>
+    (boost::make_shared<Rosenbrock<T> > (n), "Rosenbrock");
+
+  problem_t pb (cost);
+  vector_t x0 (n);
+  for (typename function_t::size_type i = 0; i < n; ++i)
+    x0[i] = i % 2 ? 1. : -1.2;
+  pb.setStartingPoint (x0);
+
+  SolverFactory<solver_t> factory (Plugin<T>::name (), pb);
+  solver_t& solver = factory ();
+  std::cout << solver << std::endl;
+
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  const Result& res = solver.template getMinimum<Result> ();
+  std::cout << res << std::endl;
+  BOOST_CHECK (res.warnings.empty ());
+  BOOST_CHECK (allclose (res.x, vector_t::Ones (n), 1e-6));
+  BOOST_CHECK_SMALL (res.value[0], 1e-12);
+
+  // Bounds: x_0 <= 0.5.
+  pb.setArgumentBounds (0, function_t::makeUpperInterval (.5));
+  SolverFactory<solver_t> boundedFactory (Plugin<T>::name (), pb);
+  solver_t& bounded = boundedFactory ();
+  BOOST_REQUIRE_EQUAL (bounded.minimumType (), GenericSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (bounded.template getMinimum<Result> ().x[0], .5, 1e-6);
+  BOOST_CHECK_CLOSE (bounded.template getMinimum<Result> ().x[1], .25, 1e-6);
+  BOOST_CHECK_CLOSE (bounded.template getMinimum<Result> ().value[0], .25,
+                     1e-6);
+
+  // The cost function has to be a sum of squares.
+  problem_t generic (boost::make_shared<Rosenbrock<T> > (n));
+  SolverFactory<solver_t> genericFactory (Plugin<T>::name (), generic);
+  BOOST_CHECK_EQUAL (genericFactory ().minimumType (),
+                     GenericSolver::SOLVER_ERROR);
+}
+
+BOOST_AUTO_TEST_CASE (plugin_levenberg_marquardt_fit)
+{
+  typedef Solver<EigenMatrixDense> solver_t;
+
+  // Noiseless data: y = 2 exp (-t / 2).
+  const Function::size_type m = 20;
+  Function::vector_t t (m);
+  Function::vector_t y (m);
+  for (Function::size_type i = 0; i < m; ++i)
+    {
+      t[i] = .25 * static_cast<Function::value_type> (i);
+      y[i] = 2. * std::exp (-.5 * t[i]);
+    }
+
+  solver_t::problem_t pb
+    (boost::make_shared<SumOfC1Squares>
+     (boost::make_shared<ExponentialFit> (t, y), "exponential fit"));
+  Function::vector_t x0 (2);
+  x0 << 1., 0.;
+  pb.setStartingPoint (x0);
+
+  SolverFactory<solver_t> factory ("levenberg-marquardt", pb);
+  solver_t& solver = factory ();
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (solver.getMinimum<Result> ().x[0], 2., 1e-6);
+  BOOST_CHECK_CLOSE (solver.getMinimum<Result> ().x[1], -.5, 1e-6);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
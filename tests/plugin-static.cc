@@ -0,0 +1,76 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "shared-tests/fixture.hh"
+
+#include <iostream>
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/plugin-registry.hh>
+#include <roboptim/core/function/constant.hh>
+
+// The dummy plug-ins are linked statically in this test.
+ROBOPTIM_IMPORT_STATIC_PLUGIN (dummy)
+ROBOPTIM_IMPORT_STATIC_PLUGIN (dummy_td)
+
+using namespace roboptim;
+
+typedef Solver<EigenMatrixDense> solver_t;
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (plugin_static)
+{
+  PluginRegistry& registry = PluginRegistry::instance ();
+
+  // Static plug-ins are registered before main.
+  BOOST_CHECK (registry.isLoaded ("dummy"));
+  BOOST_CHECK (registry.isStatic ("dummy"));
+  BOOST_CHECK (registry.isStatic ("dummy-td"));
+  BOOST_CHECK (!registry.isStatic ("dummy-laststate"));
+
+  Function::vector_t v (1);
+  v[0] = 1.;
+  solver_t::problem_t pb
+    (boost::make_shared<GenericConstantFunction<EigenMatrixDense> > (4, v));
+
+  {
+    SolverFactory<solver_t> factory ("dummy", pb);
+    solver_t& solver = factory ();
+    BOOST_CHECK_EQUAL (solver.pluginName (), "dummy");
+
+    solver.solve ();
+    BOOST_CHECK_EQUAL (solver.minimum ().which (),
+                       solver_t::SOLVER_ERROR);
+    std::cout << solver << std::endl;
+  }
+
+  {
+    SolverFactory<solver_t> factory ("dummy-td", pb);
+    BOOST_CHECK_EQUAL (factory ().pluginName (), "dummy-td");
+  }
+
+  // Static plug-ins are never unloaded.
+  registry.unloadUnused ();
+  BOOST_CHECK (registry.isStatic ("dummy"));
+  BOOST_CHECK (registry.isStatic ("dummy-td"));
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
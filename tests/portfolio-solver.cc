@@ -0,0 +1,171 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "shared-tests/fixture.hh"
+
+#include "gradient-descent-solver.hh"
+
+#include <boost/atomic.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/portfolio-solver.hh>
+
+using namespace roboptim;
+
+typedef PortfolioSolver<EigenMatrixDense> solver_t;
+
+// f(x) = (x - 1)^2
+struct F : public DifferentiableFunction
+{
+  F () : DifferentiableFunction (1, 1, "(x - 1)^2")
+  {}
+
+  void impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = (x[0] - 1.) * (x[0] - 1.);
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+                      size_type) const
+  {
+    grad[0] = 2. * (x[0] - 1.);
+  }
+};
+
+bool converged (const Result& res)
+{
+  return res.value[0] < 1e-6;
+}
+
+// Whether the blocking solvers can return.
+boost::atomic<bool> released (false);
+
+// Solver that supports neither the iteration callback nor cooperative
+// interruption, and only returns the solution once released.
+class BlockingSolver : public Solver<EigenMatrixDense>
+{
+public:
+  typedef Solver<EigenMatrixDense> parent_t;
+
+  explicit BlockingSolver (const problem_t& pb)
+    : parent_t (pb)
+  {}
+
+  virtual void solve ()
+  {
+    while (!released)
+      boost::this_thread::yield ();
+
+    Result res (1, 1);
+    res.x[0] = 1.;
+    res.value[0] = 0.;
+    result_ = res;
+  }
+};
+
+void registerBlockingSolver ()
+{
+  detail::PluginEntryPoints<BlockingSolver>::registerStatic ("test-blocking");
+}
+
+namespace
+{
+  detail::StaticPluginRegistration
+  blockingSolverRegistration (&registerBlockingSolver);
+} // end of anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (portfolio_solver)
+{
+  solver_t::problem_t pb (boost::make_shared<F> ());
+  pb.setStartingPoint (Function::vector_t::Zero (1));
+
+  solver_t::plugins_t plugins;
+  plugins.push_back ("dummy");
+  plugins.push_back ("test-gd-slow");
+  plugins.push_back ("test-gd");
+
+  solver_t solver (pb, plugins);
+  solver.setConvergenceCriterion (&converged);
+
+  // Forwarded to the plug-in solvers, except the portfolio parameters.
+  solver.parameters ()["gd.tolerance"].value = 1e-4;
+  solver.parameters ()["portfolio.unknown"].value = 1;
+
+  BOOST_REQUIRE_EQUAL (solver.minimumType (), GenericSolver::SOLVER_VALUE);
+  std::cout << solver << std::endl;
+
+  BOOST_REQUIRE (solver.winner ());
+  BOOST_CHECK_EQUAL (solver.plugins ()[*solver.winner ()], "test-gd");
+  BOOST_CHECK_CLOSE (solver.getMinimum<Result> ().x[0], 1., 1e-1);
+
+  // The slow solver may still be running.
+  solver.join ();
+  const solver_t::statistics_t& stats = solver.statistics ();
+  BOOST_REQUIRE_EQUAL (stats.size (), 3);
+
+  BOOST_CHECK_EQUAL (stats[0].plugin, "dummy");
+  BOOST_CHECK_EQUAL (stats[0].status, GenericSolver::SOLVER_ERROR);
+  BOOST_CHECK (!stats[0].converged);
+
+  // The slow solver is cancelled once the race is won.
+  BOOST_CHECK (stats[1].cancelled);
+  BOOST_CHECK (!stats[1].converged);
+  BOOST_CHECK (stats[1].iterations < 100000000);
+
+  BOOST_CHECK (stats[2].converged);
+  BOOST_CHECK (!stats[2].cancelled);
+  BOOST_CHECK (stats[2].iterations > 0);
+
+  // A plug-in that can not be cancelled does not delay the winner: it is
+  // joined afterwards.
+  plugins.push_back ("test-blocking");
+  {
+    solver_t blocked (pb, plugins);
+    blocked.setConvergenceCriterion (&converged);
+    BOOST_REQUIRE_EQUAL (blocked.minimumType (), GenericSolver::SOLVER_VALUE);
+    BOOST_CHECK_EQUAL (blocked.plugins ()[*blocked.winner ()], "test-gd");
+
+    released = true;
+    blocked.join ();
+    const solver_t::statistics_t& blockedStats = blocked.statistics ();
+    BOOST_CHECK_EQUAL (blockedStats[3].status, GenericSolver::SOLVER_VALUE);
+    BOOST_CHECK (blockedStats[3].converged);
+    BOOST_CHECK (!blockedStats[3].cancelled);
+    BOOST_CHECK_EQUAL (blocked.plugins ()[*blocked.winner ()], "test-gd");
+  }
+  plugins.pop_back ();
+
+  // No plug-in converges.
+  plugins.pop_back ();
+  plugins.pop_back ();
+  solver_t failing (pb, plugins);
+  BOOST_CHECK_EQUAL (failing.minimumType (), GenericSolver::SOLVER_ERROR);
+  BOOST_CHECK (!failing.winner ());
+
+  // Invalid portfolios.
+  BOOST_CHECK_THROW (solver_t (pb, solver_t::plugins_t ()),
+                     std::runtime_error);
+  plugins.push_back ("invalid-plugin");
+  solver_t invalid (pb, plugins);
+  BOOST_CHECK_THROW (invalid.solve (), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -25,6 +25,7 @@
 #include <roboptim/core/problem.hh>
 #include <roboptim/core/function/constant.hh>
 #include <roboptim/core/numeric-linear-function.hh>
+#include <roboptim/core/numeric-quadratic-function.hh>
 
 using namespace roboptim;
 
@@ -96,9 +97,9 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (problem, T, functionTypes_t)
   problem_t pb (f);
   argument_t x (2);
   x.setZero ();
-  pb.startingPoint () = x;
-  pb.argumentBounds ()[0] = function_t::makeInterval (-5., 5.);
-  pb.argumentBounds ()[1] = function_t::makeLowerInterval (-10.);
+  pb.setStartingPoint (x);
+  pb.setArgumentBounds (0, function_t::makeInterval (-5., 5.));
+  pb.setArgumentBounds (1, function_t::makeLowerInterval (-10.));
 
   typename constantFunction_t::names_t names (2);
   names[0] = "x₀";
@@ -142,6 +143,75 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (problem, T, functionTypes_t)
   x << 1., 2.;
   (*output) << toDense (pb.jacobian (x)) << std::endl;
 
+  // Check in-place Jacobian evaluation against the Jacobians of the
+  // differentiable constraints, stacked by hand. Later calls reuse the
+  // cached sparsity pattern and only update the values, so the quadratic
+  // constraint (whose Jacobian depends on x) is evaluated at several
+  // points.
+  {
+    typedef GenericNumericQuadraticFunction<T> numericQuadraticFunction_t;
+    typedef typename GenericFunctionTraits<EigenMatrixDense>::matrix_t
+      denseMatrix_t;
+
+    typename numericQuadraticFunction_t::matrix_t qa (2, 2);
+    qa.setZero ();
+    qa.coeffRef (0, 0) = 1.;
+    qa.coeffRef (0, 1) = 2.;
+    qa.coeffRef (1, 0) = 2.;
+    typename numericQuadraticFunction_t::vector_t qb (2);
+    qb << 1., -1.;
+    typename numericQuadraticFunction_t::vector_t qc (1);
+    qc << 0.;
+    boost::shared_ptr<numericQuadraticFunction_t>
+      q = boost::make_shared<numericQuadraticFunction_t> (qa, qb, qc);
+
+    problem_t pbq (f);
+    pbq.addConstraint (g0, intervals, scaling);
+    pbq.addConstraint (g2, intervals, scaling);
+    pbq.addConstraint (q, function_t::makeInterval (-1., 1.), 1.);
+    pbq.addConstraint (g1, intervals, scaling);
+    BOOST_REQUIRE_EQUAL (pbq.differentiableConstraintsOutputSize (), 5);
+
+    typename problem_t::jacobian_t
+      jac (pbq.differentiableConstraintsOutputSize (), 2);
+    argument_t y (2);
+    for (int i = 0; i < 3; ++i)
+      {
+        y << 1. + i, 2. - 3. * i;
+
+        denseMatrix_t expected (5, 2);
+        expected.topRows (2) = toDense (g0->jacobian (y));
+        expected.row (2) = toDense (q->jacobian (y));
+        expected.bottomRows (2) = toDense (g1->jacobian (y));
+
+        pbq.jacobian (jac, y);
+        BOOST_CHECK (allclose (toDense (jac), expected));
+        BOOST_CHECK (allclose (toDense (pbq.jacobian (y)), expected));
+      }
+
+    // Hand-written values at the last point: 2 qa y + qb.
+    BOOST_CHECK_CLOSE (toDense (jac) (2, 0), 2. * (3. - 8.) + 1., 1e-8);
+    BOOST_CHECK_CLOSE (toDense (jac) (2, 1), 2. * 6. - 1., 1e-8);
+  }
+
+  // Check stacked constraints and bounds
+  {
+    typename problem_t::result_t g (pb.constraintsOutputSize ());
+    pb.constraints (g, x);
+    BOOST_CHECK (allclose (g.segment (0, 2), (*g0) (x)));
+    BOOST_CHECK (allclose (g.segment (2, 2), (*g1) (x)));
+    BOOST_CHECK (allclose (g.segment (4, 2), (*g2) (x)));
+
+    BOOST_CHECK_EQUAL (pb.constraintsLowerBounds ().size (), 6);
+    BOOST_CHECK_EQUAL (pb.constraintsLowerBounds ()[2], 0.);
+    BOOST_CHECK_EQUAL (pb.constraintsUpperBounds ()[4], 42.);
+    BOOST_CHECK_EQUAL (pb.argumentLowerBounds ()[0], -5.);
+    BOOST_CHECK_EQUAL (pb.argumentUpperBounds ()[1], Function::infinity ());
+
+    BOOST_CHECK_EQUAL (pb.template constraintsViolation<1> (x, g),
+                       pb.template constraintsViolation<1> (x));
+  }
+
   // Check constraints output size
   BOOST_CHECK_EQUAL (pb.constraintsOutputSize (),
                      g0->outputSize () + g1->outputSize () + g2->outputSize ());
@@ -198,12 +268,12 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (problem, T, functionTypes_t)
   BOOST_CHECK (pb.scalingVector ().empty ());
   BOOST_CHECK_EQUAL (pb.constraintsOutputSize (), 0);
   x << 0., 0.;
-  pb.startingPoint () = x;
+  pb.setStartingPoint (x);
   (*output) << pb << std::endl;
   BOOST_CHECK_EQUAL (pb.template constraintsViolation<1> (x), 0.);
   BOOST_CHECK_EQUAL (pb.template constraintsViolation<Eigen::Infinity> (x), 0.);
   x << 200., 30.;
-  pb.startingPoint () = x;
+  pb.setStartingPoint (x);
   (*output) << pb << std::endl;
   BOOST_CHECK_EQUAL (pb.template constraintsViolation<1> (x), 195.);
   BOOST_CHECK_EQUAL (pb.template constraintsViolation<Eigen::Infinity> (x), 195.);
@@ -212,9 +282,9 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (problem, T, functionTypes_t)
   typedef Problem<T> mixedProblem_t;
   mixedProblem_t mixedPb (f);
   x << 1., 2.;
-  mixedPb.startingPoint () = x;
+  mixedPb.setStartingPoint (x);
   mixedPb.argumentNames () = names;
-  mixedPb.argumentBounds ()[0] = function_t::makeUpperInterval (5.);
+  mixedPb.setArgumentBounds (0, function_t::makeUpperInterval (5.));
 
   // First constraint: ConstantFunction automatically converted to LinearFunction
   mixedPb.addConstraint (g0, intervals, scaling);
@@ -228,12 +298,12 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (problem, T, functionTypes_t)
   BOOST_CHECK (mixedPb.constraints()[1]->template asType<GenericDifferentiableFunction<T> >());
   BOOST_CHECK_EQUAL (mixedPb.constraintsOutputSize (), 2 * g0->outputSize ());
   x << 0., 0.;
-  mixedPb.startingPoint () = x;
+  mixedPb.setStartingPoint (x);
   (*output) << mixedPb << std::endl;
   BOOST_CHECK_EQUAL (mixedPb.template constraintsViolation<1> (x), 0.);
   BOOST_CHECK_EQUAL (mixedPb.template constraintsViolation<Eigen::Infinity> (x), 0.);
   x << 200., 50.;
-  mixedPb.startingPoint () = x;
+  mixedPb.setStartingPoint (x);
   (*output) << mixedPb << std::endl;
   BOOST_CHECK_EQUAL (mixedPb.template constraintsViolation<1> (x), 366.);
   BOOST_CHECK_EQUAL (mixedPb.template constraintsViolation<Eigen::Infinity> (x), 195.);
@@ -242,4 +312,90 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (problem, T, functionTypes_t)
   BOOST_CHECK (output->match_pattern ());
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE (problem_copy, T, functionTypes_t)
+{
+  typedef Problem<T> problem_t;
+  typedef GenericConstantFunction<T> constantFunction_t;
+  typedef typename problem_t::function_t function_t;
+  typedef typename problem_t::intervals_t intervals_t;
+  typedef typename problem_t::scaling_t scaling_t;
+
+  typename constantFunction_t::vector_t v (2);
+  v << 1., 2.;
+  boost::shared_ptr<constantFunction_t>
+    f = boost::make_shared<constantFunction_t> (v);
+
+  problem_t pb (f);
+  const problem_t& cpb = pb;
+  intervals_t bounds = cpb.argumentBounds ();
+  bounds[0] = function_t::makeInterval (-1., 1.);
+  pb.setArgumentBounds (bounds);
+  pb.addConstraint (f, intervals_t (2, function_t::makeInterval (0., 3.)),
+                    scaling_t (2, 1.));
+
+  // Copies share the data of the problem.
+  const problem_t copy (pb);
+  BOOST_CHECK (&copy.argumentBounds () == &cpb.argumentBounds ());
+  BOOST_CHECK (&copy.boundsVector () == &cpb.boundsVector ());
+  BOOST_CHECK_EQUAL (copy.argumentLowerBounds ()[0], -1.);
+
+  // Modifying a problem does not modify its copies.
+  pb.setArgumentBounds (0, function_t::makeInterval (-2., 2.));
+  pb.argumentScaling ()[1] = 3.;
+  pb.addConstraint (f, intervals_t (2, function_t::makeInterval (0., 3.)),
+                    scaling_t (2, 1.));
+  BOOST_CHECK (&copy.argumentBounds () != &cpb.argumentBounds ());
+  BOOST_CHECK_EQUAL (pb.argumentLowerBounds ()[0], -2.);
+  BOOST_CHECK_EQUAL (copy.argumentLowerBounds ()[0], -1.);
+  BOOST_CHECK_EQUAL (copy.argumentScaling ()[1], 1.);
+  BOOST_CHECK_EQUAL (pb.constraints ().size (), 2);
+  BOOST_CHECK_EQUAL (copy.constraints ().size (), 1);
+  BOOST_CHECK_EQUAL (copy.constraintsOutputSize (), 2);
+  BOOST_CHECK_EQUAL (copy.constraintsLowerBounds ().size (), 2);
+
+  // Modifying a copy does not modify the original problem.
+  problem_t copy2 (copy);
+  copy2.clearConstraints ();
+  copy2.setStartingPoint (v);
+  BOOST_CHECK_EQUAL (copy.constraints ().size (), 1);
+  BOOST_CHECK (!copy.startingPoint ());
+
+  // References taken before a copy do not modify the copy.
+  problem_t pb2 (f);
+  intervals_t& bounds2 = pb2.argumentBounds ();
+  typename problem_t::startingPoint_t& x0 = pb2.startingPoint ();
+  const problem_t copy3 (pb2);
+  bounds2[1] = function_t::makeInterval (-5., 5.);
+  x0 = v;
+  BOOST_CHECK (&copy3.argumentBounds () != &bounds2);
+  BOOST_CHECK_EQUAL (copy3.argumentLowerBounds ()[1],
+                     -function_t::infinity ());
+  BOOST_CHECK (!copy3.startingPoint ());
+
+  // The arguments bounds of the original problem are updated once the
+  // mutable reference is retrieved again.
+  BOOST_CHECK_EQUAL (pb2.argumentLowerBounds ()[1], -5.);
+  bounds2[1] = function_t::makeInterval (-6., 6.);
+  pb2.argumentBounds ();
+  BOOST_CHECK_EQUAL (pb2.argumentLowerBounds ()[1], -6.);
+  const problem_t copy4 (pb2);
+  BOOST_CHECK_EQUAL (copy4.argumentUpperBounds ()[1], 6.);
+
+  // Setters do not prevent the copies from sharing the data.
+  problem_t pb3 (f);
+  pb3.setArgumentBounds (1, function_t::makeInterval (-3., 3.));
+  pb3.setStartingPoint (v);
+  const problem_t copy6 (pb3);
+  const problem_t& cpb3 = pb3;
+  BOOST_CHECK (&copy6.argumentBounds () == &cpb3.argumentBounds ());
+  BOOST_CHECK_EQUAL (copy6.argumentUpperBounds ()[1], 3.);
+  BOOST_CHECK_THROW (pb3.setArgumentBounds (2, function_t::makeInterval
+                                            (0., 1.)),
+                     std::runtime_error);
+
+  // Copies of the copy share its data.
+  const problem_t copy5 (copy3);
+  BOOST_CHECK (&copy5.argumentBounds () == &copy3.argumentBounds ());
+}
+
 BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,156 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "shared-tests/fixture.hh"
+
+#include "gradient-descent-solver.hh"
+
+#include <boost/make_shared.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/solver-factory.hh>
+#include <roboptim/core/solve-async.hh>
+
+using namespace roboptim;
+
+typedef Solver<EigenMatrixDense> solver_t;
+typedef AsyncSolveOptions<EigenMatrixDense> options_t;
+
+// f(x) = (x - 1)^2
+struct F : public DifferentiableFunction
+{
+  F () : DifferentiableFunction (1, 1, "(x - 1)^2")
+  {}
+
+  void impl_compute (result_ref result, const_argument_ref x) const
+  {
+    result[0] = (x[0] - 1.) * (x[0] - 1.);
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+                      size_type) const
+  {
+    grad[0] = 2. * (x[0] - 1.);
+  }
+};
+
+struct CountIterations
+{
+  explicit CountIterations (int& count)
+    : count_ (count)
+  {}
+
+  void operator() (const solver_t::problem_t&, solver_t::solverState_t&)
+  {
+    ++count_;
+  }
+
+  int& count_;
+};
+
+// Callback throwing an exception not derived from std::exception.
+struct ThrowNonStandard
+{
+  void operator() (const solver_t::problem_t&, solver_t::solverState_t&)
+  {
+    throw 42;
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (solve_async)
+{
+  solver_t::problem_t pb (boost::make_shared<F> ());
+  pb.setStartingPoint (Function::vector_t::Zero (1));
+
+  // Normal completion.
+  SolverFactory<solver_t> factory ("test-gd", pb);
+  solver_t& solver = factory ();
+
+  int iterations = 0;
+  options_t options;
+  options.callback = CountIterations (iterations);
+
+  futureResult_t future = solveAsync (solver, options);
+  GenericSolver::result_t result = future.get ();
+  BOOST_REQUIRE_EQUAL (result.which (), GenericSolver::SOLVER_VALUE);
+  BOOST_CHECK_CLOSE (boost::get<Result> (result).x[0], 1., 1e-1);
+  BOOST_CHECK (boost::get<Result> (result).warnings.empty ());
+  BOOST_CHECK (iterations > 0);
+
+  // Cancellation.
+  SolverFactory<solver_t> slowFactory ("test-gd-slow", pb);
+  solver_t& slowSolver = slowFactory ();
+
+  options_t cancelOptions;
+  futureResult_t cancelled = solveAsync (slowSolver, cancelOptions);
+  BOOST_CHECK (!cancelled.timed_wait (boost::posix_time::milliseconds (10)));
+  cancelOptions.token.cancel ();
+  result = cancelled.get ();
+  BOOST_REQUIRE_EQUAL (result.which (), GenericSolver::SOLVER_VALUE);
+  BOOST_REQUIRE_EQUAL (boost::get<Result> (result).warnings.size (), 1);
+  BOOST_CHECK_EQUAL (boost::get<Result> (result).warnings[0].what (),
+                     std::string ("solve cancelled"));
+
+  // Deadline: the best iterate is returned.
+  options_t deadlineOptions;
+  deadlineOptions.deadline =
+    boost::posix_time::microsec_clock::universal_time ()
+    + boost::posix_time::milliseconds (20);
+  result = solveAsync (slowSolver, deadlineOptions).get ();
+  BOOST_REQUIRE_EQUAL (result.which (), GenericSolver::SOLVER_VALUE);
+  const Result& res = boost::get<Result> (result);
+  std::cout << res << std::endl;
+  BOOST_REQUIRE_EQUAL (res.warnings.size (), 1);
+  BOOST_CHECK_EQUAL (res.warnings[0].what (), std::string ("deadline reached"));
+  BOOST_CHECK (res.x[0] > 0. && res.x[0] < 1.);
+  BOOST_CHECK_CLOSE (res.value[0], (res.x[0] - 1.) * (res.x[0] - 1.), 1e-6);
+
+  // The solver can be used again once the future is ready.
+  BOOST_CHECK_EQUAL (slowSolver.minimumType (), GenericSolver::SOLVER_VALUE);
+
+  // Solvers without iteration callback can not be interrupted.
+  SolverFactory<solver_t> dummyFactory ("dummy", pb);
+  options_t pastDeadline;
+  pastDeadline.deadline = boost::posix_time::microsec_clock::universal_time ();
+  result = solveAsync (dummyFactory (), pastDeadline).get ();
+  BOOST_CHECK_EQUAL (result.which (), GenericSolver::SOLVER_ERROR);
+
+  // Other exceptions are forwarded to the future.
+  options_t throwingOptions;
+  throwingOptions.callback = ThrowNonStandard ();
+  futureResult_t failed = solveAsync (solver, throwingOptions);
+  // Depending on the version of Boost, the exception is rethrown as is,
+  // or as a boost::unknown_exception.
+  bool thrown = false;
+  try
+    {
+      failed.get ();
+    }
+  catch (...)
+    {
+      thrown = true;
+    }
+  BOOST_CHECK (thrown);
+
+  // The solver can be used again.
+  result = solveAsync (solver).get ();
+  BOOST_CHECK_EQUAL (result.which (), GenericSolver::SOLVER_VALUE);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
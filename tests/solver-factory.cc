@@ -18,11 +18,13 @@
 #include "shared-tests/fixture.hh"
 
 #include <iostream>
+#include <typeinfo>
 
 #include <boost/make_shared.hpp>
 
 #include <roboptim/core/io.hh>
 #include <roboptim/core/plugin/dummy.hh>
+#include <roboptim/core/plugin-registry.hh>
 #include <roboptim/core/twice-differentiable-function.hh>
 
 using namespace roboptim;
@@ -71,7 +73,7 @@ BOOST_AUTO_TEST_CASE (solver_factory)
   // Set bounds for all optimization parameters.
   for (std::size_t i = 0;
        static_cast<Function::size_type> (i) < pb.function ().inputSize (); ++i)
-    pb.argumentBounds ()[i] = Function::makeInterval (0., 1.);
+    pb.setArgumentBounds (i, Function::makeInterval (0., 1.));
 
   // Set the starting point.
   Function::vector_t start (pb.function ().inputSize ());
@@ -82,6 +84,26 @@ BOOST_AUTO_TEST_CASE (solver_factory)
   solver_t& solver = factory ();
   (*output) << solver << std::endl;
 
+  // The plug-in is kept in the registry, and validated once.
+  PluginRegistry& registry = PluginRegistry::instance ();
+  BOOST_CHECK (registry.isLoaded ("dummy-td"));
+  BOOST_CHECK (registry.isValidated ("dummy-td", typeid (solver_t).name ()));
+  for (int i = 0; i < 10; ++i)
+    {
+      SolverFactory<solver_t> factory_loop ("dummy-td", pb);
+      BOOST_CHECK_EQUAL (factory_loop ().pluginName (), "dummy-td");
+    }
+  BOOST_CHECK (registry.isLoaded ("dummy-td"));
+
+  // Plug-ins that are still used are not unloaded.
+  {
+    SolverFactory<solver_t> factory_dummy ("dummy", pb);
+  }
+  BOOST_CHECK (registry.isLoaded ("dummy"));
+  BOOST_CHECK_EQUAL (registry.unloadUnused (), 1);
+  BOOST_CHECK (!registry.isLoaded ("dummy"));
+  BOOST_CHECK (registry.isLoaded ("dummy-td"));
+
   BOOST_CHECK_THROW (SolverFactory<solver_t> factory_plugin ("dummy-foo", pb);
                      solver_t& solver_plugin = factory_plugin ();
                      (*output) << solver_plugin << std::endl,
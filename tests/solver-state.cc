@@ -16,6 +16,7 @@
 // along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "shared-tests/fixture.hh"
+#include "allocation.hh"
 
 #include <iostream>
 
@@ -29,6 +30,8 @@
 
 using namespace roboptim;
 
+ROBOPTIM_DEFINE_ALLOCATION_HOOKS
+
 // Specify the solver that will be used.
 typedef Solver<EigenMatrixDense> parent_solver_t;
 
@@ -214,4 +217,100 @@ BOOST_AUTO_TEST_CASE (solver_state)
   BOOST_CHECK (output->match_pattern ());
 }
 
+BOOST_AUTO_TEST_CASE (solver_state_stop)
+{
+  typedef parent_solver_t::solverState_t solverState_t;
+
+  parent_solver_t::problem_t pb (boost::make_shared<F1> ());
+  solverState_t state (pb);
+
+  // No stop parameter: cooperative interruption is not supported.
+  BOOST_CHECK (!state.requestStop ());
+  BOOST_CHECK (!state.stopRequested ());
+
+  state.parameters ()["solver.stop"].value = false;
+  state.parameters ()["solver.nonstop"].value = false;
+  state.parameters ()["other.stop"].value = 42;
+  BOOST_CHECK (!state.stopRequested ());
+
+  BOOST_CHECK (state.requestStop ());
+  BOOST_CHECK (state.stopRequested ());
+  BOOST_CHECK (state.getParameter<bool> ("solver.stop"));
+  BOOST_CHECK (!state.getParameter<bool> ("solver.nonstop"));
+  BOOST_CHECK_EQUAL (state.getParameter<int> ("other.stop"), 42);
+}
+
+BOOST_AUTO_TEST_CASE (solver_state_handles)
+{
+  typedef parent_solver_t::solverState_t solverState_t;
+  typedef Function::value_type value_type;
+  typedef Function::vector_t vector_t;
+
+  parent_solver_t::problem_t pb (boost::make_shared<F1> ());
+  solverState_t state (pb);
+
+  state.parameters ()["data.existing"].value = 1;
+
+  StateParameterHandle<bool> stop =
+    state.registerParameter ("solver.stop", "stop", false);
+  StateParameterHandle<int> iteration =
+    state.registerParameter ("solver.iteration", "iteration", 0);
+  StateParameterHandle<value_type> penalty =
+    state.registerParameter ("solver.penalty", "penalty", value_type (1.));
+  StateParameterHandle<vector_t> multipliers =
+    state.registerParameter ("solver.multipliers", "multipliers",
+			     vector_t (vector_t::Zero (3)));
+  StateParameterHandle<std::string> message =
+    state.registerParameter ("solver.message", "message", std::string ("ok"));
+  StateParameterHandle<int> existing =
+    state.registerParameter ("data.existing", "existing", 2);
+  BOOST_CHECK (stop.valid ());
+  BOOST_CHECK (!StateParameterHandle<int> ().valid ());
+
+  // Registering twice returns the same handle, another type fails.
+  BOOST_CHECK_EQUAL (state.registerParameter
+		     ("solver.iteration", "iteration", 3).index,
+		     iteration.index);
+  BOOST_CHECK_EQUAL (state.parameter (iteration), 3);
+  BOOST_CHECK_THROW (state.registerParameter ("solver.iteration", "", 1.),
+		     std::runtime_error);
+  BOOST_CHECK_EQUAL (state.parameterHandle<value_type> ("solver.penalty").index,
+		     penalty.index);
+  BOOST_CHECK_THROW (state.parameterHandle<int> ("solver.penalty"),
+		     std::out_of_range);
+  BOOST_CHECK_THROW (state.parameterHandle<int> ("solver.unknown"),
+		     std::out_of_range);
+
+  // Updates through handles do not allocate memory.
+  ROBOPTIM_CHECK_NO_ALLOCATION
+    (for (int i = 0; i < 10; ++i)
+       {
+	 state.setParameter (iteration, i);
+	 state.setParameter (penalty, 2. * state.parameter (penalty));
+	 state.setParameter (multipliers, vector_t::Constant (3, i));
+       });
+
+  // The string API is a view of the store.
+  BOOST_CHECK_EQUAL (state.getParameter<int> ("solver.iteration"), 9);
+  BOOST_CHECK_EQUAL (state.getParameter<value_type> ("solver.penalty"), 1024.);
+  BOOST_CHECK_EQUAL (state.getParameter<vector_t> ("solver.multipliers")[2],
+		     9.);
+  BOOST_CHECK_EQUAL (state.getParameter<std::string> ("solver.message"), "ok");
+  BOOST_CHECK_EQUAL (state.getParameter<int> ("data.existing"), 2);
+  BOOST_CHECK_EQUAL (state.parameters ().find ("solver.stop")->second.description,
+		     "stop");
+
+  // Changes made through the string API are seen through the handles.
+  state.parameters ()["solver.message"].value = std::string ("changed");
+  state.getParameter<int> ("data.existing") = 4;
+  BOOST_CHECK_EQUAL (state.parameter (message), "changed");
+  BOOST_CHECK_EQUAL (state.parameter (existing), 4);
+
+  BOOST_CHECK (!state.parameter (stop));
+  BOOST_CHECK (state.requestStop ());
+  BOOST_CHECK (state.parameter (stop));
+
+  std::cout << state << std::endl;
+}
+
 BOOST_AUTO_TEST_SUITE_END ()
@@ -88,7 +88,7 @@ BOOST_AUTO_TEST_CASE (solver)
   solver_t::problem_t pb (f);
   solver_t::argument_t x (f->inputSize ());
   x.setZero ();
-  pb.startingPoint () = x;
+  pb.setStartingPoint (x);
 
   solver_t solver (pb);
   (*output) << solver << std::endl << std::endl;
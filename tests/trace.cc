@@ -0,0 +1,346 @@
+// Copyright (C) 2016 by Benjamin Chrétien, CNRS-AIST JRL.
+//
+// This file is part of the roboptim.
+//
+// roboptim is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "shared-tests/fixture.hh"
+
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <roboptim/core/trace.hh>
+#include <roboptim/core/problem.hh>
+#include <roboptim/core/solver.hh>
+#include <roboptim/core/solver-state.hh>
+#include <roboptim/core/twice-differentiable-function.hh>
+#include <roboptim/core/callback/trace.hh>
+
+using namespace roboptim;
+
+// f (x) = x0^2 + x1^2
+struct F : public TwiceDifferentiableFunction
+{
+  explicit F (const std::string& name)
+    : TwiceDifferentiableFunction (2, 1, name)
+  {}
+
+  void impl_compute (result_ref res, const_argument_ref x) const
+  {
+    res[0] = x.squaredNorm ();
+  }
+
+  void impl_gradient (gradient_ref grad, const_argument_ref x,
+		      size_type) const
+  {
+    grad = 2. * x;
+  }
+
+  void impl_hessian (hessian_ref h, const_argument_ref, size_type) const
+  {
+    h.setIdentity ();
+    h *= 2.;
+  }
+};
+
+std::size_t count (const std::vector<TraceEvent>& events,
+		   const std::string& category, const std::string& name)
+{
+  std::size_t n = 0;
+  for (std::size_t i = 0; i < events.size (); ++i)
+    if (category == events[i].category && name == events[i].name)
+      ++n;
+  return n;
+}
+
+void evaluate (const F* f, int n)
+{
+  Tracer::instance ().setThreadName ("worker");
+  F::vector_t x (2);
+  x << 1., 2.;
+  F::result_t res (1);
+  for (int i = 0; i < n; ++i)
+    {
+      TraceScope scope ("test", f->getName ());
+      (*f) (res, x);
+    }
+}
+
+void record (int n)
+{
+  for (int i = 0; i < n; ++i)
+    Tracer::instance ().record ("test", "span", 0, 1, i);
+}
+
+// Record spans whose start, duration and index are all equal to i.
+void recordIndexed (int n, boost::atomic<bool>* done)
+{
+  for (int i = 0; i < n; ++i)
+    {
+      const boost::uint64_t t = static_cast<boost::uint64_t> (i);
+      Tracer::instance ().record ("test", "indexed", t, 2 * t, i);
+    }
+  done->store (true);
+}
+
+BOOST_FIXTURE_TEST_SUITE (core, TestSuiteConfiguration)
+
+BOOST_AUTO_TEST_CASE (trace_scopes)
+{
+  Tracer& tracer = Tracer::instance ();
+  tracer.clear ();
+  tracer.setThreadName ("main");
+
+  const std::string name ("traced \"scope\"");
+
+  // Nothing is recorded while the tracer is disabled.
+  BOOST_CHECK (!tracer.isEnabled ());
+  {
+    TraceScope scope ("test", name);
+  }
+  BOOST_CHECK (tracer.events ().empty ());
+
+  tracer.enable ();
+  {
+    TraceScope outer ("outer", name);
+    TraceScope inner ("inner", "inner", 3);
+  }
+  tracer.disable ();
+
+  std::vector<TraceEvent> events = tracer.events ();
+  BOOST_REQUIRE_EQUAL (events.size (), 2u);
+  BOOST_CHECK_EQUAL (count (events, "outer", name), 1u);
+  BOOST_CHECK_EQUAL (count (events, "inner", "inner"), 1u);
+
+  // Spans are sorted, and the inner span is nested in the outer one.
+  const TraceEvent& outer = events[0];
+  const TraceEvent& inner = events[1];
+  BOOST_CHECK_EQUAL (std::string (outer.category), "outer");
+  BOOST_CHECK_EQUAL (inner.index, 3);
+  BOOST_CHECK (outer.start <= inner.start);
+  BOOST_CHECK (inner.start + inner.duration
+	       <= outer.start + outer.duration);
+
+  // Chrome trace export.
+  std::stringstream ss;
+  ss << tracer;
+  BOOST_CHECK (ss.str ().find ("\"traceEvents\"") != std::string::npos);
+  BOOST_CHECK (ss.str ().find ("\"name\":\"traced \\\"scope\\\"\"")
+	       != std::string::npos);
+  BOOST_CHECK (ss.str ().find ("\"thread_name\"") != std::string::npos);
+  BOOST_CHECK (ss.str ().find ("\"cat\":\"outer\",\"ph\":\"X\"")
+	       != std::string::npos);
+
+  tracer.clear ();
+  BOOST_CHECK (tracer.events ().empty ());
+}
+
+// The evaluation front-ends are only traced if roboptim-core is configured
+// with ROBOPTIM_TRACE_EVALUATION.
+#ifdef ROBOPTIM_TRACE_EVALUATION
+BOOST_AUTO_TEST_CASE (trace_evaluations)
+{
+  Tracer& tracer = Tracer::instance ();
+  tracer.clear ();
+  tracer.setThreadName ("main");
+
+  F f ("traced \"f\"");
+  F::vector_t x (2);
+  x << 1., 2.;
+  F::result_t res (1);
+  F::gradient_t grad (2);
+  F::jacobian_t jac (1, 2);
+
+  // Nothing is recorded while the tracer is disabled.
+  BOOST_CHECK (!tracer.isEnabled ());
+  f (res, x);
+  BOOST_CHECK (tracer.events ().empty ());
+
+  tracer.enable ();
+  for (int i = 0; i < 3; ++i)
+    f (res, x);
+  f.gradient (grad, x, 0);
+  f.jacobian (jac, x);
+  tracer.disable ();
+  f (res, x);
+
+  std::vector<TraceEvent> events = tracer.events ();
+  BOOST_CHECK_EQUAL (events.size (), 6u);
+  BOOST_CHECK_EQUAL (count (events, "compute", f.getName ()), 3u);
+  // The default Jacobian is computed from the gradients.
+  BOOST_CHECK_EQUAL (count (events, "gradient", f.getName ()), 2u);
+  BOOST_CHECK_EQUAL (count (events, "jacobian", f.getName ()), 1u);
+  BOOST_CHECK_EQUAL (tracer.dropped (), 0u);
+
+  // Spans are sorted, and the gradient is nested in the Jacobian.
+  for (std::size_t i = 1; i < events.size (); ++i)
+    BOOST_CHECK (events[i - 1].start <= events[i].start);
+  const TraceEvent& jacobian = events[4];
+  const TraceEvent& nested = events[5];
+  BOOST_CHECK_EQUAL (std::string (jacobian.category), "jacobian");
+  BOOST_CHECK_EQUAL (std::string (nested.category), "gradient");
+  BOOST_CHECK (nested.start + nested.duration
+	       <= jacobian.start + jacobian.duration);
+
+  // Chrome trace export.
+  std::stringstream ss;
+  ss << tracer;
+  std::cout << ss.str () << std::endl;
+  BOOST_CHECK (ss.str ().find ("\"traceEvents\"") != std::string::npos);
+  BOOST_CHECK (ss.str ().find ("\"name\":\"traced \\\"f\\\"\"")
+	       != std::string::npos);
+  BOOST_CHECK (ss.str ().find ("\"thread_name\"") != std::string::npos);
+  BOOST_CHECK (ss.str ().find ("\"cat\":\"jacobian\",\"ph\":\"X\"")
+	       != std::string::npos);
+
+  tracer.clear ();
+  BOOST_CHECK (tracer.events ().empty ());
+}
+#endif //! ROBOPTIM_TRACE_EVALUATION
+
+BOOST_AUTO_TEST_CASE (trace_iterations)
+{
+  typedef Solver<EigenMatrixDense> solver_t;
+  typedef solver_t::problem_t problem_t;
+
+  Tracer& tracer = Tracer::instance ();
+  tracer.clear ();
+
+  boost::shared_ptr<F> f = boost::make_shared<F> ("cost");
+  problem_t pb (f);
+  SolverState<problem_t> state (pb);
+
+  callback::Trace<solver_t> trace;
+  tracer.enable ();
+  trace.reset ();
+  for (int i = 0; i < 3; ++i)
+    {
+      {
+	TraceScope scope ("test", f->getName ());
+	(*f) (state.x ());
+      }
+      trace (pb, state);
+    }
+  tracer.disable ();
+  BOOST_CHECK_EQUAL (trace.iterations (), 3);
+
+  std::vector<TraceEvent> events = tracer.events ();
+  BOOST_CHECK_EQUAL (count (events, "iteration", "solver iteration"), 3u);
+  BOOST_CHECK_EQUAL (count (events, "test", "cost"), 3u);
+
+  // Iterations are contiguous, and each one covers an evaluation.
+  std::vector<TraceEvent> iterations;
+  std::vector<TraceEvent> evaluations;
+  for (std::size_t i = 0; i < events.size (); ++i)
+    if (std::string (events[i].category) == "iteration")
+      iterations.push_back (events[i]);
+    else if (std::string (events[i].category) == "test")
+      evaluations.push_back (events[i]);
+  BOOST_REQUIRE_EQUAL (iterations.size (), evaluations.size ());
+  for (std::size_t i = 0; i < iterations.size (); ++i)
+    {
+      BOOST_CHECK_EQUAL (iterations[i].index, static_cast<boost::int64_t> (i));
+      BOOST_CHECK (iterations[i].start <= evaluations[i].start);
+      BOOST_CHECK (evaluations[i].start + evaluations[i].duration
+		   <= iterations[i].start + iterations[i].duration);
+      if (i > 0)
+	BOOST_CHECK_EQUAL (iterations[i].start,
+			   iterations[i - 1].start
+			   + iterations[i - 1].duration);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (trace_threads)
+{
+  Tracer& tracer = Tracer::instance ();
+  tracer.clear ();
+  tracer.enable ();
+
+  const int threads = 4;
+  const int evaluations = 100;
+  F f ("shared");
+  boost::thread_group group;
+  for (int i = 0; i < threads; ++i)
+    group.create_thread (boost::bind (&evaluate, &f, evaluations));
+  group.join_all ();
+
+  // Each thread has its own buffer.
+  std::vector<TraceEvent> events = tracer.events ();
+  BOOST_CHECK_EQUAL (count (events, "test", "shared"),
+		     static_cast<std::size_t> (threads * evaluations));
+  std::set<unsigned> ids;
+  for (std::size_t i = 0; i < events.size (); ++i)
+    ids.insert (events[i].thread);
+  BOOST_CHECK_EQUAL (ids.size (), static_cast<std::size_t> (threads));
+
+  // When a buffer is full, the oldest spans are overwritten.
+  const std::size_t capacity = tracer.capacity ();
+  tracer.setCapacity (8);
+  tracer.clear ();
+  boost::thread overflow (boost::bind (&record, 20));
+  overflow.join ();
+  tracer.setCapacity (capacity);
+  tracer.disable ();
+
+  events = tracer.events ();
+  BOOST_REQUIRE_EQUAL (events.size (), 8u);
+  BOOST_CHECK_EQUAL (events.front ().index, 12);
+  BOOST_CHECK_EQUAL (events.back ().index, 19);
+  BOOST_CHECK_EQUAL (tracer.dropped (), 12u);
+
+  BOOST_CHECK_THROW (tracer.setCapacity (0), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (trace_concurrent_events)
+{
+  Tracer& tracer = Tracer::instance ();
+  tracer.clear ();
+  tracer.enable ();
+
+  // Read the spans while a thread keeps overwriting a small buffer: the
+  // spans being overwritten must be skipped, never returned torn.
+  const std::size_t capacity = tracer.capacity ();
+  tracer.setCapacity (8);
+  boost::atomic<bool> done (false);
+  boost::thread writer (boost::bind (&recordIndexed, 200000, &done));
+
+  std::size_t torn = 0;
+  while (!done.load ())
+    {
+      const std::vector<TraceEvent> events = tracer.events ();
+      for (std::size_t i = 0; i < events.size (); ++i)
+	{
+	  if (std::string ("indexed") != events[i].name)
+	    continue;
+	  if (events[i].start != static_cast<boost::uint64_t> (events[i].index)
+	      || events[i].duration != events[i].start)
+	    ++torn;
+	}
+    }
+  writer.join ();
+  tracer.setCapacity (capacity);
+  tracer.disable ();
+
+  BOOST_CHECK_EQUAL (torn, 0u);
+  BOOST_CHECK_EQUAL (count (tracer.events (), "test", "indexed"), 8u);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()